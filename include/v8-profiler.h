@@ -387,6 +387,63 @@ class V8EXPORT HeapSnapshot {
 };
 
 
+/**
+ * AllocationProfileNode represents a function in the call tree of a
+ * sampled allocation profile.
+ */
+class V8EXPORT AllocationProfileNode {
+ public:
+  /** Returns function name (empty string for anonymous functions.) */
+  Handle<String> GetFunctionName() const;
+
+  /** Returns resource name for script from where the function originates. */
+  Handle<String> GetScriptResourceName() const;
+
+  /**
+   * Returns the number, 1-based, of the line where the function originates.
+   * kNoLineNumberInfo if no line number information is available.
+   */
+  int GetLineNumber() const;
+
+  /**
+   * Returns the number of bytes allocated by the function itself,
+   * estimated from the samples.
+   */
+  double GetSelfSize() const;
+
+  /**
+   * Returns the number of bytes allocated by the function and the functions
+   * it called, estimated from the samples.
+   */
+  double GetTotalSize() const;
+
+  /** Returns the count of samples taken while the function allocated. */
+  int GetSelfSamplesCount() const;
+
+  /** Returns child nodes count of the node. */
+  int GetChildrenCount() const;
+
+  /** Retrieves a child node by index. */
+  const AllocationProfileNode* GetChild(int index) const;
+
+  static const int kNoLineNumberInfo = Message::kNoLineNumberInfo;
+};
+
+
+/**
+ * AllocationProfile contains the call tree of the allocations sampled since
+ * HeapProfiler::StartSamplingHeapProfiler was called.
+ */
+class V8EXPORT AllocationProfile {
+ public:
+  /** Returns the root node of the top down call tree. */
+  const AllocationProfileNode* GetRoot() const;
+
+  /** Returns the number of samples taken. */
+  int GetSamplesCount() const;
+};
+
+
 class RetainedObjectInfo;
 
 /**
@@ -468,6 +525,26 @@ class V8EXPORT HeapProfiler {
    */
   static void DeleteAllSnapshots();
 
+  /**
+   * Starts sampling allocations.  On average one allocation is sampled
+   * every sample_interval bytes, with random distances between samples.
+   * Each sample is attributed to the JavaScript stack at the time of the
+   * allocation.  Returns false if sampling is already running.
+   */
+  static bool StartSamplingHeapProfiler(int sample_interval = 512 * 1024);
+
+  /**
+   * Stops sampling allocations and deletes the profile.  All previously
+   * returned pointers to the profile and its nodes become invalid.
+   */
+  static void StopSamplingHeapProfiler();
+
+  /**
+   * Returns the allocations sampled so far, NULL if sampling is not
+   * running.  The profile keeps growing while sampling continues.
+   */
+  static const AllocationProfile* GetAllocationProfile();
+
   /** Binds a callback to embedder's class ID. */
   static void DefineWrapperClass(
       uint16_t class_id,
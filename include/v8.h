@@ -119,6 +119,7 @@ class Object;
 class Heap;
 class HeapObject;
 class Isolate;
+class StreamedSource;
 }
 
 
@@ -401,6 +402,17 @@ template <class T> class Persistent : public Handle<T> {
    */
   inline void MarkIndependent();
 
+  /**
+   * Marks the reference to this object partially dependent.  Partially
+   * dependent handles only depend on other partially dependent handles
+   * and these dependencies are provided through object groups added in
+   * a kGCTypeScavenge prologue callback.  This lets scavenges collect
+   * short-lived wrappers and run their weak callbacks, using object groups
+   * for young objects that cover only a subset of all external
+   * dependencies.  The mark is cleared after each garbage collection.
+   */
+  inline void MarkPartiallyDependent();
+
   /**
    *Checks if the handle holds the only reference to an object.
    */
@@ -527,6 +539,20 @@ class V8EXPORT ScriptData {  // NOLINT
    */
   static ScriptData* PreCompile(const char* input, int length);
 
+  /**
+   * Pre-compiles the specified script without using any isolate, so that it
+   * can be called on any thread, including while another thread is running
+   * JavaScript.  In addition to the usual pre-compilation data, the result
+   * holds the names and string literals of the script, which Script::New
+   * and Script::Compile turn into heap strings in one batch before parsing.
+   *
+   * Returns NULL if the script nests too deeply to be pre-compiled.
+   *
+   * \param input Pointer to UTF-8 script source code.
+   * \param length Length of UTF-8 script source code.
+   */
+  static ScriptData* PreCompileInBackground(const char* input, int length);
+
   /**
    * Pre-compiles the specified script (context-independent).
    *
@@ -538,7 +564,27 @@ class V8EXPORT ScriptData {  // NOLINT
   static ScriptData* PreCompile(Handle<String> source);
 
   /**
-   * Load previous pre-compilation data.
+   * Compiles the specified script in the current context and serializes the
+   * result into a code cache.  Passing the cache to Script::New or
+   * Script::Compile together with the same source skips parsing and
+   * compiling the top-level code and the functions that were compiled
+   * eagerly; the other functions are compiled lazily as usual.  The cache is
+   * ignored, and the script compiled normally, if the source, the V8 version
+   * or the V8 flags differ from when it was produced.
+   *
+   * Returns NULL if the script could not be compiled, in which case an
+   * exception is pending as for Script::New, or if its code cannot be
+   * cached.
+   *
+   * NOTE: The serialized data is specific to the build and the machine that
+   * produced it.
+   *
+   * \param source Script source code.
+   */
+  static ScriptData* CreateCodeCache(Handle<String> source);
+
+  /**
+   * Load previous pre-compilation data or a code cache.
    *
    * \param data Pointer to data returned by a call to Data() of a previous
    *   ScriptData. Ownership is not transferred.
@@ -564,6 +610,58 @@ class V8EXPORT ScriptData {  // NOLINT
 };
 
 
+/**
+ * Script source code that is delivered in chunks of UTF-8, for instance as
+ * it arrives from the network.
+ */
+class V8EXPORT ScriptSourceStream {  // NOLINT
+ public:
+  virtual ~ScriptSourceStream() { }
+
+  /**
+   * Sets *chunk to the next chunk of the source and returns its length in
+   * bytes, or returns 0 once the whole source has been delivered.  May block
+   * until more data is available.  The chunk must stay valid until the next
+   * call.  A multi-byte character may be split between two chunks.
+   */
+  virtual int GetNextChunk(const char** chunk) = 0;
+};
+
+
+/**
+ * A script source that is read from a ScriptSourceStream.  Scanning
+ * starts with the first chunk instead of after the last, and the decoded
+ * characters become the source string of the script without being copied
+ * again.
+ */
+class V8EXPORT StreamedSource {  // NOLINT
+ public:
+  /**
+   * The stream is owned by the caller and must stay alive until the source
+   * has been read.
+   */
+  explicit StreamedSource(ScriptSourceStream* stream);
+  ~StreamedSource();
+
+  /**
+   * Reads the whole stream and pre-compiles the script while the chunks
+   * arrive.  Does not use any isolate, so it may be called on another
+   * thread, after which the source is passed to Script::Compile on the
+   * isolate's thread.  Script::Compile calls it if it has not been called.
+   */
+  void Read();
+
+ private:
+  // Prevent copying.
+  StreamedSource(const StreamedSource&);
+  StreamedSource& operator=(const StreamedSource&);
+
+  internal::StreamedSource* impl_;
+
+  friend class Script;
+};
+
+
 /**
  * The origin, within a file, of a script.
  */
@@ -662,6 +760,21 @@ class V8EXPORT Script {
                                Handle<Value> file_name,
                                Handle<String> script_data = Handle<String>());
 
+  /**
+   * Compiles a script whose source is read from a stream (bound to current
+   * context).  The source string of the script is created from the decoded
+   * stream, and a StreamedSource can be compiled only once.
+   *
+   * \param source Streamed script source.  Owned by caller.
+   * \param origin Script origin, owned by caller, no references are kept
+   *   when Compile() returns
+   * \return Compiled script object, bound to the context that was active
+   *   when this function was called.  When run it will always use this
+   *   context.
+   */
+  static Local<Script> Compile(StreamedSource* source,
+                               ScriptOrigin* origin = NULL);
+
   /**
    * Runs the script returning the resulting value.  If the script is
    * context independent (created using ::New) it will be run in the
@@ -2610,6 +2723,8 @@ inline Handle<Boolean> False(Isolate* isolate);
 class V8EXPORT ResourceConstraints {
  public:
   ResourceConstraints();
+  // With --dynamic-new-space-sizing the young generation is grown up to this
+  // size when scavenges would otherwise take too much of the running time.
   int max_young_space_size() const { return max_young_space_size_; }
   void set_max_young_space_size(int value) { max_young_space_size_ = value; }
   int max_old_space_size() const { return max_old_space_size_; }
@@ -2749,6 +2864,7 @@ class V8EXPORT HeapStatistics {
   HeapStatistics();
   size_t total_heap_size() { return total_heap_size_; }
   size_t total_heap_size_executable() { return total_heap_size_executable_; }
+  size_t total_heap_size_huge_pages() { return total_heap_size_huge_pages_; }
   size_t used_heap_size() { return used_heap_size_; }
   size_t heap_size_limit() { return heap_size_limit_; }
 
@@ -2757,11 +2873,15 @@ class V8EXPORT HeapStatistics {
   void set_total_heap_size_executable(size_t size) {
     total_heap_size_executable_ = size;
   }
+  void set_total_heap_size_huge_pages(size_t size) {
+    total_heap_size_huge_pages_ = size;
+  }
   void set_used_heap_size(size_t size) { used_heap_size_ = size; }
   void set_heap_size_limit(size_t size) { heap_size_limit_ = size; }
 
   size_t total_heap_size_;
   size_t total_heap_size_executable_;
+  size_t total_heap_size_huge_pages_;
   size_t used_heap_size_;
   size_t heap_size_limit_;
 
@@ -2769,6 +2889,107 @@ class V8EXPORT HeapStatistics {
 };
 
 
+/**
+ * Memory usage of one space of the V8 heap.
+ *
+ * Instances of this class can be passed to v8::V8::GetHeapSpaceStatistics
+ * to get the statistics of the space with the given index.
+ */
+class V8EXPORT HeapSpaceStatistics {
+ public:
+  HeapSpaceStatistics();
+  const char* space_name() { return space_name_; }
+  size_t space_size() { return space_size_; }
+  size_t space_committed_size() { return space_committed_size_; }
+  size_t space_used_size() { return space_used_size_; }
+  size_t space_available_size() { return space_available_size_; }
+  /**
+   * Bytes of free memory that are too small to be used for allocation.
+   */
+  size_t space_fragmentation_size() { return space_fragmentation_size_; }
+
+ private:
+  const char* space_name_;
+  size_t space_size_;
+  size_t space_committed_size_;
+  size_t space_used_size_;
+  size_t space_available_size_;
+  size_t space_fragmentation_size_;
+
+  friend class V8;
+};
+
+
+/**
+ * Pause times of the garbage collections of one type broken down by the
+ * phases of the collection.  The pauses of the most recent collections are
+ * kept individually, all others only in the totals and histograms.
+ *
+ * Instances of this class can be passed to v8::V8::GetGCPauseStatistics.
+ */
+class V8EXPORT GCPauseStatistics {
+ public:
+  enum Phase {
+    kTotal,
+    kExternal,
+    kMark,
+    kSweep,
+    kSweepNewSpace,
+    kEvacuatePages,
+    kUpdateNewToNewPointers,
+    kUpdateRootToNewPointers,
+    kUpdateOldToNewPointers,
+    kUpdatePointersToEvacuated,
+    kUpdatePointersBetweenEvacuated,
+    kUpdateMiscPointers,
+    kFlushCode,
+    kNumberOfPhases
+  };
+
+  static const int kNumberOfBuckets = 16;
+  static const int kMaxSamples = 32;
+
+  GCPauseStatistics();
+
+  /**
+   * Number of collections of this type since the isolate was created.
+   */
+  int gc_count() { return gc_count_; }
+  double total_ms(Phase phase) { return total_ms_[phase]; }
+  double max_ms(Phase phase) { return max_ms_[phase]; }
+
+  /**
+   * Number of collections where the phase took less than 2^bucket ms but
+   * not less than 2^(bucket - 1) ms.  Bucket 0 counts the phases that took
+   * less than 1 ms and the last bucket also counts all longer ones.
+   * Phases that took no time at all are not counted.
+   */
+  int histogram(Phase phase, int bucket) { return histogram_[phase][bucket]; }
+
+  /**
+   * Number of recent collections kept individually, at most kMaxSamples.
+   */
+  int sample_count() { return sample_count_; }
+
+  /**
+   * Time the phase took in a recent collection, starting with the oldest.
+   */
+  double sample_ms(int sample, Phase phase) {
+    return sample_ms_[sample][phase];
+  }
+
+ private:
+  int gc_count_;
+  double total_ms_[kNumberOfPhases];
+  double max_ms_[kNumberOfPhases];
+  int histogram_[kNumberOfPhases][kNumberOfBuckets];
+  int sample_count_;
+  double sample_ms_[kMaxSamples][kNumberOfPhases];
+
+  friend class V8;
+};
+
+
 class RetainedObjectInfo;
 
 /**
@@ -3164,7 +3385,8 @@ class V8EXPORT V8 {
    * After each garbage collection, object groups are removed. It is
    * intended to be used in the before-garbage-collection callback
    * function, for instance to simulate DOM tree connections among JS
-   * wrapper objects.
+   * wrapper objects.  Scavenges only honor object groups for handles
+   * marked partially dependent, see Persistent::MarkPartiallyDependent.
    * See v8-profiler.h for RetainedObjectInfo interface description.
    */
   static void AddObjectGroup(Persistent<Value>* objects,
@@ -3329,6 +3551,27 @@ class V8EXPORT V8 {
    */
   static void GetHeapStatistics(HeapStatistics* heap_statistics);
 
+  /**
+   * Returns the number of spaces of the heap, see GetHeapSpaceStatistics.
+   */
+  static int NumberOfHeapSpaces();
+
+  /**
+   * Get statistics about the memory usage of the space with the given index
+   * between 0 and NumberOfHeapSpaces() - 1.  Returns false if the index is
+   * out of range.
+   */
+  static bool GetHeapSpaceStatistics(HeapSpaceStatistics* space_statistics,
+                                     int index);
+
+  /**
+   * Get the pause times of the scavenges or of the mark-compact
+   * collections.  The type must be either kGCTypeScavenge or
+   * kGCTypeMarkSweepCompact.
+   */
+  static void GetGCPauseStatistics(GCType type,
+                                   GCPauseStatistics* pause_statistics);
+
   /**
    * Iterates through all external resources referenced from current isolate
    * heap. This method is not expected to be used except for debugging purposes
@@ -3350,6 +3593,18 @@ class V8EXPORT V8 {
    */
   static bool IdleNotification(int hint = 1000);
 
+  /**
+   * Optional notification that the embedder is idle for the next
+   * idle_time_in_ms milliseconds.  V8 uses the time for the garbage
+   * collection work it estimates to fit: incremental marking steps, lazy
+   * sweeping, finalizing incremental marking or a scavenge.  The time
+   * actually spent is stored in time_used_in_ms unless it is NULL.
+   * Returns true if the embedder should stop calling the idle notification
+   * until real work has been done, as for IdleNotification.
+   */
+  static bool IdleNotificationDeadline(int idle_time_in_ms,
+                                       double* time_used_in_ms = NULL);
+
   /**
    * Optional notification that the system is running low on memory.
    * V8 uses these notifications to attempt to free memory.
@@ -3374,6 +3629,7 @@ class V8EXPORT V8 {
                        WeakReferenceCallback);
   static void ClearWeak(internal::Object** global_handle);
   static void MarkIndependent(internal::Object** global_handle);
+  static void MarkPartiallyDependent(internal::Object** global_handle);
   static bool IsGlobalNearDeath(internal::Object** global_handle);
   static bool IsGlobalWeak(internal::Object** global_handle);
   static void SetWrapperClassId(internal::Object** global_handle,
@@ -3968,7 +4224,7 @@ class Internals {
   static const int kFalseValueRootIndex = 9;
   static const int kEmptySymbolRootIndex = 112;
 
-  static const int kJSObjectType = 0xaa;
+  static const int kJSObjectType = 0xac;
   static const int kFirstNonstringType = 0x80;
   static const int kOddballType = 0x82;
   static const int kForeignType = 0x85;
@@ -4126,6 +4382,11 @@ void Persistent<T>::MarkIndependent() {
   V8::MarkIndependent(reinterpret_cast<internal::Object**>(**this));
 }
 
+template <class T>
+void Persistent<T>::MarkPartiallyDependent() {
+  V8::MarkPartiallyDependent(reinterpret_cast<internal::Object**>(**this));
+}
+
 template <class T>
 void Persistent<T>::SetWrapperClassId(uint16_t class_id) {
   V8::SetWrapperClassId(reinterpret_cast<internal::Object**>(**this), class_id);
@@ -52,7 +52,9 @@
 #include "property-details.h"
 #include "property.h"
 #include "runtime-profiler.h"
+#include "sampling-heap-profiler.h"
 #include "scanner-character-streams.h"
+#include "serialize.h"
 #include "snapshot.h"
 #include "unicode-inl.h"
 #include "v8threads.h"
@@ -646,6 +648,13 @@ void V8::MarkIndependent(i::Object** object) {
 }
 
 
+void V8::MarkPartiallyDependent(i::Object** object) {
+  i::Isolate* isolate = i::Isolate::Current();
+  LOG_API(isolate, "MarkPartiallyDependent");
+  isolate->global_handles()->MarkPartiallyDependent(object);
+}
+
+
 bool V8::IsGlobalNearDeath(i::Object** obj) {
   i::Isolate* isolate = i::Isolate::Current();
   LOG_API(isolate, "IsGlobalNearDeath");
@@ -1460,6 +1469,14 @@ ScriptData* ScriptData::PreCompile(const char* input, int length) {
 }
 
 
+ScriptData* ScriptData::PreCompileInBackground(const char* input,
+                                               int length) {
+  i::Utf8ToUtf16CharacterStream stream(
+      reinterpret_cast<const unsigned char*>(input), length);
+  return i::ParserApi::PreParseInBackground(&stream, i::FLAG_harmony_scoping);
+}
+
+
 ScriptData* ScriptData::PreCompile(v8::Handle<String> source) {
   i::Handle<i::String> str = Utils::OpenHandle(*source);
   if (str->IsExternalTwoByteString()) {
@@ -1473,6 +1490,23 @@ ScriptData* ScriptData::PreCompile(v8::Handle<String> source) {
 }
 
 
+ScriptData* ScriptData::CreateCodeCache(v8::Handle<String> source) {
+  i::Isolate* isolate = i::Isolate::Current();
+  ON_BAILOUT(isolate, "v8::ScriptData::CreateCodeCache()", return NULL);
+  LOG_API(isolate, "ScriptData::CreateCodeCache");
+  ENTER_V8(isolate);
+  i::HandleScope scope(isolate);
+  i::CodeCacheScope code_cache_scope(isolate);
+  i::Handle<i::String> str = Utils::OpenHandle(*source);
+  EXCEPTION_PREAMBLE(isolate);
+  i::Handle<i::SharedFunctionInfo> result =
+      i::Compiler::CompileForCodeCache(str);
+  has_pending_exception = result.is_null();
+  EXCEPTION_BAILOUT_CHECK(isolate, NULL);
+  return i::CodeSerializer::Serialize(result);
+}
+
+
 ScriptData* ScriptData::New(const char* data, int length) {
   // Return an empty ScriptData if the length is obviously invalid.
   if (length % sizeof(unsigned) != 0) {
@@ -1481,16 +1515,41 @@ ScriptData* ScriptData::New(const char* data, int length) {
 
   // Copy the data to ensure it is properly aligned.
   int deserialized_data_length = length / sizeof(unsigned);
+  unsigned magic = 0;
+  if (length >= static_cast<int>(sizeof(magic))) {
+    i::OS::MemCopy(&magic, data, sizeof(magic));
+  }
+  bool is_code_cache = magic == i::CodeSerializer::kMagicNumber;
   // If aligned, don't create a copy of the data.
   if (reinterpret_cast<intptr_t>(data) % sizeof(unsigned) == 0) {
+    if (is_code_cache) return new i::CodeCacheData(data, length);
     return new i::ScriptDataImpl(data, length);
   }
   // Copy the data to align it.
   unsigned* deserialized_data = i::NewArray<unsigned>(deserialized_data_length);
   i::OS::MemCopy(deserialized_data, data, length);
 
-  return new i::ScriptDataImpl(
-      i::Vector<unsigned>(deserialized_data, deserialized_data_length));
+  i::Vector<unsigned> store(deserialized_data, deserialized_data_length);
+  if (is_code_cache) return new i::CodeCacheData(store);
+  return new i::ScriptDataImpl(store);
+}
+
+
+// --- S t r e a m e d S o u r c e ---
+
+
+StreamedSource::StreamedSource(ScriptSourceStream* stream)
+    : impl_(new i::StreamedSource(stream)) {
+}
+
+
+StreamedSource::~StreamedSource() {
+  delete impl_;
+}
+
+
+void StreamedSource::Read() {
+  impl_->Read();
 }
 
 
@@ -1524,24 +1583,34 @@ Local<Script> Script::New(v8::Handle<String> source,
       }
     }
     EXCEPTION_PREAMBLE(isolate);
-    i::ScriptDataImpl* pre_data_impl =
-        static_cast<i::ScriptDataImpl*>(pre_data);
-    // We assert that the pre-data is sane, even though we can actually
-    // handle it if it turns out not to be in release mode.
-    ASSERT(pre_data_impl == NULL || pre_data_impl->SanityCheck());
-    // If the pre-data isn't sane we simply ignore it
-    if (pre_data_impl != NULL && !pre_data_impl->SanityCheck()) {
-      pre_data_impl = NULL;
+    i::Handle<i::SharedFunctionInfo> result;
+    if (pre_data != NULL && i::CodeSerializer::IsCodeCache(pre_data)) {
+      result = i::Compiler::CompileWithCodeCache(
+          str,
+          name_obj,
+          line_offset,
+          column_offset,
+          static_cast<i::CodeCacheData*>(pre_data),
+          Utils::OpenHandle(*script_data));
+    } else {
+      i::ScriptDataImpl* pre_data_impl =
+          static_cast<i::ScriptDataImpl*>(pre_data);
+      // We assert that the pre-data is sane, even though we can actually
+      // handle it if it turns out not to be in release mode.
+      ASSERT(pre_data_impl == NULL || pre_data_impl->SanityCheck());
+      // If the pre-data isn't sane we simply ignore it
+      if (pre_data_impl != NULL && !pre_data_impl->SanityCheck()) {
+        pre_data_impl = NULL;
+      }
+      result = i::Compiler::Compile(str,
+                                    name_obj,
+                                    line_offset,
+                                    column_offset,
+                                    NULL,
+                                    pre_data_impl,
+                                    Utils::OpenHandle(*script_data),
+                                    i::NOT_NATIVES_CODE);
     }
-    i::Handle<i::SharedFunctionInfo> result =
-      i::Compiler::Compile(str,
-                           name_obj,
-                           line_offset,
-                           column_offset,
-                           NULL,
-                           pre_data_impl,
-                           Utils::OpenHandle(*script_data),
-                           i::NOT_NATIVES_CODE);
     has_pending_exception = result.is_null();
     EXCEPTION_BAILOUT_CHECK(isolate, Local<Script>());
     raw_result = *result;
@@ -1588,6 +1657,19 @@ Local<Script> Script::Compile(v8::Handle<String> source,
 }
 
 
+Local<Script> Script::Compile(StreamedSource* source,
+                              v8::ScriptOrigin* origin) {
+  i::Isolate* isolate = i::Isolate::Current();
+  ON_BAILOUT(isolate, "v8::Script::Compile()", return Local<Script>());
+  LOG_API(isolate, "Script::Compile(StreamedSource)");
+  ENTER_V8(isolate);
+  i::StreamedSource* impl = source->impl_;
+  if (!impl->has_been_read()) impl->Read();
+  Local<String> str = Utils::ToLocal(impl->Source(isolate));
+  return Compile(str, origin, impl->pre_data());
+}
+
+
 Local<Value> Script::Run() {
   i::Isolate* isolate = i::Isolate::Current();
   ON_BAILOUT(isolate, "v8::Script::Run()", return Local<Value>());
@@ -4252,6 +4334,7 @@ bool v8::V8::Dispose() {
 
 HeapStatistics::HeapStatistics(): total_heap_size_(0),
                                   total_heap_size_executable_(0),
+                                  total_heap_size_huge_pages_(0),
                                   used_heap_size_(0),
                                   heap_size_limit_(0) { }
 
@@ -4261,6 +4344,7 @@ void v8::V8::GetHeapStatistics(HeapStatistics* heap_statistics) {
     // Isolate is unitialized thus heap is not configured yet.
     heap_statistics->set_total_heap_size(0);
     heap_statistics->set_total_heap_size_executable(0);
+    heap_statistics->set_total_heap_size_huge_pages(0);
     heap_statistics->set_used_heap_size(0);
     heap_statistics->set_heap_size_limit(0);
     return;
@@ -4270,11 +4354,125 @@ void v8::V8::GetHeapStatistics(HeapStatistics* heap_statistics) {
   heap_statistics->set_total_heap_size(heap->CommittedMemory());
   heap_statistics->set_total_heap_size_executable(
       heap->CommittedMemoryExecutable());
+  heap_statistics->set_total_heap_size_huge_pages(
+      heap->CommittedMemoryHugePages());
   heap_statistics->set_used_heap_size(heap->SizeOfObjects());
   heap_statistics->set_heap_size_limit(heap->MaxReserved());
 }
 
 
+HeapSpaceStatistics::HeapSpaceStatistics(): space_name_(0),
+                                            space_size_(0),
+                                            space_committed_size_(0),
+                                            space_used_size_(0),
+                                            space_available_size_(0),
+                                            space_fragmentation_size_(0) { }
+
+
+int v8::V8::NumberOfHeapSpaces() {
+  return i::LAST_SPACE - i::FIRST_SPACE + 1;
+}
+
+
+bool v8::V8::GetHeapSpaceStatistics(HeapSpaceStatistics* space_statistics,
+                                    int index) {
+  if (index < 0 || index >= NumberOfHeapSpaces()) return false;
+  i::AllocationSpace identity =
+      static_cast<i::AllocationSpace>(i::FIRST_SPACE + index);
+  space_statistics->space_name_ = i::AllocationSpaceName(identity);
+
+  i::Isolate* isolate = i::Isolate::Current();
+  if (!isolate->IsInitialized()) {
+    // Isolate is unitialized thus heap is not configured yet.
+    space_statistics->space_size_ = 0;
+    space_statistics->space_committed_size_ = 0;
+    space_statistics->space_used_size_ = 0;
+    space_statistics->space_available_size_ = 0;
+    space_statistics->space_fragmentation_size_ = 0;
+    return true;
+  }
+
+  i::Heap* heap = isolate->heap();
+  if (identity == i::NEW_SPACE) {
+    i::NewSpace* space = heap->new_space();
+    space_statistics->space_size_ = space->Size();
+    space_statistics->space_committed_size_ = space->CommittedMemory();
+    space_statistics->space_used_size_ = space->SizeOfObjects();
+    space_statistics->space_available_size_ = space->Available();
+    space_statistics->space_fragmentation_size_ = 0;
+  } else if (identity == i::LO_SPACE) {
+    i::LargeObjectSpace* space = heap->lo_space();
+    space_statistics->space_size_ = space->Size();
+    space_statistics->space_committed_size_ = space->CommittedMemory();
+    space_statistics->space_used_size_ = space->SizeOfObjects();
+    space_statistics->space_available_size_ = space->Available();
+    space_statistics->space_fragmentation_size_ = 0;
+  } else {
+    i::PagedSpace* space = heap->paged_space(identity);
+    space_statistics->space_size_ = space->Size();
+    space_statistics->space_committed_size_ = space->CommittedMemory();
+    space_statistics->space_used_size_ = space->SizeOfObjects();
+    space_statistics->space_available_size_ = space->Available();
+    space_statistics->space_fragmentation_size_ = space->Waste();
+  }
+  return true;
+}
+
+
+GCPauseStatistics::GCPauseStatistics() : gc_count_(0), sample_count_(0) {
+  for (int phase = 0; phase < kNumberOfPhases; phase++) {
+    total_ms_[phase] = 0;
+    max_ms_[phase] = 0;
+    for (int bucket = 0; bucket < kNumberOfBuckets; bucket++) {
+      histogram_[phase][bucket] = 0;
+    }
+  }
+}
+
+
+void v8::V8::GetGCPauseStatistics(GCType type,
+                                  GCPauseStatistics* pause_statistics) {
+  STATIC_ASSERT(static_cast<int>(GCPauseStatistics::kNumberOfPhases) ==
+                i::GCPauseHistory::kNumberOfPhases);
+  STATIC_ASSERT(static_cast<int>(GCPauseStatistics::kNumberOfBuckets) ==
+                i::GCPauseHistory::kNumberOfBuckets);
+  STATIC_ASSERT(static_cast<int>(GCPauseStatistics::kMaxSamples) ==
+                i::GCPauseHistory::kCapacity);
+  if (!ApiCheck(type == kGCTypeScavenge || type == kGCTypeMarkSweepCompact,
+                "v8::V8::GetGCPauseStatistics()",
+                "Type must be kGCTypeScavenge or kGCTypeMarkSweepCompact")) {
+    return;
+  }
+  i::Isolate* isolate = i::Isolate::Current();
+  if (!isolate->IsInitialized()) {
+    // Isolate is unitialized thus no collection has happened yet.
+    *pause_statistics = GCPauseStatistics();
+    return;
+  }
+
+  i::Heap* heap = isolate->heap();
+  i::GCPauseHistory* pauses = (type == kGCTypeScavenge)
+      ? heap->scavenge_pauses()
+      : heap->mark_compact_pauses();
+  pause_statistics->gc_count_ = pauses->count();
+  pause_statistics->sample_count_ = pauses->length();
+  for (int phase = 0; phase < GCPauseStatistics::kNumberOfPhases; phase++) {
+    pause_statistics->total_ms_[phase] = pauses->total(phase);
+    pause_statistics->max_ms_[phase] = pauses->max(phase);
+    for (int bucket = 0;
+         bucket < GCPauseStatistics::kNumberOfBuckets;
+         bucket++) {
+      pause_statistics->histogram_[phase][bucket] =
+          pauses->histogram(phase, bucket);
+    }
+    for (int sample = 0; sample < pauses->length(); sample++) {
+      pause_statistics->sample_ms_[sample][phase] =
+          pauses->sample(sample, phase);
+    }
+  }
+}
+
+
 void v8::V8::VisitExternalResources(ExternalResourceVisitor* visitor) {
   i::Isolate* isolate = i::Isolate::Current();
   IsDeadCheck(isolate, "v8::V8::VisitExternalResources");
@@ -4291,6 +4489,17 @@ bool v8::V8::IdleNotification(int hint) {
 }
 
 
+bool v8::V8::IdleNotificationDeadline(int idle_time_in_ms,
+                                      double* time_used_in_ms) {
+  i::Isolate* isolate = i::Isolate::Current();
+  if (isolate == NULL || !isolate->IsInitialized()) {
+    if (time_used_in_ms != NULL) *time_used_in_ms = 0;
+    return true;
+  }
+  return i::V8::IdleNotificationDeadline(idle_time_in_ms, time_used_in_ms);
+}
+
+
 void v8::V8::LowMemoryNotification() {
   i::Isolate* isolate = i::Isolate::Current();
   if (isolate == NULL || !isolate->IsInitialized()) return;
@@ -6274,6 +6483,115 @@ void HeapProfiler::DeleteAllSnapshots() {
 }
 
 
+Handle<String> AllocationProfileNode::GetFunctionName() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetFunctionName");
+  const i::AllocationNode* node =
+      reinterpret_cast<const i::AllocationNode*>(this);
+  return Handle<String>(ToApi<String>(
+      isolate->factory()->LookupAsciiSymbol(node->name())));
+}
+
+
+Handle<String> AllocationProfileNode::GetScriptResourceName() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetScriptResourceName");
+  const i::AllocationNode* node =
+      reinterpret_cast<const i::AllocationNode*>(this);
+  return Handle<String>(ToApi<String>(
+      isolate->factory()->LookupAsciiSymbol(node->script_name())));
+}
+
+
+int AllocationProfileNode::GetLineNumber() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetLineNumber");
+  return reinterpret_cast<const i::AllocationNode*>(this)->line_number();
+}
+
+
+double AllocationProfileNode::GetSelfSize() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetSelfSize");
+  return reinterpret_cast<const i::AllocationNode*>(this)->self_size();
+}
+
+
+double AllocationProfileNode::GetTotalSize() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetTotalSize");
+  return reinterpret_cast<const i::AllocationNode*>(this)->TotalSize();
+}
+
+
+int AllocationProfileNode::GetSelfSamplesCount() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetSelfSamplesCount");
+  return reinterpret_cast<const i::AllocationNode*>(this)->self_count();
+}
+
+
+int AllocationProfileNode::GetChildrenCount() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetChildrenCount");
+  return reinterpret_cast<const i::AllocationNode*>(this)->children()->length();
+}
+
+
+const AllocationProfileNode* AllocationProfileNode::GetChild(int index) const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfileNode::GetChild");
+  const i::AllocationNode* child =
+      reinterpret_cast<const i::AllocationNode*>(this)->children()->at(index);
+  return reinterpret_cast<const AllocationProfileNode*>(child);
+}
+
+
+const AllocationProfileNode* AllocationProfile::GetRoot() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfile::GetRoot");
+  const i::SamplingHeapProfiler* profiler =
+      reinterpret_cast<const i::SamplingHeapProfiler*>(this);
+  return reinterpret_cast<const AllocationProfileNode*>(profiler->root());
+}
+
+
+int AllocationProfile::GetSamplesCount() const {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::AllocationProfile::GetSamplesCount");
+  const i::SamplingHeapProfiler* profiler =
+      reinterpret_cast<const i::SamplingHeapProfiler*>(this);
+  return profiler->samples_count();
+}
+
+
+bool HeapProfiler::StartSamplingHeapProfiler(int sample_interval) {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::HeapProfiler::StartSamplingHeapProfiler");
+  if (!ApiCheck(sample_interval > 0,
+                "v8::HeapProfiler::StartSamplingHeapProfiler()",
+                "Sample interval must be positive")) {
+    return false;
+  }
+  return i::HeapProfiler::StartSamplingHeapProfiler(sample_interval);
+}
+
+
+void HeapProfiler::StopSamplingHeapProfiler() {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::HeapProfiler::StopSamplingHeapProfiler");
+  i::HeapProfiler::StopSamplingHeapProfiler();
+}
+
+
+const AllocationProfile* HeapProfiler::GetAllocationProfile() {
+  i::Isolate* isolate = i::Isolate::Current();
+  IsDeadCheck(isolate, "v8::HeapProfiler::GetAllocationProfile");
+  return reinterpret_cast<const AllocationProfile*>(
+      i::HeapProfiler::GetSamplingHeapProfiler());
+}
+
+
 void HeapProfiler::DefineWrapperClass(uint16_t class_id,
                                       WrapperInfoCallback callback) {
   i::Isolate::Current()->heap_profiler()->DefineWrapperClass(class_id,
@@ -782,7 +782,7 @@ bool Operand::must_use_constant_pool() const {
       Serializer::TooLateToEnableNow();
     }
 #endif  // def DEBUG
-    return Serializer::enabled();
+    return Serializer::enabled(Isolate::UncheckedCurrent());
   } else if (rmode_ == RelocInfo::NONE) {
     return false;
   }
@@ -2547,7 +2547,7 @@ void Assembler::RecordRelocInfo(RelocInfo::Mode rmode, intptr_t data) {
         Serializer::TooLateToEnableNow();
       }
 #endif
-      if (!Serializer::enabled() && !emit_debug_code()) {
+      if (!Serializer::enabled(isolate()) && !emit_debug_code()) {
         return;
       }
     }
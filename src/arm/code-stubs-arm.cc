@@ -330,16 +330,77 @@ void FastNewBlockContextStub::Generate(MacroAssembler* masm) {
 }
 
 
+// Replaces an allocation site in boilerplate by the boilerplate it tracks.
+// Sites are copied here without tracking, except for every n-th copy, which
+// the runtime tracks.  Copies of a site that decided to tenure continue at
+// tenured.
+static void GenerateLoadSiteBoilerplate(MacroAssembler* masm,
+                                        Register boilerplate,
+                                        Register scratch,
+                                        Label* slow_case,
+                                        Label* tenured) {
+  Label done;
+  __ ldr(scratch, FieldMemOperand(boilerplate, HeapObject::kMapOffset));
+  __ CompareRoot(scratch, Heap::kAllocationSiteMapRootIndex);
+  __ b(ne, &done);
+  __ ldr(scratch,
+         FieldMemOperand(boilerplate, AllocationSite::kCopyCountOffset));
+  __ add(scratch, scratch, Operand(Smi::FromInt(1)));
+  __ str(scratch,
+         FieldMemOperand(boilerplate, AllocationSite::kCopyCountOffset));
+  __ cmp(scratch, Operand(Smi::FromInt(AllocationSite::kStubSampleInterval)));
+  __ b(ge, slow_case);
+  __ ldr(scratch, FieldMemOperand(boilerplate,
+                                  AllocationSite::kPretenureDecisionOffset));
+  __ ldr(boilerplate,
+         FieldMemOperand(boilerplate, AllocationSite::kBoilerplateOffset));
+  __ cmp(scratch, Operand(Smi::FromInt(AllocationSite::kTenure)));
+  __ b(eq, tenured);
+  __ bind(&done);
+}
+
+
+// Enters the fields of object between start_offset and end_offset that
+// point to new space into the store buffer.  Used for copies allocated in
+// old space, which are filled without a write barrier.
+static void GenerateRecordNewSpaceFields(MacroAssembler* masm,
+                                         Register object,
+                                         int start_offset,
+                                         int end_offset,
+                                         Register value,
+                                         Register address) {
+  for (int i = start_offset; i < end_offset; i += kPointerSize) {
+    Label skip;
+    __ ldr(value, FieldMemOperand(object, i));
+    __ JumpIfSmi(value, &skip);
+    __ JumpIfNotInNewSpace(value, address, &skip);
+    __ add(address, object, Operand(i - kHeapObjectTag));
+    __ RememberedSetHelper(object, address, value, kDontSaveFPRegs,
+                           MacroAssembler::kFallThroughAtEnd);
+    __ bind(&skip);
+  }
+}
+
+
 static void GenerateFastCloneShallowArrayCommon(
     MacroAssembler* masm,
     int length,
     FastCloneShallowArrayStub::Mode mode,
+    PretenureFlag pretenure,
     Label* fail) {
   // Registers on entry:
   //
   // r3: boilerplate literal array.
   ASSERT(mode != FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS);
 
+  // Double arrays belong in old data space, leave them to the runtime.
+  if (pretenure == TENURED &&
+      mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS &&
+      length > 0) {
+    __ jmp(fail);
+    return;
+  }
+
   // All sizes here are multiples of kPointerSize.
   int elements_size = 0;
   if (length > 0) {
@@ -351,12 +412,16 @@ static void GenerateFastCloneShallowArrayCommon(
 
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
   __ AllocateInNewSpace(size,
                         r0,
                         r1,
                         r2,
                         fail,
-                        TAG_OBJECT);
+                        flags);
 
   // Copy the JS array part.
   for (int i = 0; i < JSArray::kSize; i += kPointerSize) {
@@ -377,34 +442,34 @@ static void GenerateFastCloneShallowArrayCommon(
     ASSERT((elements_size % kPointerSize) == 0);
     __ CopyFields(r2, r3, r1.bit(), elements_size / kPointerSize);
   }
-}
 
-void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
-  // Stack layout on entry:
-  //
-  // [sp]: constant elements.
-  // [sp + kPointerSize]: literal index.
-  // [sp + (2 * kPointerSize)]: literals array.
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, r0, JSObject::kPropertiesOffset,
+                                 JSArray::kSize, r1, r3);
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
+      __ add(r2, r0, Operand(JSArray::kSize));
+      GenerateRecordNewSpaceFields(masm, r2, FixedArray::kHeaderSize,
+                                   elements_size, r1, r3);
+    }
+  }
+}
 
-  // Load boilerplate object into r3 and check if we need to create a
-  // boilerplate.
-  Label slow_case;
-  __ ldr(r3, MemOperand(sp, 2 * kPointerSize));
-  __ ldr(r0, MemOperand(sp, 1 * kPointerSize));
-  __ add(r3, r3, Operand(FixedArray::kHeaderSize - kHeapObjectTag));
-  __ ldr(r3, MemOperand(r3, r0, LSL, kPointerSizeLog2 - kSmiTagSize));
-  __ CompareRoot(r3, Heap::kUndefinedValueRootIndex);
-  __ b(eq, &slow_case);
 
-  FastCloneShallowArrayStub::Mode mode = mode_;
-  if (mode == CLONE_ANY_ELEMENTS) {
+static void GenerateFastCloneShallowArray(MacroAssembler* masm,
+                                          int length,
+                                          FastCloneShallowArrayStub::Mode mode,
+                                          PretenureFlag pretenure,
+                                          Label* fail) {
+  // r3 is boilerplate object.
+  if (mode == FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS) {
     Label double_elements, check_fast_elements;
     __ ldr(r0, FieldMemOperand(r3, JSArray::kElementsOffset));
     __ ldr(r0, FieldMemOperand(r0, HeapObject::kMapOffset));
     __ CompareRoot(r0, Heap::kFixedCOWArrayMapRootIndex);
     __ b(ne, &check_fast_elements);
-    GenerateFastCloneShallowArrayCommon(masm, 0,
-                                        COPY_ON_WRITE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, 0, FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS, pretenure,
+        fail);
     // Return and remove the on-stack parameters.
     __ add(sp, sp, Operand(3 * kPointerSize));
     __ Ret();
@@ -412,28 +477,29 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
     __ bind(&check_fast_elements);
     __ CompareRoot(r0, Heap::kFixedArrayMapRootIndex);
     __ b(ne, &double_elements);
-    GenerateFastCloneShallowArrayCommon(masm, length_,
-                                        CLONE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, length, FastCloneShallowArrayStub::CLONE_ELEMENTS, pretenure,
+        fail);
     // Return and remove the on-stack parameters.
     __ add(sp, sp, Operand(3 * kPointerSize));
     __ Ret();
 
     __ bind(&double_elements);
-    mode = CLONE_DOUBLE_ELEMENTS;
+    mode = FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS;
     // Fall through to generate the code to handle double elements.
   }
 
   if (FLAG_debug_code) {
     const char* message;
     Heap::RootListIndex expected_map_index;
-    if (mode == CLONE_ELEMENTS) {
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
       message = "Expected (writable) fixed array";
       expected_map_index = Heap::kFixedArrayMapRootIndex;
-    } else if (mode == CLONE_DOUBLE_ELEMENTS) {
+    } else if (mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS) {
       message = "Expected (writable) fixed double array";
       expected_map_index = Heap::kFixedDoubleArrayMapRootIndex;
     } else {
-      ASSERT(mode == COPY_ON_WRITE_ELEMENTS);
+      ASSERT(mode == FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS);
       message = "Expected copy-on-write fixed array";
       expected_map_index = Heap::kFixedCOWArrayMapRootIndex;
     }
@@ -445,54 +511,107 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
     __ pop(r3);
   }
 
-  GenerateFastCloneShallowArrayCommon(masm, length_, mode, &slow_case);
+  GenerateFastCloneShallowArrayCommon(masm, length, mode, pretenure, fail);
 
   // Return and remove the on-stack parameters.
   __ add(sp, sp, Operand(3 * kPointerSize));
   __ Ret();
-
-  __ bind(&slow_case);
-  __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
 }
 
 
-void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
+void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
   // Stack layout on entry:
   //
-  // [sp]: object literal flags.
-  // [sp + kPointerSize]: constant properties.
-  // [sp + (2 * kPointerSize)]: literal index.
-  // [sp + (3 * kPointerSize)]: literals array.
+  // [sp]: constant elements.
+  // [sp + kPointerSize]: literal index.
+  // [sp + (2 * kPointerSize)]: literals array.
 
   // Load boilerplate object into r3 and check if we need to create a
   // boilerplate.
-  Label slow_case;
-  __ ldr(r3, MemOperand(sp, 3 * kPointerSize));
-  __ ldr(r0, MemOperand(sp, 2 * kPointerSize));
+  Label slow_case, tenured;
+  __ ldr(r3, MemOperand(sp, 2 * kPointerSize));
+  __ ldr(r0, MemOperand(sp, 1 * kPointerSize));
   __ add(r3, r3, Operand(FixedArray::kHeaderSize - kHeapObjectTag));
   __ ldr(r3, MemOperand(r3, r0, LSL, kPointerSizeLog2 - kSmiTagSize));
   __ CompareRoot(r3, Heap::kUndefinedValueRootIndex);
   __ b(eq, &slow_case);
+  GenerateLoadSiteBoilerplate(
+      masm, r3, r0, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  GenerateFastCloneShallowArray(masm, length_, mode_, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowArray(masm, length_, mode_, TENURED, &slow_case);
+  }
+
+  __ bind(&slow_case);
+  __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
+}
+
+
+static void GenerateFastCloneShallowObject(MacroAssembler* masm,
+                                           int size,
+                                           PretenureFlag pretenure,
+                                           Label* fail) {
+  // r3 is boilerplate object.
 
   // Check that the boilerplate contains only fast properties and we can
   // statically determine the instance size.
-  int size = JSObject::kHeaderSize + length_ * kPointerSize;
   __ ldr(r0, FieldMemOperand(r3, HeapObject::kMapOffset));
   __ ldrb(r0, FieldMemOperand(r0, Map::kInstanceSizeOffset));
   __ cmp(r0, Operand(size >> kPointerSizeLog2));
-  __ b(ne, &slow_case);
+  __ b(ne, fail);
 
   // Allocate the JS object and copy header together with all in-object
   // properties from the boilerplate.
-  __ AllocateInNewSpace(size, r0, r1, r2, &slow_case, TAG_OBJECT);
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
+  __ AllocateInNewSpace(size, r0, r1, r2, fail, flags);
   for (int i = 0; i < size; i += kPointerSize) {
     __ ldr(r1, FieldMemOperand(r3, i));
     __ str(r1, FieldMemOperand(r0, i));
   }
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, r0, JSObject::kPropertiesOffset, size,
+                                 r1, r3);
+  }
 
   // Return and remove the on-stack parameters.
   __ add(sp, sp, Operand(4 * kPointerSize));
   __ Ret();
+}
+
+
+void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
+  // Stack layout on entry:
+  //
+  // [sp]: object literal flags.
+  // [sp + kPointerSize]: constant properties.
+  // [sp + (2 * kPointerSize)]: literal index.
+  // [sp + (3 * kPointerSize)]: literals array.
+
+  // Load boilerplate object into r3 and check if we need to create a
+  // boilerplate.
+  Label slow_case, tenured;
+  __ ldr(r3, MemOperand(sp, 3 * kPointerSize));
+  __ ldr(r0, MemOperand(sp, 2 * kPointerSize));
+  __ add(r3, r3, Operand(FixedArray::kHeaderSize - kHeapObjectTag));
+  __ ldr(r3, MemOperand(r3, r0, LSL, kPointerSizeLog2 - kSmiTagSize));
+  __ CompareRoot(r3, Heap::kUndefinedValueRootIndex);
+  __ b(eq, &slow_case);
+  GenerateLoadSiteBoilerplate(
+      masm, r3, r0, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  int size = JSObject::kHeaderSize + length_ * kPointerSize;
+  GenerateFastCloneShallowObject(masm, size, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowObject(masm, size, TENURED, &slow_case);
+  }
 
   __ bind(&slow_case);
   __ TailCallRuntime(Runtime::kCreateObjectLiteralShallow, 4, 1);
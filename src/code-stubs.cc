@@ -37,11 +37,22 @@
 namespace v8 {
 namespace internal {
 
+// Code that is generated for a code cache gets stubs of its own, see
+// CodeCacheScope.
+static UnseededNumberDictionary* StubDictionary(Isolate* isolate) {
+  Object** code_cache_stubs = isolate->code_cache_stubs();
+  if (code_cache_stubs != NULL) {
+    return UnseededNumberDictionary::cast(*code_cache_stubs);
+  }
+  return isolate->heap()->code_stubs();
+}
+
+
 bool CodeStub::FindCodeInCache(Code** code_out) {
-  Heap* heap = Isolate::Current()->heap();
-  int index = heap->code_stubs()->FindEntry(GetKey());
+  UnseededNumberDictionary* stubs = StubDictionary(Isolate::Current());
+  int index = stubs->FindEntry(GetKey());
   if (index != UnseededNumberDictionary::kNotFound) {
-    *code_out = Code::cast(heap->code_stubs()->ValueAt(index));
+    *code_out = Code::cast(stubs->ValueAt(index));
     return true;
   }
   return false;
@@ -133,15 +144,20 @@ Handle<Code> CodeStub::GetCode() {
       // Update the dictionary and the root in Heap.
       Handle<UnseededNumberDictionary> dict =
           factory->DictionaryAtNumberPut(
-              Handle<UnseededNumberDictionary>(heap->code_stubs()),
+              Handle<UnseededNumberDictionary>(StubDictionary(isolate)),
               GetKey(),
               new_object);
-      heap->public_set_code_stubs(*dict);
+      if (isolate->code_cache_stubs() != NULL) {
+        *isolate->code_cache_stubs() = *dict;
+      } else {
+        heap->public_set_code_stubs(*dict);
+      }
     }
     code = *new_object;
   }
 
-  Activate(code);
+  // The stubs of a code cache are activated when the cache is loaded.
+  if (isolate->code_cache_stubs() == NULL) Activate(code);
   ASSERT(!NeedsImmovableCode() || heap->lo_space()->Contains(code));
   return Handle<Code>(code, isolate);
 }
@@ -45,6 +45,7 @@
 #include "scanner-character-streams.h"
 #include "scopeinfo.h"
 #include "scopes.h"
+#include "serialize.h"
 #include "vm-state-inl.h"
 
 namespace v8 {
@@ -528,6 +529,40 @@ static Handle<SharedFunctionInfo> MakeFunctionInfo(CompilationInfo* info) {
 }
 
 
+static Handle<SharedFunctionInfo> CompileToplevel(
+    Handle<String> source,
+    Handle<Object> script_name,
+    int line_offset,
+    int column_offset,
+    v8::Extension* extension,
+    ScriptDataImpl* pre_data,
+    Handle<Object> script_data,
+    NativesFlag natives) {
+  // Create a script object describing the script to be compiled.
+  Handle<Script> script = FACTORY->NewScript(source);
+  if (natives == NATIVES_CODE) {
+    script->set_type(Smi::FromInt(Script::TYPE_NATIVE));
+  }
+  if (!script_name.is_null()) {
+    script->set_name(*script_name);
+    script->set_line_offset(Smi::FromInt(line_offset));
+    script->set_column_offset(Smi::FromInt(column_offset));
+  }
+
+  script->set_data(script_data.is_null() ? HEAP->undefined_value()
+                                         : *script_data);
+
+  CompilationInfoWithZone info(script);
+  info.MarkAsGlobal();
+  info.SetExtension(extension);
+  info.SetPreParseData(pre_data);
+  if (FLAG_use_strict) {
+    info.SetLanguageMode(FLAG_harmony_scoping ? EXTENDED_MODE : STRICT_MODE);
+  }
+  return MakeFunctionInfo(&info);
+}
+
+
 Handle<SharedFunctionInfo> Compiler::Compile(Handle<String> source,
                                              Handle<Object> script_name,
                                              int line_offset,
@@ -565,29 +600,15 @@ Handle<SharedFunctionInfo> Compiler::Compile(Handle<String> source,
     // that would be compiled lazily anyway, so we skip the preparse step
     // in that case too.
 
-    // Create a script object describing the script to be compiled.
-    Handle<Script> script = FACTORY->NewScript(source);
-    if (natives == NATIVES_CODE) {
-      script->set_type(Smi::FromInt(Script::TYPE_NATIVE));
-    }
-    if (!script_name.is_null()) {
-      script->set_name(*script_name);
-      script->set_line_offset(Smi::FromInt(line_offset));
-      script->set_column_offset(Smi::FromInt(column_offset));
-    }
-
-    script->set_data(script_data.is_null() ? HEAP->undefined_value()
-                                           : *script_data);
-
     // Compile the function and add it to the cache.
-    CompilationInfoWithZone info(script);
-    info.MarkAsGlobal();
-    info.SetExtension(extension);
-    info.SetPreParseData(pre_data);
-    if (FLAG_use_strict) {
-      info.SetLanguageMode(FLAG_harmony_scoping ? EXTENDED_MODE : STRICT_MODE);
-    }
-    result = MakeFunctionInfo(&info);
+    result = CompileToplevel(source,
+                             script_name,
+                             line_offset,
+                             column_offset,
+                             extension,
+                             pre_data,
+                             script_data,
+                             natives);
     if (extension == NULL && !result.is_null() && !result->dont_cache()) {
       compilation_cache->PutScript(source, result);
     }
@@ -602,6 +623,88 @@ Handle<SharedFunctionInfo> Compiler::Compile(Handle<String> source,
 }
 
 
+Handle<SharedFunctionInfo> Compiler::CompileWithCodeCache(
+    Handle<String> source,
+    Handle<Object> script_name,
+    int line_offset,
+    int column_offset,
+    CodeCacheData* cached_data,
+    Handle<Object> script_data) {
+  Isolate* isolate = source->GetIsolate();
+  CompilationCache* compilation_cache = isolate->compilation_cache();
+  Handle<SharedFunctionInfo> result;
+  if (compilation_cache->LookupScript(
+          source, script_name, line_offset, column_offset).is_null()) {
+    VMState state(isolate, COMPILER);
+    result = CodeSerializer::Deserialize(cached_data, source);
+  }
+  if (result.is_null()) {
+    // Not loaded from the code cache.  Go through the normal path, which
+    // also handles hits in the compilation cache.
+    return Compile(source,
+                   script_name,
+                   line_offset,
+                   column_offset,
+                   NULL,
+                   NULL,
+                   script_data,
+                   NOT_NATIVES_CODE);
+  }
+
+  isolate->counters()->total_load_size()->Increment(source->length());
+  Handle<Script> script(Script::cast(result->script()));
+  if (!script_name.is_null()) {
+    script->set_name(*script_name);
+    script->set_line_offset(Smi::FromInt(line_offset));
+    script->set_column_offset(Smi::FromInt(column_offset));
+  }
+  script->set_data(script_data.is_null() ? isolate->heap()->undefined_value()
+                                         : *script_data);
+  script->set_context_data((*isolate->global_context())->data());
+  script->set_compilation_state(
+      Smi::FromInt(Script::COMPILATION_STATE_COMPILED));
+  if (result->ic_age() != isolate->heap()->global_ic_age()) {
+    result->ResetForNewContext(isolate->heap()->global_ic_age());
+  }
+
+  Handle<Code> code(result->code());
+  Handle<String> name = script->name()->IsString()
+      ? Handle<String>(String::cast(script->name()))
+      : isolate->factory()->empty_string();
+  PROFILE(isolate, CodeCreateEvent(
+      Logger::ToNativeByScript(Logger::SCRIPT_TAG, *script),
+      *code,
+      *result,
+      *name));
+
+#ifdef ENABLE_DEBUGGER_SUPPORT
+  isolate->debugger()->OnBeforeCompile(script);
+  isolate->debugger()->OnAfterCompile(
+      script, Debugger::NO_AFTER_COMPILE_FLAGS);
+#endif
+
+  compilation_cache->PutScript(source, result);
+  return result;
+}
+
+
+Handle<SharedFunctionInfo> Compiler::CompileForCodeCache(
+    Handle<String> source) {
+  Isolate* isolate = source->GetIsolate();
+  VMState state(isolate, COMPILER);
+  Handle<SharedFunctionInfo> result = CompileToplevel(source,
+                                                      Handle<Object>::null(),
+                                                      0,
+                                                      0,
+                                                      NULL,
+                                                      NULL,
+                                                      Handle<Object>::null(),
+                                                      NOT_NATIVES_CODE);
+  if (result.is_null()) isolate->ReportPendingMessages();
+  return result;
+}
+
+
 Handle<SharedFunctionInfo> Compiler::CompileEval(Handle<String> source,
                                                  Handle<Context> context,
                                                  bool is_global,
@@ -855,7 +958,10 @@ void Compiler::RecompileParallel(Handle<JSFunction> closure) {
             new(info->zone()) OptimizingCompiler(*info);
         OptimizingCompiler::Status status = compiler->CreateGraph();
         if (status == OptimizingCompiler::SUCCEEDED) {
-          isolate->optimizing_compiler_thread()->QueueForOptimization(compiler);
+          // Hotter functions are compiled first.
+          int priority = shared->code()->profiler_ticks();
+          isolate->optimizing_compiler_thread()->QueueForOptimization(
+              compiler, priority);
           shared->code()->set_profiler_ticks(0);
           closure->ReplaceCode(isolate->builtins()->builtin(
               Builtins::kInRecompileQueue));
@@ -35,6 +35,7 @@
 namespace v8 {
 namespace internal {
 
+class CodeCacheData;
 class ScriptDataImpl;
 
 // CompilationInfo encapsulates some information known at compile time.  It
@@ -437,6 +438,22 @@ class Compiler : public AllStatic {
                                             Handle<Object> script_data,
                                             NativesFlag is_natives_code);
 
+  // Compile a String source within a context, loading the top-level function
+  // from a code cache if the cache was produced for the same source, V8
+  // version and flags, and compiling it normally otherwise.
+  static Handle<SharedFunctionInfo> CompileWithCodeCache(
+      Handle<String> source,
+      Handle<Object> script_name,
+      int line_offset,
+      int column_offset,
+      CodeCacheData* cached_data,
+      Handle<Object> script_data);
+
+  // Compile a String source within a context without looking in the
+  // compilation cache, so that the result has never run and can be put into
+  // a code cache.
+  static Handle<SharedFunctionInfo> CompileForCodeCache(Handle<String> source);
+
   // Compile a String source within a context for Eval.
   static Handle<SharedFunctionInfo> CompileEval(Handle<String> source,
                                                 Handle<Context> context,
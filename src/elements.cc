@@ -796,7 +796,11 @@ class FastElementsAccessor
           Address filler_start = backing_store->address() +
               BackingStore::OffsetOfElementAt(length);
           int filler_size = (old_capacity - length) * ElementSize;
-          array->GetHeap()->CreateFillerObjectAt(filler_start, filler_size);
+          Heap* heap = array->GetHeap();
+          heap->CreateFillerObjectAt(filler_start, filler_size);
+          if (heap->lo_space()->Contains(backing_store)) {
+            heap->lo_space()->ReleaseTrimmedTail(backing_store, filler_size);
+          }
         }
       } else {
         // Otherwise, fill the unused tail with holes.
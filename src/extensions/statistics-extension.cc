@@ -31,13 +31,20 @@ namespace v8 {
 namespace internal {
 
 const char* const StatisticsExtension::kSource =
-    "native function getV8Statistics();";
+    "native function getV8Statistics();"
+    "native function getV8FragmentationReport();";
 
 
 v8::Handle<v8::FunctionTemplate> StatisticsExtension::GetNativeFunction(
     v8::Handle<v8::String> str) {
-  ASSERT(strcmp(*v8::String::AsciiValue(str), "getV8Statistics") == 0);
-  return v8::FunctionTemplate::New(StatisticsExtension::GetCounters);
+  if (strcmp(*v8::String::AsciiValue(str), "getV8Statistics") == 0) {
+    return v8::FunctionTemplate::New(StatisticsExtension::GetCounters);
+  } else {
+    ASSERT(strcmp(*v8::String::AsciiValue(str),
+                  "getV8FragmentationReport") == 0);
+    return v8::FunctionTemplate::New(
+        StatisticsExtension::GetFragmentationReport);
+  }
 }
 
 
@@ -102,6 +109,111 @@ v8::Handle<v8::Value> StatisticsExtension::GetCounters(
 }
 
 
+static void SetNumber(v8::Local<v8::Object> object,
+                      const char* name,
+                      intptr_t value) {
+  object->Set(v8::String::New(name),
+              v8::Number::New(static_cast<double>(value)));
+}
+
+
+static const int kLiveBytesBins = 10;
+
+
+// The fragmentation numbers of one paged space.
+struct SpaceFragmentation {
+  AllocationSpace identity;
+  intptr_t area_size;
+  intptr_t live_bytes;
+  List<intptr_t> page_live_bytes;
+  int histogram[kLiveBytesBins];
+  FreeList::SizeStats free_list;
+};
+
+
+static void CollectFragmentation(PagedSpace* space,
+                                 SpaceFragmentation* result) {
+  result->identity = space->identity();
+  result->area_size = space->AreaSize();
+  result->live_bytes = 0;
+  for (int i = 0; i < kLiveBytesBins; i++) result->histogram[i] = 0;
+  result->free_list.small_size_ = 0;
+  result->free_list.medium_size_ = 0;
+  result->free_list.large_size_ = 0;
+  result->free_list.huge_size_ = 0;
+
+  PageIterator it(space);
+  while (it.has_next()) {
+    Page* p = it.next();
+    FreeList::SizeStats sizes;
+    intptr_t page_live_bytes = space->EstimateLiveBytes(p, &sizes);
+    result->page_live_bytes.Add(page_live_bytes);
+    // Completely live pages go into the last bin.
+    int bin = static_cast<int>(page_live_bytes * kLiveBytesBins /
+                               p->area_size());
+    result->histogram[Min(bin, kLiveBytesBins - 1)]++;
+    result->live_bytes += page_live_bytes;
+    result->free_list.small_size_ += sizes.small_size_;
+    result->free_list.medium_size_ += sizes.medium_size_;
+    result->free_list.large_size_ += sizes.large_size_;
+    result->free_list.huge_size_ += sizes.huge_size_;
+  }
+}
+
+
+// Returns an object with a property per old paged space.  For each space it
+// gives the live bytes of every page, a histogram of the pages by live bytes
+// in tenths of the page area, and the bytes in the free list size classes.
+v8::Handle<v8::Value> StatisticsExtension::GetFragmentationReport(
+    const v8::Arguments& args) {
+  static const int kPagedSpaces = LAST_PAGED_SPACE - FIRST_PAGED_SPACE + 1;
+  Heap* heap = Isolate::Current()->heap();
+  if (args.Length() > 0) {  // GC if first argument evaluates to true.
+    if (args[0]->IsBoolean() && args[0]->ToBoolean()->Value()) {
+      heap->CollectAllGarbage(Heap::kNoGCFlags, "fragmentation report");
+    }
+  }
+
+  // Building the report allocates, so all spaces are measured before.
+  SpaceFragmentation fragmentation[kPagedSpaces];
+  int count = 0;
+  PagedSpaces spaces;
+  for (PagedSpace* space = spaces.next();
+       space != NULL;
+       space = spaces.next()) {
+    CollectFragmentation(space, &fragmentation[count++]);
+  }
+
+  v8::Local<v8::Object> result = v8::Object::New();
+  for (int i = 0; i < count; i++) {
+    const SpaceFragmentation& space = fragmentation[i];
+    int pages = space.page_live_bytes.length();
+    v8::Local<v8::Array> live_bytes = v8::Array::New(pages);
+    for (int j = 0; j < pages; j++) {
+      live_bytes->Set(
+          j, v8::Number::New(static_cast<double>(space.page_live_bytes[j])));
+    }
+    v8::Local<v8::Array> live_bytes_histogram = v8::Array::New(kLiveBytesBins);
+    for (int j = 0; j < kLiveBytesBins; j++) {
+      live_bytes_histogram->Set(j, v8::Integer::New(space.histogram[j]));
+    }
+
+    v8::Local<v8::Object> report = v8::Object::New();
+    SetNumber(report, "pages", pages);
+    SetNumber(report, "area_size", space.area_size);
+    SetNumber(report, "live_bytes", space.live_bytes);
+    report->Set(v8::String::New("page_live_bytes"), live_bytes);
+    report->Set(v8::String::New("live_bytes_histogram"), live_bytes_histogram);
+    SetNumber(report, "free_list_small", space.free_list.small_size_);
+    SetNumber(report, "free_list_medium", space.free_list.medium_size_);
+    SetNumber(report, "free_list_large", space.free_list.large_size_);
+    SetNumber(report, "free_list_huge", space.free_list.huge_size_);
+    result->Set(v8::String::New(AllocationSpaceName(space.identity)), report);
+  }
+  return result;
+}
+
+
 void StatisticsExtension::Register() {
   static StatisticsExtension statistics_extension;
   static v8::DeclareExtension declaration(&statistics_extension);
@@ -39,6 +39,8 @@ class StatisticsExtension : public v8::Extension {
   virtual v8::Handle<v8::FunctionTemplate> GetNativeFunction(
       v8::Handle<v8::String> name);
   static v8::Handle<v8::Value> GetCounters(const v8::Arguments& args);
+  static v8::Handle<v8::Value> GetFragmentationReport(
+      const v8::Arguments& args);
   static void Register();
  private:
   static const char* const kSource;
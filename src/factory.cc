@@ -362,6 +362,20 @@ Handle<AccessorInfo> Factory::NewAccessorInfo() {
 }
 
 
+Handle<AllocationSite> Factory::NewAllocationSite(
+    Handle<JSObject> boilerplate) {
+  Handle<AllocationSite> site =
+      Handle<AllocationSite>::cast(NewStruct(ALLOCATION_SITE_TYPE));
+  site->set_boilerplate(*boilerplate);
+  site->set_memento_create_count(0);
+  site->set_memento_found_count(0);
+  site->set_pretenure_decision(AllocationSite::kUndecided);
+  site->set_feedback_gc_count(isolate()->heap()->gc_count());
+  site->set_copy_count(0);
+  return site;
+}
+
+
 Handle<Script> Factory::NewScript(Handle<String> source) {
   // Generate id for this script.
   int id;
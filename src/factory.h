@@ -193,6 +193,8 @@ class Factory {
 
   Handle<AccessorInfo> NewAccessorInfo();
 
+  Handle<AllocationSite> NewAllocationSite(Handle<JSObject> boilerplate);
+
   Handle<Script> NewScript(Handle<String> source);
 
   // Foreign objects are pretenured when allocated by the bootstrapper.
@@ -169,6 +169,8 @@ DEFINE_bool(use_range, true, "use hydrogen range analysis")
 DEFINE_bool(eliminate_dead_phis, true, "eliminate dead phis")
 DEFINE_bool(use_gvn, true, "use hydrogen global value numbering")
 DEFINE_bool(use_canonicalizing, true, "use hydrogen instruction canonicalizing")
+DEFINE_bool(use_load_store_elimination, false,
+            "use hydrogen redundant field load and store elimination")
 DEFINE_bool(use_inlining, true, "use function inlining")
 DEFINE_int(max_inlined_source_size, 600,
            "maximum source size in bytes considered for a single inlining")
@@ -188,6 +190,8 @@ DEFINE_bool(trace_alloc, false, "trace register allocator")
 DEFINE_bool(trace_all_uses, false, "trace all use positions")
 DEFINE_bool(trace_range, false, "trace range analysis")
 DEFINE_bool(trace_gvn, false, "trace global value numbering")
+DEFINE_bool(trace_load_store_elimination, false,
+            "trace redundant field load and store elimination")
 DEFINE_bool(trace_representation, false, "trace representation types")
 DEFINE_bool(stress_pointer_maps, false, "pointer map for every instruction")
 DEFINE_bool(stress_environments, false, "environment for every instruction")
@@ -221,8 +225,13 @@ DEFINE_bool(optimize_for_in, true,
 DEFINE_bool(parallel_recompilation, false,
             "optimizing hot functions asynchronously on a separate thread")
 DEFINE_bool(trace_parallel_recompilation, false, "track parallel recompilation")
-DEFINE_int(parallel_recompilation_queue_length, 2,
+DEFINE_int(parallel_recompilation_queue_length, 8,
            "the length of the parallel compilation queue")
+DEFINE_int(parallel_recompilation_threads, 1,
+           "number of threads used for parallel recompilation")
+DEFINE_bool(block_parallel_recompilation, false,
+            "hold queued functions back from the compiler threads until they "
+            "are unblocked (for testing)")
 
 // Experimental profiler changes.
 DEFINE_bool(experimental_profiler, true, "enable all profiler experiments")
@@ -369,12 +378,42 @@ DEFINE_bool(collect_maps, true,
             "garbage collect maps from which no objects can be reached")
 DEFINE_bool(flush_code, true,
             "flush code that we expect not to use again before full gc")
+DEFINE_int(code_flush_age, 5,
+           "number of full gcs without execution after which unoptimized "
+           "code is flushed (at most 7)")
 DEFINE_bool(incremental_marking, true, "use incremental marking")
 DEFINE_bool(incremental_marking_steps, true, "do incremental marking steps")
 DEFINE_bool(trace_incremental_marking, false,
             "trace progress of the incremental marking")
+DEFINE_int(gc_target_pause_ms, 0,
+           "size incremental marking steps from the measured marking speed "
+           "and allocation rate so that no step takes longer than this many "
+           "ms (0 uses the allocation marking factor)")
+DEFINE_bool(incremental_marking_for_external_memory, true,
+            "start and advance incremental marking as external memory grows "
+            "instead of waiting for the external allocation limit")
 DEFINE_bool(track_gc_object_stats, false,
             "track object counts and memory usage")
+DEFINE_bool(dynamic_new_space_sizing, false,
+            "size the new generation from the survival rate, the scavenge "
+            "speed and the allocation throughput")
+DEFINE_int(new_space_gc_time_percent, 5,
+           "share of the mutator time that scavenges may take before dynamic "
+           "new space sizing grows the new generation")
+DEFINE_bool(parallel_scavenge, false,
+            "scavenge the new generation on several threads")
+DEFINE_int(scavenger_threads, 1,
+           "number of helper threads used for parallel scavenges")
+DEFINE_bool(allocation_site_pretenuring, false,
+            "allocate copies of literals that survive scavenges in old space")
+DEFINE_bool(trace_pretenuring, false,
+            "trace pretenuring decisions of allocation sites")
+DEFINE_int(large_object_chunk_pool_size, 16,
+           "size (in Mbytes) of freed large object chunks that are kept "
+           "mapped for reuse by later large objects")
+DEFINE_bool(huge_pages, false,
+            "back large object chunks and the code range with transparent "
+            "huge pages where the platform supports them")
 
 // v8.cc
 DEFINE_bool(use_idle_notification, true,
@@ -382,6 +421,15 @@ DEFINE_bool(use_idle_notification, true,
 
 DEFINE_bool(send_idle_notification, false,
             "Send idle notifcation between stress runs.")
+DEFINE_bool(memory_reducer, false,
+            "release memory with well-spaced full collections in idle time "
+            "after the allocation rate dropped")
+DEFINE_bool(trace_memory_reducer, false,
+            "print committed and used memory of each space around the "
+            "collections of the memory reducer")
+DEFINE_bool(trace_idle_notification, false,
+            "print one trace line following each idle notification with a "
+            "deadline")
 // ic.cc
 DEFINE_bool(use_ic, true, "use inline caching")
 
@@ -403,9 +451,25 @@ DEFINE_bool(never_compact, false,
             "Never perform compaction on full GC - testing only")
 DEFINE_bool(compact_code_space, true,
             "Compact code space on full non-incremental collections")
+DEFINE_int(evacuation_time_budget_ms, 0,
+           "choose the evacuation candidates that free the most pages per "
+           "evacuated byte within this many ms of evacuation per full GC "
+           "(0 uses the free list fragmentation estimate)")
 DEFINE_bool(cleanup_code_caches_at_gc, true,
             "Flush inline caches prior to mark compact collection and "
             "flush code caches in maps during mark compact cycle.")
+DEFINE_bool(parallel_marking, false,
+            "mark the transitive closure on several threads in full GCs")
+DEFINE_int(marking_threads, 1,
+           "number of helper threads used for parallel marking")
+DEFINE_bool(concurrent_sweeping, false,
+            "sweep the old spaces on background threads after full GCs")
+DEFINE_int(sweeper_threads, 1,
+           "number of threads used for concurrent sweeping")
+DEFINE_bool(parallel_compaction, false,
+            "evacuate pages and update pointers on several threads")
+DEFINE_int(compaction_threads, 1,
+           "number of helper threads used for parallel compaction")
 DEFINE_int(random_seed, 0,
            "Default seed for initializing random generator "
            "(0, the default, means to use system random).")
@@ -417,6 +481,11 @@ DEFINE_bool(use_verbose_printer, true, "allows verbose printing")
 DEFINE_bool(allow_natives_syntax, false, "allow natives syntax")
 DEFINE_bool(trace_parse, false, "trace parsing and preparsing")
 
+// sampling-heap-profiler.cc
+DEFINE_bool(sampling_heap_profiler_suppress_randomness, false,
+            "take allocation samples at fixed instead of random intervals "
+            "(for testing)")
+
 // simulator-arm.cc and simulator-mips.cc
 DEFINE_bool(trace_sim, false, "Trace simulator execution")
 DEFINE_bool(check_icache, false,
@@ -265,6 +265,22 @@ List<const char*>* FlagList::argv() {
 }
 
 
+uint32_t FlagList::Hash() {
+  List<const char*>* args = argv();
+  uint32_t hash = 0;
+  for (int i = 0; i < args->length(); i++) {
+    for (const char* c = args->at(i); *c != '\0'; c++) {
+      hash = hash * 31 + static_cast<uint8_t>(*c);
+    }
+    // Separate the arguments so that e.g. "--a", "b" and "--ab" differ.
+    hash = hash * 31 + ' ';
+    DeleteArray(args->at(i));
+  }
+  delete args;
+  return hash;
+}
+
+
 // Helper function to parse flags: Takes an argument arg and splits it into
 // a flag name and flag value (or NULL if they are missing). is_bool is set
 // if the arg started with "-no" or "--no". The buffer may be used to NUL-
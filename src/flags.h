@@ -75,6 +75,10 @@ class FlagList {
 
   // Set flags as consequence of being implied by another flag.
   static void EnforceFlagImplications();
+
+  // Hash of the flags that differ from their defaults and their values, used
+  // to check that cached code was generated under the same flags.
+  static uint32_t Hash();
 };
 
 } }  // namespace v8::internal
@@ -0,0 +1,102 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gc-helper-thread.h"
+
+#include "v8.h"
+
+#include "heap.h"
+#include "isolate.h"
+#include "mark-compact.h"
+
+namespace v8 {
+namespace internal {
+
+
+const char* GCHelperThread::TaskName(Task task) {
+  switch (task) {
+    case MARKING:
+      return "MarkingThread";
+    case COMPACTION:
+      return "CompactionThread";
+    case SCAVENGING:
+      return "ScavengerThread";
+    case kNumberOfTasks:
+      break;
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+
+void GCHelperThread::Run() {
+  Isolate::SetIsolateThreadLocals(isolate_, NULL);
+
+  while (true) {
+    start_round_semaphore_->Wait();
+
+    if (Acquire_Load(&stop_thread_)) {
+      stop_semaphore_->Signal();
+      return;
+    }
+
+    Heap* heap = isolate_->heap();
+    switch (task_) {
+      case MARKING:
+        heap->mark_compact_collector()->MarkInParallel(id_);
+        break;
+      case COMPACTION:
+        heap->mark_compact_collector()->CompactInParallel(id_);
+        break;
+      case SCAVENGING:
+        heap->ScavengeInParallel(id_);
+        break;
+      case kNumberOfTasks:
+        UNREACHABLE();
+    }
+    end_round_semaphore_->Signal();
+  }
+}
+
+
+void GCHelperThread::Stop() {
+  Release_Store(&stop_thread_, static_cast<AtomicWord>(true));
+  start_round_semaphore_->Signal();
+  stop_semaphore_->Wait();
+}
+
+
+void GCHelperThread::StartRound() {
+  start_round_semaphore_->Signal();
+}
+
+
+void GCHelperThread::WaitForRound() {
+  end_round_semaphore_->Wait();
+}
+
+} }  // namespace v8::internal
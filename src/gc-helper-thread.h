@@ -0,0 +1,96 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef V8_GC_HELPER_THREAD_H_
+#define V8_GC_HELPER_THREAD_H_
+
+#include "atomicops.h"
+#include "flags.h"
+#include "platform.h"
+
+namespace v8 {
+namespace internal {
+
+// Helper thread that takes part in one of the parallel phases of a garbage
+// collection.  The thread sleeps until the collector starts a parallel round
+// of its task and signals back once its share of the round is done.
+class GCHelperThread : public Thread {
+ public:
+  enum Task {
+    // Marking of a full garbage collection, see
+    // MarkCompactCollector::MarkInParallel.
+    MARKING,
+    // Evacuation of candidate pages and updating of recorded slots, see
+    // MarkCompactCollector::CompactInParallel.
+    COMPACTION,
+    // Scavenges, see Heap::ScavengeInParallel.
+    SCAVENGING,
+    kNumberOfTasks
+  };
+
+  GCHelperThread(Isolate* isolate, Task task, int id)
+      : Thread(TaskName(task)),
+        isolate_(isolate),
+        task_(task),
+        id_(id),
+        start_round_semaphore_(OS::CreateSemaphore(0)),
+        end_round_semaphore_(OS::CreateSemaphore(0)),
+        stop_semaphore_(OS::CreateSemaphore(0)) {
+    NoBarrier_Store(&stop_thread_, static_cast<AtomicWord>(false));
+  }
+
+  ~GCHelperThread() {
+    delete start_round_semaphore_;
+    delete end_round_semaphore_;
+    delete stop_semaphore_;
+  }
+
+  void Run();
+  void Stop();
+  void StartRound();
+  void WaitForRound();
+
+  Task task() const { return task_; }
+
+  // Worker id of the thread, the main thread uses id 0.
+  int id() const { return id_; }
+
+ private:
+  static const char* TaskName(Task task);
+
+  Isolate* isolate_;
+  Task task_;
+  int id_;
+  Semaphore* start_round_semaphore_;
+  Semaphore* end_round_semaphore_;
+  Semaphore* stop_semaphore_;
+  volatile AtomicWord stop_thread_;
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_GC_HELPER_THREAD_H_
@@ -69,6 +69,7 @@ class GlobalHandles::Node {
     class_id_ = v8::HeapProfiler::kPersistentHandleNoClassId;
     index_ = 0;
     independent_ = false;
+    partially_dependent_ = false;
     in_new_space_list_ = false;
     parameter_or_next_free_.next_free = NULL;
     callback_ = NULL;
@@ -89,6 +90,7 @@ class GlobalHandles::Node {
     object_ = object;
     class_id_ = v8::HeapProfiler::kPersistentHandleNoClassId;
     independent_ = false;
+    partially_dependent_ = false;
     state_  = NORMAL;
     parameter_or_next_free_.parameter = NULL;
     callback_ = NULL;
@@ -104,8 +106,6 @@ class GlobalHandles::Node {
       }
     }
     state_ = FREE;
-    parameter_or_next_free_.next_free = global_handles->first_free_;
-    global_handles->first_free_ = this;
     DecreaseBlockUses(global_handles);
   }
 
@@ -154,6 +154,20 @@ class GlobalHandles::Node {
   }
   bool is_independent() const { return independent_; }
 
+  // Partially dependent flag accessors.  The flag is only set for nodes
+  // holding new space objects and cleared after each garbage collection.
+  void set_partially_dependent(bool v) {
+    ASSERT(!v || state_ != FREE);
+    partially_dependent_ = v;
+  }
+  bool is_partially_dependent() const { return partially_dependent_; }
+
+  // Scavenges may collect the objects of independent and partially
+  // dependent handles.
+  bool is_independent_or_partially_dependent() const {
+    return independent_ || partially_dependent_;
+  }
+
   // In-new-space-list flag accessors.
   void set_in_new_space_list(bool v) { in_new_space_list_ = v; }
   bool is_in_new_space_list() const { return in_new_space_list_; }
@@ -260,6 +274,7 @@ class GlobalHandles::Node {
   State state_ : 4;
 
   bool independent_ : 1;
+  bool partially_dependent_ : 1;
   bool in_new_space_list_ : 1;
 
   // Handle specific callback.
@@ -276,17 +291,27 @@ class GlobalHandles::Node {
 };
 
 
+// Every block keeps its own free list, so that the nodes of a block that
+// becomes empty can be released with the block.  Blocks with free nodes are
+// linked in a separate list from which new nodes are taken.
 class GlobalHandles::NodeBlock {
  public:
   static const int kSize = 256;
 
   explicit NodeBlock(NodeBlock* next)
-      : next_(next), used_nodes_(0), next_used_(NULL), prev_used_(NULL) {}
-
-  void PutNodesOnFreeList(Node** first_free) {
+      : next_(next),
+        used_nodes_(0),
+        first_free_(NULL),
+        next_used_(NULL),
+        prev_used_(NULL),
+        next_free_block_(NULL),
+        prev_free_block_(NULL) {}
+
+  void PutNodesOnFreeList(GlobalHandles* global_handles) {
     for (int i = kSize - 1; i >= 0; --i) {
-      nodes_[i].Initialize(i, first_free);
+      nodes_[i].Initialize(i, &first_free_);
     }
+    AddToFreeBlocks(global_handles);
   }
 
   Node* node_at(int index) {
@@ -294,8 +319,18 @@ class GlobalHandles::NodeBlock {
     return &nodes_[index];
   }
 
+  // Takes the first node in the free list of this block.  The node is not
+  // used until it is acquired.
+  Node* TakeFreeNode() {
+    ASSERT(first_free_ != NULL);
+    Node* result = first_free_;
+    first_free_ = result->next_free();
+    return result;
+  }
+
   void IncreaseUses(GlobalHandles* global_handles) {
     ASSERT(used_nodes_ < kSize);
+    if (used_nodes_ == kSize - 1) RemoveFromFreeBlocks(global_handles);
     if (used_nodes_++ == 0) {
       NodeBlock* old_first = global_handles->first_used_block_;
       global_handles->first_used_block_ = this;
@@ -306,8 +341,11 @@ class GlobalHandles::NodeBlock {
     }
   }
 
-  void DecreaseUses(GlobalHandles* global_handles) {
+  void DecreaseUses(Node* node, GlobalHandles* global_handles) {
     ASSERT(used_nodes_ > 0);
+    node->set_next_free(first_free_);
+    first_free_ = node;
+    if (used_nodes_ == kSize) AddToFreeBlocks(global_handles);
     if (--used_nodes_ == 0) {
       if (next_used_ != NULL) next_used_->prev_used_ = prev_used_;
       if (prev_used_ != NULL) prev_used_->next_used_ = next_used_;
@@ -317,8 +355,35 @@ class GlobalHandles::NodeBlock {
     }
   }
 
+  // Links the block in front of the list of blocks with free nodes, so
+  // that recently freed nodes are reused first.
+  void AddToFreeBlocks(GlobalHandles* global_handles) {
+    NodeBlock* old_first = global_handles->first_free_block_;
+    global_handles->first_free_block_ = this;
+    next_free_block_ = old_first;
+    prev_free_block_ = NULL;
+    if (old_first != NULL) old_first->prev_free_block_ = this;
+  }
+
+  void RemoveFromFreeBlocks(GlobalHandles* global_handles) {
+    if (next_free_block_ != NULL) {
+      next_free_block_->prev_free_block_ = prev_free_block_;
+    }
+    if (prev_free_block_ != NULL) {
+      prev_free_block_->next_free_block_ = next_free_block_;
+    }
+    if (this == global_handles->first_free_block_) {
+      global_handles->first_free_block_ = next_free_block_;
+    }
+    next_free_block_ = NULL;
+    prev_free_block_ = NULL;
+  }
+
+  bool IsEmpty() const { return used_nodes_ == 0; }
+
   // Next block in the list of all blocks.
   NodeBlock* next() const { return next_; }
+  void set_next(NodeBlock* next) { next_ = next; }
 
   // Next/previous block in the list of blocks with used nodes.
   NodeBlock* next_used() const { return next_used_; }
@@ -326,10 +391,14 @@ class GlobalHandles::NodeBlock {
 
  private:
   Node nodes_[kSize];
-  NodeBlock* const next_;
+  NodeBlock* next_;
   int used_nodes_;
+  // Free list of the nodes in this block.
+  Node* first_free_;
   NodeBlock* next_used_;
   NodeBlock* prev_used_;
+  NodeBlock* next_free_block_;
+  NodeBlock* prev_free_block_;
 };
 
 
@@ -348,7 +417,7 @@ void GlobalHandles::Node::IncreaseBlockUses(GlobalHandles* global_handles) {
 
 
 void GlobalHandles::Node::DecreaseBlockUses(GlobalHandles* global_handles) {
-  FindBlock()->DecreaseUses(global_handles);
+  FindBlock()->DecreaseUses(this, global_handles);
 }
 
 
@@ -387,7 +456,7 @@ GlobalHandles::GlobalHandles(Isolate* isolate)
       number_of_global_handles_(0),
       first_block_(NULL),
       first_used_block_(NULL),
-      first_free_(NULL),
+      first_free_block_(NULL),
       post_gc_processing_count_(0) {}
 
 
@@ -405,14 +474,13 @@ GlobalHandles::~GlobalHandles() {
 Handle<Object> GlobalHandles::Create(Object* value) {
   isolate_->counters()->global_handles()->Increment();
   number_of_global_handles_++;
-  if (first_free_ == NULL) {
+  if (first_free_block_ == NULL) {
     first_block_ = new NodeBlock(first_block_);
-    first_block_->PutNodesOnFreeList(&first_free_);
+    first_block_->PutNodesOnFreeList(this);
   }
-  ASSERT(first_free_ != NULL);
-  // Take the first node in the free list.
-  Node* result = first_free_;
-  first_free_ = result->next_free();
+  ASSERT(first_free_block_ != NULL);
+  // Take the first free node of the first block with free nodes.
+  Node* result = first_free_block_->TakeFreeNode();
   result->Acquire(value, this);
   if (isolate_->heap()->InNewSpace(value) &&
       !result->is_in_new_space_list()) {
@@ -448,6 +516,15 @@ void GlobalHandles::MarkIndependent(Object** location) {
 }
 
 
+void GlobalHandles::MarkPartiallyDependent(Object** location) {
+  Node* node = Node::FromLocation(location);
+  if (isolate_->heap()->InNewSpace(node->object())) {
+    ASSERT(node->is_in_new_space_list());
+    node->set_partially_dependent(true);
+  }
+}
+
+
 bool GlobalHandles::IsNearDeath(Object** location) {
   return Node::FromLocation(location)->IsNearDeath();
 }
@@ -493,7 +570,8 @@ void GlobalHandles::IterateNewSpaceStrongAndDependentRoots(ObjectVisitor* v) {
   for (int i = 0; i < new_space_nodes_.length(); ++i) {
     Node* node = new_space_nodes_[i];
     if (node->IsStrongRetainer() ||
-        (node->IsWeakRetainer() && !node->is_independent())) {
+        (node->IsWeakRetainer() &&
+         !node->is_independent_or_partially_dependent())) {
       v->VisitPointer(node->location());
     }
   }
@@ -505,7 +583,7 @@ void GlobalHandles::IdentifyNewSpaceWeakIndependentHandles(
   for (int i = 0; i < new_space_nodes_.length(); ++i) {
     Node* node = new_space_nodes_[i];
     ASSERT(node->is_in_new_space_list());
-    if (node->is_independent() && node->IsWeak() &&
+    if (node->is_independent_or_partially_dependent() && node->IsWeak() &&
         f(isolate_->heap(), node->location())) {
       node->MarkPending();
     }
@@ -517,7 +595,8 @@ void GlobalHandles::IterateNewSpaceWeakIndependentRoots(ObjectVisitor* v) {
   for (int i = 0; i < new_space_nodes_.length(); ++i) {
     Node* node = new_space_nodes_[i];
     ASSERT(node->is_in_new_space_list());
-    if (node->is_independent() && node->IsWeakRetainer()) {
+    if (node->is_independent_or_partially_dependent() &&
+        node->IsWeakRetainer()) {
       v->VisitPointer(node->location());
     }
   }
@@ -538,8 +617,9 @@ bool GlobalHandles::PostGarbageCollectionProcessing(
       ASSERT(node->is_in_new_space_list());
       // Skip dependent handles. Their weak callbacks might expect to be
       // called between two global garbage collection callbacks which
-      // are not called for minor collections.
-      if (!node->is_independent()) continue;
+      // are not called for minor collections.  Partially dependent
+      // handles had their dependencies provided for this scavenge.
+      if (!node->is_independent_or_partially_dependent()) continue;
       if (node->PostGarbageCollectionProcessing(isolate_, this)) {
         if (initial_post_gc_processing_count != post_gc_processing_count_) {
           // Weak callback triggered another GC and another round of
@@ -571,6 +651,7 @@ bool GlobalHandles::PostGarbageCollectionProcessing(
   for (int i = 0; i < new_space_nodes_.length(); ++i) {
     Node* node = new_space_nodes_[i];
     ASSERT(node->is_in_new_space_list());
+    node->set_partially_dependent(false);
     if (node->IsRetainer() && isolate_->heap()->InNewSpace(node->object())) {
       new_space_nodes_[last++] = node;
     } else {
@@ -578,10 +659,43 @@ bool GlobalHandles::PostGarbageCollectionProcessing(
     }
   }
   new_space_nodes_.Rewind(last);
+  ReleaseEmptyBlocks();
   return next_gc_likely_to_collect_more;
 }
 
 
+void GlobalHandles::ReleaseEmptyBlocks() {
+  // Only retainers are left in the list of new space nodes, so no node of
+  // an empty block is referenced any more.
+  NodeBlock* previous = NULL;
+  NodeBlock* block = first_block_;
+  while (block != NULL) {
+    NodeBlock* next = block->next();
+    if (block->IsEmpty()) {
+      if (previous == NULL) {
+        first_block_ = next;
+      } else {
+        previous->set_next(next);
+      }
+      block->RemoveFromFreeBlocks(this);
+      delete block;
+    } else {
+      previous = block;
+    }
+    block = next;
+  }
+}
+
+
+int GlobalHandles::NumberOfBlocks() {
+  int count = 0;
+  for (NodeBlock* block = first_block_; block != NULL; block = block->next()) {
+    count++;
+  }
+  return count;
+}
+
+
 void GlobalHandles::IterateStrongRoots(ObjectVisitor* v) {
   for (NodeIterator it(this); !it.done(); it.Advance()) {
     if (it.node()->IsStrongRetainer()) {
@@ -670,6 +784,46 @@ void GlobalHandles::Print() {
 
 
 
+bool GlobalHandles::IterateObjectGroups(ObjectVisitor* v,
+                                        WeakSlotCallbackWithHeap can_skip) {
+  int last = 0;
+  bool any_group_was_visited = false;
+  for (int i = 0; i < object_groups_.length(); i++) {
+    ObjectGroup* entry = object_groups_.at(i);
+    ASSERT(entry != NULL);
+
+    Object*** objects = entry->objects_;
+    bool group_should_be_visited = false;
+    for (size_t j = 0; j < entry->length_; j++) {
+      Object* object = *objects[j];
+      if (object->IsHeapObject() &&
+          !can_skip(isolate_->heap(), &object)) {
+        group_should_be_visited = true;
+        break;
+      }
+    }
+
+    if (!group_should_be_visited) {
+      object_groups_[last++] = entry;
+      continue;
+    }
+
+    // An object in the group requires visiting, so iterate over all
+    // objects in the group.
+    for (size_t j = 0; j < entry->length_; ++j) {
+      if ((*objects[j])->IsHeapObject()) v->VisitPointer(objects[j]);
+    }
+
+    // Once the entire group has been iterated over, dispose it because it's
+    // not needed anymore.
+    entry->Dispose();
+    any_group_was_visited = true;
+  }
+  object_groups_.Rewind(last);
+  return any_group_was_visited;
+}
+
+
 void GlobalHandles::AddObjectGroup(Object*** handles,
                                    size_t length,
                                    v8::RetainedObjectInfo* info) {
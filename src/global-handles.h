@@ -36,10 +36,9 @@ namespace v8 {
 namespace internal {
 
 // Structure for tracking global handles.
-// A single list keeps all the allocated global handles.
-// Destroyed handles stay in the list but is added to the free list.
-// At GC the destroyed global handles are removed from the free list
-// and deallocated.
+// Global handles are allocated in blocks, each with its own free list.
+// Destroyed handles are added to the free list of their block.  After a
+// GC the blocks without live handles are deallocated.
 
 // An object group is treated like a single JS object: if one of object in
 // the group is alive, all objects in the same group are considered alive.
@@ -148,12 +147,19 @@ class GlobalHandles {
     return number_of_global_handles_;
   }
 
+  // Returns the number of blocks the handles are allocated in.
+  int NumberOfBlocks();
+
   // Clear the weakness of a global handle.
   void ClearWeakness(Object** location);
 
   // Clear the weakness of a global handle.
   void MarkIndependent(Object** location);
 
+  // Mark the reference to a new space object partially dependent, its
+  // object groups are then honored by scavenges.
+  void MarkPartiallyDependent(Object** location);
+
   // Tells whether global handle is near death.
   static bool IsNearDeath(Object** location);
 
@@ -199,9 +205,16 @@ class GlobalHandles {
   // Iterates over weak independent handles. See the note above.
   void IterateNewSpaceWeakIndependentRoots(ObjectVisitor* v);
 
+  // Iterates over the objects of the object groups that contain an object
+  // which can not be skipped and disposes those groups.  Returns true if
+  // a group was visited, then the groups have to be iterated again once
+  // the newly visited objects have been processed.
+  bool IterateObjectGroups(ObjectVisitor* v,
+                           WeakSlotCallbackWithHeap can_skip);
+
   // Add an object group.
   // Should be only used in GC callback function before a collection.
-  // All groups are destroyed after a mark-compact collection.
+  // All groups are destroyed after a collection.
   void AddObjectGroup(Object*** handles,
                       size_t length,
                       v8::RetainedObjectInfo* info);
@@ -238,6 +251,11 @@ class GlobalHandles {
  private:
   explicit GlobalHandles(Isolate* isolate);
 
+  // Deletes the node blocks without used nodes.  Called after the weak
+  // handles have been processed, so that handle churn between collections
+  // does not allocate and free blocks over and over.
+  void ReleaseEmptyBlocks();
+
   // Internal node structures.
   class Node;
   class NodeBlock;
@@ -262,8 +280,8 @@ class GlobalHandles {
   // List of node blocks with used nodes.
   NodeBlock* first_used_block_;
 
-  // Free list of nodes.
-  Node* first_free_;
+  // List of node blocks with free nodes.
+  NodeBlock* first_free_block_;
 
   // Contains all nodes holding new space objects. Note: when the list
   // is accessed, some of the objects may have been promoted already.
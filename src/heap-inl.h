@@ -33,6 +33,7 @@
 #include "list-inl.h"
 #include "objects.h"
 #include "platform.h"
+#include "sampling-heap-profiler.h"
 #include "v8-counters.h"
 #include "store-buffer.h"
 #include "store-buffer-inl.h"
@@ -170,13 +171,14 @@ MaybeObject* Heap::AllocateTwoByteSymbol(Vector<const uc16> str,
   return answer;
 }
 
-MaybeObject* Heap::CopyFixedArray(FixedArray* src) {
-  return CopyFixedArrayWithMap(src, src->map());
+MaybeObject* Heap::CopyFixedArray(FixedArray* src, PretenureFlag pretenure) {
+  return CopyFixedArrayWithMap(src, src->map(), pretenure);
 }
 
 
-MaybeObject* Heap::CopyFixedDoubleArray(FixedDoubleArray* src) {
-  return CopyFixedDoubleArrayWithMap(src, src->map());
+MaybeObject* Heap::CopyFixedDoubleArray(FixedDoubleArray* src,
+                                        PretenureFlag pretenure) {
+  return CopyFixedDoubleArrayWithMap(src, src->map(), pretenure);
 }
 
 
@@ -221,7 +223,13 @@ MaybeObject* Heap::AllocateRaw(int size_in_bytes,
     ASSERT(MAP_SPACE == space);
     result = map_space_->AllocateRaw(size_in_bytes);
   }
-  if (result->IsFailure()) old_gen_exhausted_ = true;
+  if (result->IsFailure()) {
+    old_gen_exhausted_ = true;
+  } else if (sampling_heap_profiler_ != NULL) {
+    // Generated code only allocates inline in new space, allocation in the
+    // other spaces is sampled here.
+    sampling_heap_profiler_->Step(size_in_bytes, size_in_bytes);
+  }
   return result;
 }
 
@@ -332,6 +340,25 @@ bool Heap::ShouldBePromoted(Address old_address, int object_size) {
 }
 
 
+void Heap::RecordAllocationSiteFeedback(HeapObject* object,
+                                        int object_size,
+                                        Address limit) {
+  Address memento_address = object->address() + object_size;
+  if (NewSpacePage::IsAtEnd(memento_address) ||
+      memento_address + AllocationMemento::kSize > limit) {
+    return;
+  }
+  // The map word of the next object can be a forwarding address, which is
+  // never mistaken for the memento map.
+  Object* candidate = Memory::Object_at(memento_address);
+  if (candidate != allocation_memento_map()) return;
+  AllocationSite* site =
+      AllocationMemento::cast(HeapObject::FromAddress(memento_address))->
+          allocation_site();
+  site->set_memento_found_count(site->memento_found_count() + 1);
+}
+
+
 void Heap::RecordWrite(Address address, int offset) {
   if (!InNewSpace(address)) store_buffer_.Mark(address + offset);
 }
@@ -472,7 +499,9 @@ intptr_t Heap::AdjustAmountOfExternalAllocatedMemory(
     intptr_t amount_since_last_global_gc =
         amount_of_external_allocated_memory_ -
         amount_of_external_allocated_memory_at_last_global_gc_;
-    if (amount_since_last_global_gc > external_allocation_limit_) {
+    if (FLAG_incremental_marking_for_external_memory) {
+      ReportExternalMemoryPressure(change_in_bytes);
+    } else if (amount_since_last_global_gc > external_allocation_limit_) {
       CollectAllGarbage(kNoGCFlags, "external memory allocation limit reached");
     }
   } else {
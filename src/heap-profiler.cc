@@ -29,17 +29,20 @@
 
 #include "heap-profiler.h"
 #include "profile-generator.h"
+#include "sampling-heap-profiler.h"
 
 namespace v8 {
 namespace internal {
 
 HeapProfiler::HeapProfiler()
     : snapshots_(new HeapSnapshotsCollection()),
+      sampling_heap_profiler_(NULL),
       next_snapshot_uid_(1) {
 }
 
 
 HeapProfiler::~HeapProfiler() {
+  StopSamplingHeapProfilerImpl();
   delete snapshots_;
 }
 
@@ -168,10 +171,50 @@ void HeapProfiler::StopHeapObjectsTrackingImpl() {
 }
 
 
+bool HeapProfiler::StartSamplingHeapProfiler(int sample_interval) {
+  ASSERT(Isolate::Current()->heap_profiler() != NULL);
+  return Isolate::Current()->heap_profiler()->StartSamplingHeapProfilerImpl(
+      sample_interval);
+}
+
+
+void HeapProfiler::StopSamplingHeapProfiler() {
+  ASSERT(Isolate::Current()->heap_profiler() != NULL);
+  Isolate::Current()->heap_profiler()->StopSamplingHeapProfilerImpl();
+}
+
+
+SamplingHeapProfiler* HeapProfiler::GetSamplingHeapProfiler() {
+  HeapProfiler* profiler = Isolate::Current()->heap_profiler();
+  ASSERT(profiler != NULL);
+  return profiler->sampling_heap_profiler_;
+}
+
+
+bool HeapProfiler::StartSamplingHeapProfilerImpl(int sample_interval) {
+  if (sampling_heap_profiler_ != NULL) return false;
+  Heap* heap = Isolate::Current()->heap();
+  sampling_heap_profiler_ = new SamplingHeapProfiler(heap, sample_interval);
+  heap->set_sampling_heap_profiler(sampling_heap_profiler_);
+  return true;
+}
+
+
+void HeapProfiler::StopSamplingHeapProfilerImpl() {
+  if (sampling_heap_profiler_ == NULL) return;
+  sampling_heap_profiler_->heap()->set_sampling_heap_profiler(NULL);
+  delete sampling_heap_profiler_;
+  sampling_heap_profiler_ = NULL;
+}
+
+
 size_t HeapProfiler::GetMemorySizeUsedByProfiler() {
   HeapProfiler* profiler = Isolate::Current()->heap_profiler();
   ASSERT(profiler != NULL);
   size_t size = profiler->snapshots_->GetUsedMemorySize();
+  if (profiler->sampling_heap_profiler_ != NULL) {
+    size += profiler->sampling_heap_profiler_->GetUsedMemorySize();
+  }
   return size;
 }
 
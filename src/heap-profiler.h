@@ -35,6 +35,7 @@ namespace internal {
 
 class HeapSnapshot;
 class HeapSnapshotsCollection;
+class SamplingHeapProfiler;
 
 #define HEAP_PROFILE(heap, call)                                             \
   do {                                                                       \
@@ -67,6 +68,10 @@ class HeapProfiler {
   static SnapshotObjectId GetSnapshotObjectId(Handle<Object> obj);
   static void DeleteAllSnapshots();
 
+  static bool StartSamplingHeapProfiler(int sample_interval);
+  static void StopSamplingHeapProfiler();
+  static SamplingHeapProfiler* GetSamplingHeapProfiler();
+
   void ObjectMoveEvent(Address from, Address to);
 
   void DefineWrapperClass(
@@ -93,7 +98,11 @@ class HeapProfiler {
   void StopHeapObjectsTrackingImpl();
   SnapshotObjectId PushHeapObjectsStatsImpl(OutputStream* stream);
 
+  bool StartSamplingHeapProfilerImpl(int sample_interval);
+  void StopSamplingHeapProfilerImpl();
+
   HeapSnapshotsCollection* snapshots_;
+  SamplingHeapProfiler* sampling_heap_profiler_;
   unsigned next_snapshot_uid_;
   List<v8::HeapProfiler::WrapperInfoCallback> wrapper_callbacks_;
 };
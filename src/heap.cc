@@ -146,6 +146,9 @@ Heap::Heap()
       store_buffer_(this),
       marking_(this),
       incremental_marking_(this),
+      memory_reducer_(this),
+      sampling_heap_profiler_(NULL),
+      new_space_allocation_counter_(0),
       number_idle_notifications_(0),
       last_idle_notification_gc_count_(0),
       last_idle_notification_gc_count_init_(false),
@@ -153,10 +156,31 @@ Heap::Heap()
       ms_count_at_last_idle_notification_(0),
       gc_count_at_last_idle_gc_(0),
       scavenges_since_last_idle_round_(kIdleScavengeThreshold),
+      scavenge_speed_in_bytes_per_ms_(kInitialScavengeSpeedInBytesPerMs),
+      mark_compact_speed_in_bytes_per_ms_(kInitialMarkCompactSpeedInBytesPerMs),
+      sweeping_speed_in_bytes_per_ms_(kInitialSweepingSpeedInBytesPerMs),
+      idle_mark_compact_in_ms_(0),
+      final_incremental_mark_compact_in_ms_(
+          kInitialFinalIncrementalMarkCompactInMs),
+      incremental_marking_start_in_ms_(kInitialIncrementalMarkingStartInMs),
+      survivor_speed_in_bytes_per_ms_(kInitialScavengeSpeedInBytesPerMs),
+      new_space_allocation_throughput_in_bytes_per_ms_(0),
+      new_space_size_at_last_gc_(0),
       promotion_queue_(this),
+      new_space_top_before_gc_(NULL),
       configured_(false),
       chunks_queued_for_free_(NULL),
-      relocation_mutex_(NULL) {
+      relocation_mutex_(NULL),
+      relocation_readers_done_(NULL),
+      relocation_readers_(0),
+      relocation_writer_waiting_(0),
+      parallel_scavengers_(NULL),
+      parallel_scavengers_count_(0),
+      parallel_scavenge_task_(SCAVENGE_ROOTS_AND_STORE_BUFFER),
+      parallel_scavenge_ranges_(0),
+      next_parallel_scavenge_range_(0),
+      idle_parallel_scavengers_(0),
+      scavenge_mutex_(NULL) {
   // Allow build-time customization of the max semispace size. Building
   // V8 with snapshots and a non-default max semispace size is much
   // easier if you can define it as part of the build environment.
@@ -216,6 +240,13 @@ intptr_t Heap::CommittedMemoryExecutable() {
 }
 
 
+intptr_t Heap::CommittedMemoryHugePages() {
+  if (!HasBeenSetUp()) return 0;
+
+  return isolate()->memory_allocator()->SizeHugePages();
+}
+
+
 intptr_t Heap::Available() {
   if (!HasBeenSetUp()) return 0;
 
@@ -327,6 +358,10 @@ void Heap::PrintShortHeapStatistics() {
                ", available: %6" V8_PTR_PREFIX "d KB\n",
            isolate_->memory_allocator()->Size() / KB,
            isolate_->memory_allocator()->Available() / KB);
+  if (FLAG_huge_pages) {
+    PrintPID("Huge pages,   committed: %6" V8_PTR_PREFIX "d KB\n",
+             isolate_->memory_allocator()->SizeHugePages() / KB);
+  }
   PrintPID("New space,          used: %6" V8_PTR_PREFIX "d KB"
                ", available: %6" V8_PTR_PREFIX "d KB"
                ", committed: %6" V8_PTR_PREFIX "d KB\n",
@@ -522,10 +557,18 @@ void Heap::CollectAllAvailableGarbage(const char* gc_reason) {
     }
   }
   mark_compact_collector()->SetFlags(kNoGCFlags);
+  ReleaseUnusedMemory();
+}
+
+
+void Heap::ReleaseUnusedMemory() {
   new_space_.Shrink();
   UncommitFromSpace();
   Shrink();
   incremental_marking()->UncommitMarkingDeque();
+  if (isolate_->code_range()->exists()) {
+    isolate_->code_range()->TrimFreeList();
+  }
 }
 
 
@@ -593,7 +636,9 @@ bool Heap::CollectGarbage(AllocationSpace space,
 
   ASSERT(collector == SCAVENGER || incremental_marking()->IsStopped());
   if (incremental_marking()->IsStopped()) {
-    if (incremental_marking()->WorthActivating() && NextGCIsLikelyToBeFull()) {
+    if (incremental_marking()->WorthActivating() &&
+        (NextGCIsLikelyToBeFull() ||
+         incremental_marking()->ShouldStartForPauseTarget())) {
       incremental_marking()->Start();
     }
   }
@@ -837,6 +882,7 @@ bool Heap::PerformGarbageCollection(GarbageCollector collector,
   EnsureFromSpaceIsCommitted();
 
   int start_new_space_size = Heap::new_space()->SizeAsInt();
+  new_space_allocation_counter_ += start_new_space_size;
 
   if (IsHighSurvivalRate()) {
     // We speed up the incremental marker if it is running so that it
@@ -845,10 +891,27 @@ bool Heap::PerformGarbageCollection(GarbageCollector collector,
     incremental_marking()->NotifyOfHighPromotionRate();
   }
 
+  double start_time = OS::TimeCurrentMillis();
+
+  if (last_gc_end_timestamp_ > 0) {
+    UpdateSpeed(&new_space_allocation_throughput_in_bytes_per_ms_,
+                start_new_space_size - new_space_size_at_last_gc_,
+                start_time - last_gc_end_timestamp_);
+  }
+
   if (collector == MARK_COMPACTOR) {
     // Perform mark-sweep with optional compaction.
+    bool was_stopped = incremental_marking()->IsStopped();
+    intptr_t size_of_objects = SizeOfObjects();
     MarkCompact(tracer);
+    // Collections that finish incremental marking are not representative.
+    if (was_stopped) {
+      UpdateSpeed(&mark_compact_speed_in_bytes_per_ms_,
+                  size_of_objects,
+                  OS::TimeCurrentMillis() - start_time);
+    }
     sweep_generation_++;
+    memory_reducer_.NotifyMarkCompact();
     bool high_survival_rate_during_scavenges = IsHighSurvivalRate() &&
         IsStableOrIncreasingSurvivalTrend();
 
@@ -879,8 +942,20 @@ bool Heap::PerformGarbageCollection(GarbageCollector collector,
     tracer_ = tracer;
     Scavenge();
     tracer_ = NULL;
+    double duration = OS::TimeCurrentMillis() - start_time;
+    UpdateSpeed(&scavenge_speed_in_bytes_per_ms_,
+                start_new_space_size,
+                duration);
+    UpdateSpeed(&survivor_speed_in_bytes_per_ms_,
+                young_survivors_after_last_gc_,
+                duration);
 
     UpdateSurvivalRateTrend(start_new_space_size);
+
+    if (FLAG_dynamic_new_space_sizing &&
+        !new_space_high_promotion_mode_active_) {
+      AdjustNewSpaceCapacity();
+    }
   }
 
   if (!new_space_high_promotion_mode_active_ &&
@@ -949,6 +1024,8 @@ bool Heap::PerformGarbageCollection(GarbageCollector collector,
     VerifySymbolTable();
   }
 
+  new_space_size_at_last_gc_ = new_space_.SizeAsInt();
+
   return next_gc_likely_to_collect_more;
 }
 
@@ -966,6 +1043,10 @@ void Heap::MarkCompact(GCTracer* tracer) {
 
   mark_compact_collector_.CollectGarbage();
 
+  // Survivors moved within new space are not allocation.
+  new_space_.LowerInlineAllocationLimit(
+      new_space_.inline_allocation_limit_step());
+
   LOG(isolate_, ResourceEvent("markcompact", "end"));
 
   gc_state_ = NOT_IN_GC;
@@ -1066,6 +1147,8 @@ static void VerifyNonPointerSpacePointers() {
 
 
 void Heap::CheckNewSpaceExpansionCriteria() {
+  // The capacity is adjusted after each scavenge instead.
+  if (FLAG_dynamic_new_space_sizing) return;
   if (new_space_.Capacity() < new_space_.MaximumCapacity() &&
       survived_since_last_expansion_ > new_space_.Capacity() &&
       !new_space_high_promotion_mode_active_) {
@@ -1078,6 +1161,52 @@ void Heap::CheckNewSpaceExpansionCriteria() {
 }
 
 
+intptr_t Heap::NewSpaceCapacityForGCTime(
+    intptr_t survived_bytes,
+    intptr_t survivor_speed_in_bytes_per_ms,
+    intptr_t allocation_throughput_in_bytes_per_ms,
+    int gc_time_percent) {
+  ASSERT(survivor_speed_in_bytes_per_ms > 0);
+  // A scavenge every capacity / throughput ms of mutator time that takes
+  // survived_bytes / survivor_speed ms.
+  double scavenge_ms =
+      static_cast<double>(survived_bytes) / survivor_speed_in_bytes_per_ms;
+  double capacity = allocation_throughput_in_bytes_per_ms * scavenge_ms *
+      100 / Max(gc_time_percent, 1);
+  return static_cast<intptr_t>(Min(capacity, static_cast<double>(kMaxInt)));
+}
+
+
+void Heap::AdjustNewSpaceCapacity() {
+  intptr_t target = NewSpaceCapacityForGCTime(
+      young_survivors_after_last_gc_,
+      survivor_speed_in_bytes_per_ms_,
+      new_space_allocation_throughput_in_bytes_per_ms_,
+      FLAG_new_space_gc_time_percent);
+  int capacity = new_space_.Capacity();
+  // Growing doubles the capacity and shrinking halves it, so the target has
+  // to leave the range [capacity / 2, capacity] before anything changes.
+  // Otherwise the capacity would keep alternating around the target.
+  if (target > capacity && capacity < new_space_.MaximumCapacity()) {
+    new_space_.Grow();
+    survived_since_last_expansion_ = 0;
+  } else if (target < capacity / 2 && capacity > new_space_.InitialCapacity()) {
+    new_space_.ShrinkTo(Max(new_space_.InitialCapacity(), capacity / 2));
+  }
+  if (FLAG_trace_gc && new_space_.Capacity() != capacity) {
+    PrintPID("%s new space to %d KB for a target of %d KB: survival rate "
+             "%.1f%%, survivors copied at %d KB/ms, allocation at %d KB/ms\n",
+             new_space_.Capacity() > capacity ? "Grew" : "Shrank",
+             static_cast<int>(new_space_.Capacity() / KB),
+             static_cast<int>(target / KB),
+             survival_rate_,
+             static_cast<int>(survivor_speed_in_bytes_per_ms_ / KB),
+             static_cast<int>(
+                 new_space_allocation_throughput_in_bytes_per_ms_ / KB));
+  }
+}
+
+
 static bool IsUnscavengedHeapObject(Heap* heap, Object** p) {
   return heap->InNewSpace(*p) &&
       !HeapObject::cast(*p)->map_word().IsForwardingAddress();
@@ -1222,10 +1351,15 @@ void Heap::Scavenge() {
 
   incremental_marking()->PrepareForScavenge();
 
-  AdvanceSweepers(static_cast<int>(new_space_.Size()));
+  // Sweeper threads take care of the old spaces while a concurrent sweeping
+  // round is in progress; allocation picks up their results.
+  if (!mark_compact_collector()->IsConcurrentSweepingInProgress()) {
+    AdvanceSweepers(static_cast<int>(new_space_.Size()));
+  }
 
   // Flip the semispaces.  After flipping, to space is empty, from space has
   // live objects.
+  new_space_top_before_gc_ = new_space_.top();
   new_space_.Flip();
   new_space_.ResetAllocationInfo();
 
@@ -1253,39 +1387,55 @@ void Heap::Scavenge() {
   store_buffer()->Clean();
 #endif
 
-  ScavengeVisitor scavenge_visitor(this);
-  // Copy roots.
-  IterateRoots(&scavenge_visitor, VISIT_ALL_IN_SCAVENGE);
+  if (IsParallelScavengeEnabled()) {
+    ParallelScavenge();
+  } else {
+    ScavengeVisitor scavenge_visitor(this);
+    // Copy roots.
+    IterateRoots(&scavenge_visitor, VISIT_ALL_IN_SCAVENGE);
 
-  // Copy objects reachable from the old generation.
-  {
-    StoreBufferRebuildScope scope(this,
-                                  store_buffer(),
-                                  &ScavengeStoreBufferCallback);
-    store_buffer()->IteratePointersToNewSpace(&ScavengeObject);
-  }
+    // Copy objects reachable from the old generation.
+    {
+      StoreBufferRebuildScope scope(this,
+                                    store_buffer(),
+                                    &ScavengeStoreBufferCallback);
+      store_buffer()->IteratePointersToNewSpace(&ScavengeObject);
+    }
+
+    // Copy objects reachable from cells by scavenging cell values directly.
+    HeapObjectIterator cell_iterator(cell_space_);
+    for (HeapObject* cell = cell_iterator.Next();
+         cell != NULL; cell = cell_iterator.Next()) {
+      if (cell->IsJSGlobalPropertyCell()) {
+        Address value_address =
+            reinterpret_cast<Address>(cell) +
+            (JSGlobalPropertyCell::kValueOffset - kHeapObjectTag);
+        scavenge_visitor.VisitPointer(
+            reinterpret_cast<Object**>(value_address));
+      }
+    }
 
-  // Copy objects reachable from cells by scavenging cell values directly.
-  HeapObjectIterator cell_iterator(cell_space_);
-  for (HeapObject* cell = cell_iterator.Next();
-       cell != NULL; cell = cell_iterator.Next()) {
-    if (cell->IsJSGlobalPropertyCell()) {
-      Address value_address =
-          reinterpret_cast<Address>(cell) +
-          (JSGlobalPropertyCell::kValueOffset - kHeapObjectTag);
-      scavenge_visitor.VisitPointer(reinterpret_cast<Object**>(value_address));
+    // Scavenge object reachable from the global contexts list directly.
+    scavenge_visitor.VisitPointer(BitCast<Object**>(&global_contexts_list_));
+
+    new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
+    // Keep alive the object groups of partially dependent handles that
+    // contain a live object.
+    while (isolate_->global_handles()->IterateObjectGroups(
+        &scavenge_visitor, &IsUnscavengedHeapObject)) {
+      new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
     }
+    isolate_->global_handles()->IdentifyNewSpaceWeakIndependentHandles(
+        &IsUnscavengedHeapObject);
+    isolate_->global_handles()->IterateNewSpaceWeakIndependentRoots(
+        &scavenge_visitor);
+    new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
+    ASSERT(new_space_front == new_space_.top());
   }
 
-  // Scavenge object reachable from the global contexts list directly.
-  scavenge_visitor.VisitPointer(BitCast<Object**>(&global_contexts_list_));
-
-  new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
-  isolate_->global_handles()->IdentifyNewSpaceWeakIndependentHandles(
-      &IsUnscavengedHeapObject);
-  isolate_->global_handles()->IterateNewSpaceWeakIndependentRoots(
-      &scavenge_visitor);
-  new_space_front = DoScavenge(&scavenge_visitor, new_space_front);
+  // Object groups are only valid for the collection they were added for.
+  isolate_->global_handles()->RemoveObjectGroups();
+  isolate_->global_handles()->RemoveImplicitRefGroups();
 
   UpdateNewSpaceReferencesInExternalStringTable(
       &UpdateNewSpaceReferenceInExternalStringTableEntry);
@@ -1301,8 +1451,6 @@ void Heap::Scavenge() {
   ScavengeWeakObjectRetainer weak_object_retainer(this);
   ProcessWeakReferences(&weak_object_retainer);
 
-  ASSERT(new_space_front == new_space_.top());
-
   // Set age mark.
   new_space_.set_age_mark(new_space_.top());
 
@@ -1673,7 +1821,7 @@ class ScavengingVisitor : public StaticVisitorBase {
                                    kVisitDataObject,
                                    kVisitDataObjectGeneric>();
 
-    table_.RegisterSpecializations<ObjectEvacuationStrategy<POINTER_OBJECT>,
+    table_.RegisterSpecializations<JSObjectEvacuationStrategy,
                                    kVisitJSObject,
                                    kVisitJSObjectGeneric>();
 
@@ -1957,6 +2105,37 @@ class ScavengingVisitor : public StaticVisitorBase {
     }
   };
 
+  // Copies of literals that are tracked by an allocation site are followed
+  // by an allocation memento, which is counted as feedback for the site.
+  class JSObjectEvacuationStrategy {
+   public:
+    template<int object_size>
+    static inline void VisitSpecialized(Map* map,
+                                        HeapObject** slot,
+                                        HeapObject* object) {
+      if (FLAG_allocation_site_pretenuring) {
+        Heap* heap = map->GetHeap();
+        heap->RecordAllocationSiteFeedback(object,
+                                           object_size,
+                                           heap->new_space_top_before_gc());
+      }
+      ObjectEvacuationStrategy<POINTER_OBJECT>::
+          template VisitSpecialized<object_size>(map, slot, object);
+    }
+
+    static inline void Visit(Map* map,
+                             HeapObject** slot,
+                             HeapObject* object) {
+      if (FLAG_allocation_site_pretenuring) {
+        Heap* heap = map->GetHeap();
+        heap->RecordAllocationSiteFeedback(object,
+                                           map->instance_size(),
+                                           heap->new_space_top_before_gc());
+      }
+      ObjectEvacuationStrategy<POINTER_OBJECT>::Visit(map, slot, object);
+    }
+  };
+
   static VisitorDispatchTable<ScavengingCallback> table_;
 };
 
@@ -2028,6 +2207,515 @@ void Heap::ScavengeObjectSlow(HeapObject** p, HeapObject* object) {
 }
 
 
+// Per-thread state of a parallel scavenge.  Objects are copied into linear
+// allocation buffers that belong to the scavenger and the forwarding
+// address is installed with a compare-and-swap on the map word, so only one
+// copy of every object survives.  Copied objects that may contain pointers
+// are scanned from a work-stealing deque.  Slots of promoted objects that
+// still point to new space are recorded locally and entered into the store
+// buffer on the main thread once the scavenge is done.
+class ParallelScavenger : public ObjectVisitor {
+ public:
+  ParallelScavenger() : heap_(NULL), promoted_objects_size_(0) {
+    new_space_buffer_.top = new_space_buffer_.limit = NULL;
+    old_pointer_space_buffer_.top = old_pointer_space_buffer_.limit = NULL;
+    old_data_space_buffer_.top = old_data_space_buffer_.limit = NULL;
+  }
+
+  void Initialize(Heap* heap) { heap_ = heap; }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** p = start; p < end; p++) ScavengePointer(p);
+  }
+
+  // Copies the object the slot points to if it is in from space and
+  // updates the slot.  Slots found in the store buffer can be in memory
+  // that is reused for promoted objects by other threads, so the slot is
+  // only updated if it still holds the old value.
+  inline void ScavengePointer(Object** p) {
+    Object* object = *p;
+    if (!heap_->InFromSpace(object)) return;
+    HeapObject* target = CopyObject(HeapObject::cast(object));
+    NoBarrier_CompareAndSwap(reinterpret_cast<volatile AtomicWord*>(p),
+                             reinterpret_cast<AtomicWord>(object),
+                             reinterpret_cast<AtomicWord>(target));
+  }
+
+  // Scans copied objects until the deque of this scavenger is empty.
+  void ProcessQueue() {
+    HeapObject* object;
+    while (queue_.Pop(&object)) {
+      if (heap_->InNewSpace(object)) {
+        ScanNewSpaceObject(object);
+      } else {
+        ScanPromotedObject(object);
+      }
+    }
+  }
+
+  // Gives the unused parts of the allocation buffers back to the spaces.
+  void ReleaseAllocationBuffers() {
+    if (new_space_buffer_.top != new_space_buffer_.limit) {
+      heap_->CreateFillerObjectAt(
+          new_space_buffer_.top,
+          static_cast<int>(new_space_buffer_.limit - new_space_buffer_.top));
+    }
+    new_space_buffer_.top = new_space_buffer_.limit = NULL;
+    ReleaseOldSpaceBuffer(heap_->old_pointer_space(),
+                          &old_pointer_space_buffer_);
+    ReleaseOldSpaceBuffer(heap_->old_data_space(), &old_data_space_buffer_);
+  }
+
+  WorkStealingMarkingDeque* queue() { return &queue_; }
+
+  List<Object**>* old_to_new_slots() { return &old_to_new_slots_; }
+
+  intptr_t promoted_objects_size() { return promoted_objects_size_; }
+
+  void ResetPromotedObjectsSize() { promoted_objects_size_ = 0; }
+
+ private:
+  static const int kAllocationBufferSize = 8 * KB;
+
+  static inline MapWord LoadMapWord(HeapObject* object) {
+    return MapWord::FromRawValue(static_cast<uintptr_t>(Acquire_Load(
+        reinterpret_cast<volatile AtomicWord*>(object->address()))));
+  }
+
+  inline HeapObject* CopyObject(HeapObject* object);
+  HeapObject* CopyLargeObject(HeapObject* object,
+                              Map* map,
+                              int object_size,
+                              int allocation_size);
+
+  HeapObject* AllocateInNewSpace(int size);
+  HeapObject* AllocateInOldSpace(AllocationSpace space, int size);
+  void UndoAllocation(AllocationInfo* buffer, Address address, int size);
+  void ReleaseOldSpaceBuffer(OldSpace* space, AllocationInfo* buffer);
+
+  AllocationInfo* BufferFor(AllocationSpace space) {
+    ASSERT(space == OLD_POINTER_SPACE || space == OLD_DATA_SPACE);
+    return space == OLD_POINTER_SPACE ? &old_pointer_space_buffer_
+                                      : &old_data_space_buffer_;
+  }
+
+  OldSpace* OldSpaceFor(AllocationSpace space) {
+    return space == OLD_POINTER_SPACE ? heap_->old_pointer_space()
+                                      : heap_->old_data_space();
+  }
+
+  void ScanNewSpaceObject(HeapObject* object);
+  void ScanPromotedObject(HeapObject* object);
+
+  Heap* heap_;
+  AllocationInfo new_space_buffer_;
+  AllocationInfo old_pointer_space_buffer_;
+  AllocationInfo old_data_space_buffer_;
+  WorkStealingMarkingDeque queue_;
+  List<Object**> old_to_new_slots_;
+  intptr_t promoted_objects_size_;
+};
+
+
+HeapObject* ParallelScavenger::CopyObject(HeapObject* object) {
+  MapWord map_word = LoadMapWord(object);
+  if (map_word.IsForwardingAddress()) return map_word.ToForwardingAddress();
+
+  Map* map = map_word.ToMap();
+  int object_size = object->SizeFromMap(map);
+  InstanceType type = map->instance_type();
+  AllocationSpace target_space = heap_->TargetSpaceId(type);
+  bool double_align = kDoubleAlignment != kObjectAlignment &&
+      type == FIXED_DOUBLE_ARRAY_TYPE;
+  int allocation_size = object_size;
+  if (double_align) allocation_size += kPointerSize;
+
+  if (allocation_size > Page::kMaxNonCodeHeapObjectSize) {
+    return CopyLargeObject(object, map, object_size, allocation_size);
+  }
+
+  HeapObject* target = NULL;
+  AllocationInfo* buffer = NULL;
+  bool promoted = false;
+  if (heap_->ShouldBePromoted(object->address(), object_size)) {
+    target = AllocateInOldSpace(target_space, allocation_size);
+    buffer = BufferFor(target_space);
+    promoted = true;
+  }
+  if (target == NULL) {
+    target = AllocateInNewSpace(allocation_size);
+    buffer = &new_space_buffer_;
+    promoted = false;
+  }
+  if (target == NULL) {
+    // To space can run out because of the space lost at the ends of the
+    // allocation buffers, in which case the object is promoted anyway.
+    target = AllocateInOldSpace(target_space, allocation_size);
+    buffer = BufferFor(target_space);
+    promoted = true;
+  }
+  if (target == NULL) {
+    V8::FatalProcessOutOfMemory("ParallelScavenger::CopyObject");
+  }
+
+  Address allocation_address = target->address();
+  if (double_align) {
+    target = EnsureDoubleAligned(heap_, target, allocation_size);
+  }
+
+  // Copy the content of the object and install the forwarding address.  The
+  // map is copied from the value read above in case another thread already
+  // forwarded the object while it was being copied.
+  heap_->CopyBlock(target->address(), object->address(), object_size);
+  target->set_map_no_write_barrier(map);
+  AtomicWord expected = static_cast<AtomicWord>(map_word.ToRawValue());
+  AtomicWord forwarded = static_cast<AtomicWord>(
+      MapWord::FromForwardingAddress(target).ToRawValue());
+  AtomicWord previous = Release_CompareAndSwap(
+      reinterpret_cast<volatile AtomicWord*>(object->address()),
+      expected,
+      forwarded);
+  if (previous != expected) {
+    // Another scavenger copied the object first.
+    UndoAllocation(buffer, allocation_address, allocation_size);
+    return MapWord::FromRawValue(previous).ToForwardingAddress();
+  }
+
+  // Survivor counts of allocation sites are only a heuristic, so updates
+  // racing with other scavengers are tolerated.
+  if (FLAG_allocation_site_pretenuring &&
+      (type == JS_OBJECT_TYPE || type == JS_ARRAY_TYPE)) {
+    heap_->RecordAllocationSiteFeedback(object,
+                                        object_size,
+                                        heap_->new_space_top_before_gc());
+  }
+
+  if (promoted) promoted_objects_size_ += object_size;
+  if (target_space == OLD_POINTER_SPACE) queue_.Push(target);
+  return target;
+}
+
+
+HeapObject* ParallelScavenger::CopyLargeObject(HeapObject* object,
+                                               Map* map,
+                                               int object_size,
+                                               int allocation_size) {
+  // Objects of this size are copied under the lock by every scavenger, so
+  // the object cannot be forwarded concurrently.
+  ScopedLock lock(heap_->scavenge_mutex_);
+  MapWord map_word = LoadMapWord(object);
+  if (map_word.IsForwardingAddress()) return map_word.ToForwardingAddress();
+
+  Object* result = NULL;
+  bool promoted = false;
+  if (heap_->ShouldBePromoted(object->address(), object_size)) {
+    MaybeObject* maybe_result =
+        heap_->lo_space()->AllocateRaw(allocation_size, NOT_EXECUTABLE);
+    promoted = maybe_result->ToObject(&result);
+  }
+  if (!promoted) {
+    MaybeObject* maybe_result =
+        heap_->new_space()->AllocateRaw(allocation_size);
+    if (!maybe_result->ToObject(&result)) {
+      V8::FatalProcessOutOfMemory("ParallelScavenger::CopyLargeObject");
+    }
+  }
+
+  HeapObject* target = HeapObject::cast(result);
+  if (allocation_size != object_size) {
+    target = EnsureDoubleAligned(heap_, target, allocation_size);
+  }
+  heap_->CopyBlock(target->address(), object->address(), object_size);
+  Release_Store(reinterpret_cast<volatile AtomicWord*>(object->address()),
+                static_cast<AtomicWord>(
+                    MapWord::FromForwardingAddress(target).ToRawValue()));
+
+  if (promoted) promoted_objects_size_ += object_size;
+  if (heap_->TargetSpaceId(map->instance_type()) == OLD_POINTER_SPACE) {
+    queue_.Push(target);
+  }
+  return target;
+}
+
+
+HeapObject* ParallelScavenger::AllocateInNewSpace(int size) {
+  AllocationInfo* buffer = &new_space_buffer_;
+  if (buffer->limit - buffer->top >= size) {
+    HeapObject* result = HeapObject::FromAddress(buffer->top);
+    buffer->top += size;
+    return result;
+  }
+
+  ScopedLock lock(heap_->scavenge_mutex_);
+  NewSpace* space = heap_->new_space();
+  Object* result;
+  if (size <= kAllocationBufferSize / 4 &&
+      space->AllocateRaw(kAllocationBufferSize)->ToObject(&result)) {
+    if (buffer->top != buffer->limit) {
+      heap_->CreateFillerObjectAt(
+          buffer->top, static_cast<int>(buffer->limit - buffer->top));
+    }
+    Address start = HeapObject::cast(result)->address();
+    buffer->top = start + size;
+    buffer->limit = start + kAllocationBufferSize;
+    return HeapObject::cast(result);
+  }
+  if (!space->AllocateRaw(size)->ToObject(&result)) return NULL;
+  return HeapObject::cast(result);
+}
+
+
+HeapObject* ParallelScavenger::AllocateInOldSpace(AllocationSpace space_id,
+                                                  int size) {
+  // The unused part of an old space buffer is always covered by a filler,
+  // so the pages stay iterable for the main thread when it scans pages
+  // that are not covered by the store buffer.
+  AllocationInfo* buffer = BufferFor(space_id);
+  if (buffer->limit - buffer->top < size) {
+    ScopedLock lock(heap_->scavenge_mutex_);
+    OldSpace* space = OldSpaceFor(space_id);
+    Object* result;
+    if (size > kAllocationBufferSize / 4 ||
+        !space->AllocateRaw(kAllocationBufferSize)->ToObject(&result)) {
+      if (!space->AllocateRaw(size)->ToObject(&result)) return NULL;
+      return HeapObject::cast(result);
+    }
+    ReleaseOldSpaceBuffer(space, buffer);
+    buffer->top = HeapObject::cast(result)->address();
+    buffer->limit = buffer->top + kAllocationBufferSize;
+  }
+  HeapObject* result = HeapObject::FromAddress(buffer->top);
+  buffer->top += size;
+  if (buffer->top != buffer->limit) {
+    heap_->CreateFillerObjectAt(buffer->top,
+                                static_cast<int>(buffer->limit - buffer->top));
+  }
+  return result;
+}
+
+
+void ParallelScavenger::UndoAllocation(AllocationInfo* buffer,
+                                       Address address,
+                                       int size) {
+  if (buffer->top == address + size) {
+    buffer->top = address;
+    if (buffer != &new_space_buffer_) {
+      heap_->CreateFillerObjectAt(
+          buffer->top, static_cast<int>(buffer->limit - buffer->top));
+    }
+  } else {
+    heap_->CreateFillerObjectAt(address, size);
+  }
+}
+
+
+void ParallelScavenger::ReleaseOldSpaceBuffer(OldSpace* space,
+                                              AllocationInfo* buffer) {
+  if (buffer->top != buffer->limit) {
+    space->Free(buffer->top, static_cast<int>(buffer->limit - buffer->top));
+  }
+  buffer->top = buffer->limit = NULL;
+}
+
+
+void ParallelScavenger::ScanNewSpaceObject(HeapObject* object) {
+  Map* map = object->map();
+  if (map->instance_type() == JS_FUNCTION_TYPE) {
+    // Like NewSpaceScavenger, skip the code entry and the weak fields.
+    VisitPointers(
+        HeapObject::RawField(object, JSFunction::kPropertiesOffset),
+        HeapObject::RawField(object, JSFunction::kCodeEntryOffset));
+    VisitPointers(
+        HeapObject::RawField(object,
+                             JSFunction::kCodeEntryOffset + kPointerSize),
+        HeapObject::RawField(object, JSFunction::kNonWeakFieldsEndOffset));
+  } else {
+    object->IterateBody(map->instance_type(), object->SizeFromMap(map), this);
+  }
+}
+
+
+void ParallelScavenger::ScanPromotedObject(HeapObject* object) {
+  // Like IterateAndMarkPointersToFromSpace, look at every word of the
+  // promoted object.
+  Object** start = reinterpret_cast<Object**>(object->address());
+  Object** end = start + object->Size() / kPointerSize;
+  for (Object** slot = start; slot < end; slot++) {
+    ScavengePointer(slot);
+    if (heap_->InNewSpace(*slot)) old_to_new_slots_.Add(slot);
+  }
+}
+
+
+bool Heap::IsParallelScavengeEnabled() {
+  // Marks are transferred and object moves are reported to the profilers
+  // one at a time by the serial scavenger only.
+  bool logging_and_profiling =
+      isolate()->logger()->is_logging() ||
+      CpuProfiler::is_profiling(isolate()) ||
+      (isolate()->heap_profiler() != NULL &&
+       isolate()->heap_profiler()->is_profiling());
+  return FLAG_parallel_scavenge &&
+      isolate()->gc_helper_threads(GCHelperThread::SCAVENGING) != NULL &&
+      !incremental_marking()->IsMarking() &&
+      !logging_and_profiling;
+}
+
+
+void Heap::ScavengeObjectOnMainThread(HeapObject** p, HeapObject* object) {
+  Heap* heap = object->GetHeap();
+  heap->parallel_scavengers_[0].ScavengePointer(reinterpret_cast<Object**>(p));
+}
+
+
+void Heap::RunParallelScavengeTask(ParallelScavengeTask task) {
+  GCHelperThread** threads =
+      isolate()->gc_helper_threads(GCHelperThread::SCAVENGING);
+  parallel_scavenge_task_ = task;
+  NoBarrier_Store(&next_parallel_scavenge_range_, 0);
+  NoBarrier_Store(&idle_parallel_scavengers_, 0);
+  for (int i = 0; i < parallel_scavengers_count_ - 1; i++) {
+    threads[i]->StartRound();
+  }
+  ScavengeInParallel(0);
+  for (int i = 0; i < parallel_scavengers_count_ - 1; i++) {
+    threads[i]->WaitForRound();
+  }
+  // The main thread scans pages between rounds, which requires all
+  // allocation buffers to be iterable.
+  for (int i = 0; i < parallel_scavengers_count_; i++) {
+    parallel_scavengers_[i].ReleaseAllocationBuffers();
+  }
+}
+
+
+void Heap::ScavengeInParallel(int worker_id) {
+  ParallelScavenger* scavenger = &parallel_scavengers_[worker_id];
+  if (parallel_scavenge_task_ == SCAVENGE_ROOTS_AND_STORE_BUFFER) {
+    if (worker_id == 0) {
+      IterateRoots(scavenger, VISIT_ALL_IN_SCAVENGE);
+
+      // Copy objects reachable from cells by scavenging cell values directly.
+      HeapObjectIterator cell_iterator(cell_space_);
+      for (HeapObject* cell = cell_iterator.Next();
+           cell != NULL; cell = cell_iterator.Next()) {
+        if (cell->IsJSGlobalPropertyCell()) {
+          Address value_address =
+              reinterpret_cast<Address>(cell) +
+              (JSGlobalPropertyCell::kValueOffset - kHeapObjectTag);
+          scavenger->VisitPointer(reinterpret_cast<Object**>(value_address));
+        }
+      }
+
+      scavenger->VisitPointer(BitCast<Object**>(&global_contexts_list_));
+    }
+    while (true) {
+      int range =
+          NoBarrier_AtomicIncrement(&next_parallel_scavenge_range_, 1) - 1;
+      if (range >= parallel_scavenge_ranges_) break;
+      store_buffer()->IteratePointersInRange(range, scavenger);
+      scavenger->ProcessQueue();
+    }
+  }
+  do {
+    scavenger->ProcessQueue();
+  } while (StealScavengingWork(worker_id) || !ParallelScavengingDone());
+}
+
+
+bool Heap::StealScavengingWork(int worker_id) {
+  WorkStealingMarkingDeque* own = parallel_scavengers_[worker_id].queue();
+  for (int i = 1; i < parallel_scavengers_count_; i++) {
+    int victim = (worker_id + i) % parallel_scavengers_count_;
+    if (parallel_scavengers_[victim].queue()->StealInto(own)) return true;
+  }
+  return false;
+}
+
+
+bool Heap::ParallelScavengingDone() {
+  // As with parallel marking, a scavenger only becomes idle once its own
+  // deque is empty, and only the owner adds work to a deque.
+  Barrier_AtomicIncrement(&idle_parallel_scavengers_, 1);
+  while (true) {
+    if (Acquire_Load(&idle_parallel_scavengers_) ==
+        parallel_scavengers_count_) {
+      return true;
+    }
+    for (int i = 0; i < parallel_scavengers_count_; i++) {
+      if (parallel_scavengers_[i].queue()->HasSharedWork()) {
+        Barrier_AtomicIncrement(&idle_parallel_scavengers_, -1);
+        return false;
+      }
+    }
+    Thread::YieldCPU();
+  }
+}
+
+
+void Heap::ParallelScavenge() {
+  if (parallel_scavengers_ == NULL) {
+    parallel_scavengers_count_ =
+        isolate()->num_gc_helper_threads(GCHelperThread::SCAVENGING) + 1;
+    parallel_scavengers_ = new ParallelScavenger[parallel_scavengers_count_];
+    for (int i = 0; i < parallel_scavengers_count_; i++) {
+      parallel_scavengers_[i].Initialize(this);
+    }
+    scavenge_mutex_ = OS::CreateMutex();
+  }
+
+  // The store buffer is split in a few ranges per scavenger so that the
+  // scavengers that are done with the roots early can pick up more.
+  static const int kStoreBufferRangesPerScavenger = 4;
+  {
+    StoreBufferRebuildScope scope(this,
+                                  store_buffer(),
+                                  &ScavengeStoreBufferCallback);
+    parallel_scavenge_ranges_ =
+        parallel_scavengers_count_ * kStoreBufferRangesPerScavenger;
+    store_buffer()->StartParallelIteration(parallel_scavenge_ranges_);
+    RunParallelScavengeTask(SCAVENGE_ROOTS_AND_STORE_BUFFER);
+    store_buffer()->FinishParallelIteration(&ScavengeObjectOnMainThread);
+  }
+  RunParallelScavengeTask(SCAVENGE_TRANSITIVE_CLOSURE);
+
+  while (isolate_->global_handles()->IterateObjectGroups(
+      &parallel_scavengers_[0], &IsUnscavengedHeapObject)) {
+    RunParallelScavengeTask(SCAVENGE_TRANSITIVE_CLOSURE);
+  }
+  isolate_->global_handles()->IdentifyNewSpaceWeakIndependentHandles(
+      &IsUnscavengedHeapObject);
+  isolate_->global_handles()->IterateNewSpaceWeakIndependentRoots(
+      &parallel_scavengers_[0]);
+  RunParallelScavengeTask(SCAVENGE_TRANSITIVE_CLOSURE);
+
+  FinishParallelScavenge();
+}
+
+
+void Heap::FinishParallelScavenge() {
+  StoreBufferRebuildScope scope(this,
+                                store_buffer(),
+                                &ScavengeStoreBufferCallback);
+  for (int i = 0; i < parallel_scavengers_count_; i++) {
+    ParallelScavenger* scavenger = &parallel_scavengers_[i];
+    ASSERT(scavenger->queue()->IsEmpty());
+    List<Object**>* slots = scavenger->old_to_new_slots();
+    for (int j = 0; j < slots->length(); j++) {
+      Object** slot = slots->at(j);
+      if (InNewSpace(*slot)) {
+        store_buffer()->EnterDirectlyIntoStoreBuffer(
+            reinterpret_cast<Address>(slot));
+      }
+    }
+    slots->Clear();
+    tracer()->increment_promoted_objects_size(
+        scavenger->promoted_objects_size());
+    scavenger->ResetPromotedObjectsSize();
+  }
+}
+
+
 MaybeObject* Heap::AllocatePartialMap(InstanceType instance_type,
                                       int instance_size) {
   Object* result;
@@ -4177,10 +4865,13 @@ MaybeObject* Heap::AllocateGlobalObject(JSFunction* constructor) {
 }
 
 
-MaybeObject* Heap::CopyJSObject(JSObject* source) {
+MaybeObject* Heap::CopyJSObject(JSObject* source,
+                                PretenureFlag pretenure,
+                                AllocationSite* site) {
   // Never used to copy functions.  If functions need to be copied we
   // have to be careful to clear the literals array.
   SLOW_ASSERT(!source->IsJSFunction());
+  ASSERT(site == NULL || pretenure == NOT_TENURED);
 
   // Make the clone.
   Map* map = source->map();
@@ -4190,10 +4881,13 @@ MaybeObject* Heap::CopyJSObject(JSObject* source) {
   WriteBarrierMode wb_mode = UPDATE_WRITE_BARRIER;
 
   // If we're forced to always allocate, we use the general allocation
-  // functions which may leave us with an object in old space.
-  if (always_allocate()) {
+  // functions which may leave us with an object in old space.  Copies that
+  // are pretenured are allocated in old space right away.
+  if (always_allocate() || pretenure == TENURED) {
+    AllocationSpace space =
+        pretenure == TENURED ? OLD_POINTER_SPACE : NEW_SPACE;
     { MaybeObject* maybe_clone =
-          AllocateRaw(object_size, NEW_SPACE, OLD_POINTER_SPACE);
+          AllocateRaw(object_size, space, OLD_POINTER_SPACE);
       if (!maybe_clone->ToObject(&clone)) return maybe_clone;
     }
     Address clone_address = HeapObject::cast(clone)->address();
@@ -4206,7 +4900,9 @@ MaybeObject* Heap::CopyJSObject(JSObject* source) {
                  (object_size - JSObject::kHeaderSize) / kPointerSize);
   } else {
     wb_mode = SKIP_WRITE_BARRIER;
-    { MaybeObject* maybe_clone = new_space_.AllocateRaw(object_size);
+    int allocation_size = object_size;
+    if (site != NULL) allocation_size += AllocationMemento::kSize;
+    { MaybeObject* maybe_clone = new_space_.AllocateRaw(allocation_size);
       if (!maybe_clone->ToObject(&clone)) return maybe_clone;
     }
     SLOW_ASSERT(InNewSpace(clone));
@@ -4215,6 +4911,14 @@ MaybeObject* Heap::CopyJSObject(JSObject* source) {
     CopyBlock(HeapObject::cast(clone)->address(),
               source->address(),
               object_size);
+    if (site != NULL) {
+      AllocationMemento* memento = reinterpret_cast<AllocationMemento*>(
+          HeapObject::FromAddress(
+              HeapObject::cast(clone)->address() + object_size));
+      memento->set_map_no_write_barrier(allocation_memento_map());
+      memento->set_allocation_site(site, SKIP_WRITE_BARRIER);
+      site->set_memento_create_count(site->memento_create_count() + 1);
+    }
   }
 
   SLOW_ASSERT(
@@ -4228,9 +4932,10 @@ MaybeObject* Heap::CopyJSObject(JSObject* source) {
       if (elements->map() == fixed_cow_array_map()) {
         maybe_elem = FixedArray::cast(elements);
       } else if (source->HasFastDoubleElements()) {
-        maybe_elem = CopyFixedDoubleArray(FixedDoubleArray::cast(elements));
+        maybe_elem = CopyFixedDoubleArray(FixedDoubleArray::cast(elements),
+                                          pretenure);
       } else {
-        maybe_elem = CopyFixedArray(FixedArray::cast(elements));
+        maybe_elem = CopyFixedArray(FixedArray::cast(elements), pretenure);
       }
       if (!maybe_elem->ToObject(&elem)) return maybe_elem;
     }
@@ -4239,7 +4944,7 @@ MaybeObject* Heap::CopyJSObject(JSObject* source) {
   // Update properties if necessary.
   if (properties->length() > 0) {
     Object* prop;
-    { MaybeObject* maybe_prop = CopyFixedArray(properties);
+    { MaybeObject* maybe_prop = CopyFixedArray(properties, pretenure);
       if (!maybe_prop->ToObject(&prop)) return maybe_prop;
     }
     JSObject::cast(clone)->set_properties(FixedArray::cast(prop), wb_mode);
@@ -4637,10 +5342,14 @@ MaybeObject* Heap::AllocateRawFixedArray(int length) {
 }
 
 
-MaybeObject* Heap::CopyFixedArrayWithMap(FixedArray* src, Map* map) {
+MaybeObject* Heap::CopyFixedArrayWithMap(FixedArray* src,
+                                         Map* map,
+                                         PretenureFlag pretenure) {
   int len = src->length();
   Object* obj;
-  { MaybeObject* maybe_obj = AllocateRawFixedArray(len);
+  { MaybeObject* maybe_obj = pretenure == TENURED
+        ? AllocateRawFixedArray(len, TENURED)
+        : AllocateRawFixedArray(len);
     if (!maybe_obj->ToObject(&obj)) return maybe_obj;
   }
   if (InNewSpace(obj)) {
@@ -4664,10 +5373,11 @@ MaybeObject* Heap::CopyFixedArrayWithMap(FixedArray* src, Map* map) {
 
 
 MaybeObject* Heap::CopyFixedDoubleArrayWithMap(FixedDoubleArray* src,
-                                               Map* map) {
+                                               Map* map,
+                                               PretenureFlag pretenure) {
   int len = src->length();
   Object* obj;
-  { MaybeObject* maybe_obj = AllocateRawFixedDoubleArray(len, NOT_TENURED);
+  { MaybeObject* maybe_obj = AllocateRawFixedDoubleArray(len, pretenure);
     if (!maybe_obj->ToObject(&obj)) return maybe_obj;
   }
   HeapObject* dst = HeapObject::cast(obj);
@@ -5030,18 +5740,23 @@ void Heap::AdvanceIdleIncrementalMarking(intptr_t step_size) {
                               IncrementalMarking::NO_GC_VIA_STACK_GUARD);
 
   if (incremental_marking()->IsComplete()) {
-    bool uncommit = false;
-    if (gc_count_at_last_idle_gc_ == gc_count_) {
-      // No GC since the last full GC, the mutator is probably not active.
-      isolate_->compilation_cache()->Clear();
-      uncommit = true;
-    }
-    CollectAllGarbage(kNoGCFlags, "idle notification: finalize incremental");
-    gc_count_at_last_idle_gc_ = gc_count_;
-    if (uncommit) {
-      new_space_.Shrink();
-      UncommitFromSpace();
-    }
+    FinalizeIdleIncrementalMarking();
+  }
+}
+
+
+void Heap::FinalizeIdleIncrementalMarking() {
+  bool uncommit = false;
+  if (gc_count_at_last_idle_gc_ == gc_count_) {
+    // No GC since the last full GC, the mutator is probably not active.
+    isolate_->compilation_cache()->Clear();
+    uncommit = true;
+  }
+  CollectAllGarbage(kNoGCFlags, "idle notification: finalize incremental");
+  gc_count_at_last_idle_gc_ = gc_count_;
+  if (uncommit) {
+    new_space_.Shrink();
+    UncommitFromSpace();
   }
 }
 
@@ -5058,6 +5773,8 @@ bool Heap::IdleNotification(int hint) {
   // chrome/performance_ui_tests --gtest_filter="GeneralMixMemoryTest.*
   intptr_t step_size = size_factor * IncrementalMarking::kAllocatedThreshold;
 
+  memory_reducer_.NotifyIdle(hint >= kMinHintForFullGC);
+
   if (contexts_disposed_ > 0) {
     if (hint >= kMaxHint) {
       // The embedder is requesting a lot of GC work after context disposal,
@@ -5207,6 +5924,158 @@ bool Heap::IdleGlobalGC() {
 }
 
 
+void Heap::UpdateDuration(double* duration_in_ms, double sample_in_ms) {
+  // Overshooting a deadline is worse than leaving idle time unused, so a
+  // slower sample is taken over at once and a faster one only halfway.
+  *duration_in_ms = Max(sample_in_ms, (*duration_in_ms + sample_in_ms) / 2);
+}
+
+
+void Heap::UpdateSpeed(intptr_t* speed_in_bytes_per_ms,
+                       intptr_t bytes,
+                       double duration_in_ms) {
+  if (bytes <= 0 || duration_in_ms <= 0) return;
+  intptr_t sample = static_cast<intptr_t>(bytes / duration_in_ms);
+  *speed_in_bytes_per_ms = Max(static_cast<intptr_t>(1),
+                               (*speed_in_bytes_per_ms + sample) / 2);
+}
+
+
+bool Heap::IdleNotificationDeadline(int idle_time_in_ms,
+                                    double* time_used_in_ms) {
+  double start = OS::TimeCurrentMillis();
+  double deadline = start + idle_time_in_ms;
+
+  memory_reducer_.NotifyIdle(
+      SizeOfObjects() <= mark_compact_speed_in_bytes_per_ms_ *
+                         idle_time_in_ms * kIdleTimeBudgetPercent / 100);
+
+  // Idle rounds are counted in mark-sweeps as for hint based notifications,
+  // see IdleNotification.
+  if (contexts_disposed_ > 0) StartIdleRound();
+  if (mark_sweeps_since_idle_round_started_ >= kMaxMarkSweepsInIdleRound &&
+      EnoughGarbageSinceLastIdleRound()) {
+    StartIdleRound();
+  }
+  mark_sweeps_since_idle_round_started_ +=
+      ms_count_ - ms_count_at_last_idle_notification_;
+  ms_count_at_last_idle_notification_ = ms_count_;
+
+  IdleTimeResult result = IDLE_TIME_WORK_DONE;
+  while (result == IDLE_TIME_WORK_DONE) {
+    double remaining_ms = deadline - OS::TimeCurrentMillis();
+    if (remaining_ms < kMinIdleTimeSliceInMs) break;
+    result = PerformIdleTimeWork(remaining_ms);
+    mark_sweeps_since_idle_round_started_ +=
+        ms_count_ - ms_count_at_last_idle_notification_;
+    ms_count_at_last_idle_notification_ = ms_count_;
+  }
+
+  double used = OS::TimeCurrentMillis() - start;
+  if (FLAG_trace_idle_notification) {
+    PrintPID("Idle notification: %d ms requested, %.1f ms used%s\n",
+             idle_time_in_ms,
+             used,
+             result == IDLE_TIME_NO_WORK_LEFT ? ", done" : "");
+  }
+  if (time_used_in_ms != NULL) *time_used_in_ms = used;
+  return result == IDLE_TIME_NO_WORK_LEFT;
+}
+
+
+Heap::IdleTimeResult Heap::PerformIdleTimeWork(double idle_time_in_ms) {
+  if (incremental_marking()->IsComplete()) {
+    if (final_incremental_mark_compact_in_ms_ >
+        idle_time_in_ms * kIdleTimeBudgetPercent / 100) {
+      return IDLE_TIME_NOTHING_FITS;
+    }
+    double start = OS::TimeCurrentMillis();
+    FinalizeIdleIncrementalMarking();
+    UpdateDuration(&final_incremental_mark_compact_in_ms_,
+                   OS::TimeCurrentMillis() - start);
+    return IDLE_TIME_WORK_DONE;
+  }
+
+  if (new_space_.Size() >= new_space_.Capacity() / 2) {
+    intptr_t bytes = static_cast<intptr_t>(
+        scavenge_speed_in_bytes_per_ms_ *
+        idle_time_in_ms * kIdleTimeBudgetPercent / 100);
+    if (new_space_.Size() <= bytes) {
+      CollectGarbage(NEW_SPACE, "idle notification: scavenge");
+      return IDLE_TIME_WORK_DONE;
+    }
+  }
+
+  if (!incremental_marking()->IsStopped()) {
+    intptr_t bytes = static_cast<intptr_t>(
+        incremental_marking()->marking_speed_in_bytes_per_ms() *
+        idle_time_in_ms * kIdleTimeBudgetPercent / 100);
+    incremental_marking()->IdleStep(
+        Max(bytes, IncrementalMarking::kAllocatedThreshold));
+    return IDLE_TIME_WORK_DONE;
+  }
+
+  if (!IsSweepingComplete()) {
+    intptr_t bytes = static_cast<intptr_t>(
+        sweeping_speed_in_bytes_per_ms_ *
+        idle_time_in_ms * kIdleTimeBudgetPercent / 100);
+    intptr_t unswept_before = old_pointer_space()->unswept_free_bytes() +
+                              old_data_space()->unswept_free_bytes();
+    double start = OS::TimeCurrentMillis();
+    AdvanceSweepers(static_cast<int>(Min(bytes,
+                                         static_cast<intptr_t>(kMaxInt))));
+    intptr_t unswept_after = old_pointer_space()->unswept_free_bytes() +
+                             old_data_space()->unswept_free_bytes();
+    UpdateSpeed(&sweeping_speed_in_bytes_per_ms_,
+                unswept_before - unswept_after,
+                OS::TimeCurrentMillis() - start);
+    return IDLE_TIME_WORK_DONE;
+  }
+
+  if (mark_sweeps_since_idle_round_started_ >= kMaxMarkSweepsInIdleRound) {
+    FinishIdleRound();
+    return IDLE_TIME_NO_WORK_LEFT;
+  }
+
+  intptr_t size_of_objects = SizeOfObjects();
+  intptr_t bytes = static_cast<intptr_t>(
+      mark_compact_speed_in_bytes_per_ms_ *
+      idle_time_in_ms * kIdleTimeBudgetPercent / 100);
+  // A full collection also has costs that do not grow with the size of the
+  // objects, so it is not expected to be faster than the last ones.  If it
+  // does not fit, incremental marking does the work in smaller steps.
+  if (size_of_objects <= bytes &&
+      idle_mark_compact_in_ms_ <=
+          idle_time_in_ms * kIdleTimeBudgetPercent / 100) {
+    // A full collection is preferred over incremental marking if it fits,
+    // because it can also compact the code space.
+    double start = OS::TimeCurrentMillis();
+    CollectAllGarbage(kReduceMemoryFootprintMask,
+                      "idle notification: mark-sweep");
+    new_space_.Shrink();
+    UncommitFromSpace();
+    UpdateDuration(&idle_mark_compact_in_ms_,
+                   OS::TimeCurrentMillis() - start);
+    // If hardly anything was freed, further collections in this round are
+    // unlikely to free more.
+    if (size_of_objects - SizeOfObjects() < size_of_objects / 16) {
+      FinishIdleRound();
+    }
+    return IDLE_TIME_WORK_DONE;
+  }
+  if (FLAG_incremental_marking && !FLAG_expose_gc && !Serializer::enabled() &&
+      incremental_marking_start_in_ms_ <=
+          idle_time_in_ms * kIdleTimeBudgetPercent / 100) {
+    double start = OS::TimeCurrentMillis();
+    incremental_marking()->Start();
+    UpdateDuration(&incremental_marking_start_in_ms_,
+                   OS::TimeCurrentMillis() - start);
+    return IDLE_TIME_WORK_DONE;
+  }
+  return IDLE_TIME_NOTHING_FITS;
+}
+
+
 #ifdef DEBUG
 
 void Heap::Print() {
@@ -5558,6 +6427,7 @@ static void CheckStoreBuffer(Heap* heap,
     }
     if (**store_buffer_position != current ||
         *store_buffer_position == store_buffer_top) {
+      if (heap->store_buffer()->CellIsInSlotSet(current_address)) continue;
       Object** obj_start = current;
       while (!(*obj_start)->IsMap()) obj_start--;
       UNREACHABLE();
@@ -5875,6 +6745,37 @@ intptr_t Heap::PromotedExternalMemorySize() {
       - amount_of_external_allocated_memory_at_last_global_gc_;
 }
 
+
+void Heap::ReportExternalMemoryPressure(intptr_t change_in_bytes) {
+  if (gc_state() != NOT_IN_GC) return;
+  intptr_t pressure = PromotedExternalMemorySize();
+  IncrementalMarking* marking = incremental_marking();
+
+  if (marking->IsStopped()) {
+    if (pressure > external_allocation_limit_) {
+      CollectAllGarbage(kNoGCFlags, "external memory allocation limit reached");
+    } else if (marking->WorthActivating() &&
+               (pressure > external_allocation_limit_ / 2 ||
+                NextGCIsLikelyToBeFull() ||
+                marking->ShouldStartForPauseTarget())) {
+      if (FLAG_trace_incremental_marking) {
+        PrintF("[IncrementalMarking] Start (external memory pressure)\n");
+      }
+      marking->Start();
+    }
+    return;
+  }
+
+  // The external memory is as good as promoted, so the marker has to keep
+  // up with it like with promoted objects.
+  marking->Step(change_in_bytes, IncrementalMarking::GC_VIA_STACK_GUARD);
+  if (pressure > 2 * external_allocation_limit_ && !marking->IsStopped()) {
+    // Marking fell too far behind, finish it without further delay.
+    marking->set_should_hurry(true);
+    CollectAllGarbage(kNoGCFlags, "external memory allocation limit reached");
+  }
+}
+
 #ifdef DEBUG
 
 // Tags 0, 1, and 3 are used. Use 2 for marking visited HeapObject.
@@ -6158,7 +7059,10 @@ bool Heap::SetUp(bool create_heap_objects) {
 
   store_buffer()->SetUp();
 
-  if (FLAG_parallel_recompilation) relocation_mutex_ = OS::CreateMutex();
+  if (FLAG_parallel_recompilation) {
+    relocation_mutex_ = OS::CreateMutex();
+    relocation_readers_done_ = OS::CreateSemaphore(0);
+  }
 
   return true;
 }
@@ -6246,6 +7150,12 @@ void Heap::TearDown() {
   isolate_->memory_allocator()->TearDown();
 
   delete relocation_mutex_;
+  delete relocation_readers_done_;
+
+  delete[] parallel_scavengers_;
+  parallel_scavengers_ = NULL;
+  delete scavenge_mutex_;
+  scavenge_mutex_ = NULL;
 
 #ifdef DEBUG
   delete debug_utils_;
@@ -6255,6 +7165,11 @@ void Heap::TearDown() {
 
 
 void Heap::Shrink() {
+  // Sweeper threads must not walk pages that are being released.
+  if (mark_compact_collector()->IsConcurrentSweepingInProgress()) {
+    mark_compact_collector()->WaitUntilSweepingCompleted();
+  }
+
   // Try to shrink all paged spaces.
   PagedSpaces spaces;
   for (PagedSpace* space = spaces.next();
@@ -6262,6 +7177,9 @@ void Heap::Shrink() {
        space = spaces.next()) {
     space->ReleaseAllUnusedPages();
   }
+
+  // Give the large object chunks kept for reuse back to the OS.
+  isolate_->memory_allocator()->ReleasePooledLargeChunks();
 }
 
 
@@ -6809,6 +7727,40 @@ static intptr_t CountTotalHolesSize() {
 }
 
 
+GCPauseHistory::GCPauseHistory() : count_(0) {
+  for (int phase = 0; phase < kNumberOfPhases; phase++) {
+    total_[phase] = 0;
+    max_[phase] = 0;
+    for (int bucket = 0; bucket < kNumberOfBuckets; bucket++) {
+      histogram_[phase][bucket] = 0;
+    }
+  }
+}
+
+
+int GCPauseHistory::BucketFor(double ms) {
+  int bucket = 0;
+  for (double limit = 1; ms >= limit; limit *= 2) {
+    if (++bucket == kNumberOfBuckets - 1) break;
+  }
+  return bucket;
+}
+
+
+void GCPauseHistory::Record(double pause, const double* scopes) {
+  STATIC_ASSERT(kNumberOfPhases == GCTracer::Scope::kNumberOfScopes + 1);
+  double* sample = samples_[count_ % kCapacity];
+  for (int phase = 0; phase < kNumberOfPhases; phase++) {
+    double ms = (phase == 0) ? pause : scopes[phase - 1];
+    sample[phase] = ms;
+    total_[phase] += ms;
+    max_[phase] = Max(max_[phase], ms);
+    if (phase == 0 || ms > 0) histogram_[phase][BucketFor(ms)]++;
+  }
+  count_++;
+}
+
+
 GCTracer::GCTracer(Heap* heap,
                    const char* gc_reason,
                    const char* collector_reason)
@@ -6820,18 +7772,21 @@ GCTracer::GCTracer(Heap* heap,
       allocated_since_last_gc_(0),
       spent_in_mutator_(0),
       promoted_objects_size_(0),
+      start_external_memory_(0),
       heap_(heap),
       gc_reason_(gc_reason),
       collector_reason_(collector_reason) {
-  if (!FLAG_trace_gc && !FLAG_print_cumulative_gc_stat) return;
+  // The pause times are always recorded for GCPauseHistory.
   start_time_ = OS::TimeCurrentMillis();
-  start_object_size_ = heap_->SizeOfObjects();
-  start_memory_size_ = heap_->isolate()->memory_allocator()->Size();
-
   for (int i = 0; i < Scope::kNumberOfScopes; i++) {
     scopes_[i] = 0;
   }
 
+  if (!FLAG_trace_gc && !FLAG_print_cumulative_gc_stat) return;
+  start_object_size_ = heap_->SizeOfObjects();
+  start_memory_size_ = heap_->isolate()->memory_allocator()->Size();
+  start_external_memory_ = heap_->amount_of_external_allocated_memory_;
+
   in_free_list_or_wasted_before_gc_ = CountTotalHolesSize();
 
   allocated_since_last_gc_ =
@@ -6848,19 +7803,32 @@ GCTracer::GCTracer(Heap* heap,
       heap_->incremental_marking()->steps_count_since_last_gc();
   steps_took_since_last_gc_ =
       heap_->incremental_marking()->steps_took_since_last_gc();
+  capped_steps_count_ = heap_->incremental_marking()->capped_steps_count();
+  marking_speed_ = heap_->incremental_marking()->marking_speed_in_bytes_per_ms();
 }
 
 
 GCTracer::~GCTracer() {
-  // Printf ONE line iff flag is set.
-  if (!FLAG_trace_gc && !FLAG_print_cumulative_gc_stat) return;
+  GCPauseHistory* pauses = (collector_ == SCAVENGER)
+      ? heap_->scavenge_pauses()
+      : heap_->mark_compact_pauses();
+  pauses->Record(OS::TimeCurrentMillis() - start_time_, scopes_);
 
   bool first_gc = (heap_->last_gc_end_timestamp_ == 0);
 
-  heap_->alive_after_last_gc_ = heap_->SizeOfObjects();
+  // The next collection measures the new space allocation throughput
+  // against the mutator time since this point.
   heap_->last_gc_end_timestamp_ = OS::TimeCurrentMillis();
 
+  // Printf ONE line iff flag is set.
+  if (!FLAG_trace_gc && !FLAG_print_cumulative_gc_stat) return;
+
+  heap_->alive_after_last_gc_ = heap_->SizeOfObjects();
+
   int time = static_cast<int>(heap_->last_gc_end_timestamp_ - start_time_);
+  // Weak callbacks run by the collection release external memory.
+  intptr_t external_released = Max(static_cast<intptr_t>(0),
+      start_external_memory_ - heap_->amount_of_external_allocated_memory_);
 
   // Update cumulative GC statistics if required.
   if (FLAG_print_cumulative_gc_stat) {
@@ -6890,6 +7858,10 @@ GCTracer::~GCTracer() {
 
     if (external_time > 0) PrintF("%d / ", external_time);
     PrintF("%d ms", time);
+    if (external_released > 0) {
+      PrintF(", %.1f MB external memory released",
+             static_cast<double>(external_released) / MB);
+    }
     if (steps_count_ > 0) {
       if (collector_ == SCAVENGER) {
         PrintF(" (+ %d ms in %d steps since last GC)",
@@ -6957,6 +7929,9 @@ GCTracer::~GCTracer() {
 
     PrintF("allocated=%" V8_PTR_PREFIX "d ", allocated_since_last_gc_);
     PrintF("promoted=%" V8_PTR_PREFIX "d ", promoted_objects_size_);
+    PrintF("external_released=%" V8_PTR_PREFIX "d ", external_released);
+    PrintF("external_size=%" V8_PTR_PREFIX "d ",
+           heap_->amount_of_external_allocated_memory_);
 
     if (collector_ == SCAVENGER) {
       PrintF("stepscount=%d ", steps_count_since_last_gc_);
@@ -6964,7 +7939,11 @@ GCTracer::~GCTracer() {
     } else {
       PrintF("stepscount=%d ", steps_count_);
       PrintF("stepstook=%d ", static_cast<int>(steps_took_));
+      PrintF("longeststep=%d ", static_cast<int>(longest_step_));
+      PrintF("cappedsteps=%d ", capped_steps_count_);
     }
+    PrintF("targetpause=%d ", FLAG_gc_target_pause_ms);
+    PrintF("markingspeed=%" V8_PTR_PREFIX "d ", marking_speed_);
 
     PrintF("\n");
   }
@@ -7169,6 +8148,32 @@ void Heap::FreeQueuedChunks() {
 }
 
 
+void Heap::AcquireRelocationLock() {
+  relocation_mutex_->Lock();
+  // New readers are held up by the mutex, wait for the current ones.  The
+  // semaphore may carry a stale signal, so the count is checked again.
+  Barrier_AtomicIncrement(&relocation_writer_waiting_, 1);
+  while (Acquire_Load(&relocation_readers_) > 0) {
+    relocation_readers_done_->Wait();
+  }
+  Barrier_AtomicIncrement(&relocation_writer_waiting_, -1);
+}
+
+
+void Heap::AcquireSharedRelocationLock() {
+  ScopedLock lock(relocation_mutex_);
+  Barrier_AtomicIncrement(&relocation_readers_, 1);
+}
+
+
+void Heap::ReleaseSharedRelocationLock() {
+  if (Barrier_AtomicIncrement(&relocation_readers_, -1) == 0 &&
+      Acquire_Load(&relocation_writer_waiting_) > 0) {
+    relocation_readers_done_->Signal();
+  }
+}
+
+
 void Heap::RememberUnmappedPage(Address page, bool compacted) {
   uintptr_t p = reinterpret_cast<uintptr_t>(page);
   // Tag the page pointer to make it findable in the dump file.
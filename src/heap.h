@@ -35,6 +35,7 @@
 #include "incremental-marking.h"
 #include "list.h"
 #include "mark-compact.h"
+#include "memory-reducer.h"
 #include "objects-visiting.h"
 #include "spaces.h"
 #include "splay-tree-inl.h"
@@ -250,6 +251,8 @@ namespace internal {
 class GCTracer;
 class HeapStats;
 class Isolate;
+class ParallelScavenger;
+class SamplingHeapProfiler;
 class WeakObjectRetainer;
 
 
@@ -387,6 +390,48 @@ typedef void (*ScavengingCallback)(Map* map,
                                    HeapObject* object);
 
 
+// Pause times of the collections done by one collector, broken down by
+// the GCTracer scopes.  Phase 0 is the whole pause and phase i + 1 is
+// GCTracer::Scope i.  The most recent pauses are kept in a ring buffer, all
+// pauses are summed up in log2 histograms with kNumberOfBuckets buckets of
+// 1, 2, 4, ... ms.
+class GCPauseHistory {
+ public:
+  static const int kNumberOfPhases = 13;
+  static const int kNumberOfBuckets = 16;
+  static const int kCapacity = 32;
+
+  GCPauseHistory();
+
+  void Record(double pause, const double* scopes);
+
+  int count() { return count_; }
+  double total(int phase) { return total_[phase]; }
+  double max(int phase) { return max_[phase]; }
+  int histogram(int phase, int bucket) { return histogram_[phase][bucket]; }
+
+  // Number of pauses in the ring buffer.
+  int length() { return count_ < kCapacity ? count_ : kCapacity; }
+
+  // Returns the i-th pause in the ring buffer starting with the oldest.
+  double sample(int i, int phase) {
+    ASSERT(0 <= i && i < length());
+    return samples_[(count_ - length() + i) % kCapacity][phase];
+  }
+
+  static int BucketFor(double ms);
+
+ private:
+  int count_;
+  double total_[kNumberOfPhases];
+  double max_[kNumberOfPhases];
+  int histogram_[kNumberOfPhases][kNumberOfBuckets];
+  double samples_[kCapacity][kNumberOfPhases];
+
+  DISALLOW_COPY_AND_ASSIGN(GCPauseHistory);
+};
+
+
 // External strings table is a place where all external strings are
 // registered.  We need to keep track of such strings to properly
 // finalize them.
@@ -481,6 +526,10 @@ class Heap {
   // Returns the amount of executable memory currently committed for the heap.
   intptr_t CommittedMemoryExecutable();
 
+  // Returns the amount of memory of the heap advised to be backed by huge
+  // pages.
+  intptr_t CommittedMemoryHugePages();
+
   // Returns the available bytes in space w/o growing.
   // Heap doesn't guarantee that it can allocate an object that requires
   // all available bytes. Check MaxHeapObjectSize() instead.
@@ -519,6 +568,13 @@ class Heap {
     return new_space_.allocation_limit_address();
   }
 
+  Address* OldPointerSpaceAllocationTopAddress() {
+    return old_pointer_space_->allocation_top_address();
+  }
+  Address* OldPointerSpaceAllocationLimitAddress() {
+    return old_pointer_space_->allocation_limit_address();
+  }
+
   // Uncommit unused semi space.
   bool UncommitFromSpace() { return new_space_.UncommitFromSpace(); }
 
@@ -564,9 +620,14 @@ class Heap {
   MUST_USE_RESULT MaybeObject* AllocateGlobalObject(JSFunction* constructor);
 
   // Returns a deep copy of the JavaScript object.
-  // Properties and elements are copied too.
+  // Properties and elements are copied too.  If an allocation site is given
+  // the copy is allocated in new space and followed by an allocation memento
+  // for the site.
   // Returns failure if allocation failed.
-  MUST_USE_RESULT MaybeObject* CopyJSObject(JSObject* source);
+  MUST_USE_RESULT MaybeObject* CopyJSObject(
+      JSObject* source,
+      PretenureFlag pretenure = NOT_TENURED,
+      AllocationSite* site = NULL);
 
   // Allocates the function prototype.
   // Returns Failure::RetryAfterGC(requested_bytes, space) if the allocation
@@ -774,21 +835,29 @@ class Heap {
 
   // Make a copy of src and return it. Returns
   // Failure::RetryAfterGC(requested_bytes, space) if the allocation failed.
-  MUST_USE_RESULT inline MaybeObject* CopyFixedArray(FixedArray* src);
+  MUST_USE_RESULT inline MaybeObject* CopyFixedArray(
+      FixedArray* src,
+      PretenureFlag pretenure = NOT_TENURED);
 
   // Make a copy of src, set the map, and return the copy. Returns
   // Failure::RetryAfterGC(requested_bytes, space) if the allocation failed.
-  MUST_USE_RESULT MaybeObject* CopyFixedArrayWithMap(FixedArray* src, Map* map);
+  MUST_USE_RESULT MaybeObject* CopyFixedArrayWithMap(
+      FixedArray* src,
+      Map* map,
+      PretenureFlag pretenure = NOT_TENURED);
 
   // Make a copy of src and return it. Returns
   // Failure::RetryAfterGC(requested_bytes, space) if the allocation failed.
   MUST_USE_RESULT inline MaybeObject* CopyFixedDoubleArray(
-      FixedDoubleArray* src);
+      FixedDoubleArray* src,
+      PretenureFlag pretenure = NOT_TENURED);
 
   // Make a copy of src, set the map, and return the copy. Returns
   // Failure::RetryAfterGC(requested_bytes, space) if the allocation failed.
   MUST_USE_RESULT MaybeObject* CopyFixedDoubleArrayWithMap(
-      FixedDoubleArray* src, Map* map);
+      FixedDoubleArray* src,
+      Map* map,
+      PretenureFlag pretenure = NOT_TENURED);
 
   // Allocates a fixed array initialized with the hole values.
   // Returns Failure::RetryAfterGC(requested_bytes, space) if the allocation
@@ -1156,6 +1225,20 @@ class Heap {
   // Number of mark-sweeps.
   int ms_count() { return ms_count_; }
 
+  // Returns the number of garbage collections so far.
+  int gc_count() { return static_cast<int>(gc_count_); }
+
+  // Counts the object as a survivor of the allocation site of its allocation
+  // memento, if the object in from space is followed by one.  Only the part
+  // of from space below the given limit has been allocated.
+  inline void RecordAllocationSiteFeedback(HeapObject* object,
+                                           int object_size,
+                                           Address limit);
+
+  // Top of new space before the semispaces were flipped by the current
+  // scavenge.
+  Address new_space_top_before_gc() { return new_space_top_before_gc_; }
+
   // Iterates over all roots in the heap.
   void IterateRoots(ObjectVisitor* v, VisitMode mode);
   // Iterates over all strong roots in the heap.
@@ -1272,6 +1355,10 @@ class Heap {
   // Invoke Shrink on shrinkable spaces.
   void Shrink();
 
+  // Releases empty pages, shrinks new space and uncommits the memory that is
+  // not needed until the next collection.
+  void ReleaseUnusedMemory();
+
   enum HeapState { NOT_IN_GC, SCAVENGE, MARK_COMPACT };
   inline HeapState gc_state() { return gc_state_; }
 
@@ -1382,6 +1469,11 @@ class Heap {
   // Implements the corresponding V8 API function.
   bool IdleNotification(int hint);
 
+  // Implements the corresponding V8 API function.  Performs the garbage
+  // collection work that is estimated to fit into the given idle time and
+  // stores the time actually spent in time_used_in_ms if it is not NULL.
+  bool IdleNotificationDeadline(int idle_time_in_ms, double* time_used_in_ms);
+
   // Declare all the root indices.
   enum RootListIndex {
 #define ROOT_INDEX_DECLARATION(type, name, camel_name) k##camel_name##RootIndex,
@@ -1430,6 +1522,10 @@ class Heap {
   // Check new space expansion criteria and expand semispaces if it was hit.
   void CheckNewSpaceExpansionCriteria();
 
+  // Grows or shrinks the semispaces by one step towards the capacity
+  // computed by NewSpaceCapacityForGCTime from the last measurements.
+  void AdjustNewSpaceCapacity();
+
   inline void IncrementYoungSurvivorsCounter(int survived) {
     ASSERT(survived >= 0);
     young_survivors_after_last_gc_ = survived;
@@ -1505,6 +1601,27 @@ class Heap {
   // Returns minimal interval between two subsequent collections.
   int get_min_in_mutator() { return min_in_mutator_; }
 
+  GCPauseHistory* scavenge_pauses() { return &scavenge_pauses_; }
+  GCPauseHistory* mark_compact_pauses() { return &mark_compact_pauses_; }
+
+  // Returns the space with the given identity as a paged space.
+  PagedSpace* paged_space(int idx) {
+    switch (idx) {
+      case OLD_POINTER_SPACE:
+        return old_pointer_space();
+      case OLD_DATA_SPACE:
+        return old_data_space();
+      case CODE_SPACE:
+        return code_space();
+      case MAP_SPACE:
+        return map_space();
+      case CELL_SPACE:
+        return cell_space();
+    }
+    UNREACHABLE();
+    return NULL;
+  }
+
   MarkCompactCollector* mark_compact_collector() {
     return &mark_compact_collector_;
   }
@@ -1521,6 +1638,39 @@ class Heap {
     return &incremental_marking_;
   }
 
+  MemoryReducer* memory_reducer() {
+    return &memory_reducer_;
+  }
+
+  SamplingHeapProfiler* sampling_heap_profiler() {
+    return sampling_heap_profiler_;
+  }
+
+  // Installs the profiler that samples allocations in all spaces, NULL
+  // stops sampling.  The heap does not take ownership.
+  void set_sampling_heap_profiler(SamplingHeapProfiler* profiler) {
+    sampling_heap_profiler_ = profiler;
+    new_space_.LowerInlineAllocationLimit(
+        new_space_.inline_allocation_limit_step());
+  }
+
+  // Returns the number of bytes allocated in new space since the heap was
+  // set up.
+  intptr_t NewSpaceAllocationCounter() {
+    return new_space_allocation_counter_ + new_space_.Size();
+  }
+
+  // Returns the semispace capacity at which scavenges take gc_time_percent
+  // of the mutator time.  The survivors of a scavenge are mostly objects
+  // allocated shortly before it, so their volume is assumed not to depend on
+  // the capacity, while the number of scavenges is inversely proportional to
+  // it.
+  static intptr_t NewSpaceCapacityForGCTime(
+      intptr_t survived_bytes,
+      intptr_t survivor_speed_in_bytes_per_ms,
+      intptr_t allocation_throughput_in_bytes_per_ms,
+      int gc_time_percent);
+
   bool IsSweepingComplete() {
     return old_data_space()->IsSweepingComplete() &&
            old_pointer_space()->IsSweepingComplete();
@@ -1627,13 +1777,17 @@ class Heap {
 
   void CheckpointObjectStats();
 
+  // Performs the share of the current parallel scavenging round that belongs
+  // to the given worker.  Worker 0 is the main thread.
+  void ScavengeInParallel(int worker_id);
+
   // We don't use a ScopedLock here since we want to lock the heap
   // only when FLAG_parallel_recompilation is true.
   class RelocationLock {
    public:
     explicit RelocationLock(Heap* heap) : heap_(heap) {
       if (FLAG_parallel_recompilation) {
-        heap_->relocation_mutex_->Lock();
+        heap_->AcquireRelocationLock();
       }
     }
     ~RelocationLock() {
@@ -1646,6 +1800,26 @@ class Heap {
     Heap* heap_;
   };
 
+  // Taken by the optimizer threads while they read the heap through
+  // handles.  Any number of them can hold it together, but not at the same
+  // time as the GC holds the RelocationLock.
+  class SharedRelocationLock {
+   public:
+    explicit SharedRelocationLock(Heap* heap) : heap_(heap) {
+      if (FLAG_parallel_recompilation) {
+        heap_->AcquireSharedRelocationLock();
+      }
+    }
+    ~SharedRelocationLock() {
+      if (FLAG_parallel_recompilation) {
+        heap_->ReleaseSharedRelocationLock();
+      }
+    }
+
+   private:
+    Heap* heap_;
+  };
+
  private:
   Heap();
 
@@ -1698,6 +1872,12 @@ class Heap {
   // Returns the amount of external memory registered since last global gc.
   intptr_t PromotedExternalMemorySize();
 
+  // Called when external memory grew by change_in_bytes.  Starts incremental
+  // marking once half of the external allocation limit is used up, treats
+  // the growth as allocation for the marking steps, and only forces a full
+  // GC when marking cannot keep up.
+  void ReportExternalMemoryPressure(intptr_t change_in_bytes);
+
   int ms_count_;  // how many mark-sweep collections happened
   unsigned int gc_count_;  // how many gc happened
 
@@ -1902,6 +2082,25 @@ class Heap {
                                           MemoryChunk* page,
                                           StoreBufferEvent event);
 
+  // Parallel scavenging is done in rounds.  In the first round the roots and
+  // ranges of the store buffer are scavenged, and every round ends with the
+  // transitive closure being copied by all workers.
+  enum ParallelScavengeTask {
+    SCAVENGE_ROOTS_AND_STORE_BUFFER,
+    SCAVENGE_TRANSITIVE_CLOSURE
+  };
+
+  bool IsParallelScavengeEnabled();
+  void ParallelScavenge();
+  void RunParallelScavengeTask(ParallelScavengeTask task);
+  bool StealScavengingWork(int worker_id);
+  bool ParallelScavengingDone();
+  void FinishParallelScavenge();
+
+  // Store buffer callback used for the pages that are scanned by the main
+  // thread at the end of a parallel store buffer iteration.
+  static void ScavengeObjectOnMainThread(HeapObject** p, HeapObject* object);
+
   // Performs a major collection in the whole heap.
   void MarkCompact(GCTracer* tracer);
 
@@ -2039,6 +2238,28 @@ class Heap {
 
   void AdvanceIdleIncrementalMarking(intptr_t step_size);
 
+  void FinalizeIdleIncrementalMarking();
+
+  enum IdleTimeResult {
+    IDLE_TIME_WORK_DONE,
+    IDLE_TIME_NOTHING_FITS,
+    IDLE_TIME_NO_WORK_LEFT
+  };
+
+  // Performs one piece of garbage collection work that is estimated to take
+  // no longer than the given time: finalizing incremental marking, a
+  // scavenge, an incremental marking step, lazy sweeping or starting the
+  // next collection of the idle round.
+  IdleTimeResult PerformIdleTimeWork(double idle_time_in_ms);
+
+  // Folds a measurement into a running duration estimate.
+  static void UpdateDuration(double* duration_in_ms, double sample_in_ms);
+
+  // Folds a measurement into a running speed estimate.
+  static void UpdateSpeed(intptr_t* speed_in_bytes_per_ms,
+                          intptr_t bytes,
+                          double duration_in_ms);
+
   void ClearObjectStats(bool clear_last_time_stats = false);
 
   static const int kInitialSymbolTableSize = 2048;
@@ -2065,6 +2286,10 @@ class Heap {
 
   double last_gc_end_timestamp_;
 
+  // Pause times of all collections by collector.
+  GCPauseHistory scavenge_pauses_;
+  GCPauseHistory mark_compact_pauses_;
+
   MarkCompactCollector mark_compact_collector_;
 
   StoreBuffer store_buffer_;
@@ -2073,6 +2298,13 @@ class Heap {
 
   IncrementalMarking incremental_marking_;
 
+  MemoryReducer memory_reducer_;
+
+  SamplingHeapProfiler* sampling_heap_profiler_;
+
+  // Bytes allocated in new space up to the last collection.
+  intptr_t new_space_allocation_counter_;
+
   int number_idle_notifications_;
   unsigned int last_idle_notification_gc_count_;
   bool last_idle_notification_gc_count_init_;
@@ -2085,9 +2317,49 @@ class Heap {
   static const int kMaxMarkSweepsInIdleRound = 7;
   static const int kIdleScavengeThreshold = 5;
 
+  // Idle time slices shorter than this are not used for garbage collection
+  // work.
+  static const int kMinIdleTimeSliceInMs = 1;
+  // Only this percentage of the idle time is planned for, so that work
+  // rather finishes early than overshoots the deadline.
+  static const int kIdleTimeBudgetPercent = 90;
+
+  // Speeds assumed until the first collections have been measured.
+  static const intptr_t kInitialScavengeSpeedInBytesPerMs = 256 * KB;
+  static const intptr_t kInitialMarkCompactSpeedInBytesPerMs = 1 * MB;
+  static const intptr_t kInitialSweepingSpeedInBytesPerMs = 1 * MB;
+  static const int kInitialFinalIncrementalMarkCompactInMs = 2;
+  static const int kInitialIncrementalMarkingStartInMs = 1;
+
+  // Running estimates of the garbage collection speeds in bytes per
+  // millisecond.  Scavenges are measured against the used new space, full
+  // collections against the size of objects in the heap and sweeping
+  // against the freed memory.
+  intptr_t scavenge_speed_in_bytes_per_ms_;
+  intptr_t mark_compact_speed_in_bytes_per_ms_;
+  intptr_t sweeping_speed_in_bytes_per_ms_;
+
+  // Running estimates of how long idle notifications take for a full
+  // collection, to finalize incremental marking and to start it, including
+  // the memory given back after a collection.  Marking is done when it is
+  // finalized, so that collection mostly sweeps and does not take longer
+  // with more garbage.
+  double idle_mark_compact_in_ms_;
+  double final_incremental_mark_compact_in_ms_;
+  double incremental_marking_start_in_ms_;
+
+  // Inputs of AdjustNewSpaceCapacity: the speed at which scavenges copy and
+  // promote survivors and the bytes allocated in new space per ms of mutator
+  // time, measured from the end of one collection to the start of the next.
+  intptr_t survivor_speed_in_bytes_per_ms_;
+  intptr_t new_space_allocation_throughput_in_bytes_per_ms_;
+  int new_space_size_at_last_gc_;
+
   // Shared state read by the scavenge collector and set by ScavengeObject.
   PromotionQueue promotion_queue_;
 
+  Address new_space_top_before_gc_;
+
   // Flag is set when the heap has been configured.  The heap can be repeatedly
   // configured through the API until it is set up.
   bool configured_;
@@ -2098,7 +2370,27 @@ class Heap {
 
   MemoryChunk* chunks_queued_for_free_;
 
+  // The GC holds relocation_mutex_ while it moves objects, after waiting
+  // for the optimizer threads counted in relocation_readers_ to finish.
+  // Optimizer threads take the mutex only briefly to be counted.
   Mutex* relocation_mutex_;
+  Semaphore* relocation_readers_done_;
+  volatile Atomic32 relocation_readers_;
+  volatile Atomic32 relocation_writer_waiting_;
+
+  void AcquireRelocationLock();
+  void AcquireSharedRelocationLock();
+  void ReleaseSharedRelocationLock();
+
+  // State of a parallel scavenge.  Allocation in the spaces is serialized
+  // by scavenge_mutex_.
+  ParallelScavenger* parallel_scavengers_;
+  int parallel_scavengers_count_;
+  ParallelScavengeTask parallel_scavenge_task_;
+  int parallel_scavenge_ranges_;
+  volatile Atomic32 next_parallel_scavenge_range_;
+  volatile Atomic32 idle_parallel_scavengers_;
+  Mutex* scavenge_mutex_;
 
   friend class Factory;
   friend class GCTracer;
@@ -2110,6 +2402,7 @@ class Heap {
   friend class MarkCompactCollector;
   friend class StaticMarkingVisitor;
   friend class MapCompact;
+  friend class ParallelScavenger;
 
   DISALLOW_COPY_AND_ASSIGN(Heap);
 };
@@ -2460,7 +2753,7 @@ class GCTracer BASE_EMBEDDED {
       MC_UPDATE_POINTERS_BETWEEN_EVACUATED,
       MC_UPDATE_MISC_POINTERS,
       MC_FLUSH_CODE,
-      kNumberOfScopes
+      kNumberOfScopes  // Keep in sync with v8::GCPauseStatistics::Phase.
     };
 
     Scope(GCTracer* tracer, ScopeId scope)
@@ -2542,12 +2835,17 @@ class GCTracer BASE_EMBEDDED {
   // Size of objects promoted during the current collection.
   intptr_t promoted_objects_size_;
 
+  // Amount of external memory registered at the start of the collection.
+  intptr_t start_external_memory_;
+
   // Incremental marking steps counters.
   int steps_count_;
   double steps_took_;
   double longest_step_;
   int steps_count_since_last_gc_;
   double steps_took_since_last_gc_;
+  int capped_steps_count_;
+  intptr_t marking_speed_;
 
   Heap* heap_;
 
@@ -1662,6 +1662,275 @@ void HStackCheckEliminator::Process() {
 }
 
 
+// Tracks the values of named fields through the graph.  A load of a field
+// whose value is known, because it was stored or loaded before with no
+// intervening side effect on that field, is replaced by that value.  A store
+// that is overwritten in the same block before anything can observe it is
+// removed.  Fields are identified by object and offset like in the loads and
+// stores, and since two different objects may be the same at runtime, a
+// store to a field forgets that field for all other objects.
+class HLoadStoreEliminator BASE_EMBEDDED {
+ public:
+  explicit HLoadStoreEliminator(HGraph* graph)
+      : graph_(graph),
+        block_states_(graph->blocks()->length(), graph->zone()),
+        unobserved_stores_(4, graph->zone()) {
+    block_states_.AddBlock(NULL, graph->blocks()->length(), graph->zone());
+  }
+
+  void Process();
+
+ private:
+  struct FieldValue {
+    HValue* object;
+    bool is_in_object;
+    int offset;
+    HValue* value;
+  };
+  typedef ZoneList<FieldValue> FieldState;
+
+  // Bounds the work done for each instruction.
+  static const int kMaxTrackedFields = 16;
+
+  FieldState* ComputeEntryState(HBasicBlock* block);
+  void ProcessBlock(HBasicBlock* block, FieldState* state);
+  void ProcessStore(HStoreNamedField* store, FieldState* state);
+
+  static void KillLoopEffects(HLoopInformation* loop, FieldState* state);
+  static void KillEffects(HInstruction* instr, FieldState* state);
+  static void KillField(FieldState* state, bool is_in_object, int offset);
+  static void KillAll(FieldState* state, bool is_in_object);
+  static HValue* LookupField(FieldState* state,
+                             HValue* object,
+                             bool is_in_object,
+                             int offset);
+  static bool ContainsField(FieldState* state, const FieldValue& field);
+  void RecordField(FieldState* state,
+                   HValue* object,
+                   bool is_in_object,
+                   int offset,
+                   HValue* value);
+
+  Zone* zone() const { return graph_->zone(); }
+
+  HGraph* graph_;
+
+  // A map of block IDs to the known field values at the end of the block.
+  ZoneList<FieldState*> block_states_;
+
+  // Stores in the current block that nothing has observed yet.
+  ZoneList<HStoreNamedField*> unobserved_stores_;
+};
+
+
+void HLoadStoreEliminator::Process() {
+  HPhase phase("H_Load store elimination", graph_);
+  // Blocks are in reverse post order, so all forward predecessors of a
+  // block have been processed before it.
+  for (int i = 0; i < graph_->blocks()->length(); i++) {
+    HBasicBlock* block = graph_->blocks()->at(i);
+    FieldState* state = ComputeEntryState(block);
+    ProcessBlock(block, state);
+    block_states_[block->block_id()] = state;
+  }
+}
+
+
+HLoadStoreEliminator::FieldState* HLoadStoreEliminator::ComputeEntryState(
+    HBasicBlock* block) {
+  const ZoneList<HBasicBlock*>* predecessors = block->predecessors();
+  FieldState* state = NULL;
+  for (int i = 0; i < predecessors->length(); i++) {
+    HBasicBlock* predecessor = predecessors->at(i);
+    // Back edges are accounted for by the loop effects below.
+    if (predecessor->block_id() >= block->block_id()) continue;
+    FieldState* incoming = block_states_[predecessor->block_id()];
+    if (incoming == NULL) return new(zone()) FieldState(0, zone());
+    if (state == NULL) {
+      state = new(zone()) FieldState(incoming->length(), zone());
+      state->AddAll(*incoming, zone());
+    } else {
+      // Keep only the field values that are the same on all incoming edges.
+      int kept = 0;
+      for (int j = 0; j < state->length(); j++) {
+        if (ContainsField(incoming, state->at(j))) {
+          state->at(kept++) = state->at(j);
+        }
+      }
+      state->Rewind(kept);
+    }
+  }
+  if (state == NULL) return new(zone()) FieldState(0, zone());
+  if (block->IsLoopHeader()) {
+    KillLoopEffects(block->loop_information(), state);
+  }
+  return state;
+}
+
+
+void HLoadStoreEliminator::ProcessBlock(HBasicBlock* block,
+                                        FieldState* state) {
+  unobserved_stores_.Rewind(0);
+  HInstruction* instr = block->first();
+  while (instr != NULL) {
+    HInstruction* next = instr->next();
+    if (instr->IsLoadNamedField()) {
+      HLoadNamedField* load = HLoadNamedField::cast(instr);
+      HValue* value = LookupField(state,
+                                  load->object(),
+                                  load->is_in_object(),
+                                  load->offset());
+      if (value != NULL) {
+        if (FLAG_trace_load_store_elimination) {
+          PrintF("[load store elimination: replacing load %d with %d]\n",
+                 load->id(), value->id());
+        }
+        graph_->isolate()->counters()->hydrogen_loads_eliminated()->
+            Increment();
+        load->DeleteAndReplaceWith(value);
+      } else {
+        unobserved_stores_.Rewind(0);
+        RecordField(state,
+                    load->object(),
+                    load->is_in_object(),
+                    load->offset(),
+                    load);
+      }
+    } else if (instr->IsStoreNamedField()) {
+      ProcessStore(HStoreNamedField::cast(instr), state);
+    } else {
+      // Only instructions that emit no code may sit between two stores that
+      // are folded, so that no deoptimization can observe the difference.
+      if (!instr->IsSimulate() && !instr->IsConstant()) {
+        unobserved_stores_.Rewind(0);
+      }
+      KillEffects(instr, state);
+    }
+    instr = next;
+  }
+}
+
+
+void HLoadStoreEliminator::ProcessStore(HStoreNamedField* store,
+                                        FieldState* state) {
+  for (int i = 0; i < unobserved_stores_.length(); i++) {
+    HStoreNamedField* previous = unobserved_stores_[i];
+    if (previous->object() == store->object() &&
+        previous->is_in_object() == store->is_in_object() &&
+        previous->offset() == store->offset()) {
+      if (FLAG_trace_load_store_elimination) {
+        PrintF("[load store elimination: removing store %d before %d]\n",
+               previous->id(), store->id());
+      }
+      graph_->isolate()->counters()->hydrogen_stores_eliminated()->
+          Increment();
+      previous->DeleteAndReplaceWith(NULL);
+      unobserved_stores_.Remove(i);
+      break;
+    }
+  }
+  // Stores that transition the map also change the map, which must stay.
+  if (store->transition().is_null()) unobserved_stores_.Add(store, zone());
+  KillEffects(store, state);
+  RecordField(state,
+              store->object(),
+              store->is_in_object(),
+              store->offset(),
+              store->value());
+}
+
+
+void HLoadStoreEliminator::KillLoopEffects(HLoopInformation* loop,
+                                           FieldState* state) {
+  const ZoneList<HBasicBlock*>* blocks = loop->blocks();
+  for (int i = 0; i < blocks->length() && !state->is_empty(); i++) {
+    HInstruction* instr = blocks->at(i)->first();
+    while (instr != NULL) {
+      KillEffects(instr, state);
+      instr = instr->next();
+    }
+  }
+}
+
+
+void HLoadStoreEliminator::KillEffects(HInstruction* instr,
+                                       FieldState* state) {
+  GVNFlagSet changes = instr->ChangesFlags();
+  if (changes.Contains(kChangesMaps)) {
+    // Field offsets are only meaningful for a given map.
+    state->Rewind(0);
+  } else if (instr->IsStoreNamedField()) {
+    HStoreNamedField* store = HStoreNamedField::cast(instr);
+    KillField(state, store->is_in_object(), store->offset());
+  } else {
+    if (changes.Contains(kChangesInobjectFields)) KillAll(state, true);
+    if (changes.Contains(kChangesBackingStoreFields)) KillAll(state, false);
+  }
+}
+
+
+void HLoadStoreEliminator::KillField(FieldState* state,
+                                     bool is_in_object,
+                                     int offset) {
+  int kept = 0;
+  for (int i = 0; i < state->length(); i++) {
+    FieldValue field = state->at(i);
+    if (field.is_in_object != is_in_object || field.offset != offset) {
+      state->at(kept++) = field;
+    }
+  }
+  state->Rewind(kept);
+}
+
+
+void HLoadStoreEliminator::KillAll(FieldState* state, bool is_in_object) {
+  int kept = 0;
+  for (int i = 0; i < state->length(); i++) {
+    FieldValue field = state->at(i);
+    if (field.is_in_object != is_in_object) state->at(kept++) = field;
+  }
+  state->Rewind(kept);
+}
+
+
+HValue* HLoadStoreEliminator::LookupField(FieldState* state,
+                                          HValue* object,
+                                          bool is_in_object,
+                                          int offset) {
+  for (int i = 0; i < state->length(); i++) {
+    FieldValue field = state->at(i);
+    if (field.object == object &&
+        field.is_in_object == is_in_object &&
+        field.offset == offset) {
+      return field.value;
+    }
+  }
+  return NULL;
+}
+
+
+bool HLoadStoreEliminator::ContainsField(FieldState* state,
+                                         const FieldValue& field) {
+  HValue* value = LookupField(state,
+                              field.object,
+                              field.is_in_object,
+                              field.offset);
+  return value == field.value;
+}
+
+
+void HLoadStoreEliminator::RecordField(FieldState* state,
+                                       HValue* object,
+                                       bool is_in_object,
+                                       int offset,
+                                       HValue* value) {
+  ASSERT(LookupField(state, object, is_in_object, offset) == NULL);
+  if (state->length() == kMaxTrackedFields) state->Remove(0);
+  FieldValue field = { object, is_in_object, offset, value };
+  state->Add(field, zone());
+}
+
+
 // Simple sparse set with O(1) add, contains, and clear.
 class SparseSet {
  public:
@@ -3136,6 +3405,11 @@ bool HGraph::Optimize(SmartArrayPointer<char>* bailout_reason) {
     }
   }
 
+  if (FLAG_use_load_store_elimination) {
+    HLoadStoreEliminator lse(this);
+    lse.Process();
+  }
+
   if (FLAG_use_range) {
     HRangeAnalysis rangeAnalysis(this);
     rangeAnalysis.Analyze();
@@ -4646,6 +4920,19 @@ void HGraphBuilder::VisitRegExpLiteral(RegExpLiteral* expr) {
 }
 
 
+// Determines whether the literals array entry may be copied inline.  Copies
+// of an allocation site that decided to tenure are made by the runtime, which
+// allocates them in old space.  Shallow literals of sites that did not decide
+// yet go through the cloning stubs, which leave a sample of the copies to the
+// runtime to collect feedback.  Nested literals would otherwise always be
+// copied by the runtime, so they are copied inline without tracking.
+static bool CanCopyLiteralInline(Object* literal, int depth) {
+  if (!literal->IsAllocationSite()) return true;
+  return AllocationSite::cast(literal)->pretenure_decision() !=
+      AllocationSite::kTenure && depth > 1;
+}
+
+
 // Determines whether the given array or object literal boilerplate satisfies
 // all limits to be considered for fast deep-copying and computes the total
 // size of all objects that are part of the graph.
@@ -4720,7 +5007,13 @@ void HGraphBuilder::VisitObjectLiteral(ObjectLiteral* expr) {
   int total_size = 0;
   int max_properties = HFastLiteral::kMaxLiteralProperties;
   Handle<Object> boilerplate(closure->literals()->get(expr->literal_index()));
-  if (boilerplate->IsJSObject() &&
+  bool copy_inline = CanCopyLiteralInline(*boilerplate, expr->depth());
+  if (boilerplate->IsAllocationSite()) {
+    boilerplate = Handle<Object>(
+        AllocationSite::cast(*boilerplate)->boilerplate());
+  }
+  if (copy_inline &&
+      boilerplate->IsJSObject() &&
       IsFastLiteral(Handle<JSObject>::cast(boilerplate),
                     HFastLiteral::kMaxLiteralDepth,
                     &max_properties,
@@ -4817,13 +5110,26 @@ void HGraphBuilder::VisitArrayLiteral(ArrayLiteral* expr) {
     if (raw_boilerplate.is_null()) {
       return Bailout("array boilerplate creation failed");
     }
-    literals->set(expr->literal_index(), *raw_boilerplate);
+    if (FLAG_allocation_site_pretenuring) {
+      literals->set(expr->literal_index(),
+                    *isolate()->factory()->NewAllocationSite(
+                        Handle<JSObject>::cast(raw_boilerplate)));
+    } else {
+      literals->set(expr->literal_index(), *raw_boilerplate);
+    }
     if (JSObject::cast(*raw_boilerplate)->elements()->map() ==
         isolate()->heap()->fixed_cow_array_map()) {
       isolate()->counters()->cow_arrays_created_runtime()->Increment();
     }
   }
 
+  bool copy_inline =
+      CanCopyLiteralInline(literals->get(expr->literal_index()), expr->depth());
+  if (raw_boilerplate->IsAllocationSite()) {
+    raw_boilerplate = Handle<Object>(
+        AllocationSite::cast(*raw_boilerplate)->boilerplate());
+  }
+
   Handle<JSObject> boilerplate = Handle<JSObject>::cast(raw_boilerplate);
   ElementsKind boilerplate_elements_kind =
         Handle<JSObject>::cast(boilerplate)->GetElementsKind();
@@ -4831,7 +5137,8 @@ void HGraphBuilder::VisitArrayLiteral(ArrayLiteral* expr) {
   // Check whether to use fast or slow deep-copying for boilerplate.
   int total_size = 0;
   int max_properties = HFastLiteral::kMaxLiteralProperties;
-  if (IsFastLiteral(boilerplate,
+  if (copy_inline &&
+      IsFastLiteral(boilerplate,
                     HFastLiteral::kMaxLiteralDepth,
                     &max_properties,
                     &total_size)) {
@@ -307,16 +307,75 @@ void FastNewBlockContextStub::Generate(MacroAssembler* masm) {
 }
 
 
+// Replaces an allocation site in boilerplate by the boilerplate it tracks.
+// Sites are copied here without tracking, except for every n-th copy, which
+// the runtime tracks.  Copies of a site that decided to tenure continue at
+// tenured.
+static void GenerateLoadSiteBoilerplate(MacroAssembler* masm,
+                                        Register boilerplate,
+                                        Register scratch,
+                                        Label* slow_case,
+                                        Label* tenured) {
+  Label done;
+  __ CompareRoot(FieldOperand(boilerplate, HeapObject::kMapOffset),
+                 Heap::kAllocationSiteMapRootIndex);
+  __ j(not_equal, &done);
+  __ add(FieldOperand(boilerplate, AllocationSite::kCopyCountOffset),
+         Immediate(Smi::FromInt(1)));
+  __ cmp(FieldOperand(boilerplate, AllocationSite::kCopyCountOffset),
+         Immediate(Smi::FromInt(AllocationSite::kStubSampleInterval)));
+  __ j(greater_equal, slow_case);
+  __ mov(scratch,
+         FieldOperand(boilerplate, AllocationSite::kPretenureDecisionOffset));
+  __ mov(boilerplate,
+         FieldOperand(boilerplate, AllocationSite::kBoilerplateOffset));
+  __ cmp(scratch, Immediate(Smi::FromInt(AllocationSite::kTenure)));
+  __ j(equal, tenured);
+  __ bind(&done);
+}
+
+
+// Enters the fields of object between start_offset and end_offset that
+// point to new space into the store buffer.  Used for copies allocated in
+// old space, which are filled without a write barrier.
+static void GenerateRecordNewSpaceFields(MacroAssembler* masm,
+                                         Register object,
+                                         int start_offset,
+                                         int end_offset,
+                                         Register value,
+                                         Register address) {
+  for (int i = start_offset; i < end_offset; i += kPointerSize) {
+    Label skip;
+    __ mov(value, FieldOperand(object, i));
+    __ JumpIfSmi(value, &skip);
+    __ JumpIfNotInNewSpace(value, address, &skip);
+    __ lea(address, FieldOperand(object, i));
+    __ RememberedSetHelper(object, address, value, kDontSaveFPRegs,
+                           MacroAssembler::kFallThroughAtEnd);
+    __ bind(&skip);
+  }
+}
+
+
 static void GenerateFastCloneShallowArrayCommon(
     MacroAssembler* masm,
     int length,
     FastCloneShallowArrayStub::Mode mode,
+    PretenureFlag pretenure,
     Label* fail) {
   // Registers on entry:
   //
   // ecx: boilerplate literal array.
   ASSERT(mode != FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS);
 
+  // Double arrays belong in old data space, leave them to the runtime.
+  if (pretenure == TENURED &&
+      mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS &&
+      length > 0) {
+    __ jmp(fail);
+    return;
+  }
+
   // All sizes here are multiples of kPointerSize.
   int elements_size = 0;
   if (length > 0) {
@@ -328,7 +387,11 @@ static void GenerateFastCloneShallowArrayCommon(
 
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
-  __ AllocateInNewSpace(size, eax, ebx, edx, fail, TAG_OBJECT);
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
+  __ AllocateInNewSpace(size, eax, ebx, edx, fail, flags);
 
   // Copy the JS array part.
   for (int i = 0; i < JSArray::kSize; i += kPointerSize) {
@@ -366,64 +429,60 @@ static void GenerateFastCloneShallowArrayCommon(
       ASSERT(i == elements_size);
     }
   }
-}
-
 
-void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
-  // Stack layout on entry:
-  //
-  // [esp + kPointerSize]: constant elements.
-  // [esp + (2 * kPointerSize)]: literal index.
-  // [esp + (3 * kPointerSize)]: literals array.
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, eax, JSObject::kPropertiesOffset,
+                                 JSArray::kSize, ebx, ecx);
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
+      __ lea(edx, Operand(eax, JSArray::kSize));
+      GenerateRecordNewSpaceFields(masm, edx, FixedArray::kHeaderSize,
+                                   elements_size, ebx, ecx);
+    }
+  }
+}
 
-  // Load boilerplate object into ecx and check if we need to create a
-  // boilerplate.
-  __ mov(ecx, Operand(esp, 3 * kPointerSize));
-  __ mov(eax, Operand(esp, 2 * kPointerSize));
-  STATIC_ASSERT(kPointerSize == 4);
-  STATIC_ASSERT(kSmiTagSize == 1);
-  STATIC_ASSERT(kSmiTag == 0);
-  __ mov(ecx, FieldOperand(ecx, eax, times_half_pointer_size,
-                           FixedArray::kHeaderSize));
-  Factory* factory = masm->isolate()->factory();
-  __ cmp(ecx, factory->undefined_value());
-  Label slow_case;
-  __ j(equal, &slow_case);
 
-  FastCloneShallowArrayStub::Mode mode = mode_;
+static void GenerateFastCloneShallowArray(MacroAssembler* masm,
+                                          int length,
+                                          FastCloneShallowArrayStub::Mode mode,
+                                          PretenureFlag pretenure,
+                                          Label* fail) {
   // ecx is boilerplate object.
-  if (mode == CLONE_ANY_ELEMENTS) {
+  Factory* factory = masm->isolate()->factory();
+  if (mode == FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS) {
     Label double_elements, check_fast_elements;
     __ mov(ebx, FieldOperand(ecx, JSArray::kElementsOffset));
     __ CheckMap(ebx, factory->fixed_cow_array_map(),
                 &check_fast_elements, DONT_DO_SMI_CHECK);
-    GenerateFastCloneShallowArrayCommon(masm, 0,
-                                        COPY_ON_WRITE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, 0, FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS, pretenure,
+        fail);
     __ ret(3 * kPointerSize);
 
     __ bind(&check_fast_elements);
     __ CheckMap(ebx, factory->fixed_array_map(),
                 &double_elements, DONT_DO_SMI_CHECK);
-    GenerateFastCloneShallowArrayCommon(masm, length_,
-                                        CLONE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, length, FastCloneShallowArrayStub::CLONE_ELEMENTS, pretenure,
+        fail);
     __ ret(3 * kPointerSize);
 
     __ bind(&double_elements);
-    mode = CLONE_DOUBLE_ELEMENTS;
+    mode = FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS;
     // Fall through to generate the code to handle double elements.
   }
 
   if (FLAG_debug_code) {
     const char* message;
     Handle<Map> expected_map;
-    if (mode == CLONE_ELEMENTS) {
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
       message = "Expected (writable) fixed array";
       expected_map = factory->fixed_array_map();
-    } else if (mode == CLONE_DOUBLE_ELEMENTS) {
+    } else if (mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS) {
       message = "Expected (writable) fixed double array";
       expected_map = factory->fixed_double_array_map();
     } else {
-      ASSERT(mode == COPY_ON_WRITE_ELEMENTS);
+      ASSERT(mode == FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS);
       message = "Expected copy-on-write fixed array";
       expected_map = factory->fixed_cow_array_map();
     }
@@ -434,28 +493,23 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
     __ pop(ecx);
   }
 
-  GenerateFastCloneShallowArrayCommon(masm, length_, mode, &slow_case);
+  GenerateFastCloneShallowArrayCommon(masm, length, mode, pretenure, fail);
   // Return and remove the on-stack parameters.
   __ ret(3 * kPointerSize);
-
-  __ bind(&slow_case);
-  __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
 }
 
 
-void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
+void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
   // Stack layout on entry:
   //
-  // [esp + kPointerSize]: object literal flags.
-  // [esp + (2 * kPointerSize)]: constant properties.
-  // [esp + (3 * kPointerSize)]: literal index.
-  // [esp + (4 * kPointerSize)]: literals array.
+  // [esp + kPointerSize]: constant elements.
+  // [esp + (2 * kPointerSize)]: literal index.
+  // [esp + (3 * kPointerSize)]: literals array.
 
   // Load boilerplate object into ecx and check if we need to create a
   // boilerplate.
-  Label slow_case;
-  __ mov(ecx, Operand(esp, 4 * kPointerSize));
-  __ mov(eax, Operand(esp, 3 * kPointerSize));
+  __ mov(ecx, Operand(esp, 3 * kPointerSize));
+  __ mov(eax, Operand(esp, 2 * kPointerSize));
   STATIC_ASSERT(kPointerSize == 4);
   STATIC_ASSERT(kSmiTagSize == 1);
   STATIC_ASSERT(kSmiTag == 0);
@@ -463,26 +517,88 @@ void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
                            FixedArray::kHeaderSize));
   Factory* factory = masm->isolate()->factory();
   __ cmp(ecx, factory->undefined_value());
+  Label slow_case, tenured;
   __ j(equal, &slow_case);
+  GenerateLoadSiteBoilerplate(
+      masm, ecx, ebx, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  GenerateFastCloneShallowArray(masm, length_, mode_, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowArray(masm, length_, mode_, TENURED, &slow_case);
+  }
+
+  __ bind(&slow_case);
+  __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
+}
+
+
+static void GenerateFastCloneShallowObject(MacroAssembler* masm,
+                                           int size,
+                                           PretenureFlag pretenure,
+                                           Label* fail) {
+  // ecx is boilerplate object.
 
   // Check that the boilerplate contains only fast properties and we can
   // statically determine the instance size.
-  int size = JSObject::kHeaderSize + length_ * kPointerSize;
   __ mov(eax, FieldOperand(ecx, HeapObject::kMapOffset));
   __ movzx_b(eax, FieldOperand(eax, Map::kInstanceSizeOffset));
   __ cmp(eax, Immediate(size >> kPointerSizeLog2));
-  __ j(not_equal, &slow_case);
+  __ j(not_equal, fail);
 
   // Allocate the JS object and copy header together with all in-object
   // properties from the boilerplate.
-  __ AllocateInNewSpace(size, eax, ebx, edx, &slow_case, TAG_OBJECT);
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
+  __ AllocateInNewSpace(size, eax, ebx, edx, fail, flags);
   for (int i = 0; i < size; i += kPointerSize) {
     __ mov(ebx, FieldOperand(ecx, i));
     __ mov(FieldOperand(eax, i), ebx);
   }
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, eax, JSObject::kPropertiesOffset, size,
+                                 ebx, ecx);
+  }
 
   // Return and remove the on-stack parameters.
   __ ret(4 * kPointerSize);
+}
+
+
+void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
+  // Stack layout on entry:
+  //
+  // [esp + kPointerSize]: object literal flags.
+  // [esp + (2 * kPointerSize)]: constant properties.
+  // [esp + (3 * kPointerSize)]: literal index.
+  // [esp + (4 * kPointerSize)]: literals array.
+
+  // Load boilerplate object into ecx and check if we need to create a
+  // boilerplate.
+  Label slow_case, tenured;
+  __ mov(ecx, Operand(esp, 4 * kPointerSize));
+  __ mov(eax, Operand(esp, 3 * kPointerSize));
+  STATIC_ASSERT(kPointerSize == 4);
+  STATIC_ASSERT(kSmiTagSize == 1);
+  STATIC_ASSERT(kSmiTag == 0);
+  __ mov(ecx, FieldOperand(ecx, eax, times_half_pointer_size,
+                           FixedArray::kHeaderSize));
+  Factory* factory = masm->isolate()->factory();
+  __ cmp(ecx, factory->undefined_value());
+  __ j(equal, &slow_case);
+  GenerateLoadSiteBoilerplate(
+      masm, ecx, ebx, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  int size = JSObject::kHeaderSize + length_ * kPointerSize;
+  GenerateFastCloneShallowObject(masm, size, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowObject(masm, size, TENURED, &slow_case);
+  }
 
   __ bind(&slow_case);
   __ TailCallRuntime(Runtime::kCreateObjectLiteralShallow, 4, 1);
@@ -6154,7 +6270,7 @@ void StringHelper::GenerateHashInit(MacroAssembler* masm,
                                     Register character,
                                     Register scratch) {
   // hash = (seed + character) + ((seed + character) << 10);
-  if (Serializer::enabled()) {
+  if (Serializer::enabled(masm->isolate())) {
     ExternalReference roots_array_start =
         ExternalReference::roots_array_start(masm->isolate());
     __ mov(scratch, Immediate(Heap::kHashSeedRootIndex));
@@ -53,7 +53,13 @@ IncrementalMarking::IncrementalMarking(Heap* heap)
       should_hurry_(false),
       allocation_marking_factor_(0),
       allocated_(0),
-      no_marking_scope_depth_(0) {
+      no_marking_scope_depth_(0),
+      allocated_during_marking_(0),
+      capped_steps_count_(0),
+      last_promotion_ratio_(1.0),
+      marking_speed_in_bytes_per_ms_(kInitialMarkingSpeedInBytesPerMs),
+      marking_speed_sample_bytes_(0),
+      marking_speed_sample_ms_(0) {
 }
 
 
@@ -405,10 +411,12 @@ bool IncrementalMarking::WorthActivating() {
   static const intptr_t kActivationThreshold = 0;
 #endif
 
+  // External memory held by the heap is freed by the same collection, so it
+  // counts towards the threshold.
   return !FLAG_expose_gc &&
       FLAG_incremental_marking &&
       !Serializer::enabled() &&
-      heap_->PromotedSpaceSizeOfObjects() > kActivationThreshold;
+      heap_->PromotedTotalSize() > kActivationThreshold;
 }
 
 
@@ -752,6 +760,7 @@ void IncrementalMarking::Abort() {
 
 
 void IncrementalMarking::Finalize() {
+  if (allocated_during_marking_ > 0) last_promotion_ratio_ = PromotionRatio();
   Hurry();
   state_ = STOPPED;
   is_compacting_ = false;
@@ -783,40 +792,20 @@ void IncrementalMarking::MarkingComplete(CompletionAction action) {
 }
 
 
-void IncrementalMarking::Step(intptr_t allocated_bytes,
-                              CompletionAction action) {
-  if (heap_->gc_state() != Heap::NOT_IN_GC ||
-      !FLAG_incremental_marking ||
-      !FLAG_incremental_marking_steps ||
-      (state_ != SWEEPING && state_ != MARKING)) {
-    return;
-  }
-
-  allocated_ += allocated_bytes;
-
-  if (allocated_ < kAllocatedThreshold) return;
-
-  if (state_ == MARKING && no_marking_scope_depth_ > 0) return;
-
-  intptr_t bytes_to_process = allocated_ * allocation_marking_factor_;
-  bytes_scanned_ += bytes_to_process;
-
-  double start = 0;
-
-  if (FLAG_trace_incremental_marking || FLAG_trace_gc) {
-    start = OS::TimeCurrentMillis();
-  }
-
+void IncrementalMarking::Advance(intptr_t bytes_to_process,
+                                 CompletionAction action) {
   if (state_ == SWEEPING) {
     if (heap_->AdvanceSweepers(static_cast<int>(bytes_to_process))) {
       bytes_scanned_ = 0;
       StartMarking(PREVENT_COMPACTION);
     }
   } else if (state_ == MARKING) {
+    double start = OS::TimeCurrentMillis();
+    intptr_t bytes_left = bytes_to_process;
     Map* filler_map = heap_->one_pointer_filler_map();
     Map* global_context_map = heap_->global_context_map();
     IncrementalMarkingMarkingVisitor marking_visitor(heap_, this);
-    while (!marking_deque_.IsEmpty() && bytes_to_process > 0) {
+    while (!marking_deque_.IsEmpty() && bytes_left > 0) {
       HeapObject* obj = marking_deque_.Pop();
 
       // Explicitly skip one word fillers. Incremental markbit patterns are
@@ -825,7 +814,7 @@ void IncrementalMarking::Step(intptr_t allocated_bytes,
       if (map == filler_map) continue;
 
       int size = obj->SizeFromMap(map);
-      bytes_to_process -= size;
+      bytes_left -= size;
       MarkBit map_mark_bit = Marking::MarkBitFrom(map);
       if (Marking::IsWhite(map_mark_bit)) {
         WhiteToGreyAndPush(map, map_mark_bit);
@@ -880,14 +869,180 @@ void IncrementalMarking::Step(intptr_t allocated_bytes,
       Marking::MarkBlack(obj_mark_bit);
       MemoryChunk::IncrementLiveBytesFromGC(obj->address(), size);
     }
+    UpdateMarkingSpeed(bytes_to_process - bytes_left,
+                       OS::TimeCurrentMillis() - start);
     if (marking_deque_.IsEmpty()) MarkingComplete(action);
   }
 
+}
+
+
+void IncrementalMarking::IdleStep(intptr_t bytes_to_process) {
+  if (heap_->gc_state() != Heap::NOT_IN_GC ||
+      !FLAG_incremental_marking ||
+      (state_ != SWEEPING && state_ != MARKING)) {
+    return;
+  }
+
+  if (state_ == MARKING && no_marking_scope_depth_ > 0) return;
+
+  bytes_scanned_ += bytes_to_process;
+  Advance(bytes_to_process, NO_GC_VIA_STACK_GUARD);
+  steps_count_++;
+  steps_count_since_last_gc_++;
+}
+
+
+void IncrementalMarking::UpdateMarkingSpeed(intptr_t bytes_marked,
+                                            double duration_in_ms) {
+  // Single steps are too short to be timed reliably, so the speed is only
+  // updated once enough of them have been accumulated.
+  marking_speed_sample_bytes_ += bytes_marked;
+  marking_speed_sample_ms_ += duration_in_ms;
+  if (marking_speed_sample_ms_ < kMarkingSpeedSampleInMs) return;
+  intptr_t sample_speed = static_cast<intptr_t>(
+      marking_speed_sample_bytes_ / marking_speed_sample_ms_);
+  marking_speed_in_bytes_per_ms_ =
+      Max(static_cast<intptr_t>(1),
+          (marking_speed_in_bytes_per_ms_ + sample_speed) / 2);
+  marking_speed_sample_bytes_ = 0;
+  marking_speed_sample_ms_ = 0;
+}
+
+
+void IncrementalMarking::Step(intptr_t allocated_bytes,
+                              CompletionAction action) {
+  if (heap_->gc_state() != Heap::NOT_IN_GC ||
+      !FLAG_incremental_marking ||
+      !FLAG_incremental_marking_steps ||
+      (state_ != SWEEPING && state_ != MARKING)) {
+    return;
+  }
+
+  allocated_ += allocated_bytes;
+
+  if (allocated_ < kAllocatedThreshold) return;
+
+  if (state_ == MARKING && no_marking_scope_depth_ > 0) return;
+
+  allocated_during_marking_ += allocated_;
+  intptr_t bytes_to_process = FLAG_gc_target_pause_ms > 0
+      ? ScheduledStepSize()
+      : allocated_ * allocation_marking_factor_;
+  bytes_scanned_ += bytes_to_process;
+
+  double start = 0;
+
+  if (FLAG_trace_incremental_marking || FLAG_trace_gc) {
+    start = OS::TimeCurrentMillis();
+  }
+
+  Advance(bytes_to_process, action);
+
   allocated_ = 0;
 
   steps_count_++;
   steps_count_since_last_gc_++;
 
+  if (FLAG_gc_target_pause_ms == 0) SpeedUpIfNeeded();
+
+  if (FLAG_trace_incremental_marking || FLAG_trace_gc) {
+    double end = OS::TimeCurrentMillis();
+    double delta = (end - start);
+    longest_step_ = Max(longest_step_, delta);
+    steps_took_ += delta;
+    steps_took_since_last_gc_ += delta;
+  }
+}
+
+
+intptr_t IncrementalMarking::ScheduledStepSize() {
+  // Marking is going around in circles, see BlackToGreyAndUnshift, and has
+  // to finish regardless of the pause target.
+  if (allocation_marking_factor_ == kMaxAllocationMarkingFactor) {
+    return allocated_ * allocation_marking_factor_;
+  }
+
+  // Marking has to keep up with the allocation at least.
+  intptr_t bytes_to_process = allocated_;
+  if (state_ == MARKING) {
+    // Spread the marking work that is left over the bytes the mutator can
+    // allocate before the old generation limit forces a full collection.
+    double remaining_work = static_cast<double>(Max(
+        static_cast<intptr_t>(0),
+        heap_->PromotedSpaceSizeOfObjects() - bytes_scanned_));
+    double allocation_left =
+        Max(kAllocatedThreshold, heap_->OldGenerationSpaceAvailable()) /
+        PromotionRatio();
+    bytes_to_process = Max(bytes_to_process, static_cast<intptr_t>(
+        allocated_ * remaining_work / allocation_left));
+  }
+
+  intptr_t max_step_size =
+      marking_speed_in_bytes_per_ms_ * FLAG_gc_target_pause_ms;
+  bool capped = bytes_to_process > max_step_size;
+  if (capped) {
+    bytes_to_process = max_step_size;
+    capped_steps_count_++;
+  }
+
+  if (FLAG_trace_incremental_marking && FLAG_trace_gc_nvp) {
+    PrintPID("incremental_step=%d allocated=%" V8_PTR_PREFIX "d "
+             "step_size=%" V8_PTR_PREFIX "d "
+             "marking_speed=%" V8_PTR_PREFIX "d "
+             "old_gen_available=%" V8_PTR_PREFIX "d capped=%d\n",
+             steps_count_,
+             allocated_,
+             bytes_to_process,
+             marking_speed_in_bytes_per_ms_,
+             heap_->OldGenerationSpaceAvailable(),
+             capped ? 1 : 0);
+  }
+  return bytes_to_process;
+}
+
+
+double IncrementalMarking::PromotionRatio() {
+  if (allocated_during_marking_ == 0) return last_promotion_ratio_;
+  double promoted = static_cast<double>(
+      heap_->PromotedTotalSize() -
+      old_generation_space_used_at_start_of_incremental_);
+  // Keep the ratio away from zero, promotion may pick up any time.
+  return Max(0.01, Min(1.0, promoted / allocated_during_marking_));
+}
+
+
+bool IncrementalMarking::ShouldStartForPauseTarget() {
+  if (FLAG_gc_target_pause_ms == 0) return false;
+  // With steps of the target size after every kAllocatedThreshold bytes
+  // allocated, marking the old generation takes this much allocation, of
+  // which the promoted part has to fit below the old generation limit.
+  intptr_t max_step_size = Max(static_cast<intptr_t>(1),
+      marking_speed_in_bytes_per_ms_ * FLAG_gc_target_pause_ms);
+  intptr_t work = heap_->PromotedSpaceSizeOfObjects();
+  double allocation_needed =
+      static_cast<double>(work / max_step_size + 1) * kAllocatedThreshold;
+  intptr_t promotion_needed =
+      static_cast<intptr_t>(allocation_needed * last_promotion_ratio_);
+  // Leave room for the scavenges that promote in bursts.
+  promotion_needed += heap_->new_space()->Capacity();
+  bool start = heap_->OldGenerationSpaceAvailable() < promotion_needed;
+
+  if (start && FLAG_trace_gc_nvp) {
+    PrintPID("incremental_start=1 work=%" V8_PTR_PREFIX "d "
+             "marking_speed=%" V8_PTR_PREFIX "d "
+             "promotion_needed=%" V8_PTR_PREFIX "d "
+             "old_gen_available=%" V8_PTR_PREFIX "d\n",
+             work,
+             marking_speed_in_bytes_per_ms_,
+             promotion_needed,
+             heap_->OldGenerationSpaceAvailable());
+  }
+  return start;
+}
+
+
+void IncrementalMarking::SpeedUpIfNeeded() {
   bool speed_up = false;
 
   if ((steps_count_ % kAllocationMarkingFactorSpeedupInterval) == 0) {
@@ -950,14 +1105,6 @@ void IncrementalMarking::Step(intptr_t allocated_bytes,
       }
     }
   }
-
-  if (FLAG_trace_incremental_marking || FLAG_trace_gc) {
-    double end = OS::TimeCurrentMillis();
-    double delta = (end - start);
-    longest_step_ = Max(longest_step_, delta);
-    steps_took_ += delta;
-    steps_took_since_last_gc_ += delta;
-  }
 }
 
 
@@ -974,6 +1121,8 @@ void IncrementalMarking::ResetStepCounters() {
   bytes_rescanned_ = 0;
   allocation_marking_factor_ = kInitialAllocationMarkingFactor;
   bytes_scanned_ = 0;
+  allocated_during_marking_ = 0;
+  capped_steps_count_ = 0;
 }
 
 
@@ -113,6 +113,24 @@ class IncrementalMarking {
 
   void Step(intptr_t allocated, CompletionAction action);
 
+  // Performs a step that processes the given number of bytes regardless of
+  // the allocation rate.  Used to fill idle time with marking work.
+  void IdleStep(intptr_t bytes_to_process);
+
+  // With a pause target, returns whether marking has to start now to finish
+  // before the old generation limit is reached with steps that stay within
+  // the target.
+  bool ShouldStartForPauseTarget();
+
+  // Marking speed assumed until the first steps have been measured.
+  static const intptr_t kInitialMarkingSpeedInBytesPerMs = 100 * KB;
+
+  // Running estimate of how many bytes a marking step processes per
+  // millisecond.
+  intptr_t marking_speed_in_bytes_per_ms() {
+    return marking_speed_in_bytes_per_ms_;
+  }
+
   inline void RestartIfNotMarking() {
     if (state_ == COMPLETE) {
       state_ = MARKING;
@@ -193,6 +211,13 @@ class IncrementalMarking {
     return steps_count_since_last_gc_;
   }
 
+  // Number of steps since the start of marking that marked less than needed
+  // to finish before the old generation limit, to stay within the pause
+  // target.
+  inline int capped_steps_count() {
+    return capped_steps_count_;
+  }
+
   inline double steps_took_since_last_gc() {
     return steps_took_since_last_gc_;
   }
@@ -239,6 +264,24 @@ class IncrementalMarking {
 
   void ResetStepCounters();
 
+  // Returns the number of bytes to mark in a step with a pause target, see
+  // --gc-target-pause-ms.
+  intptr_t ScheduledStepSize();
+
+  // Fraction of the bytes allocated during marking that were promoted.
+  double PromotionRatio();
+
+  // Adjusts the allocation marking factor when there is no pause target.
+  void SpeedUpIfNeeded();
+
+  void Advance(intptr_t bytes_to_process, CompletionAction action);
+
+  void UpdateMarkingSpeed(intptr_t bytes_marked, double duration_in_ms);
+
+  // Marking steps are accumulated until they took this long before the
+  // marking speed is updated.
+  static const int kMarkingSpeedSampleInMs = 1;
+
   enum CompactionFlag { ALLOW_COMPACTION, PREVENT_COMPACTION };
 
   void StartMarking(CompactionFlag flag);
@@ -286,6 +329,16 @@ class IncrementalMarking {
 
   int no_marking_scope_depth_;
 
+  // Bytes allocated since the start of marking.
+  intptr_t allocated_during_marking_;
+  int capped_steps_count_;
+  // Promotion ratio observed during the last marking.
+  double last_promotion_ratio_;
+
+  intptr_t marking_speed_in_bytes_per_ms_;
+  intptr_t marking_speed_sample_bytes_;
+  double marking_speed_sample_ms_;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(IncrementalMarking);
 };
 
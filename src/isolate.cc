@@ -1494,9 +1494,16 @@ Isolate::Isolate()
       date_cache_(NULL),
       context_exit_happened_(false),
       deferred_handles_head_(NULL),
-      optimizing_compiler_thread_(this) {
+      optimizing_compiler_thread_(this),
+      sweeper_thread_(NULL),
+      num_sweeper_threads_(0) {
   TRACE_ISOLATE(constructor);
 
+  for (int i = 0; i < GCHelperThread::kNumberOfTasks; i++) {
+    gc_helper_thread_[i] = NULL;
+    num_gc_helper_threads_[i] = 0;
+  }
+
   memset(isolate_addresses_, 0,
       sizeof(isolate_addresses_[0]) * (kIsolateAddressCount + 1));
 
@@ -1577,6 +1584,20 @@ void Isolate::Deinit() {
 
     if (FLAG_parallel_recompilation) optimizing_compiler_thread_.Stop();
 
+    if (sweeper_thread_ != NULL) {
+      for (int i = 0; i < num_sweeper_threads_; i++) {
+        sweeper_thread_[i]->Stop();
+        delete sweeper_thread_[i];
+      }
+      delete[] sweeper_thread_;
+      sweeper_thread_ = NULL;
+      num_sweeper_threads_ = 0;
+    }
+
+    for (int i = 0; i < GCHelperThread::kNumberOfTasks; i++) {
+      StopGCHelperThreads(static_cast<GCHelperThread::Task>(i));
+    }
+
     if (FLAG_hydrogen_stats) HStatistics::Instance()->Print();
 
     // We must stop the logger before we tear down other components.
@@ -1919,10 +1940,54 @@ bool Isolate::Init(Deserializer* des) {
   state_ = INITIALIZED;
   time_millis_at_init_ = OS::TimeCurrentMillis();
   if (FLAG_parallel_recompilation) optimizing_compiler_thread_.Start();
+
+  if (FLAG_concurrent_sweeping && FLAG_sweeper_threads > 0) {
+    num_sweeper_threads_ = FLAG_sweeper_threads;
+    sweeper_thread_ = new SweeperThread*[num_sweeper_threads_];
+    for (int i = 0; i < num_sweeper_threads_; i++) {
+      sweeper_thread_[i] = new SweeperThread(this);
+      sweeper_thread_[i]->Start();
+    }
+  }
+
+  if (FLAG_parallel_marking) {
+    StartGCHelperThreads(GCHelperThread::MARKING, FLAG_marking_threads);
+  }
+  if (FLAG_parallel_compaction) {
+    StartGCHelperThreads(GCHelperThread::COMPACTION, FLAG_compaction_threads);
+  }
+  if (FLAG_parallel_scavenge) {
+    StartGCHelperThreads(GCHelperThread::SCAVENGING, FLAG_scavenger_threads);
+  }
   return true;
 }
 
 
+void Isolate::StartGCHelperThreads(GCHelperThread::Task task, int count) {
+  ASSERT(gc_helper_thread_[task] == NULL);
+  if (count <= 0) return;
+  num_gc_helper_threads_[task] = count;
+  gc_helper_thread_[task] = new GCHelperThread*[count];
+  for (int i = 0; i < count; i++) {
+    // Worker 0 is the main thread.
+    gc_helper_thread_[task][i] = new GCHelperThread(this, task, i + 1);
+    gc_helper_thread_[task][i]->Start();
+  }
+}
+
+
+void Isolate::StopGCHelperThreads(GCHelperThread::Task task) {
+  if (gc_helper_thread_[task] == NULL) return;
+  for (int i = 0; i < num_gc_helper_threads_[task]; i++) {
+    gc_helper_thread_[task][i]->Stop();
+    delete gc_helper_thread_[task][i];
+  }
+  delete[] gc_helper_thread_[task];
+  gc_helper_thread_[task] = NULL;
+  num_gc_helper_threads_[task] = 0;
+}
+
+
 // Initialized lazily to allow early
 // v8::V8::SetAddHistogramSampleFunction calls.
 StatsTable* Isolate::stats_table() {
@@ -37,6 +37,7 @@
 #include "execution.h"
 #include "frames.h"
 #include "date.h"
+#include "gc-helper-thread.h"
 #include "global-handles.h"
 #include "handles.h"
 #include "hashmap.h"
@@ -45,6 +46,7 @@
 #include "regexp-stack.h"
 #include "runtime-profiler.h"
 #include "runtime.h"
+#include "sweeper-thread.h"
 #include "zone.h"
 
 namespace v8 {
@@ -346,6 +348,8 @@ typedef List<HeapObject*, PreallocatedStorageAllocationPolicy> DebugObjectCache;
   V(int*, irregexp_interpreter_backtrack_stack_cache, NULL)                    \
   /* Serializer state. */                                                      \
   V(ExternalReferenceTable*, external_reference_table, NULL)                   \
+  /* The code stubs of a code cache while code is generated for one. */        \
+  V(Object**, code_cache_stubs, NULL)                                          \
   /* AstNode state. */                                                         \
   V(int, ast_node_id, 0)                                                       \
   V(unsigned, ast_node_count, 0)                                               \
@@ -1064,6 +1068,24 @@ class Isolate {
     return &optimizing_compiler_thread_;
   }
 
+  // Helper threads for a parallel phase of garbage collection, NULL unless
+  // the phase is switched on by --parallel-marking, --parallel-compaction or
+  // --parallel-scavenge respectively.
+  GCHelperThread** gc_helper_threads(GCHelperThread::Task task) {
+    return gc_helper_thread_[task];
+  }
+
+  int num_gc_helper_threads(GCHelperThread::Task task) {
+    return num_gc_helper_threads_[task];
+  }
+
+  // Background sweeper threads, NULL unless --concurrent-sweeping is on.
+  SweeperThread** sweeper_threads() {
+    return sweeper_thread_;
+  }
+
+  int num_sweeper_threads() { return num_sweeper_threads_; }
+
  private:
   Isolate();
 
@@ -1166,6 +1188,10 @@ class Isolate {
   void PreallocatedMemoryThreadStop();
   void InitializeThreadLocal();
 
+  // Starts |count| helper threads for |task|, worker 0 being the main thread.
+  void StartGCHelperThreads(GCHelperThread::Task task, int count);
+  void StopGCHelperThreads(GCHelperThread::Task task);
+
   void PrintStackTrace(FILE* out, ThreadLocalTop* thread);
   void MarkCompactPrologue(bool is_compacting,
                            ThreadLocalTop* archived_thread_data);
@@ -1289,11 +1315,17 @@ class Isolate {
 
   DeferredHandles* deferred_handles_head_;
   OptimizingCompilerThread optimizing_compiler_thread_;
+  GCHelperThread** gc_helper_thread_[GCHelperThread::kNumberOfTasks];
+  int num_gc_helper_threads_[GCHelperThread::kNumberOfTasks];
+  SweeperThread** sweeper_thread_;
+  int num_sweeper_threads_;
 
   friend class ExecutionAccess;
+  friend class GCHelperThread;
   friend class HandleScopeImplementer;
   friend class IsolateInitializer;
   friend class OptimizingCompilerThread;
+  friend class SweeperThread;
   friend class ThreadManager;
   friend class Simulator;
   friend class StackGuard;
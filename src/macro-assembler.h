@@ -72,6 +72,26 @@ const int kInvalidProtoDepth = -1;
 namespace v8 {
 namespace internal {
 
+// Selects the space that inline allocation with the given flags uses.
+class AllocationUtils {
+ public:
+  static ExternalReference GetAllocationTopReference(Isolate* isolate,
+                                                     AllocationFlags flags) {
+    return ((flags & PRETENURE_OLD_POINTER_SPACE) != 0)
+        ? ExternalReference::old_pointer_space_allocation_top_address(isolate)
+        : ExternalReference::new_space_allocation_top_address(isolate);
+  }
+
+  static ExternalReference GetAllocationLimitReference(Isolate* isolate,
+                                                       AllocationFlags flags) {
+    return ((flags & PRETENURE_OLD_POINTER_SPACE) != 0)
+        ? ExternalReference::old_pointer_space_allocation_limit_address(
+              isolate)
+        : ExternalReference::new_space_allocation_limit_address(isolate);
+  }
+};
+
+
 class FrameScope {
  public:
   explicit FrameScope(MacroAssembler* masm, StackFrame::Type type)
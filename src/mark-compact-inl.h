@@ -66,6 +66,7 @@ void MarkCompactCollector::MarkObject(HeapObject* obj, MarkBit mark_bit) {
   if (!mark_bit.Get()) {
     mark_bit.Set();
     MemoryChunk::IncrementLiveBytesFromGC(obj->address(), obj->Size());
+    if (!ephemerons_.IsEmpty()) ephemerons_.KeyMarked(obj);
     ProcessNewlyMarkedObject(obj);
   }
 }
@@ -86,6 +87,7 @@ void MarkCompactCollector::SetMark(HeapObject* obj, MarkBit mark_bit) {
   ASSERT(Marking::MarkBitFrom(obj) == mark_bit);
   mark_bit.Set();
   MemoryChunk::IncrementLiveBytesFromGC(obj->address(), obj->Size());
+  if (!ephemerons_.IsEmpty()) ephemerons_.KeyMarked(obj);
   if (obj->IsMap()) {
     heap_->ClearCacheOnMap(Map::cast(obj));
   }
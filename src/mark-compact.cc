@@ -41,6 +41,7 @@
 #include "objects-visiting.h"
 #include "objects-visiting-inl.h"
 #include "stub-cache.h"
+#include "sweeper-thread.h"
 
 namespace v8 {
 namespace internal {
@@ -62,15 +63,28 @@ MarkCompactCollector::MarkCompactCollector() :  // NOLINT
       sweep_precisely_(false),
       reduce_memory_footprint_(false),
       abort_incremental_marking_(false),
+      evacuation_speed_in_bytes_per_ms_(kInitialEvacuationSpeedInBytesPerMs),
       compacting_(false),
       was_marked_incrementally_(false),
       flush_monomorphic_ics_(false),
+      sweeping_pending_(false),
+      sweeper_threads_started_(false),
       tracer_(NULL),
       migration_slots_buffer_(NULL),
       heap_(NULL),
+      parallel_markers_(NULL),
+      parallel_markers_count_(0),
       code_flusher_(NULL),
       encountered_weak_maps_(NULL),
-      marker_(this, this) { }
+      marker_(this, this),
+      parallel_evacuators_(NULL),
+      parallel_evacuators_count_(0),
+      parallel_compaction_task_(EVACUATE_CANDIDATES),
+      parallel_slots_filtering_required_(false),
+      evacuation_mutex_(NULL) {
+  NoBarrier_Store(&idle_parallel_markers_, 0);
+  NoBarrier_Store(&next_parallel_work_item_, 0);
+}
 
 
 #ifdef DEBUG
@@ -292,6 +306,8 @@ void MarkCompactCollector::CollectGarbage() {
   }
 #endif
 
+  if (FLAG_allocation_site_pretenuring) CollectAllocationSiteFeedback();
+
   SweepSpaces();
 
   if (!FLAG_collect_maps) ReattachInitialMaps();
@@ -387,6 +403,14 @@ bool Marking::TransferMark(Address old_start, Address new_start) {
   // size, so the adjustment to the live data count will be zero anyway.
   if (old_start == new_start) return false;
 
+  // Sweeper threads clear mark bits without synchronization, so make sure
+  // none of them is still working on the page.
+  MemoryChunk* chunk = MemoryChunk::FromAddress(old_start);
+  if (chunk->parallel_sweeping() != MemoryChunk::PARALLEL_SWEEPING_DONE) {
+    Page* page = static_cast<Page*>(chunk);
+    static_cast<PagedSpace*>(page->owner())->EnsurePageIsSwept(page);
+  }
+
   MarkBit new_mark_bit = MarkBitFrom(new_start);
   MarkBit old_mark_bit = MarkBitFrom(old_start);
 
@@ -500,6 +524,13 @@ void MarkCompactCollector::CollectEvacuationCandidates(PagedSpace* space) {
          space->identity() == OLD_DATA_SPACE ||
          space->identity() == CODE_SPACE);
 
+  if (FLAG_evacuation_time_budget_ms > 0 &&
+      !FLAG_stress_compaction &&
+      !FLAG_always_compact) {
+    CollectEvacuationCandidatesWithinBudget(space);
+    return;
+  }
+
   static const int kMaxMaxEvacuationCandidates = 1000;
   int number_of_pages = space->CountTotalPages();
   int max_evacuation_candidates =
@@ -649,6 +680,94 @@ void MarkCompactCollector::CollectEvacuationCandidates(PagedSpace* space) {
 }
 
 
+class EvacuationCost {
+ public:
+  EvacuationCost() : live_bytes_(0), page_(NULL) { }
+  EvacuationCost(intptr_t live_bytes, Page* p)
+      : live_bytes_(live_bytes), page_(p) { }
+
+  intptr_t live_bytes() const { return live_bytes_; }
+  Page* page() const { return page_; }
+
+  static int Compare(const EvacuationCost* a, const EvacuationCost* b) {
+    if (a->live_bytes_ < b->live_bytes_) return -1;
+    if (a->live_bytes_ > b->live_bytes_) return 1;
+    return 0;
+  }
+
+ private:
+  intptr_t live_bytes_;
+  Page* page_;
+};
+
+
+void MarkCompactCollector::CollectEvacuationCandidatesWithinBudget(
+    PagedSpace* space) {
+  // Pages that are more than three quarters live are not worth moving.
+  intptr_t max_live_bytes = space->AreaSize() - space->AreaSize() / 4;
+
+  List<EvacuationCost> costs;
+  intptr_t free_bytes = 0;
+
+  PageIterator it(space);
+  if (it.has_next()) it.next();  // Never compact the first page.
+
+  while (it.has_next()) {
+    Page* p = it.next();
+    p->ClearEvacuationCandidate();
+    FreeList::SizeStats sizes;
+    intptr_t live_bytes = space->EstimateLiveBytes(p, &sizes);
+    free_bytes += p->area_size() - live_bytes;
+    if (live_bytes <= max_live_bytes) {
+      costs.Add(EvacuationCost(live_bytes, p));
+    }
+  }
+
+  // Every candidate frees one page, so taking the candidates with the least
+  // live bytes first frees the most pages per evacuated byte.
+  costs.Sort(&EvacuationCost::Compare);
+
+  intptr_t budget =
+      evacuation_speed_in_bytes_per_ms_ * FLAG_evacuation_time_budget_ms;
+  intptr_t evacuated_bytes = 0;
+  int count = 0;
+  for (int i = 0; i < costs.length(); i++) {
+    const EvacuationCost& cost = costs[i];
+    intptr_t live_bytes = cost.live_bytes();
+    if (evacuated_bytes + live_bytes > budget) break;
+    // The evacuated objects have to fit into the free space of the pages
+    // that stay, or the evacuation just allocates new pages.
+    intptr_t free_bytes_left =
+        free_bytes - (cost.page()->area_size() - live_bytes);
+    if (evacuated_bytes + live_bytes > free_bytes_left) break;
+    free_bytes = free_bytes_left;
+    evacuated_bytes += live_bytes;
+    AddEvacuationCandidate(cost.page());
+    count++;
+  }
+
+  if (FLAG_trace_fragmentation) {
+    PrintF("Collected %d evacuation candidates for space %s: "
+           "%d bytes to evacuate, budget %d bytes\n",
+           count,
+           AllocationSpaceName(space->identity()),
+           static_cast<int>(evacuated_bytes),
+           static_cast<int>(budget));
+  }
+}
+
+
+void MarkCompactCollector::UpdateEvacuationSpeed(intptr_t bytes_evacuated,
+                                                 double duration_in_ms) {
+  // Evacuations that are too short to measure do not change the estimate.
+  if (bytes_evacuated == 0 || duration_in_ms < 1) return;
+  intptr_t speed = static_cast<intptr_t>(bytes_evacuated / duration_in_ms);
+  evacuation_speed_in_bytes_per_ms_ =
+      Max(static_cast<intptr_t>(1),
+          (evacuation_speed_in_bytes_per_ms_ + speed) / 2);
+}
+
+
 void MarkCompactCollector::AbortCompaction() {
   if (compacting_) {
     int npages = evacuation_candidates_.length();
@@ -669,6 +788,10 @@ void MarkCompactCollector::AbortCompaction() {
 void MarkCompactCollector::Prepare(GCTracer* tracer) {
   was_marked_incrementally_ = heap()->incremental_marking()->IsMarking();
 
+  // The sweeper threads must be done with the old spaces before evacuation
+  // candidates are selected and the free lists are reset.
+  if (IsConcurrentSweepingInProgress()) WaitUntilSweepingCompleted();
+
   // Monomorphic ICs are preserved when possible, but need to be flushed
   // when they might be keeping a Context alive, or when the heap is about
   // to be serialized.
@@ -778,7 +901,9 @@ class CodeFlusher {
   }
 
   void AddCandidate(JSFunction* function) {
-    ASSERT(function->code() == function->shared()->code());
+    ASSERT(function->code() == function->shared()->code() ||
+           function->code() ==
+               isolate_->builtins()->builtin(Builtins::kLazyCompile));
 
     SetNextCandidate(function, jsfunction_candidates_head_);
     jsfunction_candidates_head_ = function;
@@ -803,11 +928,12 @@ class CodeFlusher {
       Code* code = shared->code();
       MarkBit code_mark = Marking::MarkBitFrom(code);
       if (!code_mark.Get()) {
+        RecordFlushedCode(code);
         shared->set_code(lazy_compile);
-        candidate->set_code(lazy_compile);
-      } else {
-        candidate->set_code(shared->code());
       }
+      // If the code is still used elsewhere the function stays aged, its
+      // next call through the lazy compile builtin resets the code age.
+      candidate->set_code(lazy_compile);
 
       // We are in the middle of a GC cycle so the write barrier in the code
       // setter did not record the slot update and we have to do that manually.
@@ -837,6 +963,7 @@ class CodeFlusher {
       Code* code = candidate->code();
       MarkBit code_mark = Marking::MarkBitFrom(code);
       if (!code_mark.Get()) {
+        RecordFlushedCode(code);
         candidate->set_code(lazy_compile);
       }
 
@@ -848,6 +975,12 @@ class CodeFlusher {
     shared_function_info_candidates_head_ = NULL;
   }
 
+  void RecordFlushedCode(Code* code) {
+    Counters* counters = isolate_->counters();
+    counters->code_flushed_functions()->Increment();
+    counters->code_flushed_bytes()->Increment(code->Size());
+  }
+
   void RecordSharedFunctionInfoCodeSlot(SharedFunctionInfo* shared) {
     Object** slot = HeapObject::RawField(shared,
                                          SharedFunctionInfo::kCodeOffset);
@@ -899,6 +1032,12 @@ MarkCompactCollector::~MarkCompactCollector() {
     delete code_flusher_;
     code_flusher_ = NULL;
   }
+  delete[] parallel_markers_;
+  parallel_markers_ = NULL;
+  delete[] parallel_evacuators_;
+  parallel_evacuators_ = NULL;
+  delete evacuation_mutex_;
+  evacuation_mutex_ = NULL;
 }
 
 
@@ -1131,6 +1270,7 @@ class StaticMarkingVisitor : public StaticVisitorBase {
     // Recording the map slot can be skipped, because maps are not compacted.
     collector->MarkObject(table->map(), Marking::MarkBitFrom(table->map()));
     ASSERT(MarkCompactCollector::IsMarked(table->map()));
+    collector->DiscoverEphemerons(table);
   }
 
   static void VisitCode(Map* map, HeapObject* object) {
@@ -1143,13 +1283,19 @@ class StaticMarkingVisitor : public StaticVisitorBase {
   }
 
   // Code flushing support.
-
-  // How many collections newly compiled code object will survive before being
-  // flushed.
-  static const int kCodeAgeThreshold = 5;
+  //
+  // Unoptimized code ages by one in every full collection that does not
+  // find it on the stack or otherwise in use.  A function whose code aged
+  // is redirected to the lazy compile builtin, so that its next call
+  // resets the age.  Code that reaches --code-flush-age is flushed.
 
   static const int kRegExpCodeThreshold = 5;
 
+  // How many full collections code may survive without being executed.
+  inline static int CodeFlushAge() {
+    return Max(1, Min(FLAG_code_flush_age, SharedFunctionInfo::kCodeAgeMask));
+  }
+
   inline static bool HasSourceCode(Heap* heap, SharedFunctionInfo* info) {
     Object* undefined = heap->undefined_value();
     return (info->script() != undefined) &&
@@ -1167,22 +1313,30 @@ class StaticMarkingVisitor : public StaticVisitorBase {
         function->GetIsolate()->builtins()->builtin(Builtins::kLazyCompile);
   }
 
+  // An aged function was not called since a previous collection aged its
+  // code, it still calls the lazy compile builtin.
+  inline static bool IsAged(JSFunction* function) {
+    return !IsCompiled(function) && IsCompiled(function->unchecked_shared());
+  }
+
   inline static bool IsFlushable(Heap* heap, JSFunction* function) {
     SharedFunctionInfo* shared_info = function->unchecked_shared();
 
-    // Code is either on stack, in compilation cache or referenced
-    // by optimized version of function.
-    MarkBit code_mark = Marking::MarkBitFrom(function->code());
-    if (code_mark.Get()) {
-      if (!Marking::MarkBitFrom(shared_info).Get()) {
-        shared_info->set_code_age(0);
+    if (!IsAged(function)) {
+      // Code is either on stack, in compilation cache or referenced
+      // by optimized version of function.
+      MarkBit code_mark = Marking::MarkBitFrom(function->code());
+      if (code_mark.Get()) {
+        if (!Marking::MarkBitFrom(shared_info).Get()) {
+          shared_info->set_code_age(0);
+        }
+        return false;
       }
-      return false;
-    }
 
-    // We do not flush code for optimized functions.
-    if (function->code() != shared_info->code()) {
-      return false;
+      // We do not flush code for optimized functions.
+      if (function->code() != shared_info->code()) {
+        return false;
+      }
     }
 
     return IsFlushable(heap, shared_info);
@@ -1225,7 +1379,7 @@ class StaticMarkingVisitor : public StaticVisitorBase {
     }
 
     // Age this shared function info.
-    if (shared_info->code_age() < kCodeAgeThreshold) {
+    if (shared_info->code_age() < CodeFlushAge()) {
       shared_info->set_code_age(shared_info->code_age() + 1);
       return false;
     }
@@ -1235,7 +1389,19 @@ class StaticMarkingVisitor : public StaticVisitorBase {
 
 
   static bool FlushCodeForFunction(Heap* heap, JSFunction* function) {
-    if (!IsFlushable(heap, function)) return false;
+    if (!IsFlushable(heap, function)) {
+      SharedFunctionInfo* shared_info = function->unchecked_shared();
+      if (function->code() == shared_info->code() &&
+          shared_info->code_age() > 0 &&
+          !Marking::MarkBitFrom(shared_info->code()).Get()) {
+        // The code aged, route the next call through the lazy compile
+        // builtin to find out whether the function is still used.  The
+        // code entry is visited afterwards and records the new slot.
+        function->set_code(
+            heap->isolate()->builtins()->builtin(Builtins::kLazyCompile));
+      }
+      return false;
+    }
 
     // This function's code looks flushable. But we have to postpone the
     // decision until we see all functions that point to the same
@@ -1900,6 +2066,145 @@ class RootMarkingVisitor : public ObjectVisitor {
 };
 
 
+// Visitor used by parallel markers.  It only handles objects whose body is a
+// plain range of tagged pointers; everything that needs special treatment
+// (maps, code, functions, weak maps, ...) is deferred to the main thread.
+// Mark bits and live bytes are updated atomically because several markers
+// may reach the same object at the same time.
+class ParallelMarkingVisitor : public AllStatic {
+ public:
+  static inline bool CanVisitInParallel(Map* map) {
+    int id = map->visitor_id();
+    switch (id) {
+      case StaticVisitorBase::kVisitSeqAsciiString:
+      case StaticVisitorBase::kVisitSeqTwoByteString:
+      case StaticVisitorBase::kVisitShortcutCandidate:
+      case StaticVisitorBase::kVisitByteArray:
+      case StaticVisitorBase::kVisitFreeSpace:
+      case StaticVisitorBase::kVisitFixedArray:
+      case StaticVisitorBase::kVisitFixedDoubleArray:
+      case StaticVisitorBase::kVisitConsString:
+      case StaticVisitorBase::kVisitSlicedString:
+      case StaticVisitorBase::kVisitOddball:
+      case StaticVisitorBase::kVisitPropertyCell:
+        return true;
+      default:
+        return IsDataObject(id) || IsJSObject(id) || IsStruct(id);
+    }
+  }
+
+  static inline void Visit(ParallelMarker* marker, HeapObject* object) {
+    Map* map = object->map();
+    if (!Marking::MarkBitFrom(map).Get()) {
+      marker->deferred_objects()->Add(map);
+    }
+
+    int id = map->visitor_id();
+    switch (id) {
+      case StaticVisitorBase::kVisitShortcutCandidate:
+      case StaticVisitorBase::kVisitConsString:
+        VisitFixedBody<ConsString::BodyDescriptor>(marker, object);
+        return;
+      case StaticVisitorBase::kVisitSlicedString:
+        VisitFixedBody<SlicedString::BodyDescriptor>(marker, object);
+        return;
+      case StaticVisitorBase::kVisitOddball:
+        VisitFixedBody<Oddball::BodyDescriptor>(marker, object);
+        return;
+      case StaticVisitorBase::kVisitPropertyCell:
+        VisitFixedBody<JSGlobalPropertyCell::BodyDescriptor>(marker, object);
+        return;
+      case StaticVisitorBase::kVisitFixedArray:
+        VisitFlexibleBody<FixedArray::BodyDescriptor>(marker, map, object);
+        return;
+      default:
+        if (IsJSObject(id)) {
+          VisitFlexibleBody<JSObject::BodyDescriptor>(marker, map, object);
+        } else if (IsStruct(id)) {
+          VisitFlexibleBody<StructBodyDescriptor>(marker, map, object);
+        }
+        // Data objects have no pointers to visit.
+        return;
+    }
+  }
+
+ private:
+  static inline bool IsDataObject(int id) {
+    return StaticVisitorBase::kVisitDataObject <= id &&
+        id <= StaticVisitorBase::kVisitDataObjectGeneric;
+  }
+
+  static inline bool IsJSObject(int id) {
+    return StaticVisitorBase::kVisitJSObject <= id &&
+        id <= StaticVisitorBase::kVisitJSObjectGeneric;
+  }
+
+  static inline bool IsStruct(int id) {
+    return StaticVisitorBase::kVisitStruct <= id &&
+        id <= StaticVisitorBase::kVisitStructGeneric;
+  }
+
+  template<typename BodyDescriptor>
+  static inline void VisitFixedBody(ParallelMarker* marker,
+                                    HeapObject* object) {
+    VisitPointers(marker,
+                  HeapObject::RawField(object, BodyDescriptor::kStartOffset),
+                  HeapObject::RawField(object, BodyDescriptor::kEndOffset));
+  }
+
+  template<typename BodyDescriptor>
+  static inline void VisitFlexibleBody(ParallelMarker* marker,
+                                       Map* map,
+                                       HeapObject* object) {
+    VisitPointers(marker,
+                  HeapObject::RawField(object, BodyDescriptor::kStartOffset),
+                  HeapObject::RawField(object, object->SizeFromMap(map)));
+  }
+
+  static inline void VisitPointers(ParallelMarker* marker,
+                                   Object** start,
+                                   Object** end) {
+    for (Object** p = start; p < end; p++) {
+      MarkObjectByPointer(marker, start, p);
+    }
+  }
+
+  static inline void MarkObjectByPointer(ParallelMarker* marker,
+                                         Object** anchor_slot,
+                                         Object** p) {
+    if (!(*p)->IsHeapObject()) return;
+    HeapObject* object = ShortCircuitConsString(p);
+
+    // Slots are recorded into the slots buffers of evacuation candidates
+    // by the main thread once the marking round is over.
+    if (MarkCompactCollector::IsOnEvacuationCandidate(object) &&
+        !MarkCompactCollector::ShouldSkipEvacuationSlotRecording(
+            anchor_slot)) {
+      marker->recorded_slots()->Add(p);
+    }
+
+    MarkBit mark = Marking::MarkBitFrom(object);
+    if (mark.Get()) return;
+    Map* map = object->map();
+    if (!CanVisitInParallel(map)) {
+      marker->deferred_objects()->Add(object);
+      return;
+    }
+    if (!mark.AtomicSet()) return;
+    MemoryChunk::IncrementLiveBytesFromGCAtomically(
+        object->address(), object->SizeFromMap(map));
+    // The main thread marks the values of ephemerons with this key once the
+    // marking round is over.
+    EphemeronTable* ephemerons =
+        object->GetHeap()->mark_compact_collector()->ephemerons();
+    if (!ephemerons->IsEmpty() && ephemerons->HasKey(object)) {
+      marker->marked_ephemeron_keys()->Add(object);
+    }
+    marker->marking_deque()->Push(object);
+  }
+};
+
+
 // Helper class for pruning the symbol table.
 class SymbolTableCleaner : public ObjectVisitor {
  public:
@@ -2327,12 +2632,184 @@ void MarkCompactCollector::MarkImplicitRefGroups() {
 
 
 // Mark all objects reachable from the objects on the marking stack.
+bool WorkStealingMarkingDeque::StealInto(WorkStealingMarkingDeque* thief) {
+  if (!HasSharedWork()) return false;
+  ScopedLock lock(mutex_);
+  int length = shared_.length();
+  if (length == 0) return false;
+  int stolen = (length + 1) / 2;
+  for (int i = 0; i < stolen; i++) {
+    thief->private_.Add(shared_.RemoveLast());
+  }
+  NoBarrier_Store(&shared_length_, shared_.length());
+  return true;
+}
+
+
+void WorkStealingMarkingDeque::Publish() {
+  // Only publish when the shared part ran dry to keep lock traffic low.
+  if (HasSharedWork()) return;
+  ScopedLock lock(mutex_);
+  for (int i = 0; i < kPublishBatchSize; i++) {
+    shared_.Add(private_.RemoveLast());
+  }
+  NoBarrier_Store(&shared_length_, shared_.length());
+}
+
+
+bool WorkStealingMarkingDeque::Refill() {
+  if (!HasSharedWork()) return false;
+  ScopedLock lock(mutex_);
+  int length = shared_.length();
+  if (length == 0) return false;
+  int refill = Min(length, kPublishBatchSize);
+  for (int i = 0; i < refill; i++) {
+    private_.Add(shared_.RemoveLast());
+  }
+  NoBarrier_Store(&shared_length_, shared_.length());
+  return true;
+}
+
+
+bool MarkCompactCollector::IsParallelMarkingEnabled() {
+  // Object statistics are collected by the sequential visitor only.
+  return FLAG_parallel_marking &&
+      !FLAG_track_gc_object_stats &&
+      heap()->isolate()->gc_helper_threads(GCHelperThread::MARKING) != NULL;
+}
+
+
+void MarkCompactCollector::ProcessMarkingDequeInParallel() {
+  Isolate* isolate = heap()->isolate();
+  GCHelperThread** threads =
+      isolate->gc_helper_threads(GCHelperThread::MARKING);
+  int thread_count = isolate->num_gc_helper_threads(GCHelperThread::MARKING);
+  if (parallel_markers_ == NULL) {
+    parallel_markers_count_ = thread_count + 1;
+    parallel_markers_ = new ParallelMarker[parallel_markers_count_];
+  }
+  ASSERT(parallel_markers_count_ == thread_count + 1);
+
+  // Distribute the marking stack over the parallel markers.  Objects that
+  // need the sequential visitor are visited right away.
+  int next_marker = 0;
+  while (!marking_deque_.IsEmpty()) {
+    HeapObject* object = marking_deque_.Pop();
+    ASSERT(Marking::IsBlack(Marking::MarkBitFrom(object)));
+    Map* map = object->map();
+    MarkBit map_mark = Marking::MarkBitFrom(map);
+    MarkObject(map, map_mark);
+    if (ParallelMarkingVisitor::CanVisitInParallel(map)) {
+      parallel_markers_[next_marker].marking_deque()->Push(object);
+      next_marker = (next_marker + 1) % parallel_markers_count_;
+    } else {
+      StaticMarkingVisitor::IterateBody(map, object);
+    }
+  }
+
+  NoBarrier_Store(&idle_parallel_markers_, 0);
+  for (int i = 0; i < thread_count; i++) {
+    threads[i]->StartRound();
+  }
+  MarkInParallel(0);
+  for (int i = 0; i < thread_count; i++) {
+    threads[i]->WaitForRound();
+  }
+
+  for (int i = 0; i < parallel_markers_count_; i++) {
+    ParallelMarker* marker = &parallel_markers_[i];
+    ASSERT(marker->marking_deque()->IsEmpty());
+
+    List<Object**>* slots = marker->recorded_slots();
+    for (int j = 0; j < slots->length(); j++) {
+      Object** slot = slots->at(j);
+      Page* page = Page::FromAddress(reinterpret_cast<Address>(*slot));
+      if (page->IsEvacuationCandidate() &&
+          !SlotsBuffer::AddTo(&slots_buffer_allocator_,
+                              page->slots_buffer_address(),
+                              slot,
+                              SlotsBuffer::FAIL_ON_OVERFLOW)) {
+        EvictEvacuationCandidate(page);
+      }
+    }
+    slots->Clear();
+
+    List<HeapObject*>* deferred = marker->deferred_objects();
+    for (int j = 0; j < deferred->length(); j++) {
+      HeapObject* object = deferred->at(j);
+      MarkBit mark = Marking::MarkBitFrom(object);
+      MarkObject(object, mark);
+    }
+    deferred->Clear();
+
+    List<HeapObject*>* keys = marker->marked_ephemeron_keys();
+    for (int j = 0; j < keys->length(); j++) {
+      ephemerons_.KeyMarked(keys->at(j));
+    }
+    keys->Clear();
+  }
+}
+
+
+void MarkCompactCollector::MarkInParallel(int worker_id) {
+  ParallelMarker* marker = &parallel_markers_[worker_id];
+  do {
+    HeapObject* object;
+    while (marker->marking_deque()->Pop(&object)) {
+      ASSERT(object->IsHeapObject());
+      ASSERT(Marking::IsBlack(Marking::MarkBitFrom(object)));
+      ParallelMarkingVisitor::Visit(marker, object);
+    }
+  } while (StealMarkingWork(worker_id) || !ParallelMarkingDone());
+}
+
+
+bool MarkCompactCollector::StealMarkingWork(int worker_id) {
+  WorkStealingMarkingDeque* own = parallel_markers_[worker_id].marking_deque();
+  for (int i = 1; i < parallel_markers_count_; i++) {
+    int victim = (worker_id + i) % parallel_markers_count_;
+    if (parallel_markers_[victim].marking_deque()->StealInto(own)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool MarkCompactCollector::ParallelMarkingDone() {
+  // A marker only becomes idle once its own deque is empty and only the
+  // owner adds work to a deque, so all work is done when every marker is
+  // idle at the same time.
+  Barrier_AtomicIncrement(&idle_parallel_markers_, 1);
+  while (true) {
+    if (Acquire_Load(&idle_parallel_markers_) == parallel_markers_count_) {
+      return true;
+    }
+    for (int i = 0; i < parallel_markers_count_; i++) {
+      if (parallel_markers_[i].marking_deque()->HasSharedWork()) {
+        Barrier_AtomicIncrement(&idle_parallel_markers_, -1);
+        return false;
+      }
+    }
+    Thread::YieldCPU();
+  }
+}
+
+
 // Before: the marking stack contains zero or more heap object pointers.
 // After: the marking stack is empty, and all objects reachable from the
 // marking stack have been marked, or are overflowed in the heap.
 void MarkCompactCollector::EmptyMarkingDeque() {
+  // Parallel marking only pays off when there is enough work to share.
+  static const int kMinParallelMarkingWork = 256;
+  bool parallel_marking = IsParallelMarkingEnabled();
   while (!marking_deque_.IsEmpty()) {
     while (!marking_deque_.IsEmpty()) {
+      if (parallel_marking &&
+          marking_deque_.Length() >= kMinParallelMarkingWork) {
+        ProcessMarkingDequeInParallel();
+        continue;
+      }
       HeapObject* object = marking_deque_.Pop();
       ASSERT(object->IsHeapObject());
       ASSERT(heap()->Contains(object));
@@ -2345,9 +2822,9 @@ void MarkCompactCollector::EmptyMarkingDeque() {
       StaticMarkingVisitor::IterateBody(map, object);
     }
 
-    // Process encountered weak maps, mark objects only reachable by those
-    // weak maps and repeat until fix-point is reached.
-    ProcessWeakMaps();
+    // Mark the values of weak map entries whose keys were marked, and the
+    // objects only reachable from them.
+    ProcessEphemerons();
   }
 }
 
@@ -2724,30 +3201,94 @@ void MarkCompactCollector::ClearNonLiveMapTransitions(Map* map,
 }
 
 
-void MarkCompactCollector::ProcessWeakMaps() {
-  Object* weak_map_obj = encountered_weak_maps();
-  while (weak_map_obj != Smi::FromInt(0)) {
-    ASSERT(MarkCompactCollector::IsMarked(HeapObject::cast(weak_map_obj)));
-    JSWeakMap* weak_map = reinterpret_cast<JSWeakMap*>(weak_map_obj);
-    ObjectHashTable* table = ObjectHashTable::cast(weak_map->table());
-    Object** anchor = reinterpret_cast<Object**>(table->address());
-    for (int i = 0; i < table->Capacity(); i++) {
-      if (MarkCompactCollector::IsMarked(HeapObject::cast(table->KeyAt(i)))) {
-        Object** key_slot =
-            HeapObject::RawField(table, FixedArray::OffsetOfElementAt(
-                ObjectHashTable::EntryToIndex(i)));
-        RecordSlot(anchor, key_slot, *key_slot);
-        Object** value_slot =
-            HeapObject::RawField(table, FixedArray::OffsetOfElementAt(
-                ObjectHashTable::EntryToValueIndex(i)));
-        StaticMarkingVisitor::MarkObjectByPointer(this, anchor, value_slot);
-      }
+EphemeronTable::EphemeronTable()
+    : keys_(KeysMatch), ready_chain_(-1) {
+}
+
+
+void EphemeronTable::Add(HeapObject* key, ObjectHashTable* table, int entry) {
+  HashMap::Entry* key_entry = keys_.Lookup(key, Hash(key), true);
+  Ephemeron ephemeron;
+  ephemeron.table = table;
+  ephemeron.entry = entry;
+  ephemeron.next = key_entry->value == NULL
+      ? -1
+      : static_cast<int>(reinterpret_cast<intptr_t>(key_entry->value)) - 1;
+  ephemerons_.Add(ephemeron);
+  // Indices are stored biased by one to tell them apart from a new entry.
+  key_entry->value = reinterpret_cast<void*>(
+      static_cast<intptr_t>(ephemerons_.length()));
+}
+
+
+bool EphemeronTable::HasKey(HeapObject* object) {
+  return keys_.Lookup(object, Hash(object), false) != NULL;
+}
+
+
+void EphemeronTable::KeyMarked(HeapObject* key) {
+  void* value = keys_.Remove(key, Hash(key));
+  if (value == NULL) return;
+  ready_.Add(static_cast<int>(reinterpret_cast<intptr_t>(value)) - 1);
+}
+
+
+bool EphemeronTable::PopReady(ObjectHashTable** table, int* entry) {
+  while (ready_chain_ == -1) {
+    if (ready_.is_empty()) return false;
+    ready_chain_ = ready_.RemoveLast();
+  }
+  Ephemeron* ephemeron = &ephemerons_[ready_chain_];
+  *table = ephemeron->table;
+  *entry = ephemeron->entry;
+  ready_chain_ = ephemeron->next;
+  return true;
+}
+
+
+void EphemeronTable::Clear() {
+  keys_.Clear();
+  ephemerons_.Clear();
+  ready_.Clear();
+  ready_chain_ = -1;
+}
+
+
+void MarkCompactCollector::DiscoverEphemerons(ObjectHashTable* table) {
+  for (int i = 0; i < table->Capacity(); i++) {
+    HeapObject* key = HeapObject::cast(table->KeyAt(i));
+    if (IsMarked(key)) {
+      MarkEphemeronValue(table, i);
+    } else {
+      ephemerons_.Add(key, table, i);
     }
-    weak_map_obj = weak_map->next();
   }
 }
 
 
+void MarkCompactCollector::ProcessEphemerons() {
+  ObjectHashTable* table;
+  int entry;
+  while (ephemerons_.PopReady(&table, &entry)) {
+    MarkEphemeronValue(table, entry);
+  }
+}
+
+
+void MarkCompactCollector::MarkEphemeronValue(ObjectHashTable* table,
+                                              int entry) {
+  Object** anchor = reinterpret_cast<Object**>(table->address());
+  Object** key_slot =
+      HeapObject::RawField(table, FixedArray::OffsetOfElementAt(
+          ObjectHashTable::EntryToIndex(entry)));
+  RecordSlot(anchor, key_slot, *key_slot);
+  Object** value_slot =
+      HeapObject::RawField(table, FixedArray::OffsetOfElementAt(
+          ObjectHashTable::EntryToValueIndex(entry)));
+  StaticMarkingVisitor::MarkObjectByPointer(this, anchor, value_slot);
+}
+
+
 void MarkCompactCollector::ClearWeakMaps() {
   Object* weak_map_obj = encountered_weak_maps();
   while (weak_map_obj != Smi::FromInt(0)) {
@@ -2763,6 +3304,7 @@ void MarkCompactCollector::ClearWeakMaps() {
     weak_map->set_next(Smi::FromInt(0));
   }
   set_encountered_weak_maps(Smi::FromInt(0));
+  ephemerons_.Clear();
 }
 
 
@@ -2783,8 +3325,15 @@ void MarkCompactCollector::ClearWeakMaps() {
 void MarkCompactCollector::MigrateObject(Address dst,
                                          Address src,
                                          int size,
-                                         AllocationSpace dest) {
-  HEAP_PROFILE(heap(), ObjectMoveEvent(src, dst));
+                                         AllocationSpace dest,
+                                         ParallelEvacuator* evacuator) {
+  SlotsBuffer** slots_buffer_address = &migration_slots_buffer_;
+  if (evacuator == NULL) {
+    HEAP_PROFILE(heap(), ObjectMoveEvent(src, dst));
+  } else {
+    // Parallel evacuation is only used while the heap profiler is off.
+    slots_buffer_address = evacuator->migration_slots_buffer_address();
+  }
   if (dest == OLD_POINTER_SPACE || dest == LO_SPACE) {
     Address src_slot = src;
     Address dst_slot = dst;
@@ -2796,10 +3345,14 @@ void MarkCompactCollector::MigrateObject(Address dst,
       Memory::Object_at(dst_slot) = value;
 
       if (heap_->InNewSpace(value)) {
-        heap_->store_buffer()->Mark(dst_slot);
+        if (evacuator == NULL) {
+          heap_->store_buffer()->Mark(dst_slot);
+        } else {
+          evacuator->new_space_slots()->Add(dst_slot);
+        }
       } else if (value->IsHeapObject() && IsOnEvacuationCandidate(value)) {
         SlotsBuffer::AddTo(&slots_buffer_allocator_,
-                           &migration_slots_buffer_,
+                           slots_buffer_address,
                            reinterpret_cast<Object**>(dst_slot),
                            SlotsBuffer::IGNORE_OVERFLOW);
       }
@@ -2814,13 +3367,14 @@ void MarkCompactCollector::MigrateObject(Address dst,
 
       if (Page::FromAddress(code_entry)->IsEvacuationCandidate()) {
         SlotsBuffer::AddTo(&slots_buffer_allocator_,
-                           &migration_slots_buffer_,
+                           slots_buffer_address,
                            SlotsBuffer::CODE_ENTRY_SLOT,
                            code_entry_slot,
                            SlotsBuffer::IGNORE_OVERFLOW);
       }
     }
   } else if (dest == CODE_SPACE) {
+    ASSERT(evacuator == NULL);
     PROFILE(heap()->isolate(), CodeMoveEvent(src, dst));
     heap()->MoveBlock(dst, src, size);
     SlotsBuffer::AddTo(&slots_buffer_allocator_,
@@ -2976,6 +3530,20 @@ bool MarkCompactCollector::TryPromoteObject(HeapObject* object,
 }
 
 
+// Counts the surviving copies of tracked literals.  This has to happen
+// before the old spaces are swept, because sweeping may free allocation
+// sites that died in this collection while their copies are still alive.
+void MarkCompactCollector::CollectAllocationSiteFeedback() {
+  NewSpace* new_space = heap()->new_space();
+  Address top = new_space->top();
+  SemiSpaceIterator it(new_space->bottom(), top);
+  for (HeapObject* object = it.Next(); object != NULL; object = it.Next()) {
+    if (!Marking::MarkBitFrom(object).Get() || !object->IsJSObject()) continue;
+    heap()->RecordAllocationSiteFeedback(object, object->Size(), top);
+  }
+}
+
+
 void MarkCompactCollector::EvacuateNewSpace() {
   // There are soft limits in the allocation code, designed trigger a mark
   // sweep collection by failing allocations.  But since we are already in
@@ -3049,8 +3617,8 @@ void MarkCompactCollector::EvacuateNewSpace() {
 }
 
 
-void MarkCompactCollector::EvacuateLiveObjectsFromPage(Page* p) {
-  AlwaysAllocateScope always_allocate;
+void MarkCompactCollector::EvacuateLiveObjectsFromPage(
+    Page* p, ParallelEvacuator* evacuator) {
   PagedSpace* space = static_cast<PagedSpace*>(p->owner());
   ASSERT(p->IsEvacuationCandidate() && !p->WasSwept());
   MarkBit::CellType* cells = p->markbits()->cells();
@@ -3085,19 +3653,24 @@ void MarkCompactCollector::EvacuateLiveObjectsFromPage(Page* p) {
 
       int size = object->Size();
 
-      MaybeObject* target = space->AllocateRaw(size);
-      if (target->IsFailure()) {
-        // OS refused to give us memory.
-        V8::FatalProcessOutOfMemory("Evacuation");
-        return;
+      HeapObject* target_object;
+      if (evacuator == NULL) {
+        MaybeObject* target = space->AllocateRaw(size);
+        if (target->IsFailure()) {
+          // OS refused to give us memory.
+          V8::FatalProcessOutOfMemory("Evacuation");
+          return;
+        }
+        target_object = HeapObject::cast(target->ToObjectUnchecked());
+      } else {
+        target_object = AllocateForParallelEvacuation(space, size, evacuator);
       }
 
-      Object* target_object = target->ToObjectUnchecked();
-
-      MigrateObject(HeapObject::cast(target_object)->address(),
+      MigrateObject(target_object->address(),
                     object_addr,
                     size,
-                    space->identity());
+                    space->identity(),
+                    evacuator);
       ASSERT(object->map_word().IsForwardingAddress());
     }
 
@@ -3108,7 +3681,15 @@ void MarkCompactCollector::EvacuateLiveObjectsFromPage(Page* p) {
 }
 
 
+void MarkCompactCollector::AbandonEvacuationCandidate(Page* page) {
+  slots_buffer_allocator_.DeallocateChain(page->slots_buffer_address());
+  page->ClearEvacuationCandidate();
+  page->SetFlag(Page::RESCAN_ON_EVACUATION);
+}
+
+
 void MarkCompactCollector::EvacuatePages() {
+  AlwaysAllocateScope always_allocate;
   int npages = evacuation_candidates_.length();
   for (int i = 0; i < npages; i++) {
     Page* p = evacuation_candidates_[i];
@@ -3123,10 +3704,7 @@ void MarkCompactCollector::EvacuatePages() {
         // Without room for expansion evacuation is not guaranteed to succeed.
         // Pessimistically abandon unevacuated pages.
         for (int j = i; j < npages; j++) {
-          Page* page = evacuation_candidates_[j];
-          slots_buffer_allocator_.DeallocateChain(page->slots_buffer_address());
-          page->ClearEvacuationCandidate();
-          page->SetFlag(Page::RESCAN_ON_EVACUATION);
+          AbandonEvacuationCandidate(evacuation_candidates_[j]);
         }
         return;
       }
@@ -3135,6 +3713,243 @@ void MarkCompactCollector::EvacuatePages() {
 }
 
 
+bool MarkCompactCollector::IsParallelCompactionEnabled() {
+  // Object moves are reported to the heap profiler one at a time, which
+  // only works on the main thread.
+  HeapProfiler* profiler = heap()->isolate()->heap_profiler();
+  return FLAG_parallel_compaction &&
+      heap()->isolate()->gc_helper_threads(GCHelperThread::COMPACTION) !=
+          NULL &&
+      (profiler == NULL || !profiler->is_profiling());
+}
+
+
+int MarkCompactCollector::ParallelCompactionWorkers() {
+  return heap()->isolate()->num_gc_helper_threads(GCHelperThread::COMPACTION) +
+      1;
+}
+
+
+void MarkCompactCollector::RunParallelCompactionTask(
+    ParallelCompactionTask task, int workers) {
+  GCHelperThread** threads =
+      heap()->isolate()->gc_helper_threads(GCHelperThread::COMPACTION);
+  ASSERT(workers >= 1 && workers <= ParallelCompactionWorkers());
+  parallel_compaction_task_ = task;
+  NoBarrier_Store(&next_parallel_work_item_, 0);
+  for (int i = 0; i < workers - 1; i++) {
+    threads[i]->StartRound();
+  }
+  CompactInParallel(0);
+  for (int i = 0; i < workers - 1; i++) {
+    threads[i]->WaitForRound();
+  }
+}
+
+
+void MarkCompactCollector::EvacuatePagesInParallel() {
+  AlwaysAllocateScope always_allocate;
+  if (parallel_evacuators_ == NULL) {
+    parallel_evacuators_count_ = ParallelCompactionWorkers();
+    parallel_evacuators_ = new ParallelEvacuator[parallel_evacuators_count_];
+    evacuation_mutex_ = OS::CreateMutex();
+  }
+  ASSERT(parallel_evacuators_count_ == ParallelCompactionWorkers());
+
+  // Code objects are relocated and reported to the profiler as they move,
+  // so code space candidates are evacuated on the main thread.
+  ASSERT(parallel_evacuation_pages_.is_empty());
+  int npages = evacuation_candidates_.length();
+  for (int i = 0; i < npages; i++) {
+    Page* p = evacuation_candidates_[i];
+    ASSERT(p->IsEvacuationCandidate() ||
+           p->IsFlagSet(Page::RESCAN_ON_EVACUATION));
+    if (!p->IsEvacuationCandidate()) continue;
+    if (p->owner()->identity() != CODE_SPACE) {
+      parallel_evacuation_pages_.Add(p);
+    } else if (static_cast<PagedSpace*>(p->owner())->CanExpand()) {
+      EvacuateLiveObjectsFromPage(p);
+    } else {
+      AbandonEvacuationCandidate(p);
+    }
+  }
+
+  int workers = Min(parallel_evacuators_count_,
+                    parallel_evacuation_pages_.length());
+  if (workers > 0) {
+    RunParallelCompactionTask(EVACUATE_CANDIDATES, workers);
+  }
+  parallel_evacuation_pages_.Clear();
+
+  for (int i = 0; i < workers; i++) {
+    ParallelEvacuator* evacuator = &parallel_evacuators_[i];
+    List<Address>* slots = evacuator->new_space_slots();
+    for (int j = 0; j < slots->length(); j++) {
+      heap_->store_buffer()->Mark(slots->at(j));
+    }
+    slots->Clear();
+
+    List<Page*>* abandoned = evacuator->abandoned_pages();
+    for (int j = 0; j < abandoned->length(); j++) {
+      AbandonEvacuationCandidate(abandoned->at(j));
+    }
+    abandoned->Clear();
+  }
+}
+
+
+// Size of the linear allocation buffers used by parallel evacuators.  Larger
+// objects are allocated from the space directly.
+static const int kParallelEvacuationBufferSize = 32 * KB;
+
+
+HeapObject* MarkCompactCollector::AllocateForParallelEvacuation(
+    PagedSpace* space, int size, ParallelEvacuator* evacuator) {
+  AllocationInfo* buffer = evacuator->allocation_buffer(space->identity());
+  Address top = buffer->top;
+  if (top != NULL && size <= buffer->limit - top) {
+    buffer->top = top + size;
+    return HeapObject::FromAddress(top);
+  }
+
+  ScopedLock lock(evacuation_mutex_);
+  Object* object;
+  if (size <= kParallelEvacuationBufferSize / 4) {
+    MaybeObject* maybe_buffer =
+        space->AllocateRaw(kParallelEvacuationBufferSize);
+    if (maybe_buffer->ToObject(&object)) {
+      if (buffer->top != NULL && buffer->top != buffer->limit) {
+        space->Free(buffer->top, static_cast<int>(buffer->limit - buffer->top));
+      }
+      Address start = HeapObject::cast(object)->address();
+      buffer->top = start + size;
+      buffer->limit = start + kParallelEvacuationBufferSize;
+      return HeapObject::cast(object);
+    }
+  }
+  // Objects that do not fit a buffer and allocations that failed to get a
+  // whole buffer go to the space directly.
+  MaybeObject* maybe_object = space->AllocateRaw(size);
+  if (!maybe_object->ToObject(&object)) {
+    // OS refused to give us memory.
+    V8::FatalProcessOutOfMemory("Evacuation");
+    return NULL;
+  }
+  return HeapObject::cast(object);
+}
+
+
+void MarkCompactCollector::ReleaseParallelEvacuationBuffers(
+    ParallelEvacuator* evacuator) {
+  PagedSpace* spaces[] = { heap()->old_pointer_space(),
+                           heap()->old_data_space() };
+  ScopedLock lock(evacuation_mutex_);
+  for (size_t i = 0; i < ARRAY_SIZE(spaces); i++) {
+    AllocationInfo* buffer =
+        evacuator->allocation_buffer(spaces[i]->identity());
+    if (buffer->top != NULL && buffer->top != buffer->limit) {
+      spaces[i]->Free(buffer->top,
+                      static_cast<int>(buffer->limit - buffer->top));
+    }
+    buffer->top = NULL;
+    buffer->limit = NULL;
+  }
+}
+
+
+void MarkCompactCollector::UpdateStoreBufferInParallel() {
+  int workers = ParallelCompactionWorkers();
+  StoreBuffer* store_buffer = heap_->store_buffer();
+  store_buffer->StartParallelIteration(workers);
+  RunParallelCompactionTask(UPDATE_STORE_BUFFER, workers);
+  store_buffer->FinishParallelIteration(&UpdatePointer);
+}
+
+
+static void AddSlotsBuffersOfChain(List<SlotsBuffer*>* buffers,
+                                   SlotsBuffer* buffer) {
+  while (buffer != NULL) {
+    buffers->Add(buffer);
+    buffer = buffer->next();
+  }
+}
+
+
+void MarkCompactCollector::UpdateSlotsBuffersInParallel(
+    bool code_slots_filtering_required) {
+  // A slot can be recorded in more than one buffer.  Updating it is
+  // idempotent, so racing updates of the same slot store the same value.
+  ASSERT(parallel_slots_buffers_.is_empty());
+  AddSlotsBuffersOfChain(&parallel_slots_buffers_, migration_slots_buffer_);
+  for (int i = 0; i < parallel_evacuators_count_; i++) {
+    AddSlotsBuffersOfChain(
+        &parallel_slots_buffers_,
+        *parallel_evacuators_[i].migration_slots_buffer_address());
+  }
+  int npages = evacuation_candidates_.length();
+  for (int i = 0; i < npages; i++) {
+    Page* p = evacuation_candidates_[i];
+    if (p->IsEvacuationCandidate()) {
+      AddSlotsBuffersOfChain(&parallel_slots_buffers_, p->slots_buffer());
+    }
+  }
+
+  parallel_slots_filtering_required_ = code_slots_filtering_required;
+  int workers = Min(ParallelCompactionWorkers(),
+                    parallel_slots_buffers_.length());
+  if (workers > 0) {
+    RunParallelCompactionTask(UPDATE_SLOTS_BUFFERS, workers);
+  }
+  parallel_slots_buffers_.Clear();
+}
+
+
+void MarkCompactCollector::CompactInParallel(int worker_id) {
+  switch (parallel_compaction_task_) {
+    case EVACUATE_CANDIDATES: {
+      ParallelEvacuator* evacuator = &parallel_evacuators_[worker_id];
+      int npages = parallel_evacuation_pages_.length();
+      while (true) {
+        int i = NoBarrier_AtomicIncrement(&next_parallel_work_item_, 1) - 1;
+        if (i >= npages) break;
+        Page* p = parallel_evacuation_pages_[i];
+        PagedSpace* space = static_cast<PagedSpace*>(p->owner());
+        bool can_expand;
+        { ScopedLock lock(evacuation_mutex_);
+          can_expand = space->CanExpand();
+        }
+        if (can_expand) {
+          EvacuateLiveObjectsFromPage(p, evacuator);
+        } else {
+          // Without room for expansion evacuation is not guaranteed to
+          // succeed.  The main thread abandons the page after the round.
+          evacuator->abandoned_pages()->Add(p);
+        }
+      }
+      ReleaseParallelEvacuationBuffers(evacuator);
+      break;
+    }
+    case UPDATE_STORE_BUFFER:
+      heap_->store_buffer()->IteratePointersInRange(worker_id, &UpdatePointer);
+      break;
+    case UPDATE_SLOTS_BUFFERS: {
+      int nbuffers = parallel_slots_buffers_.length();
+      while (true) {
+        int i = NoBarrier_AtomicIncrement(&next_parallel_work_item_, 1) - 1;
+        if (i >= nbuffers) break;
+        SlotsBuffer* buffer = parallel_slots_buffers_[i];
+        if (parallel_slots_filtering_required_) {
+          buffer->UpdateSlotsWithFilter(heap_);
+        } else {
+          buffer->UpdateSlots(heap_);
+        }
+      }
+      break;
+    }
+  }
+}
+
+
 class EvacuationWeakObjectRetainer : public WeakObjectRetainer {
  public:
   virtual Object* RetainAs(Object* object) {
@@ -3412,8 +4227,20 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
   }
 
 
+  bool parallel_compaction = IsParallelCompactionEnabled();
   { GCTracer::Scope gc_scope(tracer_, GCTracer::Scope::MC_EVACUATE_PAGES);
-    EvacuatePages();
+    intptr_t bytes_to_evacuate = 0;
+    for (int i = 0; i < evacuation_candidates_.length(); i++) {
+      Page* p = evacuation_candidates_[i];
+      if (p->IsEvacuationCandidate()) bytes_to_evacuate += p->LiveBytes();
+    }
+    double start = OS::TimeCurrentMillis();
+    if (parallel_compaction) {
+      EvacuatePagesInParallel();
+    } else {
+      EvacuatePages();
+    }
+    UpdateEvacuationSpeed(bytes_to_evacuate, OS::TimeCurrentMillis() - start);
   }
 
   // Second pass: find pointers to new space and update them.
@@ -3446,14 +4273,23 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
     StoreBufferRebuildScope scope(heap_,
                                   heap_->store_buffer(),
                                   &Heap::ScavengeStoreBufferCallback);
-    heap_->store_buffer()->IteratePointersToNewSpace(&UpdatePointer);
+    if (parallel_compaction) {
+      UpdateStoreBufferInParallel();
+    } else {
+      heap_->store_buffer()->IteratePointersToNewSpace(&UpdatePointer);
+    }
   }
 
   { GCTracer::Scope gc_scope(tracer_,
                              GCTracer::Scope::MC_UPDATE_POINTERS_TO_EVACUATED);
-    SlotsBuffer::UpdateSlotsRecordedIn(heap_,
-                                       migration_slots_buffer_,
-                                       code_slots_filtering_required);
+    if (parallel_compaction) {
+      // Also updates the slots recorded for each evacuated candidate.
+      UpdateSlotsBuffersInParallel(code_slots_filtering_required);
+    } else {
+      SlotsBuffer::UpdateSlotsRecordedIn(heap_,
+                                         migration_slots_buffer_,
+                                         code_slots_filtering_required);
+    }
     if (FLAG_trace_fragmentation) {
       PrintF("  migration slots buffer: %d\n",
              SlotsBuffer::SizeOfChain(migration_slots_buffer_));
@@ -3485,9 +4321,11 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
              p->IsFlagSet(Page::RESCAN_ON_EVACUATION));
 
       if (p->IsEvacuationCandidate()) {
-        SlotsBuffer::UpdateSlotsRecordedIn(heap_,
-                                           p->slots_buffer(),
-                                           code_slots_filtering_required);
+        if (!parallel_compaction) {
+          SlotsBuffer::UpdateSlotsRecordedIn(heap_,
+                                             p->slots_buffer(),
+                                             code_slots_filtering_required);
+        }
         if (FLAG_trace_fragmentation) {
           PrintF("  page %p slots buffer: %d\n",
                  reinterpret_cast<void*>(p),
@@ -3574,12 +4412,17 @@ void MarkCompactCollector::EvacuateNewSpaceAndCandidates() {
 
   slots_buffer_allocator_.DeallocateChain(&migration_slots_buffer_);
   ASSERT(migration_slots_buffer_ == NULL);
+  for (int i = 0; i < parallel_evacuators_count_; i++) {
+    slots_buffer_allocator_.DeallocateChain(
+        parallel_evacuators_[i].migration_slots_buffer_address());
+  }
   for (int i = 0; i < npages; i++) {
     Page* p = evacuation_candidates_[i];
     if (!p->IsEvacuationCandidate()) continue;
     PagedSpace* space = static_cast<PagedSpace*>(p->owner());
     space->Free(p->area_start(), p->area_size());
     p->set_scan_on_scavenge(false);
+    p->ReleaseSlotSet();
     slots_buffer_allocator_.DeallocateChain(p->slots_buffer_address());
     p->ResetLiveBytes();
     space->ReleasePage(p);
@@ -3865,6 +4708,25 @@ static inline Address StartOfLiveObject(Address block_address, uint32_t cell) {
 }
 
 
+enum SweepingParallelism {
+  SWEEP_SEQUENTIALLY,
+  SWEEP_IN_PARALLEL
+};
+
+
+template<SweepingParallelism mode>
+static inline intptr_t Free(PagedSpace* space,
+                            FreeList* free_list,
+                            Address start,
+                            int size) {
+  if (mode == SWEEP_SEQUENTIALLY) {
+    return space->Free(start, size);
+  } else {
+    return size - free_list->Free(start, size);
+  }
+}
+
+
 // Sweeps a space conservatively.  After this has been done the larger free
 // spaces have been put on the free list and the smaller ones have been
 // ignored and left untouched.  A free space is always either ignored or put
@@ -3872,10 +4734,18 @@ static inline Address StartOfLiveObject(Address block_address, uint32_t cell) {
 // because it means that any FreeSpace maps left actually describe a region of
 // memory that can be ignored when scanning.  Dead objects other than free
 // spaces will not contain the free space map.
-intptr_t MarkCompactCollector::SweepConservatively(PagedSpace* space, Page* p) {
+//
+// When sweeping in parallel the free spaces are put on the given free list
+// instead, and updating the page flags, the live bytes and the space's
+// accounting is left to the main thread.
+template<SweepingParallelism mode>
+static intptr_t SweepConservativelyInMode(PagedSpace* space,
+                                          FreeList* free_list,
+                                          Page* p) {
   ASSERT(!p->IsEvacuationCandidate() && !p->WasSwept());
+  ASSERT((mode == SWEEP_IN_PARALLEL) == (free_list != NULL));
   MarkBit::CellType* cells = p->markbits()->cells();
-  p->MarkSweptConservatively();
+  if (mode == SWEEP_SEQUENTIALLY) p->MarkSweptConservatively();
 
   int last_cell_index =
       Bitmap::IndexToCell(
@@ -3900,8 +4770,8 @@ intptr_t MarkCompactCollector::SweepConservatively(PagedSpace* space, Page* p) {
   }
   size_t size = block_address - p->area_start();
   if (cell_index == last_cell_index) {
-    freed_bytes += static_cast<int>(space->Free(p->area_start(),
-                                                static_cast<int>(size)));
+    freed_bytes += Free<mode>(space, free_list, p->area_start(),
+                              static_cast<int>(size));
     ASSERT_EQ(0, p->LiveBytes());
     return freed_bytes;
   }
@@ -3910,8 +4780,8 @@ intptr_t MarkCompactCollector::SweepConservatively(PagedSpace* space, Page* p) {
   Address free_end = StartOfLiveObject(block_address, cells[cell_index]);
   // Free the first free space.
   size = free_end - p->area_start();
-  freed_bytes += space->Free(p->area_start(),
-                             static_cast<int>(size));
+  freed_bytes += Free<mode>(space, free_list, p->area_start(),
+                            static_cast<int>(size));
   // The start of the current free area is represented in undigested form by
   // the address of the last 32-word section that contained a live object and
   // the marking bitmap for that cell, which describes where the live object
@@ -3940,8 +4810,8 @@ intptr_t MarkCompactCollector::SweepConservatively(PagedSpace* space, Page* p) {
           // so now we need to find the start of the first live object at the
           // end of the free space.
           free_end = StartOfLiveObject(block_address, cell);
-          freed_bytes += space->Free(free_start,
-                                     static_cast<int>(free_end - free_start));
+          freed_bytes += Free<mode>(space, free_list, free_start,
+                                    static_cast<int>(free_end - free_start));
         }
       }
       // Update our undigested record of where the current free area started.
@@ -3955,18 +4825,30 @@ intptr_t MarkCompactCollector::SweepConservatively(PagedSpace* space, Page* p) {
   // Handle the free space at the end of the page.
   if (block_address - free_start > 32 * kPointerSize) {
     free_start = DigestFreeStart(free_start, free_start_cell);
-    freed_bytes += space->Free(free_start,
-                               static_cast<int>(block_address - free_start));
+    freed_bytes += Free<mode>(space, free_list, free_start,
+                              static_cast<int>(block_address - free_start));
   }
 
-  p->ResetLiveBytes();
+  if (mode == SWEEP_SEQUENTIALLY) p->ResetLiveBytes();
   return freed_bytes;
 }
 
 
+intptr_t MarkCompactCollector::SweepConservatively(PagedSpace* space, Page* p) {
+  return SweepConservativelyInMode<SWEEP_SEQUENTIALLY>(space, NULL, p);
+}
+
+
+intptr_t MarkCompactCollector::SweepConservativelyInParallel(
+    PagedSpace* space, FreeList* free_list, Page* p) {
+  return SweepConservativelyInMode<SWEEP_IN_PARALLEL>(space, free_list, p);
+}
+
+
 void MarkCompactCollector::SweepSpace(PagedSpace* space, SweeperType sweeper) {
   space->set_was_swept_conservatively(sweeper == CONSERVATIVE ||
-                                      sweeper == LAZY_CONSERVATIVE);
+                                      sweeper == LAZY_CONSERVATIVE ||
+                                      sweeper == CONCURRENT_CONSERVATIVE);
 
   space->ClearStats();
 
@@ -4048,6 +4930,16 @@ void MarkCompactCollector::SweepSpace(PagedSpace* space, SweeperType sweeper) {
         }
         break;
       }
+      case CONCURRENT_CONSERVATIVE: {
+        if (FLAG_gc_verbose) {
+          PrintF("Sweeping 0x%" V8PRIxPTR " concurrently.\n",
+                 reinterpret_cast<intptr_t>(p));
+        }
+        if (space->IsSweepingComplete()) space->SetPagesToSweep(p);
+        p->set_parallel_sweeping(MemoryChunk::PARALLEL_SWEEPING_PENDING);
+        space->IncreaseUnsweptFreeBytes(p);
+        break;
+      }
       case PRECISE: {
         if (FLAG_gc_verbose) {
           PrintF("Sweeping 0x%" V8PRIxPTR " precisely.\n",
@@ -4085,6 +4977,7 @@ void MarkCompactCollector::SweepSpaces() {
 #endif
   SweeperType how_to_sweep =
       FLAG_lazy_sweeping ? LAZY_CONSERVATIVE : CONSERVATIVE;
+  if (AreSweeperThreadsActivated()) how_to_sweep = CONCURRENT_CONSERVATIVE;
   if (FLAG_expose_gc) how_to_sweep = CONSERVATIVE;
   if (sweep_precisely_) how_to_sweep = PRECISE;
   // Noncompacting collections simply sweep the spaces to clear the mark
@@ -4095,6 +4988,11 @@ void MarkCompactCollector::SweepSpaces() {
   SweepSpace(heap()->old_pointer_space(), how_to_sweep);
   SweepSpace(heap()->old_data_space(), how_to_sweep);
 
+  // The old space pages are queued for the sweeper threads now, so that
+  // allocations during evacuation claim pages properly, but the threads are
+  // only started once evacuation no longer releases pages.
+  if (how_to_sweep == CONCURRENT_CONSERVATIVE) sweeping_pending_ = true;
+
   RemoveDeadInvalidatedCode();
   SweepSpace(heap()->code_space(), PRECISE);
 
@@ -4109,6 +5007,71 @@ void MarkCompactCollector::SweepSpaces() {
 
   // Deallocate unmarked objects and clear marked bits for marked objects.
   heap_->lo_space()->FreeUnmarkedObjects();
+
+  if (IsConcurrentSweepingInProgress()) StartSweeperThreads();
+}
+
+
+bool MarkCompactCollector::AreSweeperThreadsActivated() {
+  return heap()->isolate()->sweeper_threads() != NULL;
+}
+
+
+void MarkCompactCollector::StartSweeperThreads() {
+  ASSERT(sweeping_pending_ && !sweeper_threads_started_);
+  SweeperThread** threads = heap()->isolate()->sweeper_threads();
+  for (int i = 0; i < heap()->isolate()->num_sweeper_threads(); i++) {
+    threads[i]->StartSweeping();
+  }
+  sweeper_threads_started_ = true;
+}
+
+
+void MarkCompactCollector::WaitUntilSweepingCompleted() {
+  ASSERT(sweeping_pending_);
+  if (sweeper_threads_started_) {
+    SweeperThread** threads = heap()->isolate()->sweeper_threads();
+    for (int i = 0; i < heap()->isolate()->num_sweeper_threads(); i++) {
+      threads[i]->WaitForSweeperThread();
+    }
+    sweeper_threads_started_ = false;
+  }
+  // Pages nobody has claimed yet are swept here, all others are finalized.
+  heap()->old_pointer_space()->AdvanceConcurrentSweeper(kMaxInt);
+  heap()->old_data_space()->AdvanceConcurrentSweeper(kMaxInt);
+  ASSERT(heap()->IsSweepingComplete());
+  sweeping_pending_ = false;
+}
+
+
+intptr_t MarkCompactCollector::StealMemoryFromSweeperThreads(
+    PagedSpace* space) {
+  intptr_t freed_bytes = 0;
+  SweeperThread** threads = heap()->isolate()->sweeper_threads();
+  for (int i = 0; i < heap()->isolate()->num_sweeper_threads(); i++) {
+    freed_bytes += threads[i]->StealMemory(space);
+  }
+  return freed_bytes;
+}
+
+
+void MarkCompactCollector::SweepInParallel(PagedSpace* space,
+                                           FreeList* private_free_list,
+                                           FreeList* free_list,
+                                           Mutex* free_list_mutex) {
+  PageIterator it(space);
+  while (it.has_next()) {
+    Page* p = it.next();
+    if (!p->TryParallelSweeping()) continue;
+    SweepConservativelyInParallel(space, private_free_list, p);
+    {
+      ScopedLock lock(free_list_mutex);
+      free_list->Concatenate(private_free_list);
+    }
+    // The free memory of the page has to be visible to the main thread
+    // before the page can be finalized.
+    p->set_parallel_sweeping(MemoryChunk::PARALLEL_SWEEPING_FINALIZE);
+  }
 }
 
 
@@ -29,6 +29,7 @@
 #define V8_MARK_COMPACT_H_
 
 #include "compiler-intrinsics.h"
+#include "hashmap.h"
 #include "spaces.h"
 
 namespace v8 {
@@ -185,6 +186,8 @@ class MarkingDeque {
 
   inline bool IsEmpty() { return top_ == bottom_; }
 
+  inline int Length() { return (top_ - bottom_) & mask_; }
+
   bool overflowed() const { return overflowed_; }
 
   void ClearOverflowed() { overflowed_ = false; }
@@ -254,6 +257,140 @@ class MarkingDeque {
 };
 
 
+// ----------------------------------------------------------------------------
+// Marking deque used by parallel marking.  Every marker owns one deque and
+// pushes and pops objects on its private end without synchronization.  When
+// the private part grows large a batch of objects is published to a shared
+// part that idle markers can steal from.
+class WorkStealingMarkingDeque {
+ public:
+  WorkStealingMarkingDeque() : mutex_(OS::CreateMutex()) {
+    NoBarrier_Store(&shared_length_, 0);
+  }
+
+  ~WorkStealingMarkingDeque() { delete mutex_; }
+
+  inline void Push(HeapObject* object) {
+    ASSERT(object->IsHeapObject());
+    private_.Add(object);
+    if (private_.length() > kPublishThreshold) Publish();
+  }
+
+  // Pops an object from the private part, refilling it from the shared part
+  // if necessary.  Returns false if this deque has no work left.
+  inline bool Pop(HeapObject** object) {
+    if (private_.is_empty() && !Refill()) return false;
+    *object = private_.RemoveLast();
+    if (private_.length() > kPublishThreshold) Publish();
+    return true;
+  }
+
+  // Moves half of the published objects of this deque into the private part
+  // of the thief.  Returns false if there was nothing to steal.
+  bool StealInto(WorkStealingMarkingDeque* thief);
+
+  bool HasSharedWork() { return NoBarrier_Load(&shared_length_) > 0; }
+
+  bool IsEmpty() { return private_.is_empty() && !HasSharedWork(); }
+
+  void Clear() {
+    private_.Clear();
+    shared_.Clear();
+    NoBarrier_Store(&shared_length_, 0);
+  }
+
+ private:
+  static const int kPublishThreshold = 64;
+  static const int kPublishBatchSize = 32;
+
+  void Publish();
+  bool Refill();
+
+  List<HeapObject*> private_;
+  List<HeapObject*> shared_;
+  volatile Atomic32 shared_length_;
+  Mutex* mutex_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkStealingMarkingDeque);
+};
+
+
+// Per-thread state of a parallel marker.  Objects that cannot be visited
+// concurrently are deferred to the main thread together with the slots that
+// have to be recorded for evacuation candidates.
+class ParallelMarker {
+ public:
+  ParallelMarker() { }
+
+  WorkStealingMarkingDeque* marking_deque() { return &marking_deque_; }
+  List<HeapObject*>* deferred_objects() { return &deferred_objects_; }
+  List<Object**>* recorded_slots() { return &recorded_slots_; }
+  List<HeapObject*>* marked_ephemeron_keys() {
+    return &marked_ephemeron_keys_;
+  }
+
+ private:
+  WorkStealingMarkingDeque marking_deque_;
+  List<HeapObject*> deferred_objects_;
+  List<Object**> recorded_slots_;
+  List<HeapObject*> marked_ephemeron_keys_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelMarker);
+};
+
+
+// Weak map entries (ephemerons) whose key was not marked yet when their
+// weak map was visited.  They are indexed by key, so that the value of an
+// entry can be marked as soon as its key is marked, without rescanning the
+// backing tables of all encountered weak maps until a fixed point is reached.
+class EphemeronTable {
+ public:
+  EphemeronTable();
+
+  bool IsEmpty() { return keys_.occupancy() == 0; }
+
+  // Records that the value of the given table entry is live once its key is.
+  void Add(HeapObject* key, ObjectHashTable* table, int entry);
+
+  // Returns whether ephemerons with the given key are pending.  Only reads
+  // the table, so parallel markers may call it while the main thread waits.
+  bool HasKey(HeapObject* object);
+
+  // Makes the ephemerons with the given key ready to have their values
+  // marked.  Does nothing if the object is not the key of any ephemeron.
+  void KeyMarked(HeapObject* key);
+
+  // Returns the next ephemeron whose key has been marked.
+  bool PopReady(ObjectHashTable** table, int* entry);
+
+  void Clear();
+
+ private:
+  struct Ephemeron {
+    ObjectHashTable* table;
+    int entry;
+    // Index of the next ephemeron with the same key or -1.
+    int next;
+  };
+
+  static uint32_t Hash(HeapObject* key) {
+    return ComputePointerHash(key);
+  }
+
+  static bool KeysMatch(void* key1, void* key2) { return key1 == key2; }
+
+  // Maps keys to the index of their most recently added ephemeron.
+  HashMap keys_;
+  List<Ephemeron> ephemerons_;
+  // Indices of the most recently added ephemerons of marked keys.
+  List<int> ready_;
+  // Next ephemeron to pop in the chain at the end of ready_.
+  int ready_chain_;
+
+  DISALLOW_COPY_AND_ASSIGN(EphemeronTable);
+};
+
+
 class SlotsBufferAllocator {
  public:
   SlotsBuffer* AllocateBuffer(SlotsBuffer* next_buffer);
@@ -383,6 +520,39 @@ class SlotsBuffer {
 };
 
 
+// Per-thread state of a parallel evacuator.  Live objects are moved into
+// linear allocation buffers that are refilled from the target space under
+// the collector's evacuation mutex.  Slots pointing to new space and slots
+// that need updating after evacuation are recorded locally and handed to
+// the main thread once the evacuation round is over.
+class ParallelEvacuator {
+ public:
+  ParallelEvacuator() : migration_slots_buffer_(NULL) { }
+
+  AllocationInfo* allocation_buffer(AllocationSpace space) {
+    ASSERT(space == OLD_POINTER_SPACE || space == OLD_DATA_SPACE);
+    if (space == OLD_POINTER_SPACE) return &old_pointer_buffer_;
+    return &old_data_buffer_;
+  }
+
+  SlotsBuffer** migration_slots_buffer_address() {
+    return &migration_slots_buffer_;
+  }
+
+  List<Address>* new_space_slots() { return &new_space_slots_; }
+  List<Page*>* abandoned_pages() { return &abandoned_pages_; }
+
+ private:
+  AllocationInfo old_pointer_buffer_;
+  AllocationInfo old_data_buffer_;
+  SlotsBuffer* migration_slots_buffer_;
+  List<Address> new_space_slots_;
+  List<Page*> abandoned_pages_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelEvacuator);
+};
+
+
 // -------------------------------------------------------------------------
 // Marker shared between incremental and non-incremental marking
 template<class BaseMarker> class Marker {
@@ -457,6 +627,14 @@ class MarkCompactCollector {
 
   void AddEvacuationCandidate(Page* p);
 
+  // Evacuation speed assumed until the first evacuation has been measured.
+  static const intptr_t kInitialEvacuationSpeedInBytesPerMs = 256 * KB;
+
+  // Running estimate of how many live bytes are evacuated per millisecond.
+  intptr_t evacuation_speed_in_bytes_per_ms() {
+    return evacuation_speed_in_bytes_per_ms_;
+  }
+
   // Prepares for GC by resetting relocation info in old and map spaces and
   // choosing spaces to compact.
   void Prepare(GCTracer* tracer);
@@ -502,6 +680,7 @@ class MarkCompactCollector {
   enum SweeperType {
     CONSERVATIVE,
     LAZY_CONSERVATIVE,
+    CONCURRENT_CONSERVATIVE,
     PRECISE
   };
 
@@ -515,6 +694,32 @@ class MarkCompactCollector {
   // Return a number of reclaimed bytes.
   static intptr_t SweepConservatively(PagedSpace* space, Page* p);
 
+  // Variant of SweepConservatively used by the sweeper threads.  Free space
+  // is put on the given free list, and the page flags, live bytes and space
+  // accounting are left untouched for the main thread to update.
+  static intptr_t SweepConservativelyInParallel(PagedSpace* space,
+                                                FreeList* free_list,
+                                                Page* p);
+
+  // Sweeps the pending pages of the given space that are not claimed by
+  // another thread yet.  Called on the sweeper threads.
+  void SweepInParallel(PagedSpace* space,
+                       FreeList* private_free_list,
+                       FreeList* free_list,
+                       Mutex* free_list_mutex);
+
+  // True if old space pages are waiting for or being swept by the sweeper
+  // threads.
+  bool IsConcurrentSweepingInProgress() { return sweeping_pending_; }
+
+  // Waits for the sweeper threads to finish and finalizes all pages of the
+  // current concurrent sweeping round.
+  void WaitUntilSweepingCompleted();
+
+  // Moves the free memory found by the sweeper threads so far to the free
+  // list of the given space.  Returns the number of bytes moved.
+  intptr_t StealMemoryFromSweeperThreads(PagedSpace* space);
+
   INLINE(static bool ShouldSkipEvacuationSlotRecording(Object** anchor)) {
     return Page::FromAddress(reinterpret_cast<Address>(anchor))->
         ShouldSkipEvacuationSlotRecording();
@@ -556,10 +761,14 @@ class MarkCompactCollector {
 
   INLINE(void RecordSlot(Object** anchor_slot, Object** slot, Object* object));
 
+  // Moves an object and records the slots of the copy that have to be
+  // visited later.  Parallel evacuators pass their own state so that
+  // nothing shared is written.
   void MigrateObject(Address dst,
                      Address src,
                      int size,
-                     AllocationSpace to_old_space);
+                     AllocationSpace to_old_space,
+                     ParallelEvacuator* evacuator = NULL);
 
   bool TryPromoteObject(HeapObject* object, int object_size);
 
@@ -568,13 +777,30 @@ class MarkCompactCollector {
     encountered_weak_maps_ = weak_map;
   }
 
+  EphemeronTable* ephemerons() { return &ephemerons_; }
+
   void InvalidateCode(Code* code);
 
   void ClearMarkbits();
 
   bool is_compacting() const { return compacting_; }
 
+  // Marks the transitive closure of the objects on the work-stealing deque
+  // of the given parallel marker.  Called on the main thread (worker 0) and
+  // on all marking threads during a parallel marking round.
+  void MarkInParallel(int worker_id);
+
+  // Performs the share of the current parallel compaction round for the
+  // given worker.  Called on the main thread (worker 0) and on the
+  // compaction threads.
+  void CompactInParallel(int worker_id);
+
  private:
+  enum ParallelCompactionTask {
+    EVACUATE_CANDIDATES,
+    UPDATE_STORE_BUFFER,
+    UPDATE_SLOTS_BUFFERS
+  };
   MarkCompactCollector();
   ~MarkCompactCollector();
 
@@ -606,6 +832,15 @@ class MarkCompactCollector {
 
   bool abort_incremental_marking_;
 
+  intptr_t evacuation_speed_in_bytes_per_ms_;
+
+  // Chooses the pages with the least live bytes first, as long as their
+  // evacuation fits into --evacuation-time-budget-ms and into the free space
+  // of the pages that are not evacuated.
+  void CollectEvacuationCandidatesWithinBudget(PagedSpace* space);
+
+  void UpdateEvacuationSpeed(intptr_t bytes_evacuated, double duration_in_ms);
+
   // True if we are collecting slots to perform evacuation from evacuation
   // candidates.
   bool compacting_;
@@ -614,6 +849,12 @@ class MarkCompactCollector {
 
   bool flush_monomorphic_ics_;
 
+  // True while a concurrent sweeping round has pages that are not finalized.
+  bool sweeping_pending_;
+
+  // True once the sweeper threads were started for the current round.
+  bool sweeper_threads_started_;
+
   // A pointer to the current stack-allocated GC tracer object during a full
   // collection (NULL before and after).
   GCTracer* tracer_;
@@ -706,6 +947,24 @@ class MarkCompactCollector {
   // overflow flag will be set.
   void EmptyMarkingDeque();
 
+  // Returns whether the transitive closure can be computed by several
+  // marking threads.
+  bool IsParallelMarkingEnabled();
+
+  // Distributes the marking stack over the parallel markers and computes
+  // the transitive closure on all marking threads.  Objects and slots that
+  // need sequential treatment are processed afterwards, possibly refilling
+  // the marking stack.
+  void ProcessMarkingDequeInParallel();
+
+  // Steals objects from another parallel marker.  Returns false if there
+  // was nothing to steal.
+  bool StealMarkingWork(int worker_id);
+
+  // Waits until either all parallel markers ran out of work (returns true)
+  // or some marker published objects that can be stolen (returns false).
+  bool ParallelMarkingDone();
+
   // Refill the marking stack with overflowed objects from the heap.  This
   // function either leaves the marking stack full or clears the overflow
   // flag on the marking stack.
@@ -731,10 +990,16 @@ class MarkCompactCollector {
   // ClearNonLiveTransitions pass or by calling this function.
   void ReattachInitialMaps();
 
-  // Mark all values associated with reachable keys in weak maps encountered
-  // so far.  This might push new object or even new weak maps onto the
-  // marking stack.
-  void ProcessWeakMaps();
+  // Marks the values of the entries of a newly encountered weak map whose
+  // keys are already marked and records the other entries as ephemerons.
+  void DiscoverEphemerons(ObjectHashTable* table);
+
+  // Marks the values of the ephemerons whose keys have been marked since
+  // the last call.  This might push new objects or even new weak maps onto
+  // the marking stack.
+  void ProcessEphemerons();
+
+  void MarkEphemeronValue(ObjectHashTable* table, int entry);
 
   // After all reachable objects have been marked those weak map entries
   // with an unreachable key are removed from all encountered weak maps.
@@ -757,16 +1022,51 @@ class MarkCompactCollector {
   // regions to each space's free list.
   void SweepSpaces();
 
+  void CollectAllocationSiteFeedback();
+
   void EvacuateNewSpace();
 
-  void EvacuateLiveObjectsFromPage(Page* p);
+  void EvacuateLiveObjectsFromPage(Page* p,
+                                   ParallelEvacuator* evacuator = NULL);
 
   void EvacuatePages();
 
+  // Gives up on evacuating the page, it is swept and its pointers are
+  // updated after evacuation instead.
+  void AbandonEvacuationCandidate(Page* page);
+
+  bool IsParallelCompactionEnabled();
+
+  // Number of workers available for a parallel compaction task, the main
+  // thread included.
+  int ParallelCompactionWorkers();
+
+  // Runs the given task on the main thread and on |workers| - 1 compaction
+  // threads and waits for all of them.
+  void RunParallelCompactionTask(ParallelCompactionTask task, int workers);
+
+  void EvacuatePagesInParallel();
+
+  HeapObject* AllocateForParallelEvacuation(PagedSpace* space,
+                                            int size,
+                                            ParallelEvacuator* evacuator);
+
+  void ReleaseParallelEvacuationBuffers(ParallelEvacuator* evacuator);
+
+  void UpdateStoreBufferInParallel();
+
+  // Updates the slots recorded in the given chains and in the slots buffers
+  // of all evacuated candidates.
+  void UpdateSlotsBuffersInParallel(bool code_slots_filtering_required);
+
   void EvacuateNewSpaceAndCandidates();
 
   void SweepSpace(PagedSpace* space, SweeperType sweeper);
 
+  bool AreSweeperThreadsActivated();
+
+  void StartSweeperThreads();
+
 #ifdef DEBUG
   friend class MarkObjectVisitor;
   static void VisitObject(HeapObject* obj);
@@ -777,10 +1077,26 @@ class MarkCompactCollector {
 
   Heap* heap_;
   MarkingDeque marking_deque_;
+  ParallelMarker* parallel_markers_;
+  int parallel_markers_count_;
+  volatile Atomic32 idle_parallel_markers_;
   CodeFlusher* code_flusher_;
   Object* encountered_weak_maps_;
+  EphemeronTable ephemerons_;
   Marker<MarkCompactCollector> marker_;
 
+  ParallelEvacuator* parallel_evacuators_;
+  int parallel_evacuators_count_;
+  ParallelCompactionTask parallel_compaction_task_;
+  // Work items of the current parallel compaction round, claimed by
+  // incrementing next_parallel_work_item_.
+  List<Page*> parallel_evacuation_pages_;
+  List<SlotsBuffer*> parallel_slots_buffers_;
+  bool parallel_slots_filtering_required_;
+  volatile Atomic32 next_parallel_work_item_;
+  // Serializes allocation in the old spaces during parallel evacuation.
+  Mutex* evacuation_mutex_;
+
   List<Page*> evacuation_candidates_;
   List<Code*> invalidated_code_;
 
@@ -0,0 +1,152 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "v8.h"
+
+#include "memory-reducer.h"
+
+#include "heap.h"
+
+namespace v8 {
+namespace internal {
+
+MemoryReducer::MemoryReducer(Heap* heap)
+    : heap_(heap),
+      state_(DONE),
+      next_gc_start_ms_(0),
+      started_gcs_(0),
+      committed_memory_after_last_reduction_(0),
+      last_allocation_counter_(0),
+      last_idle_ms_(0) {
+  memset(&stats_before_, 0, sizeof(stats_before_));
+  memset(&stats_after_, 0, sizeof(stats_after_));
+}
+
+
+void MemoryReducer::NotifyMarkCompact() {
+  if (!FLAG_memory_reducer || state_ == RUN) return;
+  if (state_ == WAIT) {
+    // The mutator is still busy enough to trigger collections on its own.
+    StartWaiting(kLongDelayMs);
+  } else if (heap_->CommittedMemory() >
+             committed_memory_after_last_reduction_ + kCommittedMemoryDelta) {
+    started_gcs_ = 0;
+    StartWaiting(kLongDelayMs);
+  }
+}
+
+
+bool MemoryReducer::NotifyIdle(bool full_gc_fits) {
+  return NotifyIdle(full_gc_fits, OS::TimeCurrentMillis());
+}
+
+
+bool MemoryReducer::NotifyIdle(bool full_gc_fits, double now) {
+  if (!FLAG_memory_reducer) return false;
+
+  intptr_t allocation_counter = heap_->NewSpaceAllocationCounter();
+  bool low_allocation_rate =
+      (allocation_counter - last_allocation_counter_) <
+      kLowAllocationRateInBytesPerMs * (now - last_idle_ms_);
+  last_allocation_counter_ = allocation_counter;
+  last_idle_ms_ = now;
+
+  if (state_ != WAIT || now < next_gc_start_ms_ || !full_gc_fits) {
+    return false;
+  }
+  if (!low_allocation_rate) {
+    StartWaiting(kLongDelayMs);
+    return false;
+  }
+  RunGC();
+  return true;
+}
+
+
+void MemoryReducer::StartWaiting(double delay_ms) {
+  state_ = WAIT;
+  next_gc_start_ms_ = OS::TimeCurrentMillis() + delay_ms;
+}
+
+
+void MemoryReducer::RunGC() {
+  state_ = RUN;
+  started_gcs_++;
+  RecordSpaceStats(&stats_before_);
+  intptr_t committed_before = heap_->CommittedMemory();
+
+  heap_->CollectAllGarbage(Heap::kReduceMemoryFootprintMask,
+                           "memory reducer");
+  heap_->ReleaseUnusedMemory();
+
+  RecordSpaceStats(&stats_after_);
+  intptr_t committed_after = heap_->CommittedMemory();
+  if (FLAG_trace_memory_reducer) PrintSpaceStats();
+
+  if (started_gcs_ < kMaxNumberOfGCs &&
+      committed_before - committed_after >= kMinReleasedMemory) {
+    StartWaiting(kShortDelayMs);
+  } else {
+    state_ = DONE;
+    committed_memory_after_last_reduction_ = committed_after;
+  }
+}
+
+
+void MemoryReducer::RecordSpaceStats(SpaceStats* stats) {
+  stats->committed[NEW_SPACE] = heap_->new_space()->CommittedMemory();
+  stats->used[NEW_SPACE] = heap_->new_space()->SizeOfObjects();
+  PagedSpaces spaces;
+  for (PagedSpace* space = spaces.next();
+       space != NULL;
+       space = spaces.next()) {
+    stats->committed[space->identity()] = space->CommittedMemory();
+    stats->used[space->identity()] = space->SizeOfObjects();
+  }
+  stats->committed[LO_SPACE] = heap_->lo_space()->CommittedMemory();
+  stats->used[LO_SPACE] = heap_->lo_space()->SizeOfObjects();
+}
+
+
+void MemoryReducer::PrintSpaceStats() {
+  static const char* const kSpaceNames[LAST_SPACE + 1] = {
+    "New space", "Old pointers", "Old data space", "Code space",
+    "Map space", "Cell space", "Large object space"
+  };
+  PrintPID("Memory reducer GC #%d\n", started_gcs_);
+  for (int i = FIRST_SPACE; i <= LAST_SPACE; i++) {
+    PrintPID("%-19s committed: %6" V8_PTR_PREFIX "d -> %6" V8_PTR_PREFIX "d KB"
+             ", used: %6" V8_PTR_PREFIX "d -> %6" V8_PTR_PREFIX "d KB\n",
+             kSpaceNames[i],
+             stats_before_.committed[i] / KB,
+             stats_after_.committed[i] / KB,
+             stats_before_.used[i] / KB,
+             stats_after_.used[i] / KB);
+  }
+}
+
+} }  // namespace v8::internal
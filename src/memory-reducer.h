@@ -0,0 +1,125 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef V8_MEMORY_REDUCER_H_
+#define V8_MEMORY_REDUCER_H_
+
+#include "v8globals.h"
+
+namespace v8 {
+namespace internal {
+
+class Heap;
+
+// The memory reducer gives memory back to the system once the embedder's
+// load drops after a phase of heavy allocation.  It watches the allocation
+// rate and the idle notifications of the embedder and runs a few well-spaced
+// full collections that release empty pages, shrink and uncommit the
+// semispaces and merge the free blocks of the code range.
+//
+// States and transitions:
+//   DONE: nothing to do.  A mark-compact that leaves noticeably more memory
+//     committed than after the last reduction starts waiting.
+//   WAIT: waiting until next_gc_start_ms_.  Then a collection is run on the
+//     next idle notification if the allocation rate is low, otherwise the
+//     start is postponed.
+//   RUN: a collection of the reducer is in progress.  If it released enough
+//     memory and the maximum number of collections is not reached, the
+//     reducer waits for a short delay, otherwise it is done.
+class MemoryReducer {
+ public:
+  enum State {
+    DONE,
+    WAIT,
+    RUN
+  };
+
+  // Committed and used bytes of each space.
+  struct SpaceStats {
+    intptr_t committed[LAST_SPACE + 1];
+    intptr_t used[LAST_SPACE + 1];
+  };
+
+  explicit MemoryReducer(Heap* heap);
+
+  // Called after every mark-compact collection.
+  void NotifyMarkCompact();
+
+  // Called on idle notifications.  Returns true if a collection was run.
+  // The reducer only runs a collection if a full collection fits into the
+  // idle time.
+  bool NotifyIdle(bool full_gc_fits);
+  // Same as above with the given current time; used by tests.
+  bool NotifyIdle(bool full_gc_fits, double now);
+
+  State state() { return state_; }
+  int started_gcs() { return started_gcs_; }
+
+  // Space statistics recorded around the last collection of the reducer.
+  const SpaceStats& stats_before_last_gc() { return stats_before_; }
+  const SpaceStats& stats_after_last_gc() { return stats_after_; }
+
+  // Delay before the first collection after load dropped.
+  static const int kLongDelayMs = 8000;
+  // Delay between the collections of one reduction.
+  static const int kShortDelayMs = 500;
+  // Maximum number of collections of one reduction.
+  static const int kMaxNumberOfGCs = 3;
+  // Allocation rates below this count as low.
+  static const intptr_t kLowAllocationRateInBytesPerMs = 1 * KB;
+  // Committed memory has to grow at least this much before a reduction is
+  // considered again.
+  static const intptr_t kCommittedMemoryDelta = 4 * MB;
+  // A collection that releases less memory ends the reduction.
+  static const intptr_t kMinReleasedMemory = 1 * MB;
+
+ private:
+  void StartWaiting(double delay_ms);
+  void RunGC();
+  void RecordSpaceStats(SpaceStats* stats);
+  void PrintSpaceStats();
+
+  Heap* heap_;
+  State state_;
+  double next_gc_start_ms_;
+  int started_gcs_;
+  intptr_t committed_memory_after_last_reduction_;
+
+  // Allocation counter and time of the last idle notification, used to
+  // compute the allocation rate.
+  intptr_t last_allocation_counter_;
+  double last_idle_ms_;
+
+  SpaceStats stats_before_;
+  SpaceStats stats_after_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryReducer);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_MEMORY_REDUCER_H_
@@ -329,15 +329,77 @@ void FastNewBlockContextStub::Generate(MacroAssembler* masm) {
 }
 
 
+// Replaces an allocation site in boilerplate by the boilerplate it tracks.
+// Sites are copied here without tracking, except for every n-th copy, which
+// the runtime tracks.  Copies of a site that decided to tenure continue at
+// tenured.
+static void GenerateLoadSiteBoilerplate(MacroAssembler* masm,
+                                        Register boilerplate,
+                                        Register scratch1,
+                                        Register scratch2,
+                                        Label* slow_case,
+                                        Label* tenured) {
+  Label done;
+  __ lw(scratch1, FieldMemOperand(boilerplate, HeapObject::kMapOffset));
+  __ LoadRoot(scratch2, Heap::kAllocationSiteMapRootIndex);
+  __ Branch(&done, ne, scratch1, Operand(scratch2));
+  __ lw(scratch1,
+        FieldMemOperand(boilerplate, AllocationSite::kCopyCountOffset));
+  __ Addu(scratch1, scratch1, Operand(Smi::FromInt(1)));
+  __ sw(scratch1,
+        FieldMemOperand(boilerplate, AllocationSite::kCopyCountOffset));
+  __ Branch(slow_case, ge, scratch1,
+            Operand(Smi::FromInt(AllocationSite::kStubSampleInterval)));
+  __ lw(scratch1, FieldMemOperand(boilerplate,
+                                  AllocationSite::kPretenureDecisionOffset));
+  __ lw(boilerplate,
+        FieldMemOperand(boilerplate, AllocationSite::kBoilerplateOffset));
+  __ Branch(tenured, eq, scratch1,
+            Operand(Smi::FromInt(AllocationSite::kTenure)));
+  __ bind(&done);
+}
+
+
+// Enters the fields of object between start_offset and end_offset that
+// point to new space into the store buffer.  Used for copies allocated in
+// old space, which are filled without a write barrier.
+static void GenerateRecordNewSpaceFields(MacroAssembler* masm,
+                                         Register object,
+                                         int start_offset,
+                                         int end_offset,
+                                         Register value,
+                                         Register address) {
+  for (int i = start_offset; i < end_offset; i += kPointerSize) {
+    Label skip;
+    __ lw(value, FieldMemOperand(object, i));
+    __ JumpIfSmi(value, &skip);
+    __ JumpIfNotInNewSpace(value, address, &skip);
+    __ Addu(address, object, Operand(i - kHeapObjectTag));
+    __ RememberedSetHelper(object, address, value, kDontSaveFPRegs,
+                           MacroAssembler::kFallThroughAtEnd);
+    __ bind(&skip);
+  }
+}
+
+
 static void GenerateFastCloneShallowArrayCommon(
     MacroAssembler* masm,
     int length,
     FastCloneShallowArrayStub::Mode mode,
+    PretenureFlag pretenure,
     Label* fail) {
   // Registers on entry:
   // a3: boilerplate literal array.
   ASSERT(mode != FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS);
 
+  // Double arrays belong in old data space, leave them to the runtime.
+  if (pretenure == TENURED &&
+      mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS &&
+      length > 0) {
+    __ Branch(fail);
+    return;
+  }
+
   // All sizes here are multiples of kPointerSize.
   int elements_size = 0;
   if (length > 0) {
@@ -349,12 +411,16 @@ static void GenerateFastCloneShallowArrayCommon(
 
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
   __ AllocateInNewSpace(size,
                         v0,
                         a1,
                         a2,
                         fail,
-                        TAG_OBJECT);
+                        flags);
 
   // Copy the JS array part.
   for (int i = 0; i < JSArray::kSize; i += kPointerSize) {
@@ -375,63 +441,62 @@ static void GenerateFastCloneShallowArrayCommon(
     ASSERT((elements_size % kPointerSize) == 0);
     __ CopyFields(a2, a3, a1.bit(), elements_size / kPointerSize);
   }
-}
 
-void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
-  // Stack layout on entry:
-  //
-  // [sp]: constant elements.
-  // [sp + kPointerSize]: literal index.
-  // [sp + (2 * kPointerSize)]: literals array.
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, v0, JSObject::kPropertiesOffset,
+                                 JSArray::kSize, a1, a3);
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
+      __ Addu(a2, v0, Operand(JSArray::kSize));
+      GenerateRecordNewSpaceFields(masm, a2, FixedArray::kHeaderSize,
+                                   elements_size, a1, a3);
+    }
+  }
+}
 
-  // Load boilerplate object into r3 and check if we need to create a
-  // boilerplate.
-  Label slow_case;
-  __ lw(a3, MemOperand(sp, 2 * kPointerSize));
-  __ lw(a0, MemOperand(sp, 1 * kPointerSize));
-  __ Addu(a3, a3, Operand(FixedArray::kHeaderSize - kHeapObjectTag));
-  __ sll(t0, a0, kPointerSizeLog2 - kSmiTagSize);
-  __ Addu(t0, a3, t0);
-  __ lw(a3, MemOperand(t0));
-  __ LoadRoot(t1, Heap::kUndefinedValueRootIndex);
-  __ Branch(&slow_case, eq, a3, Operand(t1));
 
-  FastCloneShallowArrayStub::Mode mode = mode_;
-  if (mode == CLONE_ANY_ELEMENTS) {
+static void GenerateFastCloneShallowArray(MacroAssembler* masm,
+                                          int length,
+                                          FastCloneShallowArrayStub::Mode mode,
+                                          PretenureFlag pretenure,
+                                          Label* fail) {
+  // a3 is boilerplate object.
+  if (mode == FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS) {
     Label double_elements, check_fast_elements;
     __ lw(v0, FieldMemOperand(a3, JSArray::kElementsOffset));
     __ lw(v0, FieldMemOperand(v0, HeapObject::kMapOffset));
     __ LoadRoot(t1, Heap::kFixedCOWArrayMapRootIndex);
     __ Branch(&check_fast_elements, ne, v0, Operand(t1));
-    GenerateFastCloneShallowArrayCommon(masm, 0,
-                                        COPY_ON_WRITE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, 0, FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS, pretenure,
+        fail);
     // Return and remove the on-stack parameters.
     __ DropAndRet(3);
 
     __ bind(&check_fast_elements);
     __ LoadRoot(t1, Heap::kFixedArrayMapRootIndex);
     __ Branch(&double_elements, ne, v0, Operand(t1));
-    GenerateFastCloneShallowArrayCommon(masm, length_,
-                                        CLONE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, length, FastCloneShallowArrayStub::CLONE_ELEMENTS, pretenure,
+        fail);
     // Return and remove the on-stack parameters.
     __ DropAndRet(3);
 
     __ bind(&double_elements);
-    mode = CLONE_DOUBLE_ELEMENTS;
+    mode = FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS;
     // Fall through to generate the code to handle double elements.
   }
 
   if (FLAG_debug_code) {
     const char* message;
     Heap::RootListIndex expected_map_index;
-    if (mode == CLONE_ELEMENTS) {
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
       message = "Expected (writable) fixed array";
       expected_map_index = Heap::kFixedArrayMapRootIndex;
-    } else if (mode == CLONE_DOUBLE_ELEMENTS) {
+    } else if (mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS) {
       message = "Expected (writable) fixed double array";
       expected_map_index = Heap::kFixedDoubleArrayMapRootIndex;
     } else {
-      ASSERT(mode == COPY_ON_WRITE_ELEMENTS);
+      ASSERT(mode == FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS);
       message = "Expected copy-on-write fixed array";
       expected_map_index = Heap::kFixedCOWArrayMapRootIndex;
     }
@@ -443,16 +508,79 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
     __ pop(a3);
   }
 
-  GenerateFastCloneShallowArrayCommon(masm, length_, mode, &slow_case);
+  GenerateFastCloneShallowArrayCommon(masm, length, mode, pretenure, fail);
 
   // Return and remove the on-stack parameters.
   __ DropAndRet(3);
+}
+
+
+void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
+  // Stack layout on entry:
+  //
+  // [sp]: constant elements.
+  // [sp + kPointerSize]: literal index.
+  // [sp + (2 * kPointerSize)]: literals array.
+
+  // Load boilerplate object into r3 and check if we need to create a
+  // boilerplate.
+  Label slow_case, tenured;
+  __ lw(a3, MemOperand(sp, 2 * kPointerSize));
+  __ lw(a0, MemOperand(sp, 1 * kPointerSize));
+  __ Addu(a3, a3, Operand(FixedArray::kHeaderSize - kHeapObjectTag));
+  __ sll(t0, a0, kPointerSizeLog2 - kSmiTagSize);
+  __ Addu(t0, a3, t0);
+  __ lw(a3, MemOperand(t0));
+  __ LoadRoot(t1, Heap::kUndefinedValueRootIndex);
+  __ Branch(&slow_case, eq, a3, Operand(t1));
+  GenerateLoadSiteBoilerplate(
+      masm, a3, v0, t1, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  GenerateFastCloneShallowArray(masm, length_, mode_, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowArray(masm, length_, mode_, TENURED, &slow_case);
+  }
 
   __ bind(&slow_case);
   __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
 }
 
 
+static void GenerateFastCloneShallowObject(MacroAssembler* masm,
+                                           int size,
+                                           PretenureFlag pretenure,
+                                           Label* fail) {
+  // a3 is boilerplate object.
+
+  // Check that the boilerplate contains only fast properties and we can
+  // statically determine the instance size.
+  __ lw(a0, FieldMemOperand(a3, HeapObject::kMapOffset));
+  __ lbu(a0, FieldMemOperand(a0, Map::kInstanceSizeOffset));
+  __ Branch(fail, ne, a0, Operand(size >> kPointerSizeLog2));
+
+  // Allocate the JS object and copy header together with all in-object
+  // properties from the boilerplate.
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
+  __ AllocateInNewSpace(size, v0, a1, a2, fail, flags);
+  for (int i = 0; i < size; i += kPointerSize) {
+    __ lw(a1, FieldMemOperand(a3, i));
+    __ sw(a1, FieldMemOperand(v0, i));
+  }
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, v0, JSObject::kPropertiesOffset, size,
+                                 a1, a3);
+  }
+
+  // Return and remove the on-stack parameters.
+  __ DropAndRet(4);
+}
+
+
 void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
   // Stack layout on entry:
   //
@@ -463,7 +591,7 @@ void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
 
   // Load boilerplate object into a3 and check if we need to create a
   // boilerplate.
-  Label slow_case;
+  Label slow_case, tenured;
   __ lw(a3, MemOperand(sp, 3 * kPointerSize));
   __ lw(a0, MemOperand(sp, 2 * kPointerSize));
   __ Addu(a3, a3, Operand(FixedArray::kHeaderSize - kHeapObjectTag));
@@ -472,25 +600,17 @@ void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
   __ lw(a3, MemOperand(a3));
   __ LoadRoot(t0, Heap::kUndefinedValueRootIndex);
   __ Branch(&slow_case, eq, a3, Operand(t0));
+  GenerateLoadSiteBoilerplate(
+      masm, a3, a0, t0, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
 
-  // Check that the boilerplate contains only fast properties and we can
-  // statically determine the instance size.
   int size = JSObject::kHeaderSize + length_ * kPointerSize;
-  __ lw(a0, FieldMemOperand(a3, HeapObject::kMapOffset));
-  __ lbu(a0, FieldMemOperand(a0, Map::kInstanceSizeOffset));
-  __ Branch(&slow_case, ne, a0, Operand(size >> kPointerSizeLog2));
-
-  // Allocate the JS object and copy header together with all in-object
-  // properties from the boilerplate.
-  __ AllocateInNewSpace(size, v0, a1, a2, &slow_case, TAG_OBJECT);
-  for (int i = 0; i < size; i += kPointerSize) {
-    __ lw(a1, FieldMemOperand(a3, i));
-    __ sw(a1, FieldMemOperand(v0, i));
+  GenerateFastCloneShallowObject(masm, size, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowObject(masm, size, TENURED, &slow_case);
   }
 
-  // Return and remove the on-stack parameters.
-  __ DropAndRet(4);
-
   __ bind(&slow_case);
   __ TailCallRuntime(Runtime::kCreateObjectLiteralShallow, 4, 1);
 }
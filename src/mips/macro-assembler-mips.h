@@ -62,7 +62,9 @@ enum AllocationFlags {
   RESULT_CONTAINS_TOP = 1 << 1,
   // Specify that the requested size of the space to allocate is specified in
   // words instead of bytes.
-  SIZE_IN_WORDS = 1 << 2
+  SIZE_IN_WORDS = 1 << 2,
+  // Allocate in old pointer space instead of new space.
+  PRETENURE_OLD_POINTER_SPACE = 1 << 3
 };
 
 // Flags used for the ObjectToDoubleFPURegister function.
@@ -348,6 +348,23 @@ void AliasedArgumentsEntry::AliasedArgumentsEntryVerify() {
 }
 
 
+void AllocationSite::AllocationSiteVerify() {
+  CHECK(IsAllocationSite());
+  CHECK(boilerplate()->IsJSObject());
+  VerifySmiField(kMementoCreateCountOffset);
+  VerifySmiField(kMementoFoundCountOffset);
+  VerifySmiField(kPretenureDecisionOffset);
+  VerifySmiField(kFeedbackGCCountOffset);
+  VerifySmiField(kCopyCountOffset);
+}
+
+
+void AllocationMemento::AllocationMementoVerify() {
+  CHECK(IsAllocationMemento());
+  CHECK(allocation_site()->IsAllocationSite());
+}
+
+
 void FixedArray::FixedArrayVerify() {
   for (int i = 0; i < length(); i++) {
     Object* e = get(i);
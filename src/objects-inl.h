@@ -5277,6 +5277,28 @@ ACCESSORS(TypeFeedbackInfo, type_feedback_cells, TypeFeedbackCells,
 SMI_ACCESSORS(AliasedArgumentsEntry, aliased_context_slot, kAliasedContextSlot)
 
 
+ACCESSORS(AllocationSite, boilerplate, JSObject, kBoilerplateOffset)
+SMI_ACCESSORS(AllocationSite, memento_create_count, kMementoCreateCountOffset)
+SMI_ACCESSORS(AllocationSite, memento_found_count, kMementoFoundCountOffset)
+SMI_ACCESSORS(AllocationSite, feedback_gc_count, kFeedbackGCCountOffset)
+SMI_ACCESSORS(AllocationSite, copy_count, kCopyCountOffset)
+
+
+AllocationSite::PretenureDecision AllocationSite::pretenure_decision() {
+  return static_cast<PretenureDecision>(
+      Smi::cast(READ_FIELD(this, kPretenureDecisionOffset))->value());
+}
+
+
+void AllocationSite::set_pretenure_decision(PretenureDecision decision) {
+  WRITE_FIELD(this, kPretenureDecisionOffset, Smi::FromInt(decision));
+}
+
+
+ACCESSORS(AllocationMemento, allocation_site, AllocationSite,
+          kAllocationSiteOffset)
+
+
 Relocatable::Relocatable(Isolate* isolate) {
   ASSERT(isolate == Isolate::Current());
   isolate_ = isolate;
@@ -12665,6 +12665,41 @@ void ObjectHashTable::RemoveEntry(int entry) {
 }
 
 
+void AllocationSite::DigestFeedback(int gc_count) {
+  if (gc_count == feedback_gc_count()) return;
+  int created = memento_create_count();
+  if (created >= kMinimumCreatedCount) {
+    int found = memento_found_count();
+    PretenureDecision decision =
+        found * 100 >= created * kTenureSurvivalPercent ? kTenure
+                                                        : kDontTenure;
+    if (FLAG_trace_pretenuring) {
+      PrintF("[AllocationSite %p: %d of %d copies survived, %s]\n",
+             reinterpret_cast<void*>(this),
+             found,
+             created,
+             decision == kTenure ? "tenure" : "don't tenure");
+    }
+    set_pretenure_decision(decision);
+    set_memento_create_count(0);
+    set_memento_found_count(0);
+  }
+  set_feedback_gc_count(gc_count);
+}
+
+
+bool AllocationSite::TrackNextCopy() {
+  if (pretenure_decision() != kTenure) {
+    set_copy_count(0);
+    return true;
+  }
+  int count = copy_count() + 1;
+  if (count >= kTenuredSampleInterval) count = 0;
+  set_copy_count(count);
+  return count == 0;
+}
+
+
 #ifdef ENABLE_DEBUGGER_SUPPORT
 // Check if there is a break point at this code position.
 bool DebugInfo::HasBreakPoint(int code_position) {
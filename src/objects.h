@@ -266,6 +266,8 @@ const int kStubMinorKeyBits = kBitsPerInt - kSmiTagSize - kStubMajorKeyBits;
   V(POLYMORPHIC_CODE_CACHE_TYPE)                                               \
   V(TYPE_FEEDBACK_INFO_TYPE)                                                   \
   V(ALIASED_ARGUMENTS_ENTRY_TYPE)                                              \
+  V(ALLOCATION_SITE_TYPE)                                                      \
+  V(ALLOCATION_MEMENTO_TYPE)                                                   \
                                                                                \
   V(FIXED_ARRAY_TYPE)                                                          \
   V(FIXED_DOUBLE_ARRAY_TYPE)                                                   \
@@ -417,7 +419,9 @@ const int kStubMinorKeyBits = kBitsPerInt - kSmiTagSize - kStubMajorKeyBits;
   V(CODE_CACHE, CodeCache, code_cache)                                         \
   V(POLYMORPHIC_CODE_CACHE, PolymorphicCodeCache, polymorphic_code_cache)      \
   V(TYPE_FEEDBACK_INFO, TypeFeedbackInfo, type_feedback_info)                  \
-  V(ALIASED_ARGUMENTS_ENTRY, AliasedArgumentsEntry, aliased_arguments_entry)
+  V(ALIASED_ARGUMENTS_ENTRY, AliasedArgumentsEntry, aliased_arguments_entry)  \
+  V(ALLOCATION_SITE, AllocationSite, allocation_site)                          \
+  V(ALLOCATION_MEMENTO, AllocationMemento, allocation_memento)
 
 #ifdef ENABLE_DEBUGGER_SUPPORT
 #define STRUCT_LIST_DEBUGGER(V)                                                \
@@ -574,6 +578,8 @@ enum InstanceType {
   POLYMORPHIC_CODE_CACHE_TYPE,
   TYPE_FEEDBACK_INFO_TYPE,
   ALIASED_ARGUMENTS_ENTRY_TYPE,
+  ALLOCATION_SITE_TYPE,
+  ALLOCATION_MEMENTO_TYPE,
   // The following two instance types are only used when ENABLE_DEBUGGER_SUPPORT
   // is defined. However as include/v8.h contain some of the instance type
   // constants always having them avoids them getting different numbers
@@ -6911,6 +6917,111 @@ class AliasedArgumentsEntry: public Struct {
 };
 
 
+// An allocation site tracks the copies of an object or array literal
+// boilerplate to decide whether they should be allocated in old space right
+// away.  While a site is tracked it takes the place of the boilerplate in
+// the literals array of the function, so that the copies are made by the
+// runtime.  Copies allocated in new space are followed by an
+// AllocationMemento pointing back to the site, which lets the garbage
+// collector count the copies that survive.
+class AllocationSite: public Struct {
+ public:
+  enum PretenureDecision {
+    kUndecided = 0,
+    kDontTenure = 1,
+    kTenure = 2
+  };
+
+  // Number of tracked copies needed before a decision is made.
+  static const int kMinimumCreatedCount = 100;
+  // Copies are tenured if at least this percentage survives.
+  static const int kTenureSurvivalPercent = 85;
+  // Every n-th copy of a tenured site is still allocated in new space to
+  // notice when the copies stop surviving.
+  static const int kTenuredSampleInterval = 8;
+  // The fast cloning stubs copy sites without tracking, in old space if the
+  // site decided to tenure, and leave every n-th copy to the runtime.  They
+  // count their copies in copy_count.
+  static const int kStubSampleInterval = 8;
+
+  DECL_ACCESSORS(boilerplate, JSObject)
+  inline int memento_create_count();
+  inline void set_memento_create_count(int count);
+  inline int memento_found_count();
+  inline void set_memento_found_count(int count);
+  inline PretenureDecision pretenure_decision();
+  inline void set_pretenure_decision(PretenureDecision decision);
+  // Value of the garbage collection counter when the current feedback
+  // started to be collected.
+  inline int feedback_gc_count();
+  inline void set_feedback_gc_count(int count);
+  inline int copy_count();
+  inline void set_copy_count(int count);
+
+  // Updates the decision from the feedback collected so far.  Feedback is
+  // only complete once a garbage collection happened since it was started,
+  // otherwise nothing is done.
+  void DigestFeedback(int gc_count);
+
+  // Returns whether the next copy is tracked by an allocation memento.
+  // Copies that are not tracked are allocated in old space.
+  bool TrackNextCopy();
+
+  static inline AllocationSite* cast(Object* obj);
+
+#ifdef OBJECT_PRINT
+  inline void AllocationSitePrint() {
+    AllocationSitePrint(stdout);
+  }
+  void AllocationSitePrint(FILE* out);
+#endif
+#ifdef DEBUG
+  void AllocationSiteVerify();
+#endif
+
+  static const int kBoilerplateOffset = HeapObject::kHeaderSize;
+  static const int kMementoCreateCountOffset =
+      kBoilerplateOffset + kPointerSize;
+  static const int kMementoFoundCountOffset =
+      kMementoCreateCountOffset + kPointerSize;
+  static const int kPretenureDecisionOffset =
+      kMementoFoundCountOffset + kPointerSize;
+  static const int kFeedbackGCCountOffset =
+      kPretenureDecisionOffset + kPointerSize;
+  static const int kCopyCountOffset = kFeedbackGCCountOffset + kPointerSize;
+  static const int kSize = kCopyCountOffset + kPointerSize;
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(AllocationSite);
+};
+
+
+// Placed right behind a tracked copy of a literal in new space.  Mementos
+// are never referenced, they only live until the next garbage collection.
+class AllocationMemento: public Struct {
+ public:
+  DECL_ACCESSORS(allocation_site, AllocationSite)
+
+  static inline AllocationMemento* cast(Object* obj);
+
+#ifdef OBJECT_PRINT
+  inline void AllocationMementoPrint() {
+    AllocationMementoPrint(stdout);
+  }
+  void AllocationMementoPrint(FILE* out);
+#endif
+#ifdef DEBUG
+  void AllocationMementoVerify();
+#endif
+
+  static const int kAllocationSiteOffset = HeapObject::kHeaderSize;
+  static const int kSize = kAllocationSiteOffset + kPointerSize;
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(AllocationMemento);
+};
+
+
 enum AllowNullsFlag {ALLOW_NULLS, DISALLOW_NULLS};
 enum RobustnessFlag {ROBUST_STRING_TRAVERSAL, FAST_STRING_TRAVERSAL};
 
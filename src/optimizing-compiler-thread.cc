@@ -37,89 +37,289 @@ namespace v8 {
 namespace internal {
 
 
-void OptimizingCompilerThread::Run() {
+OptimizingCompilerThread::Worker::Worker(OptimizingCompilerThread* pool,
+                                         int id)
+    : Thread("OptimizingCompilerThread"),
+      pool_(pool),
+      id_(id),
+      jobs_compiled_(0),
+      time_spent_compiling_(0),
+      time_spent_total_(0),
+      time_spent_queued_(0),
+      max_time_spent_queued_(0) {
+#ifdef DEBUG
+  thread_id_ = ThreadId::Invalid().ToInteger();
+#endif
+}
+
+
+void OptimizingCompilerThread::Worker::Run() {
 #ifdef DEBUG
   thread_id_ = ThreadId::Current().ToInteger();
 #endif
-  Isolate::SetIsolateThreadLocals(isolate_, NULL);
+  Isolate* isolate = pool_->isolate_;
+  Isolate::SetIsolateThreadLocals(isolate, NULL);
 
   int64_t epoch = 0;
   if (FLAG_trace_parallel_recompilation) epoch = OS::Ticks();
 
   while (true) {
-    input_queue_semaphore_->Wait();
-    if (Acquire_Load(&stop_thread_)) {
-      stop_semaphore_->Signal();
+    pool_->input_queue_semaphore_->Wait();
+    if (Acquire_Load(&pool_->stop_thread_)) {
       if (FLAG_trace_parallel_recompilation) {
         time_spent_total_ = OS::Ticks() - epoch;
       }
+      pool_->stop_semaphore_->Signal();
       return;
     }
 
-    int64_t compiling_start = 0;
-    if (FLAG_trace_parallel_recompilation) compiling_start = OS::Ticks();
+    Job job;
+    if (!pool_->DequeueJob(&job)) continue;
 
-    Heap::RelocationLock relocation_lock(isolate_->heap());
-    OptimizingCompiler* optimizing_compiler = NULL;
-    input_queue_.Dequeue(&optimizing_compiler);
-    Barrier_AtomicIncrement(&queue_length_, static_cast<Atomic32>(-1));
+    int64_t compiling_start = 0;
+    if (FLAG_trace_parallel_recompilation) {
+      compiling_start = OS::Ticks();
+      int64_t queued = compiling_start - job.queued_at();
+      time_spent_queued_ += queued;
+      max_time_spent_queued_ = Max(max_time_spent_queued_, queued);
+    }
 
-    ASSERT(!optimizing_compiler->info()->closure()->IsOptimized());
+    OptimizingCompiler* optimizing_compiler = job.compiler();
+    { Heap::SharedRelocationLock relocation_lock(isolate->heap());
+      ASSERT(!optimizing_compiler->info()->closure()->IsOptimized());
 
-    OptimizingCompiler::Status status = optimizing_compiler->OptimizeGraph();
-    ASSERT(status != OptimizingCompiler::FAILED);
-    // Prevent an unused-variable error in release mode.
-    USE(status);
+      OptimizingCompiler::Status status = optimizing_compiler->OptimizeGraph();
+      ASSERT(status != OptimizingCompiler::FAILED);
+      // Prevent an unused-variable error in release mode.
+      USE(status);
+    }
 
-    output_queue_.Enqueue(optimizing_compiler);
-    isolate_->stack_guard()->RequestCodeReadyEvent();
+    pool_->AddOutput(optimizing_compiler);
+    isolate->stack_guard()->RequestCodeReadyEvent();
 
     if (FLAG_trace_parallel_recompilation) {
       time_spent_compiling_ += OS::Ticks() - compiling_start;
+      jobs_compiled_++;
     }
   }
 }
 
 
+OptimizingCompilerThread::OptimizingCompilerThread(Isolate* isolate)
+    : isolate_(isolate),
+      workers_(NULL),
+      num_workers_(0),
+      stop_semaphore_(OS::CreateSemaphore(0)),
+      input_queue_semaphore_(OS::CreateSemaphore(0)),
+      input_queue_mutex_(OS::CreateMutex()),
+      output_queue_mutex_(OS::CreateMutex()),
+      jobs_cancelled_(0),
+      blocked_jobs_(0) {
+  NoBarrier_Store(&stop_thread_, static_cast<AtomicWord>(false));
+  NoBarrier_Store(&queue_length_, static_cast<AtomicWord>(0));
+}
+
+
+OptimizingCompilerThread::~OptimizingCompilerThread() {
+  for (int i = 0; i < num_workers_; i++) delete workers_[i];
+  delete[] workers_;
+  delete output_queue_mutex_;
+  delete input_queue_mutex_;
+  delete input_queue_semaphore_;
+  delete stop_semaphore_;
+}
+
+
+void OptimizingCompilerThread::Start() {
+  ASSERT(num_workers_ == 0);
+  int num_workers = Max(1, FLAG_parallel_recompilation_threads);
+  workers_ = new Worker*[num_workers];
+  for (int i = 0; i < num_workers; i++) {
+    workers_[i] = new Worker(this, i);
+  }
+  // The threads look each other up in IsOptimizerThread.
+  num_workers_ = num_workers;
+  for (int i = 0; i < num_workers_; i++) {
+    workers_[i]->Start();
+  }
+}
+
+
 void OptimizingCompilerThread::Stop() {
   Release_Store(&stop_thread_, static_cast<AtomicWord>(true));
-  input_queue_semaphore_->Signal();
-  stop_semaphore_->Wait();
+  for (int i = 0; i < num_workers_; i++) input_queue_semaphore_->Signal();
+  for (int i = 0; i < num_workers_; i++) stop_semaphore_->Wait();
 
   if (FLAG_trace_parallel_recompilation) {
-    double compile_time = static_cast<double>(time_spent_compiling_);
-    double total_time = static_cast<double>(time_spent_total_);
-    double percentage = (compile_time * 100) / total_time;
-    PrintF("  ** Compiler thread did %.2f%% useful work\n", percentage);
+    for (int i = 0; i < num_workers_; i++) {
+      Worker* worker = workers_[i];
+      double compile_time = static_cast<double>(worker->time_spent_compiling());
+      double total_time = static_cast<double>(worker->time_spent_total());
+      double percentage = (compile_time * 100) / total_time;
+      int jobs = worker->jobs_compiled();
+      double average_queued = jobs == 0 ? 0 :
+          static_cast<double>(worker->time_spent_queued()) / jobs / 1000;
+      PrintF("  ** Compiler thread %d did %.2f%% useful work: "
+             "%d function(s) in %.2f ms, "
+             "queued %.2f ms on average and %.2f ms at most\n",
+             worker->id(),
+             percentage,
+             jobs,
+             compile_time / 1000,
+             average_queued,
+             static_cast<double>(worker->max_time_spent_queued()) / 1000);
+    }
+    PrintF("  ** Cancelled %d stale function(s).\n", jobs_cancelled_);
   }
 }
 
 
 void OptimizingCompilerThread::InstallOptimizedFunctions() {
+  // Without parallel recompilation there is nothing to install.
+  if (num_workers_ == 0) return;
   HandleScope handle_scope(isolate_);
+  CancelStaleJobs();
+
+  // Take the whole batch at once so that the threads are not held up by
+  // the installation.
+  List<OptimizingCompiler*> batch;
+  { ScopedLock lock(output_queue_mutex_);
+    batch.AddAll(output_queue_);
+    output_queue_.Clear();
+  }
+
   int functions_installed = 0;
-  while (!output_queue_.IsEmpty()) {
-    OptimizingCompiler* compiler = NULL;
-    output_queue_.Dequeue(&compiler);
+  for (int i = 0; i < batch.length(); i++) {
+    OptimizingCompiler* compiler = batch[i];
+    if (IsStale(compiler)) {
+      CancelJob(compiler);
+      continue;
+    }
     Compiler::InstallOptimizedCode(compiler);
     functions_installed++;
   }
-  if (FLAG_trace_parallel_recompilation && functions_installed != 0) {
-    PrintF("  ** Installed %d function(s).\n", functions_installed);
+  if (FLAG_trace_parallel_recompilation && batch.length() != 0) {
+    PrintF("  ** Installed %d function(s), cancelled %d.\n",
+           functions_installed,
+           batch.length() - functions_installed);
   }
 }
 
 
 void OptimizingCompilerThread::QueueForOptimization(
+    OptimizingCompiler* optimizing_compiler,
+    int priority) {
+  ASSERT(!IsOptimizerThread());
+  int64_t queued_at = 0;
+  if (FLAG_trace_parallel_recompilation) queued_at = OS::Ticks();
+  { ScopedLock lock(input_queue_mutex_);
+    input_queue_.Add(Job(optimizing_compiler, priority, queued_at));
+  }
+  Barrier_AtomicIncrement(&queue_length_, static_cast<Atomic32>(1));
+  if (FLAG_block_parallel_recompilation) {
+    blocked_jobs_++;
+  } else {
+    input_queue_semaphore_->Signal();
+  }
+}
+
+
+void OptimizingCompilerThread::Unblock() {
+  ASSERT(!IsOptimizerThread());
+  while (blocked_jobs_ > 0) {
+    input_queue_semaphore_->Signal();
+    blocked_jobs_--;
+  }
+}
+
+
+bool OptimizingCompilerThread::IsQueueAvailable() {
+  // This can be queried only from the execution thread.
+  ASSERT(!IsOptimizerThread());
+  // Since only the execution thread increments queue_length_ and only one
+  // thread can run inside an Isolate at one time, the length can only
+  // decrease before the next job is queued.
+  int limit = FLAG_parallel_recompilation_queue_length;
+  if (NoBarrier_Load(&queue_length_) < limit) return true;
+  CancelStaleJobs();
+  return NoBarrier_Load(&queue_length_) < limit;
+}
+
+
+bool OptimizingCompilerThread::DequeueJob(Job* job) {
+  ScopedLock lock(input_queue_mutex_);
+  if (input_queue_.is_empty()) return false;
+  // The queue is short, a linear search for the hottest job is enough.  The
+  // first of equally hot jobs was queued first.
+  int best = 0;
+  for (int i = 1; i < input_queue_.length(); i++) {
+    if (input_queue_[i].priority() > input_queue_[best].priority()) best = i;
+  }
+  *job = input_queue_.Remove(best);
+  Barrier_AtomicIncrement(&queue_length_, static_cast<Atomic32>(-1));
+  return true;
+}
+
+
+void OptimizingCompilerThread::AddOutput(
+    OptimizingCompiler* optimizing_compiler) {
+  ScopedLock lock(output_queue_mutex_);
+  output_queue_.Add(optimizing_compiler);
+}
+
+
+bool OptimizingCompilerThread::IsStale(
+    OptimizingCompiler* optimizing_compiler) {
+  ASSERT(!IsOptimizerThread());
+  Handle<JSFunction> closure = optimizing_compiler->info()->closure();
+  return !closure->IsInRecompileQueue() ||
+      closure->shared()->optimization_disabled();
+}
+
+
+void OptimizingCompilerThread::CancelJob(
     OptimizingCompiler* optimizing_compiler) {
-  input_queue_.Enqueue(optimizing_compiler);
-  input_queue_semaphore_->Signal();
+  CompilationInfo* info = optimizing_compiler->info();
+  Handle<JSFunction> closure = info->closure();
+  if (closure->IsInRecompileQueue()) {
+    closure->ReplaceCode(closure->shared()->code());
+  }
+  // The compiler lives in the zone of the compilation info.
+  delete info;
+  jobs_cancelled_++;
 }
 
+
+void OptimizingCompilerThread::CancelStaleJobs() {
+  List<OptimizingCompiler*> stale;
+  { ScopedLock lock(input_queue_mutex_);
+    int i = 0;
+    while (i < input_queue_.length()) {
+      if (IsStale(input_queue_[i].compiler())) {
+        stale.Add(input_queue_.Remove(i).compiler());
+        Barrier_AtomicIncrement(&queue_length_, static_cast<Atomic32>(-1));
+      } else {
+        i++;
+      }
+    }
+  }
+  // The semaphore was signalled for the cancelled jobs, so a thread may
+  // wake up to an empty queue.
+  for (int i = 0; i < stale.length(); i++) CancelJob(stale[i]);
+  if (FLAG_trace_parallel_recompilation && !stale.is_empty()) {
+    PrintF("  ** Cancelled %d queued function(s).\n", stale.length());
+  }
+}
+
+
 #ifdef DEBUG
 bool OptimizingCompilerThread::IsOptimizerThread() {
   if (!FLAG_parallel_recompilation) return false;
-  return ThreadId::Current().ToInteger() == thread_id_;
+  int current = ThreadId::Current().ToInteger();
+  for (int i = 0; i < num_workers_; i++) {
+    if (workers_[i]->thread_id() == current) return true;
+  }
+  return false;
 }
 #endif
 
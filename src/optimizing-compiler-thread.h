@@ -31,7 +31,7 @@
 #include "atomicops.h"
 #include "platform.h"
 #include "flags.h"
-#include "unbound-queue.h"
+#include "list.h"
 
 namespace v8 {
 namespace internal {
@@ -39,61 +39,120 @@ namespace internal {
 class HGraphBuilder;
 class OptimizingCompiler;
 
-class OptimizingCompilerThread : public Thread {
+// Runs the graph optimization of parallel recompilation on a pool of
+// --parallel-recompilation-threads threads.  Queued functions are taken by
+// the threads in the order of their profiler ticks, hottest first.  The
+// results are installed in batches by the execution thread when it handles
+// the CODE_READY interrupt.  Jobs whose function was optimized or had its
+// optimization disabled in the meantime are cancelled.
+class OptimizingCompilerThread {
  public:
-  explicit OptimizingCompilerThread(Isolate *isolate) :
-      Thread("OptimizingCompilerThread"),
-      isolate_(isolate),
-      stop_semaphore_(OS::CreateSemaphore(0)),
-      input_queue_semaphore_(OS::CreateSemaphore(0)),
-      time_spent_compiling_(0),
-      time_spent_total_(0) {
-    NoBarrier_Store(&stop_thread_, static_cast<AtomicWord>(false));
-    NoBarrier_Store(&queue_length_, static_cast<AtomicWord>(0));
-  }
-
-  void Run();
+  explicit OptimizingCompilerThread(Isolate *isolate);
+  ~OptimizingCompilerThread();
+
+  void Start();
   void Stop();
-  void QueueForOptimization(OptimizingCompiler* optimizing_compiler);
+
+  // Queues a job with the given priority, higher priorities are compiled
+  // first.
+  void QueueForOptimization(OptimizingCompiler* optimizing_compiler,
+                            int priority);
   void InstallOptimizedFunctions();
 
-  inline bool IsQueueAvailable() {
-    // We don't need a barrier since we have a data dependency right
-    // after.
-    Atomic32 current_length = NoBarrier_Load(&queue_length_);
+  // Whether another job can be queued.  Cancels stale jobs to make room if
+  // the queue is full.  This can be queried only from the execution thread.
+  bool IsQueueAvailable();
 
-    // This can be queried only from the execution thread.
-    ASSERT(!IsOptimizerThread());
-    // Since only the execution thread increments queue_length_ and
-    // only one thread can run inside an Isolate at one time, a direct
-    // doesn't introduce a race -- queue_length_ may decreased in
-    // meantime, but not increased.
-    return (current_length < FLAG_parallel_recompilation_queue_length);
-  }
+  // Hands the jobs that --block-parallel-recompilation held back to the
+  // threads.
+  void Unblock();
 
 #ifdef DEBUG
   bool IsOptimizerThread();
 #endif
 
-  ~OptimizingCompilerThread() {
-    delete input_queue_semaphore_;
-    delete stop_semaphore_;
-  }
-
  private:
+  class Job {
+   public:
+    Job() : compiler_(NULL), priority_(0), queued_at_(0) { }
+    Job(OptimizingCompiler* compiler, int priority, int64_t queued_at)
+        : compiler_(compiler), priority_(priority), queued_at_(queued_at) { }
+
+    OptimizingCompiler* compiler() const { return compiler_; }
+    int priority() const { return priority_; }
+    int64_t queued_at() const { return queued_at_; }
+
+   private:
+    OptimizingCompiler* compiler_;
+    int priority_;
+    int64_t queued_at_;
+  };
+
+  class Worker : public Thread {
+   public:
+    Worker(OptimizingCompilerThread* pool, int id);
+
+    void Run();
+
+    int id() const { return id_; }
+#ifdef DEBUG
+    int thread_id() const { return thread_id_; }
+#endif
+
+    // Statistics for --trace-parallel-recompilation.
+    int jobs_compiled() const { return jobs_compiled_; }
+    int64_t time_spent_compiling() const { return time_spent_compiling_; }
+    int64_t time_spent_total() const { return time_spent_total_; }
+    int64_t time_spent_queued() const { return time_spent_queued_; }
+    int64_t max_time_spent_queued() const { return max_time_spent_queued_; }
+
+   private:
+    OptimizingCompilerThread* pool_;
+    int id_;
+    int jobs_compiled_;
+    int64_t time_spent_compiling_;
+    int64_t time_spent_total_;
+    int64_t time_spent_queued_;
+    int64_t max_time_spent_queued_;
+#ifdef DEBUG
+    int thread_id_;
+#endif
+  };
+
+  // Removes the queued job with the highest priority.  Returns false if
+  // the queue is empty because its jobs were cancelled.
+  bool DequeueJob(Job* job);
+
+  void AddOutput(OptimizingCompiler* optimizing_compiler);
+
+  // Whether the job is no longer wanted because its function was
+  // optimized, left the recompile queue, or had its optimization disabled.
+  bool IsStale(OptimizingCompiler* optimizing_compiler);
+
+  // Drops a job that is not installed and restores the unoptimized code.
+  void CancelJob(OptimizingCompiler* optimizing_compiler);
+
+  // Cancels the stale jobs that are still waiting for a thread.
+  void CancelStaleJobs();
+
   Isolate* isolate_;
+  Worker** workers_;
+  int num_workers_;
   Semaphore* stop_semaphore_;
   Semaphore* input_queue_semaphore_;
-  UnboundQueue<OptimizingCompiler*> input_queue_;
-  UnboundQueue<OptimizingCompiler*> output_queue_;
+  // Protects input_queue_.
+  Mutex* input_queue_mutex_;
+  List<Job> input_queue_;
+  // Protects output_queue_.
+  Mutex* output_queue_mutex_;
+  List<OptimizingCompiler*> output_queue_;
   volatile AtomicWord stop_thread_;
   volatile Atomic32 queue_length_;
-  int64_t time_spent_compiling_;
-  int64_t time_spent_total_;
+  int jobs_cancelled_;
+  // Jobs queued without signalling input_queue_semaphore_.
+  int blocked_jobs_;
 
-#ifdef DEBUG
-  int thread_id_;
-#endif
+  friend class Worker;
 };
 
 } }  // namespace v8::internal
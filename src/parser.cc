@@ -265,6 +265,25 @@ Handle<String> Parser::LookupSymbol(int symbol_id) {
 }
 
 
+void Parser::InternalizeSymbols() {
+  // The symbols were recorded off the heap, possibly on another thread, in
+  // symbol id order.  Look them all up in one pass so that parsing only has
+  // to index the symbol cache.
+  ASSERT(symbol_cache_.is_empty());
+  Factory* factory = isolate()->factory();
+  int symbol_count = pre_data()->symbol_count();
+  for (int i = 0; i < symbol_count; i++) {
+    bool is_ascii;
+    Vector<const byte> literal;
+    if (!pre_data()->ReadSymbolContents(&is_ascii, &literal)) break;
+    Handle<String> symbol = is_ascii
+        ? factory->LookupAsciiSymbol(Vector<const char>::cast(literal))
+        : factory->LookupTwoByteSymbol(Vector<const uc16>::cast(literal));
+    symbol_cache_.Add(symbol, zone());
+  }
+}
+
+
 Handle<String> Parser::LookupCachedSymbol(int symbol_id) {
   // Make sure the cache is large enough to hold the symbol identifier.
   if (symbol_cache_.length() <= symbol_id) {
@@ -304,7 +323,25 @@ FunctionEntry ScriptDataImpl::GetFunctionEntry(int start) {
 
 
 int ScriptDataImpl::GetSymbolIdentifier() {
-  return ReadNumber(&symbol_data_);
+  return ReadNumber(&symbol_data_, symbol_data_end_);
+}
+
+
+bool ScriptDataImpl::ReadSymbolContents(bool* is_ascii,
+                                        Vector<const byte>* literal) {
+  int header = ReadNumber(&symbol_contents_, symbol_contents_end_);
+  if (header < 0) return false;
+  *is_ascii = (header & 1) != 0;
+  int size = (header >> 1) * (*is_ascii ? kCharSize : kUC16Size);
+  if (!*is_ascii &&
+      (symbol_contents_ - reinterpret_cast<byte*>(store_.start())) %
+          kUC16Size != 0) {
+    symbol_contents_++;
+  }
+  if (size > symbol_contents_end_ - symbol_contents_) return false;
+  *literal = Vector<const byte>(symbol_contents_, size);
+  symbol_contents_ += size;
+  return true;
 }
 
 
@@ -352,6 +389,11 @@ bool ScriptDataImpl::SanityCheck() {
   int minimum_size =
       PreparseDataConstants::kHeaderSize + functions_size;
   if (store_.length() < minimum_size) return false;
+  // Check that the symbol contents, if any, fit after the function entries.
+  int contents_size = static_cast<int>(
+      store_[PreparseDataConstants::kSymbolContentsSizeOffset]);
+  if (contents_size < 0) return false;
+  if (store_.length() - minimum_size < contents_size) return false;
   return true;
 }
 
@@ -612,7 +654,10 @@ FunctionLiteral* Parser::DoParseProgram(CompilationInfo* info,
                                         ZoneScope* zone_scope) {
   ASSERT(top_scope_ == NULL);
   ASSERT(target_stack_ == NULL);
-  if (pre_data_ != NULL) pre_data_->Initialize();
+  if (pre_data_ != NULL) {
+    pre_data_->Initialize();
+    if (pre_data_->has_symbol_contents()) InternalizeSymbols();
+  }
 
   // Compute the parsing mode.
   mode_ = (FLAG_lazy && allow_lazy_) ? PARSE_LAZILY : PARSE_EAGERLY;
@@ -5943,12 +5988,17 @@ void ScriptDataImpl::Initialize() {
       // Partial preparse causes no symbol information.
       symbol_data_ = reinterpret_cast<byte*>(&store_[0] + store_.length());
     }
-    symbol_data_end_ = reinterpret_cast<byte*>(&store_[0] + store_.length());
+    int contents_offset = store_.length()
+        - store_[PreparseDataConstants::kSymbolContentsSizeOffset];
+    symbol_data_end_ = reinterpret_cast<byte*>(&store_[0] + contents_offset);
+    symbol_contents_ = symbol_data_end_;
+    symbol_contents_end_ =
+        reinterpret_cast<byte*>(&store_[0] + store_.length());
   }
 }
 
 
-int ScriptDataImpl::ReadNumber(byte** source) {
+int ScriptDataImpl::ReadNumber(byte** source, byte* end) {
   // Reads a number from symbol_data_ in base 128. The most significant
   // bit marks that there are more digits.
   // If the first byte is 0x80 (kNumberTerminator), it would normally
@@ -5956,7 +6006,7 @@ int ScriptDataImpl::ReadNumber(byte** source) {
   // appear as the first digit of any actual value, it is used to
   // mark the end of the input stream.
   byte* data = *source;
-  if (data >= symbol_data_end_) return -1;
+  if (data >= end) return -1;
   byte input = *data;
   if (input == PreparseDataConstants::kNumberTerminator) {
     // End of stream marker.
@@ -5965,7 +6015,7 @@ int ScriptDataImpl::ReadNumber(byte** source) {
   int result = input & 0x7f;
   data++;
   while ((input & 0x80u) != 0) {
-    if (data >= symbol_data_end_) return -1;
+    if (data >= end) return -1;
     input = *data;
     result = (result << 7) | (input & 0x7f);
     data++;
@@ -6014,6 +6064,100 @@ ScriptDataImpl* ParserApi::PreParse(Utf16CharacterStream* source,
 }
 
 
+ScriptDataImpl* ParserApi::PreParseInBackground(Utf16CharacterStream* source,
+                                                int flags) {
+  // The isolate may be running on another thread, so nothing here may touch
+  // it: the scanner gets its own unicode cache, and the stack limit is taken
+  // from the current stack position as in the standalone preparser.
+  UnicodeCache unicode_cache;
+  Scanner scanner(&unicode_cache);
+  scanner.SetHarmonyScoping(FLAG_harmony_scoping);
+  scanner.Initialize(source);
+  uintptr_t stack_limit =
+      reinterpret_cast<uintptr_t>(&scanner) - FLAG_stack_size * KB;
+  if (FLAG_lazy) flags |= kAllowLazy;
+  CompleteParserRecorder recorder;
+  recorder.RecordSymbolContents();
+  preparser::PreParser::PreParseResult result =
+      preparser::PreParser::PreParseProgram(&scanner,
+                                            &recorder,
+                                            flags,
+                                            stack_limit);
+  if (result == preparser::PreParser::kPreParseStackOverflow) return NULL;
+  return new ScriptDataImpl(recorder.ExtractData());
+}
+
+
+// An external string resource that owns the characters of a streamed
+// source.
+template <typename Char, typename Base>
+class StreamedSourceResource: public Base {
+ public:
+  explicit StreamedSourceResource(Vector<Char> data) : data_(data) { }
+  virtual ~StreamedSourceResource() { data_.Dispose(); }
+
+  virtual const Char* data() const { return data_.start(); }
+  virtual size_t length() const { return data_.length(); }
+
+ private:
+  Vector<Char> data_;
+};
+
+
+StreamedSource::StreamedSource(v8::ScriptSourceStream* stream)
+    : stream_(stream),
+      pre_data_(NULL),
+      has_been_read_(false),
+      is_ascii_(true) {
+}
+
+
+StreamedSource::~StreamedSource() {
+  delete pre_data_;
+  ascii_source_.Dispose();
+  two_byte_source_.Dispose();
+}
+
+
+void StreamedSource::Read() {
+  ASSERT(!has_been_read_);
+  ChunkedUtf8ToUtf16CharacterStream stream(stream_);
+  // The preparser pulls in the chunks as it gets to them.  Whatever it did
+  // not need, e.g. after a syntax error, is read afterwards.
+  pre_data_ = ParserApi::PreParseInBackground(&stream, FLAG_harmony_scoping);
+  stream.ReadToEnd();
+  is_ascii_ = stream.is_ascii();
+  if (is_ascii_) {
+    ascii_source_ = stream.ReleaseAsciiData();
+  } else {
+    two_byte_source_ = stream.ReleaseTwoByteData();
+  }
+  has_been_read_ = true;
+}
+
+
+Handle<String> StreamedSource::Source(Isolate* isolate) {
+  ASSERT(has_been_read_);
+  Factory* factory = isolate->factory();
+  Handle<String> result;
+  if (is_ascii_) {
+    if (ascii_source_.is_empty()) return factory->empty_string();
+    result = factory->NewExternalStringFromAscii(
+        new StreamedSourceResource<char,
+                                   v8::String::ExternalAsciiStringResource>(
+            ascii_source_));
+    ascii_source_ = Vector<char>();
+  } else {
+    result = factory->NewExternalStringFromTwoByte(
+        new StreamedSourceResource<uc16,
+                                   v8::String::ExternalStringResource>(
+            two_byte_source_));
+    two_byte_source_ = Vector<uc16>();
+  }
+  return result;
+}
+
+
 bool RegExpParser::ParseRegExp(FlatStringReader* input,
                                bool multiline,
                                RegExpCompileData* result,
@@ -122,6 +122,11 @@ class ScriptDataImpl : public ScriptData {
   int GetSymbolIdentifier();
   bool SanityCheck();
 
+  // Reads the characters of the next symbol recorded with
+  // CompleteParserRecorder::RecordSymbolContents. Returns false if there
+  // are no more symbols or the data is malformed.
+  bool ReadSymbolContents(bool* is_ascii, Vector<const byte>* literal);
+
   Scanner::Location MessageLocation();
   const char* BuildMessage();
   Vector<const char*> BuildArgs();
@@ -131,6 +136,10 @@ class ScriptDataImpl : public ScriptData {
         ? store_[PreparseDataConstants::kSymbolCountOffset]
         : 0;
   }
+  bool has_symbol_contents() {
+    return (store_.length() > PreparseDataConstants::kHeaderSize)
+        && store_[PreparseDataConstants::kSymbolContentsSizeOffset] > 0;
+  }
   // The following functions should only be called if SanityCheck has
   // returned true.
   bool has_error() { return store_[PreparseDataConstants::kHasErrorOffset]; }
@@ -141,13 +150,15 @@ class ScriptDataImpl : public ScriptData {
   Vector<unsigned> store_;
   unsigned char* symbol_data_;
   unsigned char* symbol_data_end_;
+  unsigned char* symbol_contents_;
+  unsigned char* symbol_contents_end_;
   int function_index_;
   bool owns_store_;
 
   unsigned Read(int position);
   unsigned* ReadAddress(int position);
   // Reads a number from the current symbols
-  int ReadNumber(byte** source);
+  int ReadNumber(byte** source, byte* end);
 
   ScriptDataImpl(const char* backing_store, int length)
       : store_(reinterpret_cast<unsigned*>(const_cast<char*>(backing_store)),
@@ -175,6 +186,43 @@ class ParserApi {
   static ScriptDataImpl* PreParse(Utf16CharacterStream* source,
                                   v8::Extension* extension,
                                   int flags);
+
+  // Preparser that does not use the isolate or the heap, and can therefore
+  // run on any thread.  The preparse data also carries the contents of all
+  // symbols, which the parser internalizes in one batch when it is used.
+  // Returns NULL on stack overflow.
+  static ScriptDataImpl* PreParseInBackground(Utf16CharacterStream* source,
+                                              int flags);
+};
+
+
+// The source of a script that is delivered in chunks of UTF-8, together
+// with the preparse data produced while the chunks arrived.  Read does not
+// use the isolate and may run on any thread; Source must be called on the
+// isolate's thread, and only once.
+class StreamedSource {
+ public:
+  explicit StreamedSource(v8::ScriptSourceStream* stream);
+  ~StreamedSource();
+
+  void Read();
+  bool has_been_read() const { return has_been_read_; }
+
+  // Returns an external string that takes over the decoded characters.
+  Handle<String> Source(Isolate* isolate);
+
+  // The preparse data, or NULL if the preparser overflowed the stack.
+  ScriptDataImpl* pre_data() { return pre_data_; }
+
+ private:
+  v8::ScriptSourceStream* stream_;
+  ScriptDataImpl* pre_data_;
+  bool has_been_read_;
+  bool is_ascii_;
+  Vector<char> ascii_source_;
+  Vector<uc16> two_byte_source_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamedSource);
 };
 
 // ----------------------------------------------------------------------------
@@ -782,6 +830,9 @@ class Parser {
 
   Handle<String> LookupCachedSymbol(int symbol_id);
 
+  // Fills the symbol cache from the symbol contents in the preparse data.
+  void InternalizeSymbols();
+
   // Generate AST node that throw a ReferenceError with the given type.
   Expression* NewThrowReferenceError(Handle<String> type);
 
@@ -689,6 +689,29 @@ bool VirtualMemory::UncommitRegion(void* base, size_t size) {
 }
 
 
+size_t VirtualMemory::HugePageSize() {
+#ifdef MADV_HUGEPAGE
+  return 2 * MB;
+#else
+  return 0;
+#endif
+}
+
+
+bool VirtualMemory::AdviseHugePages(void* base, size_t size) {
+#ifdef MADV_HUGEPAGE
+  return madvise(base, size, MADV_HUGEPAGE) == 0;
+#else
+  return false;
+#endif
+}
+
+
+bool VirtualMemory::DiscardRegion(void* base, size_t size) {
+  return madvise(base, size, MADV_DONTNEED) == 0;
+}
+
+
 bool VirtualMemory::ReleaseRegion(void* base, size_t size) {
   return munmap(base, size) == 0;
 }
@@ -466,6 +466,21 @@ bool VirtualMemory::UncommitRegion(void* address, size_t size) {
 }
 
 
+size_t VirtualMemory::HugePageSize() {
+  return 0;
+}
+
+
+bool VirtualMemory::AdviseHugePages(void* address, size_t size) {
+  return false;
+}
+
+
+bool VirtualMemory::DiscardRegion(void* address, size_t size) {
+  return false;
+}
+
+
 bool VirtualMemory::ReleaseRegion(void* address, size_t size) {
   return munmap(address, size) == 0;
 }
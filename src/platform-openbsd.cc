@@ -502,6 +502,21 @@ bool VirtualMemory::UncommitRegion(void* base, size_t size) {
 }
 
 
+size_t VirtualMemory::HugePageSize() {
+  return 0;
+}
+
+
+bool VirtualMemory::AdviseHugePages(void* base, size_t size) {
+  return false;
+}
+
+
+bool VirtualMemory::DiscardRegion(void* base, size_t size) {
+  return false;
+}
+
+
 bool VirtualMemory::ReleaseRegion(void* base, size_t size) {
   return munmap(base, size) == 0;
 }
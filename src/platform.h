@@ -403,6 +403,17 @@ class VirtualMemory {
 
   static bool UncommitRegion(void* base, size_t size);
 
+  // Returns the size of the huge pages the OS can back memory with, or 0 if
+  // huge pages are not supported on this platform.
+  static size_t HugePageSize();
+
+  // Advises the OS to back the committed region with huge pages.
+  static bool AdviseHugePages(void* base, size_t size);
+
+  // Returns the physical pages of the committed region to the OS without
+  // unmapping them. The region reads as zeros afterwards.
+  static bool DiscardRegion(void* base, size_t size);
+
   // Must be called with a base pointer that has been returned by ReserveRegion
   // and the same size it was reserved with.
   static bool ReleaseRegion(void* base, size_t size);
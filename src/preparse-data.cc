@@ -52,7 +52,8 @@ FunctionLoggingParserRecorder::FunctionLoggingParserRecorder()
   preamble_[PreparseDataConstants::kFunctionsSizeOffset] = 0;
   preamble_[PreparseDataConstants::kSymbolCountOffset] = 0;
   preamble_[PreparseDataConstants::kSizeOffset] = 0;
-  ASSERT_EQ(6, PreparseDataConstants::kHeaderSize);
+  preamble_[PreparseDataConstants::kSymbolContentsSizeOffset] = 0;
+  ASSERT_EQ(7, PreparseDataConstants::kHeaderSize);
 #ifdef DEBUG
   prev_start_ = -1;
 #endif
@@ -114,7 +115,8 @@ CompleteParserRecorder::CompleteParserRecorder()
       symbol_store_(0),
       symbol_keys_(0),
       symbol_table_(vector_compare),
-      symbol_id_(0) {
+      symbol_id_(0),
+      record_symbol_contents_(false) {
 }
 
 
@@ -146,37 +148,75 @@ Vector<unsigned> CompleteParserRecorder::ExtractData() {
   int padding = sizeof(unsigned) - (symbol_size % sizeof(unsigned));
   symbol_store_.AddBlock(padding, PreparseDataConstants::kNumberTerminator);
   symbol_size += padding;
+  // The symbol contents, if requested, follow the symbol store.
+  Collector<byte> contents(0);
+  if (record_symbol_contents_ && !has_error()) {
+    WriteSymbolContents(&contents);
+    int contents_padding =
+        (sizeof(unsigned) - (contents.size() % sizeof(unsigned))) %
+        sizeof(unsigned);
+    if (contents_padding > 0) {
+      contents.AddBlock(contents_padding,
+                        PreparseDataConstants::kNumberTerminator);
+    }
+  }
+  int contents_size = contents.size() / sizeof(unsigned);
   int total_size = PreparseDataConstants::kHeaderSize + function_size
-      + (symbol_size / sizeof(unsigned));
+      + (symbol_size / sizeof(unsigned)) + contents_size;
   Vector<unsigned> data = Vector<unsigned>::New(total_size);
   preamble_[PreparseDataConstants::kFunctionsSizeOffset] = function_size;
   preamble_[PreparseDataConstants::kSymbolCountOffset] = symbol_id_;
+  preamble_[PreparseDataConstants::kSymbolContentsSizeOffset] = contents_size;
   memcpy(data.start(), preamble_, sizeof(preamble_));
   int symbol_start = PreparseDataConstants::kHeaderSize + function_size;
+  int contents_start = total_size - contents_size;
   if (function_size > 0) {
     function_store_.WriteTo(data.SubVector(PreparseDataConstants::kHeaderSize,
                                            symbol_start));
   }
   if (!has_error()) {
     symbol_store_.WriteTo(
-        Vector<byte>::cast(data.SubVector(symbol_start, total_size)));
+        Vector<byte>::cast(data.SubVector(symbol_start, contents_start)));
+  }
+  if (contents_size > 0) {
+    contents.WriteTo(
+        Vector<byte>::cast(data.SubVector(contents_start, total_size)));
   }
   return data;
 }
 
 
-void CompleteParserRecorder::WriteNumber(int number) {
+void CompleteParserRecorder::WriteNumber(Collector<byte>* store,
+                                         int number) {
   ASSERT(number >= 0);
 
   int mask = (1 << 28) - 1;
   for (int i = 28; i > 0; i -= 7) {
     if (number > mask) {
-      symbol_store_.Add(static_cast<byte>(number >> i) | 0x80u);
+      store->Add(static_cast<byte>(number >> i) | 0x80u);
       number &= mask;
     }
     mask >>= 7;
   }
-  symbol_store_.Add(static_cast<byte>(number));
+  store->Add(static_cast<byte>(number));
+}
+
+
+void CompleteParserRecorder::WriteSymbolContents(Collector<byte>* store) {
+  // Each symbol is written as its length in characters, shifted left by one
+  // with the low bit set for ASCII symbols, followed by the characters.
+  // Two-byte characters are aligned to an even offset from the start of the
+  // contents, which itself starts on an unsigned boundary.
+  Vector<Key> keys = symbol_keys_.ToVector();
+  for (int i = 0; i < keys.length(); i++) {
+    Key key = keys[i];
+    int length = key.is_ascii ? key.literal_bytes.length()
+                              : key.literal_bytes.length() / kUC16Size;
+    WriteNumber(store, (length << 1) | (key.is_ascii ? 1 : 0));
+    if (!key.is_ascii && (store->size() % kUC16Size) != 0) store->Add(0);
+    store->AddBlock(key.literal_bytes);
+  }
+  keys.Dispose();
 }
 
 
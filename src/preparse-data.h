@@ -182,6 +182,11 @@ class CompleteParserRecorder: public FunctionLoggingParserRecorder {
   virtual int symbol_position() { return symbol_store_.size(); }
   virtual int symbol_ids() { return symbol_id_; }
 
+  // Makes ExtractData also write out the characters of every logged symbol,
+  // in symbol id order, so that the parser can internalize them all at once
+  // instead of looking each one up as it is scanned.
+  void RecordSymbolContents() { record_symbol_contents_ = true; }
+
  private:
   struct Key {
     bool is_ascii;
@@ -216,13 +221,18 @@ class CompleteParserRecorder: public FunctionLoggingParserRecorder {
   }
 
   // Write a non-negative number to the symbol store.
-  void WriteNumber(int number);
+  void WriteNumber(int number) { WriteNumber(&symbol_store_, number); }
+  static void WriteNumber(Collector<byte>* store, int number);
+
+  // Write the characters of all symbols, prefixed by their lengths.
+  void WriteSymbolContents(Collector<byte>* store);
 
   Collector<byte> literal_chars_;
   Collector<byte> symbol_store_;
   Collector<Key> symbol_keys_;
   HashMap symbol_table_;
   int symbol_id_;
+  bool record_symbol_contents_;
 };
 
 
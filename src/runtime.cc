@@ -136,14 +136,18 @@ namespace internal {
       static_cast<LanguageMode>(args.smi_at(index));
 
 
-MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(Isolate* isolate,
-                                                   JSObject* boilerplate) {
+MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(
+    Isolate* isolate,
+    JSObject* boilerplate,
+    PretenureFlag pretenure = NOT_TENURED,
+    AllocationSite* site = NULL) {
   StackLimitCheck check(isolate);
   if (check.HasOverflowed()) return isolate->StackOverflow();
 
   Heap* heap = isolate->heap();
   Object* result;
-  { MaybeObject* maybe_result = heap->CopyJSObject(boilerplate);
+  { MaybeObject* maybe_result =
+        heap->CopyJSObject(boilerplate, pretenure, site);
     if (!maybe_result->ToObject(&result)) return maybe_result;
   }
   JSObject* copy = JSObject::cast(result);
@@ -155,7 +159,8 @@ MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(Isolate* isolate,
       Object* value = properties->get(i);
       if (value->IsJSObject()) {
         JSObject* js_object = JSObject::cast(value);
-        { MaybeObject* maybe_result = DeepCopyBoilerplate(isolate, js_object);
+        { MaybeObject* maybe_result =
+              DeepCopyBoilerplate(isolate, js_object, pretenure);
           if (!maybe_result->ToObject(&result)) return maybe_result;
         }
         properties->set(i, result);
@@ -166,7 +171,8 @@ MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(Isolate* isolate,
       Object* value = copy->InObjectPropertyAt(i);
       if (value->IsJSObject()) {
         JSObject* js_object = JSObject::cast(value);
-        { MaybeObject* maybe_result = DeepCopyBoilerplate(isolate, js_object);
+        { MaybeObject* maybe_result =
+              DeepCopyBoilerplate(isolate, js_object, pretenure);
           if (!maybe_result->ToObject(&result)) return maybe_result;
         }
         copy->InObjectPropertyAtPut(i, result);
@@ -192,7 +198,8 @@ MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(Isolate* isolate,
           copy->GetProperty(key_string, &attributes)->ToObjectUnchecked();
       if (value->IsJSObject()) {
         JSObject* js_object = JSObject::cast(value);
-        { MaybeObject* maybe_result = DeepCopyBoilerplate(isolate, js_object);
+        { MaybeObject* maybe_result =
+              DeepCopyBoilerplate(isolate, js_object, pretenure);
           if (!maybe_result->ToObject(&result)) return maybe_result;
         }
         { MaybeObject* maybe_result =
@@ -228,8 +235,8 @@ MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(Isolate* isolate,
                  (IsFastObjectElementsKind(copy->GetElementsKind())));
           if (value->IsJSObject()) {
             JSObject* js_object = JSObject::cast(value);
-            { MaybeObject* maybe_result = DeepCopyBoilerplate(isolate,
-                                                              js_object);
+            { MaybeObject* maybe_result =
+                  DeepCopyBoilerplate(isolate, js_object, pretenure);
               if (!maybe_result->ToObject(&result)) return maybe_result;
             }
             elements->set(i, result);
@@ -247,8 +254,8 @@ MUST_USE_RESULT static MaybeObject* DeepCopyBoilerplate(Isolate* isolate,
           Object* value = element_dictionary->ValueAt(i);
           if (value->IsJSObject()) {
             JSObject* js_object = JSObject::cast(value);
-            { MaybeObject* maybe_result = DeepCopyBoilerplate(isolate,
-                                                              js_object);
+            { MaybeObject* maybe_result =
+                  DeepCopyBoilerplate(isolate, js_object, pretenure);
               if (!maybe_result->ToObject(&result)) return maybe_result;
             }
             element_dictionary->ValueAtPut(i, result);
@@ -573,6 +580,54 @@ static Handle<Object> CreateLiteralBoilerplate(
 }
 
 
+// Stores a newly created boilerplate in the literals array.  With allocation
+// site pretenuring the boilerplate is wrapped in an allocation site that
+// collects survival feedback for the copies made from it.
+static void StoreLiteralBoilerplate(Isolate* isolate,
+                                    Handle<FixedArray> literals,
+                                    int literals_index,
+                                    Handle<JSObject> boilerplate) {
+  if (FLAG_allocation_site_pretenuring) {
+    literals->set(literals_index,
+                  *isolate->factory()->NewAllocationSite(boilerplate));
+  } else {
+    literals->set(literals_index, *boilerplate);
+  }
+}
+
+
+// Copies the boilerplate stored in the literals array.  Copies of a tracked
+// allocation site are tenured if the site decided so.  Once a site decided
+// that its copies die young it is replaced by the plain boilerplate again,
+// so that the fast cloning stubs can be used.
+MUST_USE_RESULT static MaybeObject* CopyLiteralBoilerplate(
+    Isolate* isolate,
+    FixedArray* literals,
+    int literals_index,
+    bool deep) {
+  Object* literal = literals->get(literals_index);
+  if (!literal->IsAllocationSite()) {
+    JSObject* boilerplate = JSObject::cast(literal);
+    return deep ? DeepCopyBoilerplate(isolate, boilerplate)
+                : isolate->heap()->CopyJSObject(boilerplate);
+  }
+
+  AllocationSite* site = AllocationSite::cast(literal);
+  JSObject* boilerplate = site->boilerplate();
+  site->DigestFeedback(isolate->heap()->gc_count());
+  PretenureFlag pretenure = NOT_TENURED;
+  if (site->pretenure_decision() == AllocationSite::kDontTenure) {
+    literals->set(literals_index, boilerplate);
+    site = NULL;
+  } else if (!site->TrackNextCopy()) {
+    pretenure = TENURED;
+    site = NULL;
+  }
+  return deep ? DeepCopyBoilerplate(isolate, boilerplate, pretenure, site)
+              : isolate->heap()->CopyJSObject(boilerplate, pretenure, site);
+}
+
+
 RUNTIME_FUNCTION(MaybeObject*, Runtime_CreateObjectLiteral) {
   HandleScope scope(isolate);
   ASSERT(args.length() == 4);
@@ -593,9 +648,10 @@ RUNTIME_FUNCTION(MaybeObject*, Runtime_CreateObjectLiteral) {
                                                  has_function_literal);
     if (boilerplate.is_null()) return Failure::Exception();
     // Update the functions literal and return the boilerplate.
-    literals->set(literals_index, *boilerplate);
+    StoreLiteralBoilerplate(isolate, literals, literals_index,
+                            Handle<JSObject>::cast(boilerplate));
   }
-  return DeepCopyBoilerplate(isolate, JSObject::cast(*boilerplate));
+  return CopyLiteralBoilerplate(isolate, *literals, literals_index, true);
 }
 
 
@@ -619,9 +675,10 @@ RUNTIME_FUNCTION(MaybeObject*, Runtime_CreateObjectLiteralShallow) {
                                                  has_function_literal);
     if (boilerplate.is_null()) return Failure::Exception();
     // Update the functions literal and return the boilerplate.
-    literals->set(literals_index, *boilerplate);
+    StoreLiteralBoilerplate(isolate, literals, literals_index,
+                            Handle<JSObject>::cast(boilerplate));
   }
-  return isolate->heap()->CopyJSObject(JSObject::cast(*boilerplate));
+  return CopyLiteralBoilerplate(isolate, *literals, literals_index, false);
 }
 
 
@@ -640,9 +697,10 @@ RUNTIME_FUNCTION(MaybeObject*, Runtime_CreateArrayLiteral) {
         Runtime::CreateArrayLiteralBoilerplate(isolate, literals, elements);
     if (boilerplate.is_null()) return Failure::Exception();
     // Update the functions literal and return the boilerplate.
-    literals->set(literals_index, *boilerplate);
+    StoreLiteralBoilerplate(isolate, literals, literals_index,
+                            Handle<JSObject>::cast(boilerplate));
   }
-  return DeepCopyBoilerplate(isolate, JSObject::cast(*boilerplate));
+  return CopyLiteralBoilerplate(isolate, *literals, literals_index, true);
 }
 
 
@@ -661,13 +719,17 @@ RUNTIME_FUNCTION(MaybeObject*, Runtime_CreateArrayLiteralShallow) {
         Runtime::CreateArrayLiteralBoilerplate(isolate, literals, elements);
     if (boilerplate.is_null()) return Failure::Exception();
     // Update the functions literal and return the boilerplate.
-    literals->set(literals_index, *boilerplate);
+    StoreLiteralBoilerplate(isolate, literals, literals_index,
+                            Handle<JSObject>::cast(boilerplate));
+  } else if (boilerplate->IsAllocationSite()) {
+    boilerplate = Handle<Object>(
+        AllocationSite::cast(*boilerplate)->boilerplate(), isolate);
   }
   if (JSObject::cast(*boilerplate)->elements()->map() ==
       isolate->heap()->fixed_cow_array_map()) {
     isolate->counters()->cow_arrays_created_runtime()->Increment();
   }
-  return isolate->heap()->CopyJSObject(JSObject::cast(*boilerplate));
+  return CopyLiteralBoilerplate(isolate, *literals, literals_index, false);
 }
 
 
@@ -4836,6 +4898,10 @@ RUNTIME_FUNCTION(MaybeObject*, Runtime_StoreArrayLiteralElement) {
   HandleScope scope;
 
   Object* raw_boilerplate_object = literals->get(literal_index);
+  if (raw_boilerplate_object->IsAllocationSite()) {
+    raw_boilerplate_object =
+        AllocationSite::cast(raw_boilerplate_object)->boilerplate();
+  }
   Handle<JSArray> boilerplate_object(JSArray::cast(raw_boilerplate_object));
   ElementsKind elements_kind = object->GetElementsKind();
   ASSERT(IsFastElementsKind(elements_kind));
@@ -0,0 +1,183 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "v8.h"
+
+#include "sampling-heap-profiler.h"
+
+#include "frames-inl.h"
+#include "heap.h"
+
+namespace v8 {
+namespace internal {
+
+AllocationNode::~AllocationNode() {
+  for (int i = 0; i < children_.length(); i++) delete children_[i];
+}
+
+
+AllocationNode* AllocationNode::FindChild(const char* name,
+                                          int script_id,
+                                          int start_position) {
+  for (int i = 0; i < children_.length(); i++) {
+    AllocationNode* child = children_[i];
+    // Names are interned in the profiler's StringsStorage.
+    if (child->name_ == name &&
+        child->script_id_ == script_id &&
+        child->start_position_ == start_position) {
+      return child;
+    }
+  }
+  return NULL;
+}
+
+
+double AllocationNode::TotalSize() const {
+  double size = self_size_;
+  for (int i = 0; i < children_.length(); i++) {
+    size += children_[i]->TotalSize();
+  }
+  return size;
+}
+
+
+static size_t NodeMemorySize(const AllocationNode* node) {
+  size_t size = sizeof(*node) +
+      node->children()->capacity() * sizeof(AllocationNode*);
+  for (int i = 0; i < node->children()->length(); i++) {
+    size += NodeMemorySize(node->children()->at(i));
+  }
+  return size;
+}
+
+
+SamplingHeapProfiler::SamplingHeapProfiler(Heap* heap, int sample_interval)
+    : heap_(heap),
+      sample_interval_(sample_interval),
+      bytes_until_sample_(0),
+      samples_count_(0),
+      root_("(root)", "", 0, 0, v8::CpuProfileNode::kNoLineNumberInfo) {
+  ASSERT(sample_interval > 0);
+  bytes_until_sample_ = NextSampleInterval();
+}
+
+
+SamplingHeapProfiler::~SamplingHeapProfiler() {
+}
+
+
+size_t SamplingHeapProfiler::GetUsedMemorySize() const {
+  return sizeof(*this) + NodeMemorySize(&root_) - sizeof(root_) +
+      names_.GetUsedMemorySize();
+}
+
+
+intptr_t SamplingHeapProfiler::NextSampleInterval() {
+  if (FLAG_sampling_heap_profiler_suppress_randomness) {
+    return sample_interval_;
+  }
+  // Draw from an exponential distribution with the sample interval as mean,
+  // u is uniformly distributed in (0, 1].
+  double u = (V8::RandomPrivate(heap_->isolate()) + 1.0) / 4294967296.0;
+  double next = -log(u) * sample_interval_;
+  if (next < kPointerSize) return kPointerSize;
+  if (next > kMaxInt) return kMaxInt;
+  return static_cast<intptr_t>(next);
+}
+
+
+void SamplingHeapProfiler::Step(intptr_t bytes_allocated, int object_size) {
+  // Objects moved by the garbage collector are not allocations.
+  if (heap_->gc_state() != Heap::NOT_IN_GC) return;
+  bytes_until_sample_ -= bytes_allocated;
+  // Without an object the sample is taken at the next allocation.
+  if (bytes_until_sample_ > 0 || object_size == 0) return;
+  SampleObject(object_size);
+  bytes_until_sample_ = NextSampleInterval();
+}
+
+
+void SamplingHeapProfiler::SampleObject(int size) {
+  Isolate* isolate = heap_->isolate();
+  HandleScope scope(isolate);
+  SharedFunctionInfo* stack[kMaxStackDepth];
+  int depth = 0;
+  {
+    AssertNoAllocation no_allocation;
+    for (JavaScriptFrameIterator it(isolate);
+         !it.done() && depth < kMaxStackDepth;
+         it.Advance()) {
+      Object* function = it.frame()->function();
+      if (!function->IsJSFunction()) continue;
+      stack[depth++] = JSFunction::cast(function)->shared();
+    }
+
+    AllocationNode* node = &root_;
+    for (int i = depth - 1; i >= 0; i--) {
+      node = FindOrAddChild(node, stack[i]);
+    }
+
+    // A sampled object stands for all the bytes allocated since the
+    // previous sample; estimate them from the probability of sampling an
+    // object of this size.
+    double sampled = static_cast<double>(size);
+    node->AddSample(sampled / (1 - exp(-sampled / sample_interval_)));
+  }
+  samples_count_++;
+}
+
+
+AllocationNode* SamplingHeapProfiler::FindOrAddChild(
+    AllocationNode* parent, SharedFunctionInfo* shared) {
+  const char* name = names_.GetFunctionName(shared->DebugName());
+  int script_id = 0;
+  if (shared->script()->IsScript()) {
+    Object* id = Script::cast(shared->script())->id();
+    if (id->IsSmi()) script_id = Smi::cast(id)->value();
+  }
+  AllocationNode* child =
+      parent->FindChild(name, script_id, shared->start_position());
+  if (child != NULL) return child;
+
+  const char* script_name = "";
+  int line_number = v8::CpuProfileNode::kNoLineNumberInfo;
+  if (shared->script()->IsScript()) {
+    Handle<Script> script(Script::cast(shared->script()));
+    if (script->name()->IsString()) {
+      script_name = names_.GetName(String::cast(script->name()));
+    }
+    // Does not allocate line ends while the allocation is in progress.
+    int line = GetScriptLineNumberSafe(script, shared->start_position());
+    if (line >= 0) line_number = line + 1;
+  }
+  child = new AllocationNode(
+      name, script_name, script_id, shared->start_position(), line_number);
+  parent->AddChild(child);
+  return child;
+}
+
+} }  // namespace v8::internal
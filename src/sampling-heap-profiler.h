@@ -0,0 +1,144 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef V8_SAMPLING_HEAP_PROFILER_H_
+#define V8_SAMPLING_HEAP_PROFILER_H_
+
+#include "list.h"
+#include "profile-generator.h"
+
+namespace v8 {
+namespace internal {
+
+class Heap;
+class SharedFunctionInfo;
+
+// A node of the call tree of a sampled allocation profile.  The children of
+// a node are the functions called from it that allocated or called functions
+// that allocated.  Functions are identified by their name, script and
+// position in the script, so the tree stays valid across garbage
+// collections that move the shared function infos.
+class AllocationNode {
+ public:
+  AllocationNode(const char* name,
+                 const char* script_name,
+                 int script_id,
+                 int start_position,
+                 int line_number)
+      : name_(name),
+        script_name_(script_name),
+        script_id_(script_id),
+        start_position_(start_position),
+        line_number_(line_number),
+        self_size_(0),
+        self_count_(0) { }
+  ~AllocationNode();
+
+  AllocationNode* FindChild(const char* name,
+                            int script_id,
+                            int start_position);
+  void AddChild(AllocationNode* child) { children_.Add(child); }
+
+  void AddSample(double size) {
+    self_size_ += size;
+    self_count_++;
+  }
+
+  const char* name() const { return name_; }
+  const char* script_name() const { return script_name_; }
+  int line_number() const { return line_number_; }
+  double self_size() const { return self_size_; }
+  int self_count() const { return self_count_; }
+  double TotalSize() const;
+  const List<AllocationNode*>* children() const { return &children_; }
+
+ private:
+  const char* name_;
+  const char* script_name_;
+  int script_id_;
+  int start_position_;
+  int line_number_;
+  // Estimated number of bytes allocated by the function itself.
+  double self_size_;
+  int self_count_;
+  List<AllocationNode*> children_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationNode);
+};
+
+
+// Samples allocations on average once every sample_interval bytes and
+// attributes them to the JavaScript stack at the time of the allocation.
+// The distance between samples is drawn from an exponential distribution
+// so that every allocated byte is equally likely to be sampled, which makes
+// the estimated sizes unbiased even for periodic allocation patterns.
+//
+// New space allocation is observed by lowering the inline allocation limit
+// of the new space to the next sample, see NewSpace::AllocationStep.  All
+// other spaces are only allocated in from the runtime and are observed by
+// Heap::AllocateRaw.
+class SamplingHeapProfiler {
+ public:
+  SamplingHeapProfiler(Heap* heap, int sample_interval);
+  ~SamplingHeapProfiler();
+
+  // Accounts for bytes_allocated bytes of allocation, the last object_size
+  // bytes of which belong to an object that is being allocated right now.
+  // The object is sampled if it crosses the next sample.
+  void Step(intptr_t bytes_allocated, int object_size);
+
+  // Remaining bytes until the next sample.
+  intptr_t bytes_until_sample() { return bytes_until_sample_; }
+
+  Heap* heap() { return heap_; }
+  const AllocationNode* root() const { return &root_; }
+  int samples_count() const { return samples_count_; }
+  int sample_interval() const { return sample_interval_; }
+
+  size_t GetUsedMemorySize() const;
+
+ private:
+  static const int kMaxStackDepth = 64;
+
+  void SampleObject(int size);
+  intptr_t NextSampleInterval();
+  AllocationNode* FindOrAddChild(AllocationNode* parent,
+                                 SharedFunctionInfo* shared);
+
+  Heap* heap_;
+  int sample_interval_;
+  intptr_t bytes_until_sample_;
+  int samples_count_;
+  StringsStorage names_;
+  AllocationNode root_;
+
+  DISALLOW_COPY_AND_ASSIGN(SamplingHeapProfiler);
+};
+
+} }  // namespace v8::internal
+
+#endif  // V8_SAMPLING_HEAP_PROFILER_H_
@@ -300,6 +300,188 @@ void Utf8ToUtf16CharacterStream::SetRawPosition(unsigned target_position) {
 }
 
 
+// ----------------------------------------------------------------------------
+// ChunkedUtf8ToUtf16CharacterStream
+
+ChunkedUtf8ToUtf16CharacterStream::ChunkedUtf8ToUtf16CharacterStream(
+    v8::ScriptSourceStream* source)
+    : BufferedUtf16CharacterStream(),
+      source_(source),
+      source_ended_(false),
+      incomplete_length_(0),
+      is_ascii_(true),
+      ascii_data_(NULL),
+      two_byte_data_(NULL),
+      length_(0),
+      capacity_(0) {
+}
+
+
+ChunkedUtf8ToUtf16CharacterStream::~ChunkedUtf8ToUtf16CharacterStream() {
+  DeleteArray(ascii_data_);
+  DeleteArray(two_byte_data_);
+}
+
+
+void ChunkedUtf8ToUtf16CharacterStream::ReadToEnd() {
+  while (ReadChunk()) { }
+}
+
+
+Vector<char> ChunkedUtf8ToUtf16CharacterStream::ReleaseAsciiData() {
+  ASSERT(source_ended_ && is_ascii_);
+  Vector<char> result(ascii_data_, length_);
+  ascii_data_ = NULL;
+  length_ = capacity_ = 0;
+  return result;
+}
+
+
+Vector<uc16> ChunkedUtf8ToUtf16CharacterStream::ReleaseTwoByteData() {
+  ASSERT(source_ended_ && !is_ascii_);
+  Vector<uc16> result(two_byte_data_, length_);
+  two_byte_data_ = NULL;
+  length_ = capacity_ = 0;
+  return result;
+}
+
+
+unsigned ChunkedUtf8ToUtf16CharacterStream::BufferSeekForward(
+    unsigned delta) {
+  unsigned old_pos = pos_;
+  unsigned target_pos = pos_ + delta;
+  while (length_ < target_pos && ReadChunk()) { }
+  pos_ = Min(target_pos, length_);
+  ReadBlock();
+  return pos_ - old_pos;
+}
+
+
+unsigned ChunkedUtf8ToUtf16CharacterStream::FillBuffer(unsigned position,
+                                                       unsigned length) {
+  while (length_ < position + length && ReadChunk()) { }
+  if (position >= length_) return 0;
+  if (position + length > length_) length = length_ - position;
+  if (is_ascii_) {
+    CopyChars(buffer_, ascii_data_ + position, length);
+  } else {
+    CopyChars(buffer_, two_byte_data_ + position, length);
+  }
+  return length;
+}
+
+
+// Returns the number of bytes in the UTF-8 encoding that starts with the
+// given byte, or 1 if it cannot start a multi-byte encoding.
+static inline unsigned Utf8EncodingLength(byte first_byte) {
+  if (first_byte < kUtf8MultiByteCharStart) return 1;
+  if (first_byte < 0xE0) return 2;
+  if (first_byte < 0xF0) return 3;
+  if (first_byte < 0xF8) return 4;
+  return 1;
+}
+
+
+bool ChunkedUtf8ToUtf16CharacterStream::ReadChunk() {
+  if (source_ended_) return false;
+  const char* chunk = NULL;
+  int chunk_length = source_->GetNextChunk(&chunk);
+  if (chunk_length <= 0) {
+    source_ended_ = true;
+    // A character that is cut off by the end of the source is invalid.
+    if (incomplete_length_ > 0) Decode(incomplete_, incomplete_length_);
+    incomplete_length_ = 0;
+    return false;
+  }
+  const byte* data = reinterpret_cast<const byte*>(chunk);
+  unsigned length = static_cast<unsigned>(chunk_length);
+  if (incomplete_length_ > 0) {
+    // Complete the character that was split by the end of the last chunk.
+    unsigned needed = Utf8EncodingLength(incomplete_[0]);
+    unsigned taken = 0;
+    while (incomplete_length_ < needed && taken < length &&
+           IsUtf8MultiCharacterFollower(data[taken])) {
+      incomplete_[incomplete_length_++] = data[taken++];
+    }
+    data += taken;
+    length -= taken;
+    if (incomplete_length_ < needed && length == 0) return true;
+    Decode(incomplete_, incomplete_length_);
+    incomplete_length_ = 0;
+  }
+  // Hold back a multi-byte character that continues in the next chunk.
+  unsigned end = length;
+  unsigned lookback = Min(length, unibrow::Utf8::kMaxEncodedSize - 1);
+  for (unsigned i = 1; i <= lookback; i++) {
+    byte c = data[length - i];
+    if (IsUtf8MultiCharacterFollower(c)) continue;
+    if (Utf8EncodingLength(c) > i) end = length - i;
+    break;
+  }
+  Decode(data, end);
+  while (end < length) incomplete_[incomplete_length_++] = data[end++];
+  return true;
+}
+
+
+void ChunkedUtf8ToUtf16CharacterStream::Decode(const byte* data,
+                                               unsigned length) {
+  static const unibrow::uchar kMaxUtf16Character = 0xffff;
+  unsigned cursor = 0;
+  while (cursor < length) {
+    unibrow::uchar c = data[cursor];
+    if (c <= unibrow::Utf8::kMaxOneByteChar) {
+      cursor++;
+    } else {
+      c = unibrow::Utf8::CalculateValue(data + cursor,
+                                        length - cursor,
+                                        &cursor);
+    }
+    if (c > kMaxUtf16Character) {
+      AddCharacter(unibrow::Utf16::LeadSurrogate(c));
+      AddCharacter(unibrow::Utf16::TrailSurrogate(c));
+    } else {
+      AddCharacter(static_cast<uc16>(c));
+    }
+  }
+}
+
+
+void ChunkedUtf8ToUtf16CharacterStream::AddCharacter(uc16 c) {
+  if (length_ == capacity_) Grow();
+  if (is_ascii_) {
+    if (c <= unibrow::Utf8::kMaxOneByteChar) {
+      ascii_data_[length_++] = static_cast<char>(c);
+      return;
+    }
+    // Switch to two-byte characters for the rest of the source.
+    two_byte_data_ = NewArray<uc16>(capacity_);
+    CopyChars(two_byte_data_, ascii_data_, length_);
+    DeleteArray(ascii_data_);
+    ascii_data_ = NULL;
+    is_ascii_ = false;
+  }
+  two_byte_data_[length_++] = c;
+}
+
+
+void ChunkedUtf8ToUtf16CharacterStream::Grow() {
+  unsigned new_capacity = Max(kInitialCapacity, capacity_ * 2);
+  if (is_ascii_) {
+    char* new_data = NewArray<char>(new_capacity);
+    CopyChars(new_data, ascii_data_, length_);
+    DeleteArray(ascii_data_);
+    ascii_data_ = new_data;
+  } else {
+    uc16* new_data = NewArray<uc16>(new_capacity);
+    CopyChars(new_data, two_byte_data_, length_);
+    DeleteArray(two_byte_data_);
+    two_byte_data_ = new_data;
+  }
+  capacity_ = new_capacity;
+}
+
+
 // ----------------------------------------------------------------------------
 // ExternalTwoByteStringUtf16CharacterStream
 
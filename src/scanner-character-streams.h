@@ -97,6 +97,52 @@ class Utf8ToUtf16CharacterStream: public BufferedUtf16CharacterStream {
 };
 
 
+// Utf16 stream based on UTF-8 source text that is delivered in chunks by a
+// v8::ScriptSourceStream.  A chunk is only requested once the scanner gets
+// to it.  The decoded characters are kept, as ASCII for as long as the
+// source is pure ASCII, both so that the scanner can seek backwards and so
+// that they can become the script source without being copied again.
+class ChunkedUtf8ToUtf16CharacterStream: public BufferedUtf16CharacterStream {
+ public:
+  explicit ChunkedUtf8ToUtf16CharacterStream(v8::ScriptSourceStream* source);
+  virtual ~ChunkedUtf8ToUtf16CharacterStream();
+
+  // Requests and decodes all the remaining chunks.
+  void ReadToEnd();
+
+  unsigned length() const { return length_; }
+  bool is_ascii() const { return is_ascii_; }
+
+  // Hand over the decoded characters, which the caller must dispose.  Only
+  // valid once the whole source has been read.
+  Vector<char> ReleaseAsciiData();
+  Vector<uc16> ReleaseTwoByteData();
+
+ protected:
+  virtual unsigned BufferSeekForward(unsigned delta);
+  virtual unsigned FillBuffer(unsigned position, unsigned length);
+
+  // Decodes the next chunk.  Returns false at the end of the source.
+  bool ReadChunk();
+  void Decode(const byte* data, unsigned length);
+  inline void AddCharacter(uc16 c);
+  void Grow();
+
+  static const unsigned kInitialCapacity = 4 * KB;
+
+  v8::ScriptSourceStream* source_;
+  bool source_ended_;
+  // The start of a multi-byte character that was split between chunks.
+  byte incomplete_[unibrow::Utf8::kMaxEncodedSize];
+  unsigned incomplete_length_;
+  bool is_ascii_;
+  char* ascii_data_;
+  uc16* two_byte_data_;
+  unsigned length_;
+  unsigned capacity_;
+};
+
+
 // UTF16 buffer to read characters from an external string.
 class ExternalTwoByteStringUtf16CharacterStream: public Utf16CharacterStream {
  public:
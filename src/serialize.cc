@@ -30,6 +30,7 @@
 #include "accessors.h"
 #include "api.h"
 #include "bootstrapper.h"
+#include "code-stubs.h"
 #include "execution.h"
 #include "global-handles.h"
 #include "ic-inl.h"
@@ -39,7 +40,9 @@
 #include "serialize.h"
 #include "snapshot.h"
 #include "stub-cache.h"
+#include "v8conversions.h"
 #include "v8threads.h"
+#include "version.h"
 
 namespace v8 {
 namespace internal {
@@ -511,6 +514,16 @@ void ExternalReferenceTable::PopulateTable(Isolate* isolate) {
       UNCLASSIFIED,
       47,
       "date_cache_stamp");
+  Add(ExternalReference::old_pointer_space_allocation_top_address(
+          isolate).address(),
+      UNCLASSIFIED,
+      48,
+      "Heap::OldPointerSpaceAllocationTopAddress()");
+  Add(ExternalReference::old_pointer_space_allocation_limit_address(
+          isolate).address(),
+      UNCLASSIFIED,
+      49,
+      "Heap::OldPointerSpaceAllocationLimitAddress()");
 }
 
 
@@ -587,6 +600,10 @@ Deserializer::Deserializer(SnapshotByteSource* source)
     : isolate_(NULL),
       source_(source),
       external_reference_decoder_(NULL) {
+  for (int i = 0; i <= LAST_SPACE; i++) {
+    next_reservation_[i] = 0;
+    reservation_remaining_[i] = 0;
+  }
 }
 
 
@@ -603,8 +620,9 @@ Address Deserializer::Allocate(int space_index, Space* space, int size) {
       maybe_new_allocation =
           reinterpret_cast<NewSpace*>(space)->AllocateRaw(size);
     } else {
-      maybe_new_allocation =
-          reinterpret_cast<PagedSpace*>(space)->AllocateRaw(size);
+      PagedSpace* paged_space = reinterpret_cast<PagedSpace*>(space);
+      ReserveChunkIfNeeded(space_index, paged_space, size);
+      maybe_new_allocation = paged_space->AllocateRaw(size);
     }
     ASSERT(!maybe_new_allocation->IsFailure());
     Object* new_allocation = maybe_new_allocation->ToObjectUnchecked();
@@ -633,6 +651,43 @@ Address Deserializer::Allocate(int space_index, Space* space, int size) {
 }
 
 
+void Deserializer::ReserveChunkIfNeeded(int space_number,
+                                        PagedSpace* space,
+                                        int size) {
+  if (reservations_[space_number].is_empty()) return;
+  if (size <= reservation_remaining_[space_number]) {
+    reservation_remaining_[space_number] -= size;
+    return;
+  }
+  // The serializer starts a new page exactly when an object does not fit in
+  // the rest of the current one, so this object is the first in its chunk.
+  ASSERT(reservation_remaining_[space_number] == 0);
+  int index = next_reservation_[space_number]++;
+  int chunk_size = reservations_[space_number][index];
+  ASSERT(size <= chunk_size);
+  if (!space->ReserveSpace(chunk_size)) {
+    V8::FatalProcessOutOfMemory("Deserializer::ReserveChunkIfNeeded");
+  }
+  reservation_remaining_[space_number] = chunk_size - size;
+}
+
+
+void Deserializer::FlushICacheForNewCodeObjects() {
+  List<Address>& code_pages = pages_[CODE_SPACE];
+  ASSERT(code_pages.length() <= reservations_[CODE_SPACE].length());
+  for (int i = 0; i < code_pages.length(); i++) {
+    CPU::FlushICache(code_pages[i], reservations_[CODE_SPACE][i]);
+  }
+  List<Address>& large_objects = pages_[LO_SPACE];
+  for (int i = 0; i < large_objects.length(); i++) {
+    HeapObject* object = HeapObject::FromAddress(large_objects[i]);
+    if (object->IsCode()) {
+      CPU::FlushICache(object->address(), object->Size());
+    }
+  }
+}
+
+
 // This returns the address of an object that has been described in the
 // snapshot as being offset bytes back in a particular space.
 HeapObject* Deserializer::GetAddressFromEnd(int space) {
@@ -819,6 +874,14 @@ void Deserializer::ReadChunk(Object** current,
             new_object = isolate->serialize_partial_snapshot_cache()           \
                 [cache_index];                                                 \
             emit_write_barrier = isolate->heap()->InNewSpace(new_object);      \
+          } else if (where == kBuiltin) {                                      \
+            int builtin_id = source_->GetInt();                                \
+            new_object = isolate->builtins()->builtin(                         \
+                static_cast<Builtins::Name>(builtin_id));                      \
+          } else if (where == kAttachedReference) {                            \
+            int index = source_->GetInt();                                     \
+            new_object = attached_objects_->get(index);                        \
+            emit_write_barrier = isolate->heap()->InNewSpace(new_object);      \
           } else if (where == kExternalReference) {                            \
             int reference_id = source_->GetInt();                              \
             Address address = external_reference_decoder_->                    \
@@ -1036,6 +1099,50 @@ void Deserializer::ReadChunk(Object** current,
                 kFirstInstruction,
                 0,
                 kUnknownOffsetFromStart)
+      // Find a builtin and write a pointer to it or to its first instruction
+      // to the current object.
+      CASE_STATEMENT(kBuiltin, kPlain, kStartOfObject, 0)
+      CASE_BODY(kBuiltin, kPlain, kStartOfObject, 0, kUnknownOffsetFromStart)
+      CASE_STATEMENT(kBuiltin, kPlain, kFirstInstruction, 0)
+      CASE_BODY(kBuiltin,
+                kPlain,
+                kFirstInstruction,
+                0,
+                kUnknownOffsetFromStart)
+      // Find a builtin and write a pointer to its first instruction to the
+      // current code object.
+      CASE_STATEMENT(kBuiltin, kFromCode, kFirstInstruction, 0)
+      CASE_BODY(kBuiltin,
+                kFromCode,
+                kFirstInstruction,
+                0,
+                kUnknownOffsetFromStart)
+      // Find an object supplied by the caller of the deserializer and write a
+      // pointer to it or to its first instruction to the current object.
+      CASE_STATEMENT(kAttachedReference, kPlain, kStartOfObject, 0)
+      CASE_BODY(kAttachedReference,
+                kPlain,
+                kStartOfObject,
+                0,
+                kUnknownOffsetFromStart)
+      CASE_STATEMENT(kAttachedReference, kFromCode, kStartOfObject, 0)
+      CASE_BODY(kAttachedReference,
+                kFromCode,
+                kStartOfObject,
+                0,
+                kUnknownOffsetFromStart)
+      CASE_STATEMENT(kAttachedReference, kPlain, kFirstInstruction, 0)
+      CASE_BODY(kAttachedReference,
+                kPlain,
+                kFirstInstruction,
+                0,
+                kUnknownOffsetFromStart)
+      CASE_STATEMENT(kAttachedReference, kFromCode, kFirstInstruction, 0)
+      CASE_BODY(kAttachedReference,
+                kFromCode,
+                kFirstInstruction,
+                0,
+                kUnknownOffsetFromStart)
       // Find an external reference and write a pointer to it to the current
       // object.
       CASE_STATEMENT(kExternalReference, kPlain, kStartOfObject, 0)
@@ -1116,9 +1223,6 @@ Serializer::Serializer(SnapshotByteSink* sink)
       large_object_total_(0),
       root_index_wave_front_(0) {
   isolate_ = Isolate::Current();
-  // The serializer is meant to be used only to generate initial heap images
-  // from a context in which there is only one isolate.
-  ASSERT(isolate_->IsDefaultIsolate());
   for (int i = 0; i <= LAST_SPACE; i++) {
     fullness_[i] = 0;
   }
@@ -1132,6 +1236,9 @@ Serializer::~Serializer() {
 
 void StartupSerializer::SerializeStrongReferences() {
   Isolate* isolate = Isolate::Current();
+  // The snapshot serializers are meant to be used only to generate initial
+  // heap images from a context in which there is only one isolate.
+  ASSERT(isolate->IsDefaultIsolate());
   // No active threads.
   CHECK_EQ(NULL, Isolate::Current()->thread_manager()->FirstThreadStateInUse());
   // No active or weak handles.
@@ -1408,7 +1515,7 @@ void PartialSerializer::SerializeObject(
 
 
 void Serializer::ObjectSerializer::Serialize() {
-  int space = Serializer::SpaceOfObject(object_);
+  int space = serializer_->SpaceToAllocateIn(object_);
   int size = object_->Size();
 
   sink_->Put(kNewObject + reference_representation_ + space,
@@ -1670,6 +1777,7 @@ int Serializer::Allocate(int space, int size, bool* new_page) {
     CHECK(size <= SpaceAreaSize(space));
     if (used_in_this_page + size > SpaceAreaSize(space)) {
       *new_page = true;
+      full_page_sizes_[space].Add(used_in_this_page);
       fullness_[space] = RoundUp(fullness_[space], Page::kPageSize);
     }
   }
@@ -1679,6 +1787,14 @@ int Serializer::Allocate(int space, int size, bool* new_page) {
 }
 
 
+void Serializer::GetPageSizes(int space, List<int>* page_sizes) {
+  ASSERT(SpaceIsPaged(space));
+  page_sizes->AddAll(full_page_sizes_[space]);
+  int used_in_last_page = fullness_[space] & (Page::kPageSize - 1);
+  if (used_in_last_page > 0) page_sizes->Add(used_in_last_page);
+}
+
+
 int Serializer::SpaceAreaSize(int space) {
   if (space == CODE_SPACE) {
     return isolate_->memory_allocator()->CodePageAreaSize();
@@ -1688,4 +1804,578 @@ int Serializer::SpaceAreaSize(int space) {
 }
 
 
+
+// Collects the serialized data of a code cache in memory.
+class CodeCacheSink : public SnapshotByteSink {
+ public:
+  explicit CodeCacheSink(List<byte>* data) : data_(data) { }
+  virtual void Put(int b, const char* description) {
+    data_->Add(static_cast<byte>(b));
+  }
+  virtual int Position() { return data_->length(); }
+
+ private:
+  List<byte>* data_;
+};
+
+
+CodeSerializer::CodeSerializer(SnapshotByteSink* sink,
+                               Handle<String> source,
+                               Handle<Script> script,
+                               Handle<Script> sanitized_script)
+    : Serializer(sink),
+      outermost_(this),
+      stub_(NULL),
+      source_(source),
+      script_(script),
+      sanitized_script_(sanitized_script),
+      attachment_count_(0),
+      failed_(false) {
+  set_root_index_wave_front(Heap::kStrongRootListLength);
+  Builtins* builtins = isolate_->builtins();
+  for (int i = 0; i < Builtins::builtin_count; i++) {
+    Code* code = builtins->builtin(static_cast<Builtins::Name>(i));
+    if (!builtins_.IsMapped(code)) builtins_.AddMapping(code, i);
+  }
+  ASSERT(isolate_->code_cache_stubs() != NULL);
+  UnseededNumberDictionary* stubs =
+      UnseededNumberDictionary::cast(*isolate_->code_cache_stubs());
+  int capacity = stubs->Capacity();
+  for (int i = 0; i < capacity; i++) {
+    Object* k = stubs->KeyAt(i);
+    if (stubs->IsKey(k)) {
+      HeapObject* stub = HeapObject::cast(stubs->ValueAt(i));
+      stub_keys_.AddMapping(stub, static_cast<int>(NumberToUint32(k)));
+    }
+  }
+}
+
+
+CodeSerializer::CodeSerializer(SnapshotByteSink* sink,
+                               CodeSerializer* outer,
+                               Code* stub)
+    : Serializer(sink),
+      outermost_(outer->outermost_),
+      stub_(stub),
+      source_(outer->source_),
+      script_(outer->script_),
+      sanitized_script_(outer->sanitized_script_),
+      attachment_count_(0),
+      failed_(false) {
+  set_root_index_wave_front(Heap::kStrongRootListLength);
+}
+
+
+static uint32_t AddToHash(uint32_t hash, uint32_t value) {
+  hash += value;
+  hash += hash << 10;
+  hash ^= hash >> 6;
+  return hash;
+}
+
+
+uint32_t CodeSerializer::VersionHash() {
+  // Roots, builtins and external references are encoded by their index, which
+  // is only stable within one build.
+  uint32_t hash = AddToHash(0, Version::GetMajor());
+  hash = AddToHash(hash, Version::GetMinor());
+  hash = AddToHash(hash, Version::GetBuild());
+  hash = AddToHash(hash, Version::GetPatch());
+  hash = AddToHash(hash, Heap::kStrongRootListLength);
+  hash = AddToHash(hash, Builtins::builtin_count);
+  return AddToHash(hash, kPointerSize);
+}
+
+
+uint32_t CodeSerializer::SourceHash(Handle<String> source) {
+  FlattenString(source);
+  AssertNoAllocation no_allocation;
+  uint32_t hash = source->length();
+  String::FlatContent content = source->GetFlatContent();
+  ASSERT(content.IsFlat());
+  if (content.IsAscii()) {
+    Vector<const char> chars = content.ToAsciiVector();
+    for (int i = 0; i < chars.length(); i++) {
+      hash = AddToHash(hash, static_cast<uint8_t>(chars[i]));
+    }
+  } else {
+    Vector<const uc16> chars = content.ToUC16Vector();
+    for (int i = 0; i < chars.length(); i++) {
+      hash = AddToHash(hash, chars[i]);
+    }
+  }
+  return hash;
+}
+
+
+bool CodeSerializer::IsCodeCache(ScriptData* data) {
+  if (data->Length() < kHeaderSize * static_cast<int>(sizeof(unsigned))) {
+    return false;
+  }
+  unsigned magic;
+  memcpy(&magic, data->Data() + kMagicOffset * sizeof(unsigned), sizeof(magic));
+  return magic == kMagicNumber;
+}
+
+
+CodeCacheData* CodeSerializer::Serialize(Handle<SharedFunctionInfo> info) {
+  Isolate* isolate = info->GetIsolate();
+#ifdef ENABLE_DEBUGGER_SUPPORT
+  // Break points are patched into the code.
+  if (isolate->debug()->has_break_points()) return NULL;
+#endif
+  Handle<Script> script(Script::cast(info->script()), isolate);
+  Handle<String> source(String::cast(script->source()), isolate);
+  uint32_t source_hash = SourceHash(source);
+
+  // The copy of the script that goes into the cache leaves out the fields
+  // that refer to this heap.  The id is replaced when the cache is loaded and
+  // the rest is set by the compiler.
+  Handle<Script> sanitized_script = isolate->factory()->NewScript(source);
+  sanitized_script->set_type(script->type());
+  sanitized_script->set_compilation_type(script->compilation_type());
+
+  List<byte> objects;
+  List<byte> payload;
+  CodeCacheSink sink(&objects);
+  {
+    CodeSerializer serializer(&sink, source, script, sanitized_script);
+    Object* root = *info;
+    serializer.VisitPointer(&root);
+    if (serializer.failed_) return NULL;
+    CodeCacheSink payload_sink(&payload);
+    serializer.WriteReservations(&payload_sink);
+    payload_sink.PutInt(serializer.attachment_count_, "attachment_count");
+    payload.AddAll(serializer.attachments_);
+  }
+  payload.AddAll(objects);
+
+  int payload_words = static_cast<int>(
+      (payload.length() + sizeof(unsigned) - 1) / sizeof(unsigned));
+  Vector<unsigned> store = Vector<unsigned>::New(kHeaderSize + payload_words);
+  memset(store.start(), 0, store.length() * sizeof(unsigned));
+  store[kMagicOffset] = kMagicNumber;
+  store[kVersionHashOffset] = VersionHash();
+  store[kSourceHashOffset] = source_hash;
+  store[kFlagHashOffset] = FlagList::Hash();
+  store[kPayloadLengthOffset] = payload.length();
+  if (!payload.is_empty()) {
+    memcpy(&store[kHeaderSize], &payload[0], payload.length());
+  }
+  return new CodeCacheData(store);
+}
+
+
+// Writes the chunks that the deserializer has to reserve in the paged spaces
+// before it reads the objects.
+void CodeSerializer::WriteReservations(SnapshotByteSink* sink) {
+  for (int space = FIRST_PAGED_SPACE; space <= LAST_PAGED_SPACE; space++) {
+    List<int> page_sizes;
+    GetPageSizes(space, &page_sizes);
+    sink->PutInt(page_sizes.length(), "page_count");
+    for (int i = 0; i < page_sizes.length(); i++) {
+      sink->PutInt(page_sizes[i], "page_size");
+    }
+  }
+  ASSERT_EQ(0, CurrentAllocationAddress(NEW_SPACE));
+}
+
+
+void CodeSerializer::SerializeObject(Object* o,
+                                     HowToCode how_to_code,
+                                     WhereToPoint where_to_point) {
+  CHECK(o->IsHeapObject());
+  HeapObject* heap_object = HeapObject::cast(o);
+
+  if (heap_object == *source_) {
+    SerializeAttachedReference(kSourceIndex, how_to_code, where_to_point);
+    return;
+  }
+
+  int root_index;
+  if ((root_index = RootIndex(heap_object, how_to_code)) != kInvalidRootIndex) {
+    PutRoot(root_index, heap_object, how_to_code, where_to_point);
+    return;
+  }
+
+  if (outermost_->builtins_.IsMapped(heap_object)) {
+    sink_->Put(kBuiltin + how_to_code + where_to_point, "Builtin");
+    sink_->PutInt(outermost_->builtins_.MappedTo(heap_object),
+                  "builtin_index");
+    return;
+  }
+
+  // Symbols must stay unique, so they are looked up in the symbol table
+  // before the objects that refer to them are deserialized.
+  if (heap_object->IsSymbol()) {
+    SerializeAttachedReference(SymbolIndex(String::cast(heap_object)),
+                               how_to_code,
+                               where_to_point);
+    return;
+  }
+
+  // The isolate that loads the cache may have its own copy of a stub.
+  if (heap_object->IsCode() && heap_object != stub_) {
+    Code* code = Code::cast(heap_object);
+    int index = -1;
+    if (IsUninitializedCallIC(code)) {
+      index = CallICIndex(code);
+    } else if (outermost_->stub_keys_.IsMapped(code)) {
+      index = StubIndex(code);
+    }
+    if (index != -1) {
+      SerializeAttachedReference(index, how_to_code, where_to_point);
+      return;
+    }
+  }
+
+  if (heap_object == *script_) heap_object = *sanitized_script_;
+
+  if (address_mapper_.IsMapped(heap_object)) {
+    int space = isolate_->heap()->InNewSpace(heap_object)
+        ? SpaceToAllocateIn(heap_object)
+        : SpaceOfAlreadySerializedObject(heap_object);
+    int address = address_mapper_.MappedTo(heap_object);
+    SerializeReferenceToPreviousObject(space,
+                                       address,
+                                       how_to_code,
+                                       where_to_point);
+    return;
+  }
+
+  if (outermost_->failed_ || !IsSerializable(heap_object)) {
+    // The data is thrown away, so just keep the stream going.
+    outermost_->failed_ = true;
+    sink_->Put(kSkip, "Unserializable");
+    return;
+  }
+
+  ObjectSerializer serializer(this,
+                              heap_object,
+                              sink_,
+                              how_to_code,
+                              where_to_point);
+  serializer.Serialize();
+}
+
+
+void CodeSerializer::SerializeAttachedReference(int index,
+                                                HowToCode how_to_code,
+                                                WhereToPoint where_to_point) {
+  sink_->Put(kAttachedReference + how_to_code + where_to_point,
+             "AttachedReference");
+  sink_->PutInt(index, "attached_index");
+}
+
+
+int CodeSerializer::Attach(HeapObject* object) {
+  int index = kSourceIndex + ++outermost_->attachment_count_;
+  outermost_->attachment_indices_.AddMapping(object, index);
+  return index;
+}
+
+
+int CodeSerializer::SymbolIndex(String* symbol) {
+  if (outermost_->attachment_indices_.IsMapped(symbol)) {
+    return outermost_->attachment_indices_.MappedTo(symbol);
+  }
+  CodeCacheSink sink(&outermost_->attachments_);
+  sink.Put(kSymbolAttachment, "kind");
+  String::FlatContent content = symbol->GetFlatContent();
+  ASSERT(content.IsFlat());
+  if (content.IsAscii()) {
+    Vector<const char> chars = content.ToAsciiVector();
+    sink.Put(1, "is_ascii");
+    sink.PutInt(chars.length(), "length");
+    for (int j = 0; j < chars.length(); j++) {
+      sink.Put(chars[j], "char");
+    }
+  } else {
+    Vector<const uc16> chars = content.ToUC16Vector();
+    sink.Put(0, "is_ascii");
+    sink.PutInt(chars.length(), "length");
+    const byte* bytes = reinterpret_cast<const byte*>(chars.start());
+    for (int j = 0; j < chars.length() * kUC16Size; j++) {
+      sink.Put(bytes[j], "char");
+    }
+  }
+  return Attach(symbol);
+}
+
+
+// The call ICs that the full code generator emits are found by their flags.
+bool CodeSerializer::IsUninitializedCallIC(Code* code) {
+  if (!code->is_call_stub() && !code->is_keyed_call_stub()) return false;
+  Code::ExtraICState extra_state = code->extra_ic_state();
+  if (CallICBase::StringStubState::decode(extra_state) !=
+      DEFAULT_STRING_STUB) {
+    return false;
+  }
+  return code->flags() == Code::ComputeFlags(code->kind(),
+                                             UNINITIALIZED,
+                                             extra_state,
+                                             Code::NORMAL,
+                                             code->arguments_count());
+}
+
+
+int CodeSerializer::CallICIndex(Code* code) {
+  if (outermost_->attachment_indices_.IsMapped(code)) {
+    return outermost_->attachment_indices_.MappedTo(code);
+  }
+  CodeCacheSink sink(&outermost_->attachments_);
+  sink.Put(kCallICAttachment, "kind");
+  sink.Put(code->kind(), "ic_kind");
+  sink.Put(CallICBase::Contextual::decode(code->extra_ic_state()) ? 1 : 0,
+           "contextual");
+  sink.PutInt(code->arguments_count(), "argc");
+  return Attach(code);
+}
+
+
+// A stub goes into a section of its own, which the loading isolate skips if
+// it already has the stub.
+int CodeSerializer::StubIndex(Code* stub) {
+  if (outermost_->attachment_indices_.IsMapped(stub)) {
+    return outermost_->attachment_indices_.MappedTo(stub);
+  }
+  List<Code*>* in_progress = &outermost_->stubs_in_progress_;
+  if (in_progress->Contains(stub)) {
+    // The stubs refer to each other.
+    outermost_->failed_ = true;
+    return kSourceIndex;
+  }
+  List<byte> objects;
+  List<byte> section;
+  CodeCacheSink sink(&objects);
+  {
+    in_progress->Add(stub);
+    CodeSerializer serializer(&sink, this, stub);
+    Object* root = stub;
+    serializer.VisitPointer(&root);
+    in_progress->RemoveLast();
+    CodeCacheSink section_sink(&section);
+    serializer.WriteReservations(&section_sink);
+  }
+  section.AddAll(objects);
+
+  CodeCacheSink attachment_sink(&outermost_->attachments_);
+  attachment_sink.Put(kStubAttachment, "kind");
+  attachment_sink.PutInt(outermost_->stub_keys_.MappedTo(stub), "key");
+  attachment_sink.PutInt(section.length(), "section_length");
+  outermost_->attachments_.AddAll(section);
+  return Attach(stub);
+}
+
+
+// New space objects are moved to the old generation, so that loading a cache
+// does not depend on how much of the new space is free.
+int CodeSerializer::SpaceToAllocateIn(HeapObject* object) {
+  Heap* heap = isolate_->heap();
+  if (heap->InNewSpace(object)) {
+    return heap->TargetSpaceId(object->map()->instance_type());
+  }
+  return SpaceOfObject(object);
+}
+
+
+// Only context independent objects can be cached.  Anything that a compiled
+// script has not run yet cannot refer to (JS objects, contexts, maps,
+// optimized code) makes the serialization fail.
+bool CodeSerializer::IsSerializable(HeapObject* object) {
+  if (object->IsString()) return !object->IsExternalString();
+  if (object->IsFixedArray()) return !object->IsContext();
+  if (object->IsSharedFunctionInfo()) {
+    SharedFunctionInfo* shared = SharedFunctionInfo::cast(object);
+    return shared->optimized_code_map()->IsSmi() &&
+        shared->debug_info()->IsUndefined();
+  }
+  if (object->IsCode()) return CanSerializeCode(Code::cast(object));
+  if (object->IsScript()) return object == *sanitized_script_;
+  // The wrapper of a script that has not been exposed to JavaScript yet.
+  if (object->IsForeign()) {
+    return Foreign::cast(object)->foreign_address() == NULL;
+  }
+  return object->IsHeapNumber() ||
+      object->IsByteArray() ||
+      object->IsFixedDoubleArray() ||
+      object->IsTypeFeedbackInfo() ||
+      object->IsJSGlobalPropertyCell();
+}
+
+
+bool CodeSerializer::CanSerializeCode(Code* code) {
+  // Any other code may have been generated outside of a CodeCacheScope.
+  if (code->kind() != Code::FUNCTION && code != stub_) return false;
+  int mode_mask = RelocInfo::ModeMask(RelocInfo::GLOBAL_PROPERTY_CELL) |
+                  RelocInfo::ModeMask(RelocInfo::INTERNAL_REFERENCE) |
+                  RelocInfo::ModeMask(RelocInfo::EXTERNAL_REFERENCE) |
+                  RelocInfo::ModeMask(RelocInfo::RUNTIME_ENTRY);
+  for (RelocIterator it(code, mode_mask); !it.done(); it.next()) {
+    RelocInfo* info = it.rinfo();
+    Address target;
+    if (info->rmode() == RelocInfo::EXTERNAL_REFERENCE) {
+      target = *info->target_reference_address();
+    } else if (info->rmode() == RelocInfo::RUNTIME_ENTRY) {
+      target = info->target_address();
+    } else {
+      // Internal references would have to be relocated and cells belong to
+      // a global object.
+      return false;
+    }
+    if (external_reference_encoder_->NameOfAddress(target) == NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+Handle<SharedFunctionInfo> CodeSerializer::Deserialize(
+    CodeCacheData* data,
+    Handle<String> source) {
+  Isolate* isolate = source->GetIsolate();
+  Factory* factory = isolate->factory();
+  Vector<const unsigned> store = data->store();
+  if (store.length() < kHeaderSize ||
+      store[kMagicOffset] != kMagicNumber ||
+      store[kVersionHashOffset] != VersionHash() ||
+      store[kFlagHashOffset] != FlagList::Hash() ||
+      store[kSourceHashOffset] != SourceHash(source)) {
+    return Handle<SharedFunctionInfo>::null();
+  }
+  int payload_length = static_cast<int>(store[kPayloadLengthOffset]);
+  int available =
+      (store.length() - kHeaderSize) * static_cast<int>(sizeof(unsigned));
+  if (payload_length > available) return Handle<SharedFunctionInfo>::null();
+
+  SnapshotByteSource payload(
+      reinterpret_cast<const byte*>(&store[kHeaderSize]), payload_length);
+  Deserializer deserializer(&payload);
+  for (int space = FIRST_PAGED_SPACE; space <= LAST_PAGED_SPACE; space++) {
+    int page_count = payload.GetInt();
+    for (int i = 0; i < page_count; i++) {
+      deserializer.AddReservation(space, payload.GetInt());
+    }
+  }
+
+  int attachment_count = payload.GetInt();
+  Handle<FixedArray> attached_objects =
+      factory->NewFixedArray(kSourceIndex + 1 + attachment_count);
+  attached_objects->set(kSourceIndex, *source);
+  for (int i = 0; i < attachment_count; i++) {
+    Handle<Object> attachment = ReadAttachment(&payload, attached_objects);
+    attached_objects->set(kSourceIndex + 1 + i, *attachment);
+  }
+  deserializer.set_attached_objects(attached_objects);
+
+  Object* root;
+  deserializer.DeserializePartial(&root);
+  deserializer.FlushICacheForNewCodeObjects();
+  Handle<SharedFunctionInfo> result(SharedFunctionInfo::cast(root), isolate);
+
+  // Give the script an id of its own.
+  Handle<Script> script(Script::cast(result->script()), isolate);
+  script->set_id(factory->NewScript(source)->id());
+  return result;
+}
+
+
+
+
+Handle<Object> CodeSerializer::ReadAttachment(
+    SnapshotByteSource* payload,
+    Handle<FixedArray> attached_objects) {
+  Isolate* isolate = attached_objects->GetIsolate();
+  Factory* factory = isolate->factory();
+  int kind = payload->Get();
+  if (kind == kSymbolAttachment) {
+    bool is_ascii = payload->Get() != 0;
+    int length = payload->GetInt();
+    if (is_ascii) {
+      ScopedVector<char> chars(length);
+      payload->CopyRaw(reinterpret_cast<byte*>(chars.start()), length);
+      return factory->LookupAsciiSymbol(
+          Vector<const char>(chars.start(), length));
+    }
+    ScopedVector<uc16> chars(length);
+    payload->CopyRaw(reinterpret_cast<byte*>(chars.start()),
+                     length * kUC16Size);
+    return factory->LookupTwoByteSymbol(
+        Vector<const uc16>(chars.start(), length));
+  } else if (kind == kCallICAttachment) {
+    Code::Kind ic_kind = static_cast<Code::Kind>(payload->Get());
+    RelocInfo::Mode mode = payload->Get() != 0
+        ? RelocInfo::CODE_TARGET_CONTEXT
+        : RelocInfo::CODE_TARGET;
+    int argc = payload->GetInt();
+    StubCache* stub_cache = isolate->stub_cache();
+    return ic_kind == Code::KEYED_CALL_IC
+        ? stub_cache->ComputeKeyedCallInitialize(argc)
+        : stub_cache->ComputeCallInitialize(argc, mode);
+  }
+  ASSERT_EQ(kStubAttachment, kind);
+  uint32_t key = static_cast<uint32_t>(payload->GetInt());
+  return ReadStub(key, payload, attached_objects);
+}
+
+
+Handle<Code> CodeSerializer::ReadStub(uint32_t key,
+                                      SnapshotByteSource* payload,
+                                      Handle<FixedArray> attached_objects) {
+  Isolate* isolate = attached_objects->GetIsolate();
+  Heap* heap = isolate->heap();
+  int section_length = payload->GetInt();
+  SnapshotByteSource section(payload->current(), section_length);
+  payload->Advance(section_length);
+
+  int entry = heap->code_stubs()->FindEntry(key);
+  if (entry != UnseededNumberDictionary::kNotFound) {
+    return Handle<Code>(Code::cast(heap->code_stubs()->ValueAt(entry)));
+  }
+
+  Handle<Code> stub;
+  {
+    Deserializer deserializer(&section);
+    for (int space = FIRST_PAGED_SPACE; space <= LAST_PAGED_SPACE; space++) {
+      int page_count = section.GetInt();
+      for (int i = 0; i < page_count; i++) {
+        deserializer.AddReservation(space, section.GetInt());
+      }
+    }
+    deserializer.set_attached_objects(attached_objects);
+    Object* root;
+    deserializer.DeserializePartial(&root);
+    deserializer.FlushICacheForNewCodeObjects();
+    stub = Handle<Code>(Code::cast(root), isolate);
+  }
+
+  // Register the stub as if the isolate had generated it, see
+  // CodeStub::GetCode.
+  Handle<UnseededNumberDictionary> dict =
+      isolate->factory()->DictionaryAtNumberPut(
+          Handle<UnseededNumberDictionary>(heap->code_stubs()), key, stub);
+  heap->public_set_code_stubs(*dict);
+  if (CodeStub::MajorKeyFromKey(key) == CodeStub::RecordWrite) {
+    heap->incremental_marking()->ActivateGeneratedStub(*stub);
+  }
+  return stub;
+}
+
+
+CodeCacheScope::CodeCacheScope(Isolate* isolate)
+    : isolate_(isolate),
+      stubs_(isolate->factory()->NewUnseededNumberDictionary(128)) {
+  ASSERT(isolate->code_cache_stubs() == NULL);
+  isolate->set_code_cache_stubs(stubs_.location());
+  // The code refers to the stubs that the isolate generates ahead of time.
+  CodeStub::GenerateStubsAheadOfTime();
+}
+
+
+CodeCacheScope::~CodeCacheScope() {
+  isolate_->set_code_cache_stubs(NULL);
+}
+
+
 } }  // namespace v8::internal
@@ -180,6 +180,13 @@ class SnapshotByteSource {
 
   int position() { return position_; }
 
+  const byte* current() { return data_ + position_; }
+
+  void Advance(int number_of_bytes) {
+    ASSERT(position_ + number_of_bytes <= length_);
+    position_ += number_of_bytes;
+  }
+
  private:
   const byte* data_;
   int length_;
@@ -220,7 +227,9 @@ class SerializerDeserializer: public ObjectVisitor {
     kPartialSnapshotCache = 0xa,    // Object is in the cache.
     kExternalReference = 0xb,       // Pointer to an external reference.
     kSkip = 0xc,                    // Skip a pointer sized cell.
-    // 0xd-0xf                         Free.
+    kBuiltin = 0xd,                 // Builtin code object (code caches).
+    kAttachedReference = 0xe,       // Object supplied on deserialization.
+    // 0xf                             Free.
     kBackref = 0x10,                 // Object is described relative to end.
     // 0x11-0x18                       One per space.
     // 0x19-0x1f                       Free.
@@ -340,6 +349,26 @@ class Deserializer: public SerializerDeserializer {
   // Deserialize a single object and the objects reachable from it.
   void DeserializePartial(Object** root);
 
+  // Objects that the serialized data refers to with kAttachedReference
+  // rather than containing them, e.g. the source of a cached script.
+  void set_attached_objects(Handle<FixedArray> attached_objects) {
+    attached_objects_ = attached_objects;
+  }
+
+  // When deserializing into a heap that is in use, the objects of each
+  // serialized page must be given their own linear allocation area, since
+  // references into a page are encoded as offsets from its first object.
+  // The chunks are reserved in order, just before their first object is
+  // allocated.
+  void AddReservation(int space, int chunk_size) {
+    ASSERT(SpaceIsPaged(space));
+    reservations_[space].Add(chunk_size);
+  }
+
+  // Flush the instruction cache for the code objects that were deserialized
+  // into reserved chunks or large object space.
+  void FlushICacheForNewCodeObjects();
+
  private:
   virtual void VisitPointers(Object** start, Object** end);
 
@@ -361,6 +390,7 @@ class Deserializer: public SerializerDeserializer {
   HeapObject* GetAddressFromStart(int space);
   inline HeapObject* GetAddressFromEnd(int space);
   Address Allocate(int space_number, Space* space, int size);
+  void ReserveChunkIfNeeded(int space_number, PagedSpace* space, int size);
   void ReadObject(int space_number, Space* space, Object** write_back);
 
   // Cached current isolate.
@@ -383,6 +413,13 @@ class Deserializer: public SerializerDeserializer {
 
   ExternalReferenceDecoder* external_reference_decoder_;
 
+  Handle<FixedArray> attached_objects_;
+
+  List<int> reservations_[LAST_SPACE + 1];
+  // Index of the next chunk to reserve and the bytes left in the current one.
+  int next_reservation_[LAST_SPACE + 1];
+  int reservation_remaining_[LAST_SPACE + 1];
+
   DISALLOW_COPY_AND_ASSIGN(Deserializer);
 };
 
@@ -477,9 +514,18 @@ class Serializer : public SerializerDeserializer {
   // going on.
   static void TooLateToEnableNow() { too_late_to_enable_now_ = true; }
   static bool enabled() { return serialization_enabled_; }
+  // Whether code generated for the isolate must be serializable, either for
+  // the snapshot or for a code cache.
+  static bool enabled(Isolate* isolate) {
+    return serialization_enabled_ ||
+        (isolate != NULL && isolate->code_cache_stubs() != NULL);
+  }
   SerializationAddressMapper* address_mapper() { return &address_mapper_; }
   void PutRoot(
       int index, HeapObject* object, HowToCode how, WhereToPoint where);
+  // The number of bytes used in each serialized page of a paged space, for
+  // deserializers that have to reserve the pages one by one.
+  void GetPageSizes(int space, List<int>* page_sizes);
 
  protected:
   static const int kInvalidRootIndex = -1;
@@ -550,6 +596,10 @@ class Serializer : public SerializerDeserializer {
   // for all large objects since you can't check the type of the object
   // once the map has been used for the serialization address.
   static int SpaceOfAlreadySerializedObject(HeapObject* object);
+  // The space the deserializer should allocate the object in.
+  virtual int SpaceToAllocateIn(HeapObject* object) {
+    return SpaceOfObject(object);
+  }
   int Allocate(int space, int size, bool* new_page_started);
   int EncodeExternalReference(Address addr) {
     return external_reference_encoder_->Encode(addr);
@@ -563,6 +613,8 @@ class Serializer : public SerializerDeserializer {
   // just numbered sequentially since relative addresses make no
   // sense in large object space.
   int fullness_[LAST_SPACE + 1];
+  // Bytes used in the pages of each paged space that are already full.
+  List<int> full_page_sizes_[LAST_SPACE + 1];
   SnapshotByteSink* sink_;
   int current_root_index_;
   ExternalReferenceEncoder* external_reference_encoder_;
@@ -646,6 +698,166 @@ class StartupSerializer : public Serializer {
 };
 
 
+// A code cache produced by the CodeSerializer.  It is handed to the embedder
+// as ScriptData so that it can be passed back to Script::New or
+// Script::Compile in place of preparse data; the two are told apart by the
+// magic number in the first word.
+class CodeCacheData : public ScriptData {
+ public:
+  explicit CodeCacheData(Vector<unsigned> store)
+      : store_(store),
+        owns_store_(true) { }
+
+  // The backing store must be aligned and must outlive this object.
+  CodeCacheData(const char* backing_store, int length)
+      : store_(reinterpret_cast<unsigned*>(const_cast<char*>(backing_store)),
+               length / static_cast<int>(sizeof(unsigned))),
+        owns_store_(false) {
+    ASSERT_EQ(0, static_cast<int>(
+        reinterpret_cast<intptr_t>(backing_store) % sizeof(unsigned)));
+  }
+
+  virtual ~CodeCacheData() {
+    if (owns_store_) store_.Dispose();
+  }
+
+  virtual int Length() {
+    return store_.length() * static_cast<int>(sizeof(unsigned));
+  }
+
+  virtual const char* Data() {
+    return reinterpret_cast<const char*>(store_.start());
+  }
+
+  // A script that does not compile never gets a code cache.
+  virtual bool HasError() { return false; }
+
+  Vector<const unsigned> store() {
+    return Vector<const unsigned>(store_.start(), store_.length());
+  }
+
+ private:
+  Vector<unsigned> store_;
+  bool owns_store_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeCacheData);
+};
+
+
+// Serializes a compiled top-level function, with the code of the functions
+// that were compiled eagerly and the lazy compile stubs of the rest, so that
+// a later run can skip parsing and compiling a script it has seen before.
+// Unlike the snapshot serializers it works on a heap that is in use: roots
+// and builtins are referred to by index, symbols are re-interned when the
+// cache is loaded and the script source is supplied again by the embedder
+// instead of being stored in the cache.  Code stubs are stored with their key
+// and only used if the isolate that loads the cache has not generated them
+// itself, and uninitialized call ICs are looked up again.  The code must have
+// been generated in a CodeCacheScope.
+class CodeSerializer : public Serializer {
+ public:
+  // Returns NULL if the function graph contains objects that cannot be
+  // cached, e.g. objects that belong to a context.
+  static CodeCacheData* Serialize(Handle<SharedFunctionInfo> info);
+
+  // Returns a null handle if the cache was produced for another source, V8
+  // version or set of flags.
+  static Handle<SharedFunctionInfo> Deserialize(CodeCacheData* data,
+                                                Handle<String> source);
+
+  static bool IsCodeCache(ScriptData* data);
+
+  virtual void SerializeObject(Object* o,
+                               HowToCode how_to_code,
+                               WhereToPoint where_to_point);
+
+  static const unsigned kMagicNumber = 0xC0DECAC4;
+  static const int kMagicOffset = 0;
+  static const int kVersionHashOffset = 1;
+  static const int kSourceHashOffset = 2;
+  static const int kFlagHashOffset = 3;
+  static const int kPayloadLengthOffset = 4;
+  static const int kHeaderSize = 5;
+
+ private:
+  CodeSerializer(SnapshotByteSink* sink,
+                 Handle<String> source,
+                 Handle<Script> script,
+                 Handle<Script> sanitized_script);
+
+  // Serializes the code of a stub for the given outermost serializer, which
+  // keeps the attachments.
+  CodeSerializer(SnapshotByteSink* sink, CodeSerializer* outer, Code* stub);
+
+  virtual bool ShouldBeInThePartialSnapshotCache(HeapObject* o) {
+    return false;
+  }
+  virtual int SpaceToAllocateIn(HeapObject* object);
+
+  bool IsSerializable(HeapObject* object);
+  bool CanSerializeCode(Code* code);
+  bool IsUninitializedCallIC(Code* code);
+  void SerializeAttachedReference(int index,
+                                  HowToCode how_to_code,
+                                  WhereToPoint where_to_point);
+  int SymbolIndex(String* symbol);
+  int CallICIndex(Code* code);
+  int StubIndex(Code* stub);
+  int Attach(HeapObject* object);
+  void WriteReservations(SnapshotByteSink* sink);
+
+  static uint32_t VersionHash();
+  static uint32_t SourceHash(Handle<String> source);
+  static Handle<Object> ReadAttachment(SnapshotByteSource* payload,
+                                       Handle<FixedArray> attached_objects);
+  static Handle<Code> ReadStub(uint32_t key,
+                               SnapshotByteSource* payload,
+                               Handle<FixedArray> attached_objects);
+
+  // What the objects are referred to with kAttachedReference.  Attached
+  // reference 0 is the source, the attachments follow in the order in which
+  // they were completed, so that a stub comes after the ones that it uses.
+  enum AttachmentKind {
+    kSymbolAttachment,
+    kCallICAttachment,
+    kStubAttachment
+  };
+  static const int kSourceIndex = 0;
+
+  CodeSerializer* outermost_;
+  Code* stub_;
+  Handle<String> source_;
+  Handle<Script> script_;
+  Handle<Script> sanitized_script_;
+  SerializationAddressMapper builtins_;
+  SerializationAddressMapper stub_keys_;
+  SerializationAddressMapper attachment_indices_;
+  List<Code*> stubs_in_progress_;
+  List<byte> attachments_;
+  int attachment_count_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeSerializer);
+};
+
+
+// Makes the isolate generate code that can be put into a code cache: external
+// references are recorded instead of being addressed relative to the isolate
+// and code stubs are generated anew into a dictionary of their own, which the
+// CodeSerializer gets the keys of the stubs from.
+class CodeCacheScope BASE_EMBEDDED {
+ public:
+  explicit CodeCacheScope(Isolate* isolate);
+  ~CodeCacheScope();
+
+ private:
+  Isolate* isolate_;
+  Handle<Object> stubs_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeCacheScope);
+};
+
+
 } }  // namespace v8::internal
 
 #endif  // V8_SERIALIZE_H_
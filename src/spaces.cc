@@ -31,6 +31,7 @@
 #include "macro-assembler.h"
 #include "mark-compact.h"
 #include "platform.h"
+#include "sampling-heap-profiler.h"
 
 namespace v8 {
 namespace internal {
@@ -135,7 +136,13 @@ CodeRange::CodeRange(Isolate* isolate)
 bool CodeRange::SetUp(const size_t requested) {
   ASSERT(code_range_ == NULL);
 
-  code_range_ = new VirtualMemory(requested);
+  if (FLAG_huge_pages && VirtualMemory::HugePageSize() > 0) {
+    // Start the range at a huge page boundary, so that large code chunks
+    // allocated from it can be backed by huge pages.
+    code_range_ = new VirtualMemory(requested, VirtualMemory::HugePageSize());
+  } else {
+    code_range_ = new VirtualMemory(requested);
+  }
   CHECK(code_range_ != NULL);
   if (!code_range_->IsReserved()) {
     delete code_range_;
@@ -166,15 +173,7 @@ int CodeRange::CompareFreeBlockAddress(const FreeBlock* left,
 }
 
 
-void CodeRange::GetNextAllocationBlock(size_t requested) {
-  for (current_allocation_block_index_++;
-       current_allocation_block_index_ < allocation_list_.length();
-       current_allocation_block_index_++) {
-    if (requested <= allocation_list_[current_allocation_block_index_].size) {
-      return;  // Found a large enough allocation block.
-    }
-  }
-
+void CodeRange::MergeFreeBlocks() {
   // Sort and merge the free blocks on the free list and the allocation list.
   free_list_.AddAll(allocation_list_);
   allocation_list_.Clear();
@@ -193,6 +192,27 @@ void CodeRange::GetNextAllocationBlock(size_t requested) {
     }
   }
   free_list_.Clear();
+}
+
+
+void CodeRange::TrimFreeList() {
+  if (free_list_.is_empty()) return;
+  MergeFreeBlocks();
+  current_allocation_block_index_ = 0;
+  free_list_.Free();
+}
+
+
+void CodeRange::GetNextAllocationBlock(size_t requested) {
+  for (current_allocation_block_index_++;
+       current_allocation_block_index_ < allocation_list_.length();
+       current_allocation_block_index_++) {
+    if (requested <= allocation_list_[current_allocation_block_index_].size) {
+      return;  // Found a large enough allocation block.
+    }
+  }
+
+  MergeFreeBlocks();
 
   for (current_allocation_block_index_ = 0;
        current_allocation_block_index_ < allocation_list_.length();
@@ -245,7 +265,11 @@ Address CodeRange::AllocateRawMemory(const size_t requested,
 void CodeRange::FreeRawMemory(Address address, size_t length) {
   ASSERT(IsAddressAligned(address, MemoryChunk::kAlignment));
   free_list_.Add(FreeBlock(address, length));
-  code_range_->Uncommit(address, length);
+  // With huge pages, keep the mapping and its huge page advice and only give
+  // the physical memory back.
+  if (!FLAG_huge_pages || !VirtualMemory::DiscardRegion(address, length)) {
+    code_range_->Uncommit(address, length);
+  }
 }
 
 
@@ -266,7 +290,12 @@ MemoryAllocator::MemoryAllocator(Isolate* isolate)
       capacity_(0),
       capacity_executable_(0),
       size_(0),
-      size_executable_(0) {
+      size_executable_(0),
+      size_huge_pages_(0),
+      size_pooled_large_chunks_(0) {
+  for (int i = 0; i < kLargeChunkSizeClasses; i++) {
+    pooled_large_chunks_[i] = NULL;
+  }
 }
 
 
@@ -277,18 +306,21 @@ bool MemoryAllocator::SetUp(intptr_t capacity, intptr_t capacity_executable) {
 
   size_ = 0;
   size_executable_ = 0;
+  size_huge_pages_ = 0;
 
   return true;
 }
 
 
 void MemoryAllocator::TearDown() {
+  ReleasePooledLargeChunks();
   // Check that spaces were torn down before MemoryAllocator.
   ASSERT(size_ == 0);
   // TODO(gc) this will be true again when we fix FreeMemory.
   // ASSERT(size_executable_ == 0);
   capacity_ = 0;
   capacity_executable_ = 0;
+  size_huge_pages_ = 0;
 }
 
 
@@ -447,6 +479,8 @@ MemoryChunk* MemoryChunk::Initialize(Heap* heap,
   chunk->InitializeReservedMemory();
   chunk->slots_buffer_ = NULL;
   chunk->skip_list_ = NULL;
+  chunk->set_parallel_sweeping(PARALLEL_SWEEPING_DONE);
+  chunk->slot_set_ = NULL;
   chunk->ResetLiveBytes();
   Bitmap::Clear(chunk);
   chunk->initialize_scan_on_scavenge(false);
@@ -467,6 +501,20 @@ MemoryChunk* MemoryChunk::Initialize(Heap* heap,
 }
 
 
+SlotSet* MemoryChunk::AllocateSlotSet() {
+  ASSERT(slot_set_ == NULL);
+  ASSERT(!InNewSpace());
+  slot_set_ = new SlotSet(address(), size());
+  return slot_set_;
+}
+
+
+void MemoryChunk::ReleaseSlotSet() {
+  delete slot_set_;
+  slot_set_ = NULL;
+}
+
+
 void MemoryChunk::InsertAfter(MemoryChunk* other) {
   next_chunk_ = other->next_chunk_;
   prev_chunk_ = other;
@@ -487,6 +535,38 @@ void MemoryChunk::Unlink() {
 }
 
 
+// Returns the whole huge pages inside [start..(start+size)[ and stores the
+// start of the first one in huge_start.
+static size_t HugePagesInBlock(Address start,
+                               size_t size,
+                               Address* huge_start) {
+  size_t huge_page_size = VirtualMemory::HugePageSize();
+  if (huge_page_size == 0) return 0;
+  Address begin = RoundUp(start, huge_page_size);
+  Address end = RoundDown(start + size, huge_page_size);
+  if (end <= begin) return 0;
+  *huge_start = begin;
+  return static_cast<size_t>(end - begin);
+}
+
+
+bool MemoryAllocator::AdviseHugePages(Address start, size_t size) {
+  Address huge_start = NULL;
+  size_t huge_size = HugePagesInBlock(start, size, &huge_start);
+  if (huge_size == 0) return false;
+  if (!VirtualMemory::AdviseHugePages(huge_start, huge_size)) return false;
+  size_huge_pages_ += huge_size;
+  return true;
+}
+
+
+size_t MemoryAllocator::HugePagesInChunk(MemoryChunk* chunk) {
+  if (!chunk->IsFlagSet(MemoryChunk::HUGE_PAGES)) return 0;
+  Address huge_start = NULL;
+  return HugePagesInBlock(chunk->address(), chunk->size(), &huge_start);
+}
+
+
 MemoryChunk* MemoryAllocator::AllocateChunk(intptr_t body_size,
                                             Executability executable,
                                             Space* owner) {
@@ -496,6 +576,7 @@ MemoryChunk* MemoryAllocator::AllocateChunk(intptr_t body_size,
   VirtualMemory reservation;
   Address area_start = NULL;
   Address area_end = NULL;
+  bool huge_pages = false;
   if (executable == EXECUTABLE) {
     chunk_size = RoundUp(CodePageAreaStartOffset() + body_size,
                          OS::CommitPageSize()) + CodePageGuardSize();
@@ -518,6 +599,7 @@ MemoryChunk* MemoryAllocator::AllocateChunk(intptr_t body_size,
       size_ += chunk_size;
       // Update executable memory size.
       size_executable_ += chunk_size;
+      huge_pages = FLAG_huge_pages && AdviseHugePages(base, chunk_size);
     } else {
       base = AllocateAlignedMemory(chunk_size,
                                    MemoryChunk::kAlignment,
@@ -536,12 +618,20 @@ MemoryChunk* MemoryAllocator::AllocateChunk(intptr_t body_size,
     area_end = area_start + body_size;
   } else {
     chunk_size = MemoryChunk::kObjectStartOffset + body_size;
+    // Chunks spanning at least one huge page start at a huge page boundary.
+    size_t alignment = MemoryChunk::kAlignment;
+    if (FLAG_huge_pages &&
+        VirtualMemory::HugePageSize() > 0 &&
+        chunk_size >= VirtualMemory::HugePageSize()) {
+      alignment = VirtualMemory::HugePageSize();
+    }
     base = AllocateAlignedMemory(chunk_size,
-                                 MemoryChunk::kAlignment,
+                                 alignment,
                                  executable,
                                  &reservation);
 
     if (base == NULL) return NULL;
+    huge_pages = FLAG_huge_pages && AdviseHugePages(base, chunk_size);
 
 #ifdef DEBUG
     ZapBlock(base, chunk_size);
@@ -568,6 +658,7 @@ MemoryChunk* MemoryAllocator::AllocateChunk(intptr_t body_size,
                                                 executable,
                                                 owner);
   result->set_reserved_memory(&reservation);
+  if (huge_pages) result->SetFlag(MemoryChunk::HUGE_PAGES);
   return result;
 }
 
@@ -586,12 +677,129 @@ Page* MemoryAllocator::AllocatePage(intptr_t size,
 LargePage* MemoryAllocator::AllocateLargePage(intptr_t object_size,
                                               Space* owner,
                                               Executability executable) {
-  MemoryChunk* chunk = AllocateChunk(object_size, executable, owner);
+  MemoryChunk* chunk = NULL;
+  if (executable == NOT_EXECUTABLE) {
+    chunk = TakePooledLargeChunk(object_size, owner);
+  }
+  if (chunk == NULL) {
+    chunk = AllocateChunk(object_size, executable, owner);
+  }
+  if (chunk == NULL && size_pooled_large_chunks_ > 0) {
+    // The pooled chunks may be what keeps us from mapping a new one.
+    ReleasePooledLargeChunks();
+    chunk = AllocateChunk(object_size, executable, owner);
+  }
   if (chunk == NULL) return NULL;
   return LargePage::Initialize(isolate_->heap(), chunk);
 }
 
 
+int MemoryAllocator::LargeChunkSizeClass(size_t chunk_size) {
+  int size_class = 0;
+  while (size_class < kLargeChunkSizeClasses &&
+         (static_cast<size_t>(Page::kPageSize) << (size_class + 1)) <
+             chunk_size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+
+bool MemoryAllocator::PoolLargeChunk(MemoryChunk* chunk) {
+  if (chunk->owner() != isolate_->heap()->lo_space() ||
+      chunk->executable() == EXECUTABLE ||
+      !chunk->reserved_memory()->IsReserved()) {
+    return false;
+  }
+  int size_class = LargeChunkSizeClass(chunk->size());
+  if (size_class == kLargeChunkSizeClasses) return false;
+  size_t limit = static_cast<size_t>(FLAG_large_object_chunk_pool_size) * MB;
+  if (size_pooled_large_chunks_ + chunk->size() > limit) return false;
+  chunk->set_next_chunk(pooled_large_chunks_[size_class]);
+  pooled_large_chunks_[size_class] = chunk;
+  size_pooled_large_chunks_ += chunk->size();
+  return true;
+}
+
+
+MemoryChunk* MemoryAllocator::TakePooledLargeChunk(intptr_t body_size,
+                                                   Space* owner) {
+  if (size_pooled_large_chunks_ == 0) return NULL;
+  size_t chunk_size = MemoryChunk::kObjectStartOffset + body_size;
+  size_t max_chunk_size = chunk_size + chunk_size / 4;
+  // A fitting chunk is either in the class of the requested size or, if
+  // that size is close to the upper bound of its class, in the next one.
+  int first_class = LargeChunkSizeClass(chunk_size);
+  int last_class = Min(LargeChunkSizeClass(max_chunk_size),
+                       kLargeChunkSizeClasses - 1);
+  for (int size_class = first_class; size_class <= last_class; size_class++) {
+    MemoryChunk* previous = NULL;
+    MemoryChunk* chunk = pooled_large_chunks_[size_class];
+    while (chunk != NULL &&
+           (chunk->size() < chunk_size || chunk->size() > max_chunk_size)) {
+      previous = chunk;
+      chunk = chunk->next_chunk();
+    }
+    if (chunk == NULL) continue;
+    if (previous == NULL) {
+      pooled_large_chunks_[size_class] = chunk->next_chunk();
+    } else {
+      previous->set_next_chunk(chunk->next_chunk());
+    }
+    size_pooled_large_chunks_ -= chunk->size();
+
+    Address base = chunk->address();
+    size_t size = chunk->size();
+    bool huge_pages = chunk->IsFlagSet(MemoryChunk::HUGE_PAGES);
+    VirtualMemory reservation;
+    reservation.TakeControl(chunk->reserved_memory());
+
+    // The fake chunk headers left by Heap::FreeQueuedChunks are overwritten
+    // by the new object before any of its slots can be looked up.
+#ifdef DEBUG
+    ZapBlock(base + Page::kObjectStartOffset,
+             size - Page::kObjectStartOffset);
+#endif
+
+    LOG(isolate_, NewEvent("MemoryChunk", base, size));
+    if (owner != NULL) {
+      ObjectSpace space = static_cast<ObjectSpace>(1 << owner->identity());
+      PerformAllocationCallback(space, kAllocationActionAllocate, size);
+    }
+
+    MemoryChunk* result = MemoryChunk::Initialize(isolate_->heap(),
+                                                  base,
+                                                  size,
+                                                  base + Page::kObjectStartOffset,
+                                                  base + size,
+                                                  NOT_EXECUTABLE,
+                                                  owner);
+    result->set_reserved_memory(&reservation);
+    if (huge_pages) {
+      result->SetFlag(MemoryChunk::HUGE_PAGES);
+      size_huge_pages_ += HugePagesInChunk(result);
+    }
+    return result;
+  }
+  return NULL;
+}
+
+
+void MemoryAllocator::ReleasePooledLargeChunks() {
+  for (int i = 0; i < kLargeChunkSizeClasses; i++) {
+    MemoryChunk* chunk = pooled_large_chunks_[i];
+    pooled_large_chunks_[i] = NULL;
+    while (chunk != NULL) {
+      MemoryChunk* next = chunk->next_chunk();
+      size_pooled_large_chunks_ -= chunk->size();
+      UnmapChunk(chunk);
+      chunk = next;
+    }
+  }
+  ASSERT(size_pooled_large_chunks_ == 0);
+}
+
+
 void MemoryAllocator::Free(MemoryChunk* chunk) {
   LOG(isolate_, DeleteEvent("MemoryChunk", chunk));
   if (chunk->owner() != NULL) {
@@ -600,11 +808,23 @@ void MemoryAllocator::Free(MemoryChunk* chunk) {
     PerformAllocationCallback(space, kAllocationActionFree, chunk->size());
   }
 
-  isolate_->heap()->RememberUnmappedPage(
-      reinterpret_cast<Address>(chunk), chunk->IsEvacuationCandidate());
-
   delete chunk->slots_buffer();
   delete chunk->skip_list();
+  chunk->ReleaseSlotSet();
+
+  // Pooled chunks are not counted as huge pages until they are reused.
+  size_t huge_size = HugePagesInChunk(chunk);
+  ASSERT(size_huge_pages_ >= huge_size);
+  size_huge_pages_ -= huge_size;
+
+  if (PoolLargeChunk(chunk)) return;
+  UnmapChunk(chunk);
+}
+
+
+void MemoryAllocator::UnmapChunk(MemoryChunk* chunk) {
+  isolate_->heap()->RememberUnmappedPage(
+      reinterpret_cast<Address>(chunk), chunk->IsEvacuationCandidate());
 
   VirtualMemory* reservation = chunk->reserved_memory();
   if (reservation->IsReserved()) {
@@ -980,6 +1200,20 @@ void PagedSpace::ReleaseAllUnusedPages() {
 }
 
 
+intptr_t PagedSpace::EstimateLiveBytes(Page* p, FreeList::SizeStats* sizes) {
+  if (!p->WasSwept()) {
+    // There are no free list items on a page that was not swept.
+    sizes->small_size_ = 0;
+    sizes->medium_size_ = 0;
+    sizes->large_size_ = 0;
+    sizes->huge_size_ = 0;
+    return p->LiveBytes();
+  }
+  free_list_.CountFreeListItems(p, sizes);
+  return p->area_size() - sizes->Total();
+}
+
+
 #ifdef DEBUG
 void PagedSpace::Print() { }
 #endif
@@ -1150,7 +1384,13 @@ void NewSpace::Grow() {
 
 
 void NewSpace::Shrink() {
-  int new_capacity = Max(InitialCapacity(), 2 * SizeAsInt());
+  ShrinkTo(InitialCapacity());
+}
+
+
+void NewSpace::ShrinkTo(int capacity) {
+  ASSERT(capacity >= InitialCapacity());
+  int new_capacity = Max(capacity, 2 * SizeAsInt());
   int rounded_new_capacity = RoundUp(new_capacity, Page::kPageSize);
   if (rounded_new_capacity < Capacity() &&
       to_space_.ShrinkTo(rounded_new_capacity))  {
@@ -1173,16 +1413,39 @@ void NewSpace::Shrink() {
 
 void NewSpace::UpdateAllocationInfo() {
   allocation_info_.top = to_space_.page_low();
-  allocation_info_.limit = to_space_.page_high();
+  UpdateInlineAllocationLimit(0);
+  ASSERT_SEMISPACE_ALLOCATION_INFO(allocation_info_, to_space_);
+}
+
+
+void NewSpace::UpdateInlineAllocationLimit(int size_in_bytes) {
+  Address new_top = allocation_info_.top + size_in_bytes;
+  Address limit = to_space_.page_high();
 
   // Lower limit during incremental marking.
-  if (heap()->incremental_marking()->IsMarking() &&
-      inline_allocation_limit_step() != 0) {
-    Address new_limit =
-        allocation_info_.top + inline_allocation_limit_step();
-    allocation_info_.limit = Min(new_limit, allocation_info_.limit);
+  if (inline_allocation_limit_step() != 0) {
+    limit = Min(limit, new_top + inline_allocation_limit_step());
   }
-  ASSERT_SEMISPACE_ALLOCATION_INFO(allocation_info_, to_space_);
+
+  // Lower limit to the next allocation sample.  The sample may already be
+  // due, then the next allocation takes it.
+  SamplingHeapProfiler* sampler = heap()->sampling_heap_profiler();
+  if (sampler != NULL) {
+    limit = Min(limit, new_top + Max(static_cast<intptr_t>(0),
+                                     sampler->bytes_until_sample()));
+  }
+
+  allocation_info_.limit = Max(limit, allocation_info_.top);
+}
+
+
+void NewSpace::AllocationStep(Address top, int object_size) {
+  int bytes_allocated = static_cast<int>(top - top_on_previous_step_);
+  heap()->incremental_marking()->Step(
+      bytes_allocated, IncrementalMarking::GC_VIA_STACK_GUARD);
+  SamplingHeapProfiler* sampler = heap()->sampling_heap_profiler();
+  if (sampler != NULL) sampler->Step(bytes_allocated, object_size);
+  top_on_previous_step_ = top;
 }
 
 
@@ -1234,23 +1497,20 @@ MaybeObject* NewSpace::SlowAllocateRaw(int size_in_bytes) {
   Address old_top = allocation_info_.top;
   Address new_top = old_top + size_in_bytes;
   Address high = to_space_.page_high();
-  if (allocation_info_.limit < high) {
-    // Incremental marking has lowered the limit to get a
-    // chance to do a step.
-    allocation_info_.limit = Min(
-        allocation_info_.limit + inline_allocation_limit_step_,
-        high);
-    int bytes_allocated = static_cast<int>(new_top - top_on_previous_step_);
-    heap()->incremental_marking()->Step(
-        bytes_allocated, IncrementalMarking::GC_VIA_STACK_GUARD);
-    top_on_previous_step_ = new_top;
+  if (allocation_info_.limit < high && new_top <= high) {
+    // Incremental marking or the allocation sampler has lowered the limit
+    // to get a chance to do a step.
+    AllocationStep(new_top, size_in_bytes);
+    UpdateInlineAllocationLimit(size_in_bytes);
     return AllocateRaw(size_in_bytes);
-  } else if (AddFreshPage()) {
+  }
+  // The object is allocated on the next page, the rest of this one is
+  // wasted.
+  AllocationStep(old_top, 0);
+  if (AddFreshPage()) {
     // Switched to new page. Try allocating again.
-    int bytes_allocated = static_cast<int>(old_top - top_on_previous_step_);
-    heap()->incremental_marking()->Step(
-        bytes_allocated, IncrementalMarking::GC_VIA_STACK_GUARD);
     top_on_previous_step_ = to_space_.page_low();
+    UpdateInlineAllocationLimit(0);
     return AllocateRaw(size_in_bytes);
   } else {
     return Failure::RetryAfterGC();
@@ -1931,6 +2191,29 @@ int FreeList::Free(Address start, int size_in_bytes) {
 }
 
 
+void FreeList::ConcatenateList(FreeListNode** list, FreeListNode** other) {
+  FreeListNode* head = *other;
+  if (head == NULL) return;
+  FreeListNode* tail = head;
+  while (tail->next() != NULL) tail = tail->next();
+  tail->set_next(*list);
+  *list = head;
+  *other = NULL;
+}
+
+
+intptr_t FreeList::Concatenate(FreeList* other) {
+  intptr_t moved_bytes = other->available_;
+  ConcatenateList(&small_list_, &other->small_list_);
+  ConcatenateList(&medium_list_, &other->medium_list_);
+  ConcatenateList(&large_list_, &other->large_list_);
+  ConcatenateList(&huge_list_, &other->huge_list_);
+  available_ += moved_bytes;
+  other->Reset();
+  return moved_bytes;
+}
+
+
 FreeListNode* FreeList::PickNodeFromList(FreeListNode** list, int* node_size) {
   FreeListNode* node = *list;
 
@@ -2274,6 +2557,17 @@ bool LargeObjectSpace::ReserveSpace(int bytes) {
 bool PagedSpace::AdvanceSweeper(intptr_t bytes_to_sweep) {
   if (IsSweepingComplete()) return true;
 
+  MarkCompactCollector* collector = heap()->mark_compact_collector();
+  if (collector->IsConcurrentSweepingInProgress()) {
+    AdvanceConcurrentSweeper(bytes_to_sweep);
+    // Once every page is accounted for the sweeper threads are about to
+    // run out of work, so we can join them without blocking for long.
+    if (heap()->IsSweepingComplete()) {
+      collector->WaitUntilSweepingCompleted();
+    }
+    return IsSweepingComplete();
+  }
+
   intptr_t freed_bytes = 0;
   Page* p = first_unswept_page_;
   do {
@@ -2301,6 +2595,89 @@ bool PagedSpace::AdvanceSweeper(intptr_t bytes_to_sweep) {
 }
 
 
+void PagedSpace::AdvanceConcurrentSweeper(intptr_t bytes_to_sweep) {
+  if (IsSweepingComplete()) return;
+
+  intptr_t freed_bytes =
+      heap()->mark_compact_collector()->StealMemoryFromSweeperThreads(this);
+
+  // Pages with a pending sweep are after first_unswept_page_, but not
+  // necessarily in order, since the sweeper threads claim pages on their own.
+  Page* first_unswept = NULL;
+  Page* p = first_unswept_page_;
+  do {
+    switch (p->parallel_sweeping()) {
+      case MemoryChunk::PARALLEL_SWEEPING_DONE:
+        break;
+      case MemoryChunk::PARALLEL_SWEEPING_FINALIZE:
+        FinalizeSweptPage(p);
+        break;
+      case MemoryChunk::PARALLEL_SWEEPING_PENDING:
+      case MemoryChunk::PARALLEL_SWEEPING_IN_PROGRESS:
+        if (freed_bytes < bytes_to_sweep) {
+          if (p->TryParallelSweeping()) {
+            freed_bytes += SweepClaimedPage(p);
+          } else {
+            // Still not enough memory, so wait for the sweeper thread that
+            // is working on this page.
+            EnsurePageIsSwept(p);
+            freed_bytes += heap()->mark_compact_collector()->
+                StealMemoryFromSweeperThreads(this);
+            FinalizeSweptPage(p);
+          }
+        } else if (first_unswept == NULL) {
+          first_unswept = p;
+        }
+        break;
+    }
+    p = p->next_page();
+  } while (p != anchor());
+
+  first_unswept_page_ =
+      (first_unswept == NULL) ? Page::FromAddress(NULL) : first_unswept;
+}
+
+
+void PagedSpace::EnsurePageIsSwept(Page* p) {
+  if (p->parallel_sweeping() == MemoryChunk::PARALLEL_SWEEPING_DONE) return;
+
+  if (p->TryParallelSweeping()) {
+    SweepClaimedPage(p);
+    return;
+  }
+
+  while (p->parallel_sweeping() ==
+         MemoryChunk::PARALLEL_SWEEPING_IN_PROGRESS) {
+    Thread::YieldCPU();
+  }
+}
+
+
+intptr_t PagedSpace::SweepClaimedPage(Page* p) {
+  ASSERT(p->parallel_sweeping() ==
+         MemoryChunk::PARALLEL_SWEEPING_IN_PROGRESS);
+  if (FLAG_gc_verbose) {
+    PrintF("Sweeping 0x%" V8PRIxPTR " on the main thread.\n",
+           reinterpret_cast<intptr_t>(p));
+  }
+  DecreaseUnsweptFreeBytes(p);
+  intptr_t freed_bytes = MarkCompactCollector::SweepConservatively(this, p);
+  p->set_parallel_sweeping(MemoryChunk::PARALLEL_SWEEPING_DONE);
+  heap()->isolate()->counters()->pages_swept_by_main_thread()->Increment();
+  return freed_bytes;
+}
+
+
+void PagedSpace::FinalizeSweptPage(Page* p) {
+  ASSERT(p->parallel_sweeping() == MemoryChunk::PARALLEL_SWEEPING_FINALIZE);
+  DecreaseUnsweptFreeBytes(p);
+  p->ResetLiveBytes();
+  p->MarkSweptConservatively();
+  p->set_parallel_sweeping(MemoryChunk::PARALLEL_SWEEPING_DONE);
+  heap()->isolate()->counters()->pages_swept_concurrently()->Increment();
+}
+
+
 void PagedSpace::EvictEvacuationCandidatesFromFreeLists() {
   if (allocation_info_.top >= allocation_info_.limit) return;
 
@@ -2347,6 +2724,12 @@ HeapObject* PagedSpace::SlowAllocateRaw(int size_in_bytes) {
   if (!IsSweepingComplete()) {
     AdvanceSweeper(kMaxInt);
 
+    // Pages still being swept by the sweeper threads are waited for.
+    MarkCompactCollector* collector = heap()->mark_compact_collector();
+    if (collector->IsConcurrentSweepingInProgress()) {
+      collector->WaitUntilSweepingCompleted();
+    }
+
     // Retry the free list allocation.
     HeapObject* object = free_list_.Allocate(size_in_bytes);
     if (object != NULL) return object;
@@ -2687,6 +3070,43 @@ LargePage* LargeObjectSpace::FindPage(Address a) {
 }
 
 
+void LargeObjectSpace::ReleaseTrimmedTail(HeapObject* object,
+                                          int bytes_trimmed) {
+  objects_size_ -= bytes_trimmed;
+
+  // Marking may still visit the filler, and huge pages and the guard page
+  // of executable chunks cannot be uncommitted piecewise.
+  LargePage* page =
+      static_cast<LargePage*>(MemoryChunk::FromAddress(object->address()));
+  if (!heap()->incremental_marking()->IsStopped() ||
+      page->IsFlagSet(MemoryChunk::HUGE_PAGES) ||
+      page->executable() == EXECUTABLE ||
+      !page->reserved_memory()->IsReserved()) {
+    return;
+  }
+
+  Address old_end = page->address() + page->size();
+  Address new_end = RoundUp(object->address() + object->Size(),
+                            OS::CommitPageSize());
+  if (new_end >= old_end) return;
+
+  heap()->store_buffer()->RemoveSlots(page, new_end, old_end);
+  if (!page->reserved_memory()->Uncommit(new_end, old_end - new_end)) return;
+
+  const intptr_t alignment = MemoryChunk::kAlignment;
+  uintptr_t first = (reinterpret_cast<uintptr_t>(new_end) - 1) / alignment + 1;
+  uintptr_t last = (reinterpret_cast<uintptr_t>(old_end) - 1) / alignment;
+  for (uintptr_t key = first; key <= last; key++) {
+    chunk_map_.Remove(reinterpret_cast<void*>(key),
+                      static_cast<uint32_t>(key));
+  }
+
+  size_ -= old_end - new_end;
+  page->set_size(new_end - page->address());
+  page->SetArea(page->area_start(), new_end);
+}
+
+
 void LargeObjectSpace::FreeUnmarkedObjects() {
   LargePage* previous = NULL;
   LargePage* current = first_page_;
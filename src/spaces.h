@@ -29,6 +29,7 @@
 #define V8_SPACES_H_
 
 #include "allocation.h"
+#include "atomicops.h"
 #include "hashmap.h"
 #include "list.h"
 #include "log.h"
@@ -141,6 +142,21 @@ class MarkBit {
   inline bool Get() { return (*cell_ & mask_) != 0; }
   inline void Clear() { *cell_ &= ~mask_; }
 
+  // Sets the bit with a compare-and-swap on the whole cell so that bits of
+  // neighbouring objects updated concurrently are not lost.  Returns false
+  // if the bit was already set, i.e. another marker got there first.
+  inline bool AtomicSet() {
+    volatile Atomic32* cell = reinterpret_cast<volatile Atomic32*>(cell_);
+    Atomic32 old_value = NoBarrier_Load(cell);
+    while ((old_value & static_cast<Atomic32>(mask_)) == 0) {
+      Atomic32 new_value = old_value | static_cast<Atomic32>(mask_);
+      Atomic32 result = Acquire_CompareAndSwap(cell, old_value, new_value);
+      if (result == old_value) return true;
+      old_value = result;
+    }
+    return false;
+  }
+
   inline bool data_only() { return data_only_; }
 
   inline MarkBit Next() {
@@ -292,6 +308,7 @@ class Bitmap {
 
 
 class SkipList;
+class SlotSet;
 class SlotsBuffer;
 
 // MemoryChunk represents a memory region owned by a specific space.
@@ -393,6 +410,10 @@ class MemoryChunk {
     WAS_SWEPT_PRECISELY,
     WAS_SWEPT_CONSERVATIVELY,
 
+    // The whole huge pages of the chunk were advised to be backed by huge
+    // pages, see MemoryAllocator::AdviseHugePages.
+    HUGE_PAGES,
+
     // Last flag, keep at bottom.
     NUM_MEMORY_CHUNK_FLAGS
   };
@@ -444,6 +465,36 @@ class MemoryChunk {
   // Return all current flags.
   intptr_t GetFlags() { return flags_; }
 
+  // State of a page with respect to concurrent sweeping.  Pages queued for
+  // the sweeper threads start out PENDING and are claimed by exactly one
+  // thread (possibly the main thread).  A page swept by a sweeper thread
+  // stays in FINALIZE until the main thread has updated its flags and the
+  // space accounting.  All other pages are DONE.
+  enum ParallelSweepingState {
+    PARALLEL_SWEEPING_DONE,
+    PARALLEL_SWEEPING_FINALIZE,
+    PARALLEL_SWEEPING_IN_PROGRESS,
+    PARALLEL_SWEEPING_PENDING
+  };
+
+  ParallelSweepingState parallel_sweeping() {
+    return static_cast<ParallelSweepingState>(
+        Acquire_Load(&parallel_sweeping_));
+  }
+
+  void set_parallel_sweeping(ParallelSweepingState state) {
+    Release_Store(&parallel_sweeping_, state);
+  }
+
+  // Claims a pending page for sweeping.  Returns false if the page was not
+  // pending or another thread claimed it first.
+  bool TryParallelSweeping() {
+    return Acquire_CompareAndSwap(&parallel_sweeping_,
+                                  PARALLEL_SWEEPING_PENDING,
+                                  PARALLEL_SWEEPING_IN_PROGRESS) ==
+        PARALLEL_SWEEPING_PENDING;
+  }
+
   // Manage live byte count (count of bytes known to be live,
   // because they are marked black).
   void ResetLiveBytes() {
@@ -472,6 +523,14 @@ class MemoryChunk {
     MemoryChunk::FromAddress(address)->IncrementLiveBytes(by);
   }
 
+  // Used by parallel marking where several threads account live bytes on
+  // the same chunk.
+  static void IncrementLiveBytesFromGCAtomically(Address address, int by) {
+    MemoryChunk* chunk = MemoryChunk::FromAddress(address);
+    NoBarrier_AtomicIncrement(
+        reinterpret_cast<volatile Atomic32*>(&chunk->live_byte_count_), by);
+  }
+
   static void IncrementLiveBytesFromMutator(Address address, int by);
 
   static const intptr_t kAlignment =
@@ -489,7 +548,8 @@ class MemoryChunk {
   static const size_t kSlotsBufferOffset = kLiveBytesOffset + kIntSize;
 
   static const size_t kHeaderSize =
-      kSlotsBufferOffset + kPointerSize + kPointerSize;
+      kSlotsBufferOffset + kPointerSize + kPointerSize + kPointerSize +
+      kPointerSize;
 
   static const int kBodyOffset =
     CODE_POINTER_ALIGN(MAP_POINTER_ALIGN(kHeaderSize + Bitmap::kSize));
@@ -581,6 +641,16 @@ class MemoryChunk {
     return slots_buffer_;
   }
 
+  // The remembered set of slots on this chunk that point to new space, in
+  // addition to the ones in the store buffer.  NULL until the store buffer
+  // moves entries for this chunk into it.
+  inline SlotSet* slot_set() {
+    return slot_set_;
+  }
+
+  SlotSet* AllocateSlotSet();
+  void ReleaseSlotSet();
+
   inline SlotsBuffer** slots_buffer_address() {
     return &slots_buffer_;
   }
@@ -625,6 +695,9 @@ class MemoryChunk {
   int live_byte_count_;
   SlotsBuffer* slots_buffer_;
   SkipList* skip_list_;
+  // A ParallelSweepingState, accessed by the sweeper threads.
+  volatile AtomicWord parallel_sweeping_;
+  SlotSet* slot_set_;
 
   static MemoryChunk* Initialize(Heap* heap,
                                  Address base,
@@ -840,6 +913,10 @@ class CodeRange {
                                             size_t* allocated);
   void FreeRawMemory(Address buf, size_t length);
 
+  // Merges the blocks freed since the last allocation block search into the
+  // allocation list and releases the memory of the free list.
+  void TrimFreeList();
+
  private:
   Isolate* isolate_;
 
@@ -877,6 +954,9 @@ class CodeRange {
   // the existing free memory blocks, and searches again.
   // If none can be found, terminates V8 with FatalProcessOutOfMemory.
   void GetNextAllocationBlock(size_t requested);
+  // Sorts and merges the blocks of the free list and the allocation list
+  // into the allocation list.
+  void MergeFreeBlocks();
   // Compares the start addresses of two free blocks.
   static int CompareFreeBlockAddress(const FreeBlock* left,
                                      const FreeBlock* right);
@@ -960,6 +1040,14 @@ class MemoryAllocator {
 
   void Free(MemoryChunk* chunk);
 
+  // Unmaps the freed large object chunks that are kept for reuse.
+  void ReleasePooledLargeChunks();
+
+  // Returns the bytes of freed large object chunks kept for reuse.
+  intptr_t SizePooledLargeChunks() {
+    return static_cast<intptr_t>(size_pooled_large_chunks_);
+  }
+
   // Returns the maximum available bytes of heaps.
   intptr_t Available() { return capacity_ < size_ ? 0 : capacity_ - size_; }
 
@@ -975,6 +1063,9 @@ class MemoryAllocator {
   // Returns allocated executable spaces in bytes.
   intptr_t SizeExecutable() { return size_executable_; }
 
+  // Returns the bytes of allocated chunks that are backed by huge pages.
+  intptr_t SizeHugePages() { return size_huge_pages_; }
+
   // Returns maximum available bytes that the old space can have.
   intptr_t MaxAvailable() {
     return (Available() / Page::kPageSize) * Page::kMaxNonCodeHeapObjectSize;
@@ -1012,6 +1103,10 @@ class MemoryAllocator {
   // and false otherwise.
   bool UncommitBlock(Address start, size_t size);
 
+  // Advises the OS to back the whole huge pages inside the committed block
+  // [start..(start+size)[ with huge pages.  Returns true if there were any.
+  bool AdviseHugePages(Address start, size_t size);
+
   // Zaps a contiguous block of memory [start..(start+size)[ thus
   // filling it up with a recognizable non-NULL bit pattern.
   void ZapBlock(Address start, size_t size);
@@ -1058,6 +1153,33 @@ class MemoryAllocator {
   size_t size_;
   // Allocated executable space size in bytes.
   size_t size_executable_;
+  // Allocated space advised to be backed by huge pages in bytes, not
+  // counting pooled large object chunks.
+  size_t size_huge_pages_;
+
+  // Freed non-executable large object chunks stay mapped, up to
+  // --large-object-chunk-pool-size, so that large objects of similar size
+  // do not have to map and fault in fresh memory.  The chunks are kept in
+  // lists linked through next_chunk, one per size class: class c holds the
+  // chunks of up to Page::kPageSize << (c + 1) bytes.
+  static const int kLargeChunkSizeClasses = 8;
+  MemoryChunk* pooled_large_chunks_[kLargeChunkSizeClasses];
+  size_t size_pooled_large_chunks_;
+
+  static int LargeChunkSizeClass(size_t chunk_size);
+
+  // Returns false if the chunk does not qualify for the pool.
+  bool PoolLargeChunk(MemoryChunk* chunk);
+
+  // Reinitializes and returns a pooled chunk that fits body_size without
+  // wasting more than a quarter of it, or NULL.
+  MemoryChunk* TakePooledLargeChunk(intptr_t body_size, Space* owner);
+
+  // Returns the bytes of a chunk that are advised as huge pages.
+  static size_t HugePagesInChunk(MemoryChunk* chunk);
+
+  // Returns the memory of a chunk to the OS.
+  void UnmapChunk(MemoryChunk* chunk);
 
   struct MemoryAllocationCallbackRegistration {
     MemoryAllocationCallbackRegistration(MemoryAllocationCallback callback,
@@ -1366,6 +1488,11 @@ class FreeList BASE_EMBEDDED {
   // aligned, and the size should be a non-zero multiple of the word size.
   int Free(Address start, int size_in_bytes);
 
+  // Move all blocks of 'other' to this free list and clear 'other'.  Returns
+  // the number of bytes moved.  The time taken is linear in the length of
+  // 'other', so it should be the shorter of the two lists.
+  intptr_t Concatenate(FreeList* other);
+
   // Allocate a block of size 'size_in_bytes' from the free list.  The block
   // is unitialized.  A failure is returned if no block is available.  The
   // number of bytes lost to fragmentation is returned in the output parameter
@@ -1404,6 +1531,8 @@ class FreeList BASE_EMBEDDED {
 
   FreeListNode* FindNodeFor(int size_in_bytes, int* node_size);
 
+  static void ConcatenateList(FreeListNode** list, FreeListNode** other);
+
   PagedSpace* owner_;
   Heap* heap_;
 
@@ -1506,6 +1635,10 @@ class PagedSpace : public Space {
   Address top() { return allocation_info_.top; }
   Address limit() { return allocation_info_.limit; }
 
+  // The allocation top and limit addresses.
+  Address* allocation_top_address() { return &allocation_info_.top; }
+  Address* allocation_limit_address() { return &allocation_info_.limit; }
+
   // Allocate the requested number of bytes in the space if possible, return a
   // failure object if not.
   MUST_USE_RESULT inline MaybeObject* AllocateRaw(int size_in_bytes);
@@ -1602,8 +1735,29 @@ class PagedSpace : public Space {
     unswept_free_bytes_ -= (p->area_size() - p->LiveBytes());
   }
 
+  intptr_t unswept_free_bytes() { return unswept_free_bytes_; }
+
   bool AdvanceSweeper(intptr_t bytes_to_sweep);
 
+  // Concurrent sweeping support.  AdvanceConcurrentSweeper takes over the
+  // free memory found by the sweeper threads and finalizes the pages they
+  // have swept.  Until 'bytes_to_sweep' bytes are freed it also sweeps pages
+  // no sweeper thread has claimed yet and waits for the claimed ones.
+  void AdvanceConcurrentSweeper(intptr_t bytes_to_sweep);
+
+  // Makes sure that no sweeper thread is working on the given page anymore,
+  // either by sweeping it on the calling thread or by waiting for the sweeper
+  // thread that claimed it.
+  void EnsurePageIsSwept(Page* p);
+
+  // Adds the blocks of a free list filled by a sweeper thread to the free
+  // list of this space.  Returns the number of bytes added.
+  intptr_t AddSweptMemory(FreeList* free_list) {
+    intptr_t freed_bytes = free_list_.Concatenate(free_list);
+    accounting_stats_.DeallocateBytes(freed_bytes);
+    return freed_bytes;
+  }
+
   bool IsSweepingComplete() {
     return !first_unswept_page_->is_valid();
   }
@@ -1615,6 +1769,11 @@ class PagedSpace : public Space {
     free_list_.CountFreeListItems(p, sizes);
   }
 
+  // Returns the bytes of the page taken by objects: the marked bytes if the
+  // page was not swept yet, the area that is not on the free list otherwise.
+  // The free list fragments of the page are counted into sizes.
+  intptr_t EstimateLiveBytes(Page* p, FreeList::SizeStats* sizes);
+
   void EvictEvacuationCandidatesFromFreeLists();
 
   bool CanExpand();
@@ -1673,6 +1832,12 @@ class PagedSpace : public Space {
   // address denoted by top in allocation_info_.
   inline HeapObject* AllocateLinearly(int size_in_bytes);
 
+  // Sweeps a page claimed from the sweeper threads on the calling thread.
+  intptr_t SweepClaimedPage(Page* p);
+
+  // Updates the flags and accounting of a page swept by a sweeper thread.
+  void FinalizeSweptPage(Page* p);
+
   // Slow path of AllocateRaw.  This function is space-dependent.
   MUST_USE_RESULT virtual HeapObject* SlowAllocateRaw(int size_in_bytes);
 
@@ -2092,6 +2257,10 @@ class NewSpace : public Space {
   // Shrink the capacity of the semispaces.
   void Shrink();
 
+  // Shrink the capacity of the semispaces, but not below the given capacity,
+  // which must be at least the initial capacity.
+  void ShrinkTo(int capacity);
+
   // True if the address or object lies in the address range of either
   // semispace (not necessarily below the allocation pointer).
   bool Contains(Address a) {
@@ -2190,16 +2359,15 @@ class NewSpace : public Space {
 
   void LowerInlineAllocationLimit(intptr_t step) {
     inline_allocation_limit_step_ = step;
-    if (step == 0) {
-      allocation_info_.limit = to_space_.page_high();
-    } else {
-      allocation_info_.limit = Min(
-          allocation_info_.top + inline_allocation_limit_step_,
-          allocation_info_.limit);
-    }
+    UpdateInlineAllocationLimit(0);
     top_on_previous_step_ = allocation_info_.top;
   }
 
+  // Sets the limit for inline allocation so that incremental marking and
+  // the allocation sampler get a chance to do their next step once an
+  // object of size_in_bytes has been allocated at top.
+  void UpdateInlineAllocationLimit(int size_in_bytes);
+
   // Get the extent of the inactive semispace (for use as a marking stack,
   // or to zap it). Notice: space-addresses are not necessarily on the
   // same page, so FromSpaceStart() might be above FromSpaceEnd().
@@ -2301,7 +2469,8 @@ class NewSpace : public Space {
   // When incremental marking is active we will set allocation_info_.limit
   // to be lower than actual limit and then will gradually increase it
   // in steps to guarantee that we do incremental marking steps even
-  // when all allocation is performed from inlined generated code.
+  // when all allocation is performed from inlined generated code.  The
+  // sampling heap profiler lowers the limit the same way to the next sample.
   intptr_t inline_allocation_limit_step_;
 
   Address top_on_previous_step_;
@@ -2311,6 +2480,11 @@ class NewSpace : public Space {
 
   MUST_USE_RESULT MaybeObject* SlowAllocateRaw(int size_in_bytes);
 
+  // Tells incremental marking and the allocation sampler about the bytes
+  // allocated since the previous step up to top, the last object_size bytes
+  // of which belong to the object that is being allocated.
+  void AllocationStep(Address top, int object_size);
+
   friend class SemiSpaceIterator;
 
  public:
@@ -2516,6 +2690,11 @@ class LargeObjectSpace : public Space {
   // Frees unmarked objects.
   void FreeUnmarkedObjects();
 
+  // Called after the object was right-trimmed by bytes_trimmed bytes.
+  // Uncommits the whole OS pages behind the object's new end unless
+  // incremental marking, which may have recorded slots there, is running.
+  void ReleaseTrimmedTail(HeapObject* object, int bytes_trimmed);
+
   // Checks whether a heap object is in this space; O(1).
   bool Contains(HeapObject* obj);
 
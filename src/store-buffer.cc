@@ -27,6 +27,7 @@
 
 #include "v8.h"
 
+#include "compiler-intrinsics.h"
 #include "store-buffer.h"
 #include "store-buffer-inl.h"
 #include "v8-counters.h"
@@ -34,6 +35,102 @@
 namespace v8 {
 namespace internal {
 
+SlotSet::SlotSet(Address chunk_start, size_t chunk_size)
+    : chunk_start_(chunk_start),
+      buckets_count_(static_cast<int>(
+          ((chunk_size >> kPointerSizeLog2) + kSlotsPerBucket - 1) >>
+              kSlotsPerBucketLog2)),
+      buckets_(NewArray<uint32_t*>(buckets_count_)) {
+  for (int i = 0; i < buckets_count_; i++) buckets_[i] = NULL;
+}
+
+
+SlotSet::~SlotSet() {
+  for (int i = 0; i < buckets_count_; i++) {
+    if (buckets_[i] != NULL) DeleteArray(buckets_[i]);
+  }
+  DeleteArray(buckets_);
+}
+
+
+void SlotSet::Insert(Address slot_address) {
+  int index = SlotIndex(slot_address);
+  uint32_t* bucket = buckets_[index >> kSlotsPerBucketLog2];
+  if (bucket == NULL) {
+    bucket = NewArray<uint32_t>(kCellsPerBucket);
+    memset(bucket, 0, kCellsPerBucket * sizeof(*bucket));
+    buckets_[index >> kSlotsPerBucketLog2] = bucket;
+  }
+  int cell = (index & (kSlotsPerBucket - 1)) >> kBitsPerCellLog2;
+  bucket[cell] |= 1u << (index & (kBitsPerCell - 1));
+}
+
+
+bool SlotSet::Contains(Address slot_address) {
+  int index = SlotIndex(slot_address);
+  uint32_t* bucket = buckets_[index >> kSlotsPerBucketLog2];
+  if (bucket == NULL) return false;
+  int cell = (index & (kSlotsPerBucket - 1)) >> kBitsPerCellLog2;
+  return (bucket[cell] & (1u << (index & (kBitsPerCell - 1)))) != 0;
+}
+
+
+int SlotSet::Iterate(Heap* heap, ObjectVisitor* visitor) {
+  int slots = 0;
+  for (int i = 0; i < buckets_count_; i++) {
+    uint32_t* bucket = buckets_[i];
+    if (bucket == NULL) continue;
+    int bucket_slots = 0;
+    Address bucket_start =
+        chunk_start_ + (static_cast<intptr_t>(i) <<
+                        (kSlotsPerBucketLog2 + kPointerSizeLog2));
+    for (int j = 0; j < kCellsPerBucket; j++) {
+      uint32_t cell = bucket[j];
+      uint32_t remaining = cell;
+      while (remaining != 0) {
+        int bit = CompilerIntrinsics::CountTrailingZeros(remaining);
+        remaining &= remaining - 1;
+        int index = (j << kBitsPerCellLog2) + bit;
+        Object** slot = reinterpret_cast<Object**>(
+            bucket_start + (index << kPointerSizeLog2));
+        if (heap->InFromSpace(*slot)) {
+          visitor->VisitPointer(slot);
+        }
+        if (heap->InNewSpace(*slot)) {
+          bucket_slots++;
+        } else {
+          cell &= ~(1u << bit);
+        }
+      }
+      bucket[j] = cell;
+    }
+    if (bucket_slots == 0) {
+      DeleteArray(bucket);
+      buckets_[i] = NULL;
+    }
+    slots += bucket_slots;
+  }
+  return slots;
+}
+
+
+void SlotSet::RemoveRange(Address start, Address end) {
+  if (start >= end) return;
+  int start_index = SlotIndex(start);
+  int end_index = SlotIndex(end - kPointerSize) + 1;
+  for (int index = start_index; index < end_index; index++) {
+    uint32_t* bucket = buckets_[index >> kSlotsPerBucketLog2];
+    if (bucket == NULL) {
+      // Skip to the start of the next bucket.
+      index |= kSlotsPerBucket - 1;
+      continue;
+    }
+    int cell = (index & (kSlotsPerBucket - 1)) >> kBitsPerCellLog2;
+    bucket[cell] &= ~(1u << (index & (kBitsPerCell - 1)));
+  }
+}
+
+
 StoreBuffer::StoreBuffer(Heap* heap)
     : heap_(heap),
       start_(NULL),
@@ -51,7 +148,12 @@ StoreBuffer::StoreBuffer(Heap* heap)
       virtual_memory_(NULL),
       hash_set_1_(NULL),
       hash_set_2_(NULL),
-      hash_sets_are_empty_(true) {
+      hash_sets_are_empty_(true),
+      parallel_iteration_ranges_(0),
+      parallel_iteration_limit_(NULL),
+      parallel_iteration_tops_(NULL),
+      parallel_iteration_scans_pages_(false),
+      parallel_iteration_chunks_(0) {
 }
 
 
@@ -184,11 +286,13 @@ void StoreBuffer::EnsureSpace(intptr_t space_needed) {
   Compact();
 
   old_buffer_is_filtered_ = true;
+  bool page_has_slot_set = false;
   bool page_has_scan_on_scavenge_flag = false;
 
   PointerChunkIterator it(heap_);
   MemoryChunk* chunk;
   while ((chunk = it.next()) != NULL) {
+    if (chunk->slot_set() != NULL) page_has_slot_set = true;
     if (chunk->scan_on_scavenge()) page_has_scan_on_scavenge_flag = true;
   }
 
@@ -196,12 +300,16 @@ void StoreBuffer::EnsureSpace(intptr_t space_needed) {
     Filter(MemoryChunk::SCAN_ON_SCAVENGE);
   }
 
-  // If filtering out the entries from scan_on_scavenge pages got us down to
-  // less than half full, then we are satisfied with that.
+  if (page_has_slot_set) {
+    MoveEntriesToSlotSets();
+  }
+
+  // If moving out the entries of pages with slot sets got us down to less
+  // than half full, then we are satisfied with that.
   if (old_limit_ - old_top_ > old_top_ - old_start_) return;
 
-  // Sample 1 entry in 97 and filter out the pages where we estimate that more
-  // than 1 in 8 pointers are to new space.
+  // Sample 1 entry in 97 and give the pages where we estimate that more than
+  // 1 in 8 pointers are to new space a slot set of their own.
   static const int kSampleFinenesses = 5;
   static const struct Samples {
     int prime_sample_step;
@@ -214,8 +322,9 @@ void StoreBuffer::EnsureSpace(intptr_t space_needed) {
     { 1, 0}
   };
   for (int i = kSampleFinenesses - 1; i >= 0; i--) {
-    ExemptPopularPages(samples[i].prime_sample_step, samples[i].threshold);
-    // As a last resort we mark all pages as being exempt from the store buffer.
+    MovePopularPagesToSlotSets(samples[i].prime_sample_step,
+                               samples[i].threshold);
+    // As a last resort all entries are moved to slot sets.
     ASSERT(i != 0 || old_top_ == old_start_);
     if (old_limit_ - old_top_ > old_top_ - old_start_) return;
   }
@@ -224,14 +333,16 @@ void StoreBuffer::EnsureSpace(intptr_t space_needed) {
 
 
 // Sample the store buffer to see if some pages are taking up a lot of space
-// in the store buffer.
-void StoreBuffer::ExemptPopularPages(int prime_sample_step, int threshold) {
+// in the store buffer.  Their entries are moved to slot sets, where each slot
+// takes up a single bit and is only recorded once.
+void StoreBuffer::MovePopularPagesToSlotSets(int prime_sample_step,
+                                             int threshold) {
   PointerChunkIterator it(heap_);
   MemoryChunk* chunk;
   while ((chunk = it.next()) != NULL) {
     chunk->set_store_buffer_counter(0);
   }
-  bool created_new_scan_on_scavenge_pages = false;
+  bool created_new_slot_sets = false;
   MemoryChunk* previous_chunk = NULL;
   for (Address* p = old_start_; p < old_top_; p += prime_sample_step) {
     Address addr = *p;
@@ -241,21 +352,66 @@ void StoreBuffer::ExemptPopularPages(int prime_sample_step, int threshold) {
     } else {
       containing_chunk = MemoryChunk::FromAnyPointerAddress(addr);
     }
+    // The entries of chunks that are about to be freed are dropped by
+    // MoveEntriesToSlotSets.
+    if (containing_chunk->IsFlagSet(MemoryChunk::ABOUT_TO_BE_FREED)) {
+      created_new_slot_sets = true;
+      previous_chunk = containing_chunk;
+      continue;
+    }
     int old_counter = containing_chunk->store_buffer_counter();
-    if (old_counter == threshold) {
-      containing_chunk->set_scan_on_scavenge(true);
-      created_new_scan_on_scavenge_pages = true;
+    if (old_counter == threshold && containing_chunk->slot_set() == NULL) {
+      containing_chunk->AllocateSlotSet();
+      created_new_slot_sets = true;
     }
     containing_chunk->set_store_buffer_counter(old_counter + 1);
     previous_chunk = containing_chunk;
   }
-  if (created_new_scan_on_scavenge_pages) {
-    Filter(MemoryChunk::SCAN_ON_SCAVENGE);
+  if (created_new_slot_sets) {
+    MoveEntriesToSlotSets();
   }
   old_buffer_is_filtered_ = true;
 }
 
 
+void StoreBuffer::MoveEntriesToSlotSets() {
+  ASSERT(may_move_store_buffer_entries_);
+  Address* new_top = old_start_;
+  MemoryChunk* previous_chunk = NULL;
+  for (Address* p = old_start_; p < old_top_; p++) {
+    Address addr = *p;
+    MemoryChunk* containing_chunk = NULL;
+    if (previous_chunk != NULL && previous_chunk->Contains(addr)) {
+      containing_chunk = previous_chunk;
+    } else {
+      containing_chunk = MemoryChunk::FromAnyPointerAddress(addr);
+      previous_chunk = containing_chunk;
+    }
+    // Chunks that are about to be freed may be fake chunks carved out of a
+    // large chunk, see Heap::FreeQueuedChunks, that have no slot set field.
+    if (containing_chunk->IsFlagSet(MemoryChunk::ABOUT_TO_BE_FREED)) continue;
+    SlotSet* slot_set = containing_chunk->slot_set();
+    if (slot_set != NULL) {
+      slot_set->Insert(addr);
+    } else {
+      *new_top++ = addr;
+    }
+  }
+  old_top_ = new_top;
+
+  // Filtering hash sets are inconsistent with the store buffer after this
+  // operation.
+  ClearFilteringHashSets();
+}
+
+
+bool StoreBuffer::CellIsInSlotSet(Address cell_address) {
+  SlotSet* slot_set =
+      MemoryChunk::FromAnyPointerAddress(cell_address)->slot_set();
+  return slot_set != NULL && slot_set->Contains(cell_address);
+}
+
+
 void StoreBuffer::Filter(int flag) {
   Address* new_top = old_start_;
   MemoryChunk* previous_chunk = NULL;
@@ -280,6 +436,29 @@ void StoreBuffer::Filter(int flag) {
 }
 
 
+void StoreBuffer::RemoveSlots(MemoryChunk* chunk,
+                              Address start,
+                              Address end) {
+  Compact();
+  Address* new_top = old_start_;
+  for (Address* p = old_start_; p < old_top_; p++) {
+    Address addr = *p;
+    if (addr < start || addr >= end) {
+      *new_top++ = addr;
+    }
+  }
+  old_top_ = new_top;
+
+  // Filtering hash sets are inconsistent with the store buffer after this
+  // operation.
+  ClearFilteringHashSets();
+
+  if (chunk->slot_set() != NULL) {
+    chunk->slot_set()->RemoveRange(start, end);
+  }
+}
+
+
 void StoreBuffer::SortUniq() {
   Compact();
   if (old_buffer_is_sorted_) return;
@@ -348,7 +527,7 @@ bool StoreBuffer::CellIsInStoreBuffer(Address cell_address) {
       return true;
     }
   }
-  return false;
+  return CellIsInSlotSet(cell_address);
 }
 #endif
 
@@ -384,6 +563,7 @@ void StoreBuffer::VerifyPointers(PagedSpace* space,
 
   while (it.has_next()) {
     Page* page = it.next();
+    space->EnsurePageIsSwept(page);
     FindPointersToNewSpaceOnPage(
         reinterpret_cast<PagedSpace*>(page->owner()),
         page,
@@ -578,6 +758,25 @@ void StoreBuffer::FindPointersToNewSpaceOnPage(
 }
 
 
+// Adapts a slot callback to the visitor interface used for slot sets and
+// IteratePointersInRange.
+class SlotCallbackVisitor : public ObjectVisitor {
+ public:
+  explicit SlotCallbackVisitor(ObjectSlotCallback slot_callback)
+      : slot_callback_(slot_callback) { }
+
+  void VisitPointers(Object** start, Object** end) {
+    for (Object** slot = start; slot < end; slot++) {
+      slot_callback_(reinterpret_cast<HeapObject**>(slot),
+                     reinterpret_cast<HeapObject*>(*slot));
+    }
+  }
+
+ private:
+  ObjectSlotCallback slot_callback_;
+};
+
+
 void StoreBuffer::IteratePointersInStoreBuffer(
     ObjectSlotCallback slot_callback) {
   Address* limit = old_top_;
@@ -614,6 +813,13 @@ void StoreBuffer::IteratePointersToNewSpace(ObjectSlotCallback slot_callback) {
   // because slot can belong to a large object.
   IteratePointersInStoreBuffer(slot_callback);
 
+  SlotCallbackVisitor visitor(slot_callback);
+  PointerChunkIterator it(heap_);
+  MemoryChunk* chunk;
+  while ((chunk = it.next()) != NULL) {
+    if (chunk->slot_set() != NULL) IteratePointersInSlotSet(chunk, &visitor);
+  }
+
   // We are done scanning all the pointers that were in the store buffer, but
   // there may be some pages marked scan_on_scavenge that have pointers to new
   // space that are not in the store buffer.  We must scan them now.  As we
@@ -623,42 +829,153 @@ void StoreBuffer::IteratePointersToNewSpace(ObjectSlotCallback slot_callback) {
   // were added to the store buffer.  If there are not many pointers to new
   // space left on the page we will keep the pointers in the store buffer and
   // remove the flag from the page.
-  if (some_pages_to_scan) {
-    if (callback_ != NULL) {
-      (*callback_)(heap_, NULL, kStoreBufferStartScanningPagesEvent);
+  if (some_pages_to_scan) ScanPagesForPointersToNewSpace(slot_callback);
+}
+
+
+void StoreBuffer::IteratePointersInSlotSet(MemoryChunk* chunk,
+                                           ObjectVisitor* visitor) {
+  if (chunk->slot_set()->Iterate(heap_, visitor) == 0) {
+    chunk->ReleaseSlotSet();
+  }
+}
+
+
+void StoreBuffer::ScanPagesForPointersToNewSpace(
+    ObjectSlotCallback slot_callback) {
+  if (callback_ != NULL) {
+    (*callback_)(heap_, NULL, kStoreBufferStartScanningPagesEvent);
+  }
+  PointerChunkIterator it(heap_);
+  MemoryChunk* chunk;
+  while ((chunk = it.next()) != NULL) {
+    if (chunk->scan_on_scavenge()) {
+      chunk->set_scan_on_scavenge(false);
+      if (callback_ != NULL) {
+        (*callback_)(heap_, chunk, kStoreBufferScanningPageEvent);
+      }
+      if (chunk->owner() == heap_->lo_space()) {
+        LargePage* large_page = reinterpret_cast<LargePage*>(chunk);
+        HeapObject* array = large_page->GetObject();
+        ASSERT(array->IsFixedArray());
+        Address start = array->address();
+        Address end = start + array->Size();
+        FindPointersToNewSpaceInRegion(start, end, slot_callback);
+      } else {
+        Page* page = reinterpret_cast<Page*>(chunk);
+        PagedSpace* owner = reinterpret_cast<PagedSpace*>(page->owner());
+        // A sweeper thread may be writing free space into the page.
+        owner->EnsurePageIsSwept(page);
+        FindPointersToNewSpaceOnPage(
+            owner,
+            page,
+            (owner == heap_->map_space() ?
+               &StoreBuffer::FindPointersToNewSpaceInMapsRegion :
+               &StoreBuffer::FindPointersToNewSpaceInRegion),
+            slot_callback);
+      }
     }
-    PointerChunkIterator it(heap_);
-    MemoryChunk* chunk;
-    while ((chunk = it.next()) != NULL) {
-      if (chunk->scan_on_scavenge()) {
-        chunk->set_scan_on_scavenge(false);
-        if (callback_ != NULL) {
-          (*callback_)(heap_, chunk, kStoreBufferScanningPageEvent);
-        }
-        if (chunk->owner() == heap_->lo_space()) {
-          LargePage* large_page = reinterpret_cast<LargePage*>(chunk);
-          HeapObject* array = large_page->GetObject();
-          ASSERT(array->IsFixedArray());
-          Address start = array->address();
-          Address end = start + array->Size();
-          FindPointersToNewSpaceInRegion(start, end, slot_callback);
-        } else {
-          Page* page = reinterpret_cast<Page*>(chunk);
-          PagedSpace* owner = reinterpret_cast<PagedSpace*>(page->owner());
-          FindPointersToNewSpaceOnPage(
-              owner,
-              page,
-              (owner == heap_->map_space() ?
-                 &StoreBuffer::FindPointersToNewSpaceInMapsRegion :
-                 &StoreBuffer::FindPointersToNewSpaceInRegion),
-              slot_callback);
-        }
+  }
+  if (callback_ != NULL) {
+    (*callback_)(heap_, NULL, kStoreBufferScanningPageEvent);
+  }
+}
+
+
+void StoreBuffer::StartParallelIteration(int ranges) {
+  ASSERT(ranges > 0);
+  ASSERT(parallel_iteration_tops_ == NULL);
+  parallel_iteration_scans_pages_ = PrepareForIteration();
+  parallel_iteration_ranges_ = ranges;
+  parallel_iteration_limit_ = old_top_;
+  parallel_iteration_tops_ = NewArray<Address*>(ranges);
+  for (int i = 0; i < ranges; i++) {
+    parallel_iteration_tops_[i] = ParallelIterationRangeStart(i);
+  }
+  ASSERT(parallel_iteration_chunks_.is_empty());
+  PointerChunkIterator it(heap_);
+  MemoryChunk* chunk;
+  while ((chunk = it.next()) != NULL) {
+    if (chunk->slot_set() != NULL) parallel_iteration_chunks_.Add(chunk);
+  }
+}
+
+
+Address* StoreBuffer::ParallelIterationRangeStart(int range) {
+  intptr_t length = parallel_iteration_limit_ - old_start_;
+  return old_start_ + length * range / parallel_iteration_ranges_;
+}
+
+
+void StoreBuffer::IteratePointersInRange(int range,
+                                         ObjectSlotCallback slot_callback) {
+  SlotCallbackVisitor visitor(slot_callback);
+  IteratePointersInRange(range, &visitor);
+}
+
+
+void StoreBuffer::IteratePointersInRange(int range, ObjectVisitor* visitor) {
+  ASSERT(range >= 0 && range < parallel_iteration_ranges_);
+  Address* start = ParallelIterationRangeStart(range);
+  Address* limit = ParallelIterationRangeStart(range + 1);
+  // Surviving entries are compacted towards the start of the range, so no
+  // other thread ever sees them move.
+  Address* top = start;
+  for (Address* current = start; current < limit; current++) {
+    Object** slot = reinterpret_cast<Object**>(*current);
+    if (heap_->InFromSpace(*slot)) {
+      visitor->VisitPointer(slot);
+      if (heap_->InNewSpace(*slot)) {
+        *top++ = reinterpret_cast<Address>(slot);
       }
     }
-    if (callback_ != NULL) {
-      (*callback_)(heap_, NULL, kStoreBufferScanningPageEvent);
+  }
+  parallel_iteration_tops_[range] = top;
+  // Every chunk is owned by exactly one range, so its slot set is only
+  // touched by one thread.
+  int nchunks = parallel_iteration_chunks_.length();
+  for (int i = range; i < nchunks; i += parallel_iteration_ranges_) {
+    IteratePointersInSlotSet(parallel_iteration_chunks_[i], visitor);
+  }
+}
+
+
+void StoreBuffer::FinishParallelIteration(ObjectSlotCallback slot_callback) {
+  ASSERT(parallel_iteration_tops_ != NULL);
+  // Like EnterDirectlyIntoStoreBuffer, only keep the surviving entries when
+  // the store buffer is being rebuilt.
+  Address* top = old_start_;
+  if (store_buffer_rebuilding_enabled_) {
+    for (int i = 0; i < parallel_iteration_ranges_; i++) {
+      Address* start = ParallelIterationRangeStart(i);
+      intptr_t length = parallel_iteration_tops_[i] - start;
+      if (start != top && length > 0) {
+        memmove(top, start, length * sizeof(*top));
+      }
+      top += length;
+    }
+  }
+  DeleteArray(parallel_iteration_tops_);
+  parallel_iteration_tops_ = NULL;
+  parallel_iteration_chunks_.Clear();
+  parallel_iteration_ranges_ = 0;
+  parallel_iteration_limit_ = NULL;
+
+  old_top_ = top;
+  if (top != old_start_) {
+    old_buffer_is_sorted_ = false;
+    old_buffer_is_filtered_ = false;
+    if (top >= old_limit_) {
+      ASSERT(callback_ != NULL);
+      (*callback_)(heap_,
+                   MemoryChunk::FromAnyPointerAddress(*(top - 1)),
+                   kStoreBufferFullEvent);
     }
   }
+
+  if (parallel_iteration_scans_pages_) {
+    ScanPagesForPointersToNewSpace(slot_callback);
+  }
 }
 
 
@@ -31,6 +31,7 @@
 #include "allocation.h"
 #include "checks.h"
 #include "globals.h"
+#include "list.h"
 #include "platform.h"
 #include "v8globals.h"
 
@@ -44,6 +45,50 @@ typedef void (*ObjectSlotCallback)(HeapObject** from, HeapObject* to);
 typedef void (StoreBuffer::*RegionCallback)(
     Address start, Address end, ObjectSlotCallback slot_callback);
 
+
+// A remembered set of the slots on one memory chunk that may point to new
+// space.  Each slot is a bit in a bitmap that is split into buckets which are
+// only allocated once a slot in their range is recorded, so a chunk with few
+// recorded slots costs little memory.  Recording a slot twice is harmless.
+class SlotSet : public Malloced {
+ public:
+  SlotSet(Address chunk_start, size_t chunk_size);
+  ~SlotSet();
+
+  void Insert(Address slot_address);
+  bool Contains(Address slot_address);
+
+  // Visits the slots that point into from space and forgets the slots that
+  // do not point into new space afterwards.  Returns the number of slots
+  // still recorded.  Buckets that become empty are released.
+  int Iterate(Heap* heap, ObjectVisitor* visitor);
+
+  // Forgets the slots in [start, end).
+  void RemoveRange(Address start, Address end);
+
+ private:
+  static const int kBitsPerCellLog2 = 5;
+  static const int kBitsPerCell = 1 << kBitsPerCellLog2;
+  static const int kSlotsPerBucketLog2 = 10;
+  static const int kSlotsPerBucket = 1 << kSlotsPerBucketLog2;
+  static const int kCellsPerBucket = kSlotsPerBucket / kBitsPerCell;
+
+  int SlotIndex(Address slot_address) {
+    ASSERT(slot_address >= chunk_start_);
+    int index = static_cast<int>(
+        (slot_address - chunk_start_) >> kPointerSizeLog2);
+    ASSERT((index >> kSlotsPerBucketLog2) < buckets_count_);
+    return index;
+  }
+
+  Address chunk_start_;
+  int buckets_count_;
+  uint32_t** buckets_;
+
+  DISALLOW_COPY_AND_ASSIGN(SlotSet);
+};
+
+
 // Used to implement the write barrier by collecting addresses of pointers
 // between spaces.
 class StoreBuffer {
@@ -79,8 +124,22 @@ class StoreBuffer {
   // Iterates over all pointers that go from old space to new space.  It will
   // delete the store buffer as it starts so the callback should reenter
   // surviving old-to-new pointers into the store buffer to rebuild it.
+  // Slots recorded in the slot sets of the chunks stay there as long as they
+  // point to new space.
   void IteratePointersToNewSpace(ObjectSlotCallback callback);
 
+  // Parallel version of IteratePointersToNewSpace.  After
+  // StartParallelIteration the old buffer is split into |ranges| disjoint
+  // ranges that can be processed concurrently by IteratePointersInRange,
+  // one call per range.  The chunks with slot sets are distributed over the
+  // ranges too.  The callback must not touch the store buffer.
+  // FinishParallelIteration then compacts the surviving entries and scans
+  // the pages that are not covered by the store buffer on the calling thread.
+  void StartParallelIteration(int ranges);
+  void IteratePointersInRange(int range, ObjectSlotCallback slot_callback);
+  void IteratePointersInRange(int range, ObjectVisitor* visitor);
+  void FinishParallelIteration(ObjectSlotCallback slot_callback);
+
   static const int kStoreBufferOverflowBit = 1 << (14 + kPointerSizeLog2);
   static const int kStoreBufferSize = kStoreBufferOverflowBit;
   static const int kStoreBufferLength = kStoreBufferSize / sizeof(Address);
@@ -112,6 +171,12 @@ class StoreBuffer {
   void EnsureSpace(intptr_t space_needed);
   void Verify();
 
+  // Moves the entries of the old buffer that belong to chunks with a slot set
+  // into that slot set.
+  void MoveEntriesToSlotSets();
+
+  bool CellIsInSlotSet(Address cell);
+
   bool PrepareForIteration();
 
 #ifdef DEBUG
@@ -122,6 +187,10 @@ class StoreBuffer {
 
   void Filter(int flag);
 
+  // Removes the recorded slots in [start, end) of the given chunk, which is
+  // about to be uncommitted.
+  void RemoveSlots(MemoryChunk* chunk, Address start, Address end);
+
  private:
   Heap* heap_;
 
@@ -156,11 +225,18 @@ class StoreBuffer {
   uintptr_t* hash_set_2_;
   bool hash_sets_are_empty_;
 
+  // State of a parallel iteration, see StartParallelIteration.
+  int parallel_iteration_ranges_;
+  Address* parallel_iteration_limit_;
+  Address** parallel_iteration_tops_;
+  bool parallel_iteration_scans_pages_;
+  List<MemoryChunk*> parallel_iteration_chunks_;
+
   void ClearFilteringHashSets();
 
   void CheckForFullBuffer();
   void Uniq();
-  void ExemptPopularPages(int prime_sample_step, int threshold);
+  void MovePopularPagesToSlotSets(int prime_sample_step, int threshold);
 
   void FindPointersToNewSpaceInRegion(Address start,
                                       Address end,
@@ -195,6 +271,12 @@ class StoreBuffer {
 
   void IteratePointersInStoreBuffer(ObjectSlotCallback slot_callback);
 
+  void IteratePointersInSlotSet(MemoryChunk* chunk, ObjectVisitor* visitor);
+
+  void ScanPagesForPointersToNewSpace(ObjectSlotCallback slot_callback);
+
+  Address* ParallelIterationRangeStart(int range);
+
 #ifdef DEBUG
   void VerifyPointers(PagedSpace* space, RegionCallback region_callback);
   void VerifyPointers(LargeObjectSpace* space);
@@ -119,6 +119,9 @@ namespace internal {
   SC(total_old_codegen_source_size, V8.TotalOldCodegenSourceSize)     \
   /* Amount of source code compiled with the full codegen. */         \
   SC(total_full_codegen_source_size, V8.TotalFullCodegenSourceSize)   \
+  /* Unoptimized code flushed by full garbage collections. */        \
+  SC(code_flushed_functions, V8.CodeFlushedFunctions)                 \
+  SC(code_flushed_bytes, V8.CodeFlushedBytes)                         \
   /* Number of contexts created from scratch. */                      \
   SC(contexts_created_from_scratch, V8.ContextsCreatedFromScratch)    \
   /* Number of contexts created by partial snapshot. */               \
@@ -128,7 +131,10 @@ namespace internal {
   SC(pc_to_code_cached, V8.PcToCodeCached)                            \
   /* The store-buffer implementation of the write barrier. */         \
   SC(store_buffer_compactions, V8.StoreBufferCompactions)             \
-  SC(store_buffer_overflows, V8.StoreBufferOverflows)
+  SC(store_buffer_overflows, V8.StoreBufferOverflows)                 \
+  /* Field accesses removed by load store elimination. */             \
+  SC(hydrogen_loads_eliminated, V8.HydrogenLoadsEliminated)           \
+  SC(hydrogen_stores_eliminated, V8.HydrogenStoresEliminated)
 
 
 #define STATS_COUNTER_LIST_2(SC)                                      \
@@ -147,6 +153,9 @@ namespace internal {
      V8.GCCompactorCausedByWeakHandles)                               \
   SC(gc_last_resort_from_js, V8.GCLastResortFromJS)                   \
   SC(gc_last_resort_from_handles, V8.GCLastResortFromHandles)         \
+  /* Who swept the pages of a concurrent sweeping round? */           \
+  SC(pages_swept_concurrently, V8.PagesSweptConcurrently)             \
+  SC(pages_swept_by_main_thread, V8.PagesSweptByMainThread)           \
   /* How is the generic keyed-load stub used? */                      \
   SC(keyed_load_generic_smi, V8.KeyedLoadGenericSmi)                  \
   SC(keyed_load_generic_symbol, V8.KeyedLoadGenericSymbol)            \
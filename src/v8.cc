@@ -194,6 +194,16 @@ bool V8::IdleNotification(int hint) {
 }
 
 
+bool V8::IdleNotificationDeadline(int idle_time_in_ms,
+                                  double* time_used_in_ms) {
+  if (!FLAG_use_idle_notification) {
+    if (time_used_in_ms != NULL) *time_used_in_ms = 0;
+    return true;
+  }
+  return HEAP->IdleNotificationDeadline(idle_time_in_ms, time_used_in_ms);
+}
+
+
 void V8::AddCallCompletedCallback(CallCompletedCallback callback) {
   if (call_completed_callbacks_ == NULL) {  // Lazy init.
     call_completed_callbacks_ = new List<CallCompletedCallback>();
@@ -111,6 +111,8 @@ class V8 : public AllStatic {
 
   // Idle notification directly from the API.
   static bool IdleNotification(int hint);
+  static bool IdleNotificationDeadline(int idle_time_in_ms,
+                                       double* time_used_in_ms);
 
   static void AddCallCompletedCallback(CallCompletedCallback callback);
   static void RemoveCallCompletedCallback(CallCompletedCallback callback);
@@ -300,16 +300,75 @@ void FastNewBlockContextStub::Generate(MacroAssembler* masm) {
 }
 
 
+// Replaces an allocation site in boilerplate by the boilerplate it tracks.
+// Sites are copied here without tracking, except for every n-th copy, which
+// the runtime tracks.  Copies of a site that decided to tenure continue at
+// tenured.
+static void GenerateLoadSiteBoilerplate(MacroAssembler* masm,
+                                        Register boilerplate,
+                                        Register scratch,
+                                        Label* slow_case,
+                                        Label* tenured) {
+  Label done;
+  __ CompareRoot(FieldOperand(boilerplate, HeapObject::kMapOffset),
+                 Heap::kAllocationSiteMapRootIndex);
+  __ j(not_equal, &done);
+  __ SmiAddConstant(FieldOperand(boilerplate, AllocationSite::kCopyCountOffset),
+                    Smi::FromInt(1));
+  __ SmiCompare(FieldOperand(boilerplate, AllocationSite::kCopyCountOffset),
+                Smi::FromInt(AllocationSite::kStubSampleInterval));
+  __ j(greater_equal, slow_case);
+  __ movq(scratch,
+          FieldOperand(boilerplate, AllocationSite::kPretenureDecisionOffset));
+  __ movq(boilerplate,
+          FieldOperand(boilerplate, AllocationSite::kBoilerplateOffset));
+  __ SmiCompare(scratch, Smi::FromInt(AllocationSite::kTenure));
+  __ j(equal, tenured);
+  __ bind(&done);
+}
+
+
+// Enters the fields of object between start_offset and end_offset that
+// point to new space into the store buffer.  Used for copies allocated in
+// old space, which are filled without a write barrier.
+static void GenerateRecordNewSpaceFields(MacroAssembler* masm,
+                                         Register object,
+                                         int start_offset,
+                                         int end_offset,
+                                         Register value,
+                                         Register address) {
+  for (int i = start_offset; i < end_offset; i += kPointerSize) {
+    Label skip;
+    __ movq(value, FieldOperand(object, i));
+    __ JumpIfSmi(value, &skip);
+    __ JumpIfNotInNewSpace(value, address, &skip);
+    __ lea(address, FieldOperand(object, i));
+    __ RememberedSetHelper(object, address, value, kDontSaveFPRegs,
+                           MacroAssembler::kFallThroughAtEnd);
+    __ bind(&skip);
+  }
+}
+
+
 static void GenerateFastCloneShallowArrayCommon(
     MacroAssembler* masm,
     int length,
     FastCloneShallowArrayStub::Mode mode,
+    PretenureFlag pretenure,
     Label* fail) {
   // Registers on entry:
   //
   // rcx: boilerplate literal array.
   ASSERT(mode != FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS);
 
+  // Double arrays belong in old data space, leave them to the runtime.
+  if (pretenure == TENURED &&
+      mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS &&
+      length > 0) {
+    __ jmp(fail);
+    return;
+  }
+
   // All sizes here are multiples of kPointerSize.
   int elements_size = 0;
   if (length > 0) {
@@ -321,7 +380,11 @@ static void GenerateFastCloneShallowArrayCommon(
 
   // Allocate both the JS array and the elements array in one big
   // allocation. This avoids multiple limit checks.
-  __ AllocateInNewSpace(size, rax, rbx, rdx, fail, TAG_OBJECT);
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
+  __ AllocateInNewSpace(size, rax, rbx, rdx, fail, flags);
 
   // Copy the JS array part.
   for (int i = 0; i < JSArray::kSize; i += kPointerSize) {
@@ -359,63 +422,62 @@ static void GenerateFastCloneShallowArrayCommon(
       ASSERT(i == elements_size);
     }
   }
-}
 
-void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
-  // Stack layout on entry:
-  //
-  // [rsp + kPointerSize]: constant elements.
-  // [rsp + (2 * kPointerSize)]: literal index.
-  // [rsp + (3 * kPointerSize)]: literals array.
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, rax, JSObject::kPropertiesOffset,
+                                 JSArray::kSize, rbx, rcx);
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
+      __ lea(rdx, Operand(rax, JSArray::kSize));
+      GenerateRecordNewSpaceFields(masm, rdx, FixedArray::kHeaderSize,
+                                   elements_size, rbx, rcx);
+    }
+  }
+}
 
-  // Load boilerplate object into rcx and check if we need to create a
-  // boilerplate.
-  __ movq(rcx, Operand(rsp, 3 * kPointerSize));
-  __ movq(rax, Operand(rsp, 2 * kPointerSize));
-  SmiIndex index = masm->SmiToIndex(rax, rax, kPointerSizeLog2);
-  __ movq(rcx,
-          FieldOperand(rcx, index.reg, index.scale, FixedArray::kHeaderSize));
-  __ CompareRoot(rcx, Heap::kUndefinedValueRootIndex);
-  Label slow_case;
-  __ j(equal, &slow_case);
 
-  FastCloneShallowArrayStub::Mode mode = mode_;
+static void GenerateFastCloneShallowArray(MacroAssembler* masm,
+                                          int length,
+                                          FastCloneShallowArrayStub::Mode mode,
+                                          PretenureFlag pretenure,
+                                          Label* fail) {
   // rcx is boilerplate object.
   Factory* factory = masm->isolate()->factory();
-  if (mode == CLONE_ANY_ELEMENTS) {
+  if (mode == FastCloneShallowArrayStub::CLONE_ANY_ELEMENTS) {
     Label double_elements, check_fast_elements;
     __ movq(rbx, FieldOperand(rcx, JSArray::kElementsOffset));
     __ Cmp(FieldOperand(rbx, HeapObject::kMapOffset),
            factory->fixed_cow_array_map());
     __ j(not_equal, &check_fast_elements);
-    GenerateFastCloneShallowArrayCommon(masm, 0,
-                                        COPY_ON_WRITE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, 0, FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS, pretenure,
+        fail);
     __ ret(3 * kPointerSize);
 
     __ bind(&check_fast_elements);
     __ Cmp(FieldOperand(rbx, HeapObject::kMapOffset),
            factory->fixed_array_map());
     __ j(not_equal, &double_elements);
-    GenerateFastCloneShallowArrayCommon(masm, length_,
-                                        CLONE_ELEMENTS, &slow_case);
+    GenerateFastCloneShallowArrayCommon(
+        masm, length, FastCloneShallowArrayStub::CLONE_ELEMENTS, pretenure,
+        fail);
     __ ret(3 * kPointerSize);
 
     __ bind(&double_elements);
-    mode = CLONE_DOUBLE_ELEMENTS;
+    mode = FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS;
     // Fall through to generate the code to handle double elements.
   }
 
   if (FLAG_debug_code) {
     const char* message;
     Heap::RootListIndex expected_map_index;
-    if (mode == CLONE_ELEMENTS) {
+    if (mode == FastCloneShallowArrayStub::CLONE_ELEMENTS) {
       message = "Expected (writable) fixed array";
       expected_map_index = Heap::kFixedArrayMapRootIndex;
-    } else if (mode == CLONE_DOUBLE_ELEMENTS) {
+    } else if (mode == FastCloneShallowArrayStub::CLONE_DOUBLE_ELEMENTS) {
       message = "Expected (writable) fixed double array";
       expected_map_index = Heap::kFixedDoubleArrayMapRootIndex;
     } else {
-      ASSERT(mode == COPY_ON_WRITE_ELEMENTS);
+      ASSERT(mode == FastCloneShallowArrayStub::COPY_ON_WRITE_ELEMENTS);
       message = "Expected copy-on-write fixed array";
       expected_map_index = Heap::kFixedCOWArrayMapRootIndex;
     }
@@ -427,51 +489,104 @@ void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
     __ pop(rcx);
   }
 
-  GenerateFastCloneShallowArrayCommon(masm, length_, mode, &slow_case);
+  GenerateFastCloneShallowArrayCommon(masm, length, mode, pretenure, fail);
   __ ret(3 * kPointerSize);
-
-  __ bind(&slow_case);
-  __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
 }
 
-
-void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
+void FastCloneShallowArrayStub::Generate(MacroAssembler* masm) {
   // Stack layout on entry:
   //
-  // [rsp + kPointerSize]: object literal flags.
-  // [rsp + (2 * kPointerSize)]: constant properties.
-  // [rsp + (3 * kPointerSize)]: literal index.
-  // [rsp + (4 * kPointerSize)]: literals array.
+  // [rsp + kPointerSize]: constant elements.
+  // [rsp + (2 * kPointerSize)]: literal index.
+  // [rsp + (3 * kPointerSize)]: literals array.
 
-  // Load boilerplate object into ecx and check if we need to create a
+  // Load boilerplate object into rcx and check if we need to create a
   // boilerplate.
-  Label slow_case;
-  __ movq(rcx, Operand(rsp, 4 * kPointerSize));
-  __ movq(rax, Operand(rsp, 3 * kPointerSize));
+  __ movq(rcx, Operand(rsp, 3 * kPointerSize));
+  __ movq(rax, Operand(rsp, 2 * kPointerSize));
   SmiIndex index = masm->SmiToIndex(rax, rax, kPointerSizeLog2);
   __ movq(rcx,
           FieldOperand(rcx, index.reg, index.scale, FixedArray::kHeaderSize));
   __ CompareRoot(rcx, Heap::kUndefinedValueRootIndex);
+  Label slow_case, tenured;
   __ j(equal, &slow_case);
+  GenerateLoadSiteBoilerplate(
+      masm, rcx, rbx, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  GenerateFastCloneShallowArray(masm, length_, mode_, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowArray(masm, length_, mode_, TENURED, &slow_case);
+  }
+
+  __ bind(&slow_case);
+  __ TailCallRuntime(Runtime::kCreateArrayLiteralShallow, 3, 1);
+}
+
+
+static void GenerateFastCloneShallowObject(MacroAssembler* masm,
+                                           int size,
+                                           PretenureFlag pretenure,
+                                           Label* fail) {
+  // rcx is boilerplate object.
 
   // Check that the boilerplate contains only fast properties and we can
   // statically determine the instance size.
-  int size = JSObject::kHeaderSize + length_ * kPointerSize;
   __ movq(rax, FieldOperand(rcx, HeapObject::kMapOffset));
   __ movzxbq(rax, FieldOperand(rax, Map::kInstanceSizeOffset));
   __ cmpq(rax, Immediate(size >> kPointerSizeLog2));
-  __ j(not_equal, &slow_case);
+  __ j(not_equal, fail);
 
   // Allocate the JS object and copy header together with all in-object
   // properties from the boilerplate.
-  __ AllocateInNewSpace(size, rax, rbx, rdx, &slow_case, TAG_OBJECT);
+  AllocationFlags flags = TAG_OBJECT;
+  if (pretenure == TENURED) {
+    flags = static_cast<AllocationFlags>(flags | PRETENURE_OLD_POINTER_SPACE);
+  }
+  __ AllocateInNewSpace(size, rax, rbx, rdx, fail, flags);
   for (int i = 0; i < size; i += kPointerSize) {
     __ movq(rbx, FieldOperand(rcx, i));
     __ movq(FieldOperand(rax, i), rbx);
   }
+  if (pretenure == TENURED) {
+    GenerateRecordNewSpaceFields(masm, rax, JSObject::kPropertiesOffset, size,
+                                 rbx, rcx);
+  }
 
   // Return and remove the on-stack parameters.
   __ ret(4 * kPointerSize);
+}
+
+
+void FastCloneShallowObjectStub::Generate(MacroAssembler* masm) {
+  // Stack layout on entry:
+  //
+  // [rsp + kPointerSize]: object literal flags.
+  // [rsp + (2 * kPointerSize)]: constant properties.
+  // [rsp + (3 * kPointerSize)]: literal index.
+  // [rsp + (4 * kPointerSize)]: literals array.
+
+  // Load boilerplate object into ecx and check if we need to create a
+  // boilerplate.
+  Label slow_case, tenured;
+  __ movq(rcx, Operand(rsp, 4 * kPointerSize));
+  __ movq(rax, Operand(rsp, 3 * kPointerSize));
+  SmiIndex index = masm->SmiToIndex(rax, rax, kPointerSizeLog2);
+  __ movq(rcx,
+          FieldOperand(rcx, index.reg, index.scale, FixedArray::kHeaderSize));
+  __ CompareRoot(rcx, Heap::kUndefinedValueRootIndex);
+  __ j(equal, &slow_case);
+  GenerateLoadSiteBoilerplate(
+      masm, rcx, rbx, &slow_case,
+      FLAG_allocation_site_pretenuring ? &tenured : &slow_case);
+
+  int size = JSObject::kHeaderSize + length_ * kPointerSize;
+  GenerateFastCloneShallowObject(masm, size, NOT_TENURED, &slow_case);
+  if (FLAG_allocation_site_pretenuring) {
+    __ bind(&tenured);
+    GenerateFastCloneShallowObject(masm, size, TENURED, &slow_case);
+  }
 
   __ bind(&slow_case);
   __ TailCallRuntime(Runtime::kCreateObjectLiteralShallow, 4, 1);
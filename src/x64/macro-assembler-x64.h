@@ -43,7 +43,9 @@ enum AllocationFlags {
   TAG_OBJECT = 1 << 0,
   // The content of the result register already contains the allocation top in
   // new space.
-  RESULT_CONTAINS_TOP = 1 << 1
+  RESULT_CONTAINS_TOP = 1 << 1,
+  // Allocate in old pointer space instead of new space.
+  PRETENURE_OLD_POINTER_SPACE = 1 << 2
 };
 
 
@@ -1363,7 +1365,9 @@ class MacroAssembler: public Assembler {
                                AllocationFlags flags);
   // Update allocation top with value in result_end register.
   // If scratch is valid, it contains the address of the allocation top.
-  void UpdateAllocationTopHelper(Register result_end, Register scratch);
+  void UpdateAllocationTopHelper(Register result_end,
+                                 Register scratch,
+                                 AllocationFlags flags);
 
   // Helper for PopHandleScope.  Allowed to perform a GC and returns
   // NULL if gc_allowed.  Does not perform a GC if !gc_allowed, and
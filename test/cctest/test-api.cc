@@ -39,6 +39,7 @@
 #include "utils.h"
 #include "cctest.h"
 #include "parser.h"
+#include "serialize.h"
 #include "unicode-inl.h"
 
 static const bool kLogThreading = false;
@@ -2186,6 +2187,54 @@ THREADED_TEST(GlobalHandle) {
 }
 
 
+static const int kPersistentHandlesCount = 100 * 1000;
+
+
+TEST(CreateAndDisposePersistentHandles) {
+  v8::HandleScope scope;
+  LocalContext env;
+  i::GlobalHandles* global_handles = i::Isolate::Current()->global_handles();
+  int initial_handles = global_handles->NumberOfGlobalHandles();
+  int initial_blocks = global_handles->NumberOfBlocks();
+  Local<Object> object = Object::New();
+  for (int i = 0; i < kPersistentHandlesCount; i++) {
+    Persistent<Object> handle = Persistent<Object>::New(object);
+    handle.Dispose();
+  }
+  CHECK_EQ(initial_handles, global_handles->NumberOfGlobalHandles());
+  // The disposed node is reused right away.
+  CHECK_LE(global_handles->NumberOfBlocks(), initial_blocks + 1);
+}
+
+
+TEST(CreateAndDisposePersistentHandlesInBatches) {
+  static const int kBatchSize = 10 * 1000;
+  v8::HandleScope scope;
+  LocalContext env;
+  i::GlobalHandles* global_handles = i::Isolate::Current()->global_handles();
+  HEAP->CollectGarbage(i::NEW_SPACE);
+  int initial_handles = global_handles->NumberOfGlobalHandles();
+  int initial_blocks = global_handles->NumberOfBlocks();
+  Local<Object> object = Object::New();
+  Persistent<Object>* handles = new Persistent<Object>[kBatchSize];
+  for (int i = 0; i < kPersistentHandlesCount / kBatchSize; i++) {
+    for (int j = 0; j < kBatchSize; j++) {
+      handles[j] = Persistent<Object>::New(object);
+    }
+    CHECK_EQ(initial_handles + kBatchSize,
+             global_handles->NumberOfGlobalHandles());
+    CHECK_GT(global_handles->NumberOfBlocks(), initial_blocks);
+    // Dispose in allocation order, emptying one block after the other.
+    for (int j = 0; j < kBatchSize; j++) handles[j].Dispose();
+    // Empty blocks are released by the next collection.
+    HEAP->CollectGarbage(i::NEW_SPACE);
+    CHECK_EQ(initial_blocks, global_handles->NumberOfBlocks());
+  }
+  delete[] handles;
+  CHECK_EQ(initial_handles, global_handles->NumberOfGlobalHandles());
+}
+
+
 class WeakCallCounter {
  public:
   explicit WeakCallCounter(int id) : id_(id), number_of_weak_calls_(0) { }
@@ -2291,6 +2340,67 @@ THREADED_TEST(ApiObjectGroups) {
 }
 
 
+THREADED_TEST(PartiallyDependentObjectGroupsInScavenge) {
+  HandleScope scope;
+  LocalContext env;
+
+  Persistent<Object> g1s1;
+  Persistent<Object> g1s2;
+  Persistent<Object> g2s1;
+  Persistent<Object> g2s2;
+
+  WeakCallCounter counter(1234);
+
+  {
+    HandleScope scope;
+    g1s1 = Persistent<Object>::New(Object::New());
+    g1s2 = Persistent<Object>::New(Object::New());
+    g2s1 = Persistent<Object>::New(Object::New());
+    g2s2 = Persistent<Object>::New(Object::New());
+    g1s1.MakeWeak(reinterpret_cast<void*>(&counter), &WeakPointerCallback);
+    g1s2.MakeWeak(reinterpret_cast<void*>(&counter), &WeakPointerCallback);
+    g2s1.MakeWeak(reinterpret_cast<void*>(&counter), &WeakPointerCallback);
+    g2s2.MakeWeak(reinterpret_cast<void*>(&counter), &WeakPointerCallback);
+  }
+
+  // Only group 1 is reachable from a root.
+  Persistent<Object> root;
+  {
+    HandleScope scope;
+    root = Persistent<Object>::New(Object::New());
+    CHECK(root->Set(0, g1s1));
+  }
+
+  // Without partially dependent handles weak handles survive scavenges.
+  HEAP->CollectGarbage(i::NEW_SPACE);
+  CHECK_EQ(0, counter.NumberOfWeakCalls());
+
+  {
+    g1s1.MarkPartiallyDependent();
+    g1s2.MarkPartiallyDependent();
+    g2s1.MarkPartiallyDependent();
+    g2s2.MarkPartiallyDependent();
+    Persistent<Value> g1_objects[] = { g1s1, g1s2 };
+    Persistent<Value> g2_objects[] = { g2s1, g2s2 };
+    V8::AddObjectGroup(g1_objects, 2);
+    V8::AddObjectGroup(g2_objects, 2);
+  }
+  HEAP->CollectGarbage(i::NEW_SPACE);
+
+  // Group 1 is kept alive by the root, group 2 is collected.
+  CHECK_EQ(2, counter.NumberOfWeakCalls());
+  CHECK(!g1s2.IsNearDeath());
+
+  // The marks were cleared by the scavenge, group 1 survives.
+  HEAP->CollectGarbage(i::NEW_SPACE);
+  CHECK_EQ(2, counter.NumberOfWeakCalls());
+
+  root.Dispose();
+  HEAP->CollectAllGarbage(i::Heap::kAbortIncrementalMarkingMask);
+  CHECK_EQ(4, counter.NumberOfWeakCalls());
+}
+
+
 THREADED_TEST(ApiObjectGroupsCycle) {
   HandleScope scope;
   LocalContext env;
@@ -11679,6 +11789,242 @@ TEST(PreCompileAPIVariationsAreSame) {
 }
 
 
+class BackgroundPreCompileThread : public i::Thread {
+ public:
+  explicit BackgroundPreCompileThread(const char* source)
+      : Thread("BackgroundPreCompileThread"), source_(source), data_(NULL) { }
+  virtual void Run() {
+    data_ = v8::ScriptData::PreCompileInBackground(source_,
+                                                   i::StrLength(source_));
+  }
+  v8::ScriptData* data() { return data_; }
+ private:
+  const char* source_;
+  v8::ScriptData* data_;
+};
+
+
+// Verifies that pre-compiling on another thread records the contents of the
+// symbols and that the result can be used to compile the script.
+TEST(PreCompileInBackground) {
+  v8::V8::Initialize();
+  v8::HandleScope scope;
+  LocalContext context;
+
+  const char* script = "var greeting = 'hello';\n"
+      "var name = 'w\xc3\xb6rld';\n"
+      "function foo(a) { return greeting + ' ' + a; }\n"
+      "foo(name);";
+  BackgroundPreCompileThread thread(script);
+  thread.Start();
+  thread.Join();
+  v8::ScriptData* sd = thread.data();
+  CHECK(sd != NULL);
+  CHECK(!sd->HasError());
+
+  i::ScriptDataImpl* sd_impl = static_cast<i::ScriptDataImpl*>(sd);
+  CHECK(sd_impl->SanityCheck());
+  CHECK(sd_impl->has_symbol_contents());
+  sd_impl->Initialize();
+  bool found_ascii = false;
+  bool found_two_byte = false;
+  for (int i = 0; i < sd_impl->symbol_count(); i++) {
+    bool is_ascii;
+    i::Vector<const i::byte> literal;
+    CHECK(sd_impl->ReadSymbolContents(&is_ascii, &literal));
+    if (is_ascii) {
+      i::Vector<const char> chars = i::Vector<const char>::cast(literal);
+      if (chars.length() == 8 && strncmp(chars.start(), "greeting", 8) == 0) {
+        found_ascii = true;
+      }
+    } else {
+      i::Vector<const i::uc16> chars = i::Vector<const i::uc16>::cast(literal);
+      if (chars.length() == 5 && chars[1] == 0xf6) found_two_byte = true;
+    }
+  }
+  CHECK(found_ascii);
+  CHECK(found_two_byte);
+
+  // The regular pre-compilation data does not carry the symbols.
+  v8::ScriptData* sd_plain =
+      v8::ScriptData::PreCompile(script, i::StrLength(script));
+  CHECK(!static_cast<i::ScriptDataImpl*>(sd_plain)->has_symbol_contents());
+  CHECK_LT(sd_plain->Length(), sd->Length());
+
+  Local<Script> compiled_script = Script::New(v8_str(script), NULL, sd);
+  String::Utf8Value result(compiled_script->Run());
+  CHECK_EQ("hello w\xc3\xb6rld", *result);
+
+  delete sd;
+  delete sd_plain;
+}
+
+
+// Delivers a source in chunks of a fixed size.
+class ChunkedSourceStream : public v8::ScriptSourceStream {
+ public:
+  ChunkedSourceStream(const char* data, int chunk_size)
+      : data_(data),
+        length_(i::StrLength(data)),
+        chunk_size_(chunk_size),
+        position_(0) { }
+
+  virtual int GetNextChunk(const char** chunk) {
+    int size = i::Min(chunk_size_, length_ - position_);
+    *chunk = data_ + position_;
+    position_ += size;
+    return size;
+  }
+
+ private:
+  const char* data_;
+  int length_;
+  int chunk_size_;
+  int position_;
+};
+
+
+class StreamedSourceReadThread : public i::Thread {
+ public:
+  explicit StreamedSourceReadThread(v8::StreamedSource* source)
+      : Thread("StreamedSourceReadThread"), source_(source) { }
+  virtual void Run() { source_->Read(); }
+ private:
+  v8::StreamedSource* source_;
+};
+
+
+// Verifies that a script can be compiled from a stream, both when the
+// stream was read on another thread and when it is read by Compile.
+TEST(CompileStreamedSource) {
+  v8::HandleScope scope;
+  LocalContext context;
+
+  const char* script = "var name = 'w\xc3\xb6rld';\n"
+      "function f() { return 'hello ' + name; }\n"
+      "f() + '|' + f.toString();";
+  // Chunks of three bytes split the two-byte character.
+  ChunkedSourceStream stream(script, 3);
+  v8::StreamedSource source(&stream);
+  StreamedSourceReadThread thread(&source);
+  thread.Start();
+  thread.Join();
+  Local<Script> compiled_script = Script::Compile(&source);
+  CHECK(!compiled_script.IsEmpty());
+  String::Utf8Value result(compiled_script->Run());
+  CHECK_EQ("hello w\xc3\xb6rld|function f() { return 'hello ' + name; }",
+           *result);
+
+  const char* ascii_script = "function g(a) { return a * 2; }\n"
+      "g(21) + '|' + g.toString();";
+  ChunkedSourceStream ascii_stream(ascii_script, 1);
+  v8::StreamedSource ascii_source(&ascii_stream);
+  compiled_script = Script::Compile(&ascii_source);
+  CHECK(!compiled_script.IsEmpty());
+  String::Utf8Value ascii_result(compiled_script->Run());
+  CHECK_EQ("42|function g(a) { return a * 2; }", *ascii_result);
+}
+
+
+// Tests that a code cache can be loaded again and is ignored for another
+// source.
+TEST(CodeCache) {
+  v8::HandleScope scope;
+  LocalContext context;
+  const char* source_text =
+      "var o = { x: 1.5 };"
+      "function f(a) { return a + o.x; }"
+      "(function() { return f(1) + 'abc' + 'caf\\u00e9'.length; })()";
+  v8::ScriptData* sd = v8::ScriptData::CreateCodeCache(v8_str(source_text));
+  CHECK(sd != NULL);
+  CHECK(!sd->HasError());
+
+  // Copy the cache as an embedder storing it would.
+  int length = sd->Length();
+  char* data = i::NewArray<char>(length);
+  memcpy(data, sd->Data(), length);
+  delete sd;
+  v8::ScriptData* cached = v8::ScriptData::New(data, length);
+  CHECK_EQ(length, cached->Length());
+  CHECK(i::CodeSerializer::IsCodeCache(cached));
+  i::CodeCacheData* cached_impl = static_cast<i::CodeCacheData*>(cached);
+
+  i::Handle<i::String> source = v8::Utils::OpenHandle(*v8_str(source_text));
+  i::Handle<i::SharedFunctionInfo> shared =
+      i::CodeSerializer::Deserialize(cached_impl, source);
+  CHECK(!shared.is_null());
+  CHECK(shared->is_compiled());
+  CHECK_EQ(*source, i::Script::cast(shared->script())->source());
+  HEAP->CollectAllGarbage(i::Heap::kNoGCFlags);
+
+  Local<Script> script = Script::Compile(v8_str(source_text), NULL, cached);
+  CHECK_EQ("2.5abc4", *String::AsciiValue(script->Run()));
+  HEAP->CollectAllGarbage(i::Heap::kNoGCFlags);
+  CHECK_EQ("2.5abc4", *String::AsciiValue(script->Run()));
+
+  // Another source falls back to a normal compile.
+  const char* other_text = "'x' + 1";
+  i::Handle<i::String> other = v8::Utils::OpenHandle(*v8_str(other_text));
+  CHECK(i::CodeSerializer::Deserialize(cached_impl, other).is_null());
+  script = Script::Compile(v8_str(other_text), NULL, cached);
+  CHECK_EQ("x1", *String::AsciiValue(script->Run()));
+
+  delete cached;
+  i::DeleteArray(data);
+}
+
+
+// Tests that a code cache does not refer to anything that only exists in
+// the isolate it was created in.  Both isolates are alive at the same time,
+// so that the second one cannot be allocated where the first one was.
+TEST(CodeCacheInAnotherIsolate) {
+  const char* source_text =
+      "var o = { x: 1.5, y: [1, 2, 3] };"
+      "function f(a) { return a + o.x + o.y.length; }"
+      "function g(s) { return s.length > 2 ? s.charAt(1) : 'none'; }"
+      "function h() { try { throw new Error('e'); } catch (e) {"
+      "  return e.message; } }"
+      "(function() {"
+      "  var r = 0;"
+      "  for (var i = 0; i < 10; i++) r += f(i);"
+      "  return r + g('abc') + h() + /b+/.exec('abbc')[0] + (1 + 2);"
+      "})()";
+  v8::Isolate* isolate1 = v8::Isolate::New();
+  int length;
+  char* data;
+  {
+    v8::Isolate::Scope isolate_scope(isolate1);
+    v8::HandleScope scope;
+    LocalContext context;
+    v8::ScriptData* sd = v8::ScriptData::CreateCodeCache(v8_str(source_text));
+    CHECK(sd != NULL);
+    length = sd->Length();
+    data = i::NewArray<char>(length);
+    memcpy(data, sd->Data(), length);
+    delete sd;
+  }
+
+  v8::Isolate* isolate2 = v8::Isolate::New();
+  {
+    v8::Isolate::Scope isolate_scope(isolate2);
+    v8::HandleScope scope;
+    LocalContext context;
+    v8::ScriptData* cached = v8::ScriptData::New(data, length);
+    i::Handle<i::String> source = v8::Utils::OpenHandle(*v8_str(source_text));
+    CHECK(!i::CodeSerializer::Deserialize(
+        static_cast<i::CodeCacheData*>(cached), source).is_null());
+    Local<Script> script = Script::Compile(v8_str(source_text), NULL, cached);
+    CHECK_EQ("90bebb3", *String::AsciiValue(script->Run()));
+    HEAP->CollectAllGarbage(i::Heap::kNoGCFlags);
+    CHECK_EQ("90bebb3", *String::AsciiValue(script->Run()));
+    delete cached;
+  }
+  isolate2->Dispose();
+  isolate1->Dispose();
+  i::DeleteArray(data);
+}
+
+
 // This tests that we do not allow dictionary load/call inline caches
 // to use functions that have not yet been compiled.  The potential
 // problem of loading a function that has not yet been compiled can
@@ -14197,6 +14543,61 @@ TEST(IdleNotificationWithLargeHint) {
 }
 
 
+// Test that idle notification with a deadline reports the time it used and
+// eventually collects garbage.
+TEST(IdleNotificationDeadline) {
+  const intptr_t MB = 1024 * 1024;
+  const int kLongIdleTimeInMs = 1000;
+  const int kShortIdleTimeInMs = 50;
+  v8::HandleScope scope;
+  LocalContext env;
+  intptr_t initial_size = HEAP->SizeOfObjects();
+
+  // A zero deadline does no work, even if there is garbage to collect.
+  CreateGarbageInOldSpace();
+  v8::V8::ContextDisposedNotification();
+  intptr_t size_with_garbage = HEAP->SizeOfObjects();
+  CHECK_GT(size_with_garbage, initial_size + MB);
+  int gc_count = HEAP->gc_count();
+  double time_used_in_ms = -1;
+  CHECK(!v8::V8::IdleNotificationDeadline(0, &time_used_in_ms));
+  CHECK_GE(time_used_in_ms, 0);
+  CHECK_EQ(gc_count, HEAP->gc_count());
+  CHECK(HEAP->incremental_marking()->IsStopped());
+  CHECK_EQ(size_with_garbage, HEAP->SizeOfObjects());
+
+  // A long deadline collects all of the garbage.  This also measures the
+  // speeds that the notifications plan with.
+  bool finished = false;
+  for (int i = 0; i < 200 && !finished; i++) {
+    time_used_in_ms = -1;
+    finished = v8::V8::IdleNotificationDeadline(kLongIdleTimeInMs,
+                                                &time_used_in_ms);
+    CHECK_GE(time_used_in_ms, 0);
+    CHECK_LE(time_used_in_ms, kLongIdleTimeInMs);
+  }
+  CHECK(finished);
+  CHECK_LT(HEAP->SizeOfObjects(), initial_size + 1);
+
+  // A short deadline makes each notification do less, but all of it within
+  // the deadline.
+  CreateGarbageInOldSpace();
+  v8::V8::ContextDisposedNotification();
+  gc_count = HEAP->gc_count();
+  finished = false;
+  for (int i = 0; i < 200 && !finished; i++) {
+    time_used_in_ms = -1;
+    finished = v8::V8::IdleNotificationDeadline(kShortIdleTimeInMs,
+                                                &time_used_in_ms);
+    CHECK_GE(time_used_in_ms, 0);
+    CHECK_LE(time_used_in_ms, kShortIdleTimeInMs);
+  }
+  CHECK(finished);
+  CHECK_GT(HEAP->gc_count(), gc_count);
+  CHECK_LT(HEAP->SizeOfObjects(), initial_size + 1);
+}
+
+
 TEST(Regress2107) {
   const intptr_t MB = 1024 * 1024;
   const int kShortIdlePauseInMs = 100;
@@ -14315,6 +14716,69 @@ THREADED_TEST(GetHeapStatistics) {
 }
 
 
+THREADED_TEST(GetHeapSpaceStatistics) {
+  v8::HandleScope scope;
+  LocalContext c1;
+  v8::HeapStatistics heap_statistics;
+  v8::V8::GetHeapStatistics(&heap_statistics);
+  size_t committed = 0;
+  for (int i = 0; i < v8::V8::NumberOfHeapSpaces(); i++) {
+    v8::HeapSpaceStatistics space_statistics;
+    CHECK(v8::V8::GetHeapSpaceStatistics(&space_statistics, i));
+    CHECK(space_statistics.space_name() != NULL);
+    CHECK(space_statistics.space_used_size() <=
+          space_statistics.space_committed_size());
+    committed += space_statistics.space_committed_size();
+  }
+  CHECK_EQ(static_cast<intptr_t>(heap_statistics.total_heap_size()),
+           static_cast<intptr_t>(committed));
+  v8::HeapSpaceStatistics space_statistics;
+  CHECK(!v8::V8::GetHeapSpaceStatistics(&space_statistics,
+                                        v8::V8::NumberOfHeapSpaces()));
+}
+
+
+static int SumOfHistogram(v8::GCPauseStatistics* stats,
+                          v8::GCPauseStatistics::Phase phase) {
+  int sum = 0;
+  for (int i = 0; i < v8::GCPauseStatistics::kNumberOfBuckets; i++) {
+    sum += stats->histogram(phase, i);
+  }
+  return sum;
+}
+
+
+TEST(GetGCPauseStatistics) {
+  v8::HandleScope scope;
+  LocalContext c1;
+  v8::GCPauseStatistics before;
+  v8::V8::GetGCPauseStatistics(v8::kGCTypeScavenge, &before);
+  HEAP->CollectGarbage(i::NEW_SPACE);
+  v8::GCPauseStatistics scavenges;
+  v8::V8::GetGCPauseStatistics(v8::kGCTypeScavenge, &scavenges);
+  CHECK_EQ(before.gc_count() + 1, scavenges.gc_count());
+  CHECK_EQ(scavenges.gc_count(),
+           SumOfHistogram(&scavenges, v8::GCPauseStatistics::kTotal));
+  CHECK_EQ(0, SumOfHistogram(&scavenges, v8::GCPauseStatistics::kMark));
+
+  for (int i = 0; i < v8::GCPauseStatistics::kMaxSamples + 1; i++) {
+    HEAP->CollectAllGarbage(i::Heap::kNoGCFlags);
+  }
+  v8::GCPauseStatistics mark_compacts;
+  v8::V8::GetGCPauseStatistics(v8::kGCTypeMarkSweepCompact, &mark_compacts);
+  CHECK_EQ(v8::GCPauseStatistics::kMaxSamples, mark_compacts.sample_count());
+  double max = 0;
+  for (int i = 0; i < mark_compacts.sample_count(); i++) {
+    double pause = mark_compacts.sample_ms(i, v8::GCPauseStatistics::kTotal);
+    CHECK(mark_compacts.sample_ms(i, v8::GCPauseStatistics::kMark) <= pause);
+    max = i::Max(max, pause);
+  }
+  CHECK(max <= mark_compacts.max_ms(v8::GCPauseStatistics::kTotal));
+  CHECK(mark_compacts.max_ms(v8::GCPauseStatistics::kTotal) <=
+        mark_compacts.total_ms(v8::GCPauseStatistics::kTotal));
+}
+
+
 class VisitorImpl : public v8::ExternalResourceVisitor {
  public:
   VisitorImpl(TestResource* r1, TestResource* r2)
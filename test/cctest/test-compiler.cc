@@ -384,6 +384,129 @@ TEST(OptimizedCodeSharing) {
 }
 
 
+static int loads_eliminated = 0;
+static int stores_eliminated = 0;
+
+
+static int* LookupCounter(const char* name) {
+  if (strcmp(name, "c:V8.HydrogenLoadsEliminated") == 0) {
+    return &loads_eliminated;
+  } else if (strcmp(name, "c:V8.HydrogenStoresEliminated") == 0) {
+    return &stores_eliminated;
+  }
+  return NULL;
+}
+
+
+// Test that load store elimination removes a store that is overwritten
+// before anything can observe it and a load of a field that was just stored.
+TEST(LoadStoreElimination) {
+  v8::V8::SetCounterFunction(LookupCounter);
+  FLAG_use_load_store_elimination = true;
+  FLAG_allow_natives_syntax = true;
+  InitializeVM();
+  // Without type feedback the named stores are not specialized.
+  if (!V8::UseCrankshaft() || FLAG_always_opt) return;
+  v8::HandleScope scope;
+  CompileRun("function Point(x, y) { this.x = x; this.y = y; }"
+             "function f(p) {"
+             "  p.y = 3;"
+             "  p.y = 4;"
+             "  return p.y + p.x;"
+             "}"
+             "var p = new Point(1, 2);"
+             "f(p);"
+             "f(p);");
+  CHECK_EQ(0, loads_eliminated);
+  CHECK_EQ(0, stores_eliminated);
+  v8::Local<v8::Value> result =
+      CompileRun("%OptimizeFunctionOnNextCall(f);"
+                 "f(p) * 10 + p.y;");
+  CHECK_EQ(54, result->Int32Value());
+  CHECK_EQ(1, loads_eliminated);
+  CHECK_EQ(1, stores_eliminated);
+}
+
+
+static Handle<JSFunction> GetGlobalFunction(const char* name) {
+  v8::Local<v8::Value> value =
+      v8::Context::GetCurrent()->Global()->Get(v8_str(name));
+  return v8::Utils::OpenHandle(*v8::Local<v8::Function>::Cast(value));
+}
+
+
+static void RecompileParallel(Handle<JSFunction> function) {
+  if (!function->IsMarkedForParallelRecompilation()) {
+    function->MarkForParallelRecompilation();
+  }
+  Compiler::RecompileParallel(function);
+}
+
+
+static void CheckUnoptimized(Handle<JSFunction> function) {
+  CHECK(!function->IsInRecompileQueue());
+  CHECK(!function->IsOptimized());
+  CHECK_EQ(function->shared()->code(), function->code());
+}
+
+
+// Test that parallel recompilation cancels the jobs of functions whose
+// optimization was disabled after they were queued, both while the jobs
+// wait in the full queue and while they are compiled.  The functions get
+// their unoptimized code back.
+TEST(ParallelRecompilationCancelsStaleJobs) {
+  FLAG_parallel_recompilation = true;
+  FLAG_block_parallel_recompilation = true;
+  FLAG_parallel_recompilation_queue_length = 2;
+  // The flags take effect in an isolate that is set up with them.
+  v8::Isolate* isolate = v8::Isolate::New();
+  if (V8::UseCrankshaft() && !FLAG_always_opt) {
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope scope;
+    LocalContext env;
+    CompileRun("function f(x) { return x + 1; }"
+               "function g(x) { return x * 2; }"
+               "function h(x) { return x - 1; }"
+               "for (var i = 0; i < 10; i++) { f(i); g(i); h(i); }");
+    Handle<JSFunction> f = GetGlobalFunction("f");
+    Handle<JSFunction> g = GetGlobalFunction("g");
+    Handle<JSFunction> h = GetGlobalFunction("h");
+    OptimizingCompilerThread* thread =
+        Isolate::Current()->optimizing_compiler_thread();
+
+    // The threads are blocked, so f and g fill the queue.
+    RecompileParallel(f);
+    RecompileParallel(g);
+    CHECK(f->IsInRecompileQueue());
+    CHECK(g->IsInRecompileQueue());
+    RecompileParallel(h);
+    CHECK(!h->IsInRecompileQueue());
+
+    // Disabling the optimization of f makes room for h.
+    f->shared()->DisableOptimization();
+    RecompileParallel(h);
+    CHECK(h->IsInRecompileQueue());
+    CheckUnoptimized(f);
+    CHECK_EQ(3, CompileRun("f(2)")->Int32Value());
+
+    // g is cancelled wherever it is when its optimization is disabled.
+    thread->Unblock();
+    g->shared()->DisableOptimization();
+    while (g->IsInRecompileQueue() || h->IsInRecompileQueue()) {
+      OS::Sleep(1);
+      thread->InstallOptimizedFunctions();
+    }
+    CheckUnoptimized(g);
+    CHECK(h->IsOptimized());
+    CHECK_EQ(4, CompileRun("g(2)")->Int32Value());
+    CHECK_EQ(1, CompileRun("h(2)")->Int32Value());
+  }
+  isolate->Dispose();
+  FLAG_parallel_recompilation = false;
+  FLAG_block_parallel_recompilation = false;
+}
+
+
 #ifdef ENABLE_DISASSEMBLER
 static Handle<JSFunction> GetJSFunction(v8::Handle<v8::Object> obj,
                                  const char* property_name) {
@@ -1658,3 +1658,56 @@ TEST(NoRefsToNonEssentialEntries) {
       GetProperty(global_object, v8::HeapGraphEdge::kInternal, "elements");
   CHECK_EQ(NULL, elements);
 }
+
+
+static const v8::AllocationProfileNode* FindAllocationNode(
+    const v8::AllocationProfileNode* node, const char* name) {
+  v8::String::AsciiValue node_name(node->GetFunctionName());
+  if (strcmp(*node_name, name) == 0) return node;
+  for (int i = 0; i < node->GetChildrenCount(); ++i) {
+    const v8::AllocationProfileNode* found =
+        FindAllocationNode(node->GetChild(i), name);
+    if (found != NULL) return found;
+  }
+  return NULL;
+}
+
+
+TEST(SamplingHeapProfiler) {
+  i::FLAG_sampling_heap_profiler_suppress_randomness = true;
+  v8::HandleScope scope;
+  LocalContext env;
+
+  CHECK_EQ(NULL, v8::HeapProfiler::GetAllocationProfile());
+  CHECK(v8::HeapProfiler::StartSamplingHeapProfiler(1024));
+  CHECK(!v8::HeapProfiler::StartSamplingHeapProfiler(1024));
+
+  CompileRun(
+      "function allocate() { return new Array(100); }\n"
+      "function caller() {\n"
+      "  var result;\n"
+      "  for (var i = 0; i < 10000; i++) result = allocate();\n"
+      "  return result;\n"
+      "}\n"
+      "caller();\n");
+
+  const v8::AllocationProfile* profile =
+      v8::HeapProfiler::GetAllocationProfile();
+  CHECK_NE(NULL, profile);
+  CHECK_GT(profile->GetSamplesCount(), 0);
+  const v8::AllocationProfileNode* caller =
+      FindAllocationNode(profile->GetRoot(), "caller");
+  CHECK_NE(NULL, caller);
+  CHECK_EQ(2, caller->GetLineNumber());
+  const v8::AllocationProfileNode* allocate =
+      FindAllocationNode(caller, "allocate");
+  CHECK_NE(NULL, allocate);
+  CHECK_GT(allocate->GetSelfSamplesCount(), 0);
+  // About 4MB are allocated in allocate.
+  CHECK_GT(allocate->GetSelfSize(), 2 * i::MB);
+  CHECK(allocate->GetSelfSize() <= caller->GetTotalSize());
+
+  v8::HeapProfiler::StopSamplingHeapProfiler();
+  CHECK_EQ(NULL, v8::HeapProfiler::GetAllocationProfile());
+  i::FLAG_sampling_heap_profiler_suppress_randomness = false;
+}
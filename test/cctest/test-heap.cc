@@ -983,6 +983,60 @@ TEST(TestCodeFlushing) {
 }
 
 
+TEST(TestCodeFlushingAge) {
+  // If we do not flush code this test is invalid.
+  if (!FLAG_flush_code) return;
+  FLAG_code_flush_age = 2;
+  // Keep the script's code from holding on to the code of foo.
+  FLAG_compilation_cache = false;
+  InitializeVM();
+  v8::HandleScope scope;
+  const char* source = "function foo() {"
+                       "  var x = 42;"
+                       "  var y = 42;"
+                       "  var z = x + y;"
+                       "};"
+                       "foo()";
+  Handle<String> foo_name = FACTORY->LookupAsciiSymbol("foo");
+
+  { v8::HandleScope scope;
+    CompileRun(source);
+  }
+
+  Object* func_value = Isolate::Current()->context()->global()->
+      GetProperty(*foo_name)->ToObjectChecked();
+  CHECK(func_value->IsJSFunction());
+  Handle<JSFunction> function(JSFunction::cast(func_value));
+  CHECK(function->shared()->is_compiled());
+
+  // The code ages, the function calls the lazy compile builtin until it
+  // is executed again.
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK(function->shared()->is_compiled());
+  CHECK(!function->is_compiled());
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK(function->shared()->is_compiled());
+
+  // Executing foo resets the age of its code.
+  CompileRun("foo()");
+  CHECK(function->is_compiled());
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK(function->shared()->is_compiled());
+
+  // Two collections without execution flush the code.
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK(!function->shared()->is_compiled() || function->IsOptimized());
+  CHECK(!function->is_compiled() || function->IsOptimized());
+
+  CompileRun("foo()");
+  CHECK(function->shared()->is_compiled());
+  CHECK(function->is_compiled());
+  FLAG_code_flush_age = 5;
+  FLAG_compilation_cache = true;
+}
+
+
 // Count the number of global contexts in the weak list of global contexts.
 int CountGlobalContexts() {
   int count = 0;
@@ -1325,6 +1379,70 @@ TEST(GrowAndShrinkNewSpace) {
 }
 
 
+TEST(NewSpaceCapacityForGCTime) {
+  // 256 KB of survivors copied at 256 KB/ms take 1 ms.  Allocating 1 MB/ms,
+  // scavenges may come at most every 20 ms to stay within 5% of the time.
+  intptr_t capacity =
+      Heap::NewSpaceCapacityForGCTime(256 * KB, 256 * KB, 1 * MB, 5);
+  CHECK_EQ(static_cast<intptr_t>(20 * MB), capacity);
+  // Twice the survivors, twice the capacity.
+  capacity = Heap::NewSpaceCapacityForGCTime(512 * KB, 256 * KB, 1 * MB, 5);
+  CHECK_EQ(static_cast<intptr_t>(40 * MB), capacity);
+  // Nothing survives or nothing is allocated: no need for a big new space.
+  capacity = Heap::NewSpaceCapacityForGCTime(0, 256 * KB, 1 * MB, 5);
+  CHECK_EQ(static_cast<intptr_t>(0), capacity);
+  capacity = Heap::NewSpaceCapacityForGCTime(256 * KB, 256 * KB, 0, 5);
+  CHECK_EQ(static_cast<intptr_t>(0), capacity);
+}
+
+
+TEST(DynamicNewSpaceSizingFollowsSurvival) {
+  FLAG_dynamic_new_space_sizing = true;
+  InitializeVM();
+  if (HEAP->ReservedSemiSpaceSize() == HEAP->InitialSemiSpaceSize()) {
+    // The new space cannot grow.
+    FLAG_dynamic_new_space_sizing = false;
+    return;
+  }
+
+  v8::HandleScope scope;
+  NewSpace* new_space = HEAP->new_space();
+  intptr_t initial_capacity = new_space->Capacity();
+  CHECK_EQ(static_cast<intptr_t>(new_space->InitialCapacity()),
+           initial_capacity);
+
+  // Keep a window of recent arrays alive that is as large as the new space,
+  // so that most of every scavenge survives.  The new space grows.
+  const int kArrayLength = 64;
+  const int kWindow =
+      static_cast<int>(initial_capacity / FixedArray::SizeFor(kArrayLength));
+  Handle<FixedArray> window = FACTORY->NewFixedArray(kWindow, TENURED);
+  int scavenges = HEAP->gc_count();
+  for (int i = 0;
+       new_space->Capacity() == initial_capacity &&
+           HEAP->gc_count() < scavenges + 100;
+       i++) {
+    v8::HandleScope inner_scope;
+    window->set(i % kWindow, *FACTORY->NewFixedArray(kArrayLength));
+  }
+  intptr_t grown_capacity = new_space->Capacity();
+  CHECK_GT(grown_capacity, initial_capacity);
+  CHECK_LE(grown_capacity, new_space->MaximumCapacity());
+
+  // Let everything die young.  The new space shrinks back.
+  for (int i = 0; i < kWindow; i++) window->set_undefined(i);
+  scavenges = HEAP->gc_count();
+  while (new_space->Capacity() > initial_capacity &&
+         HEAP->gc_count() < scavenges + 100) {
+    v8::HandleScope inner_scope;
+    FACTORY->NewFixedArray(kArrayLength);
+  }
+  CHECK_LT(new_space->Capacity(), grown_capacity);
+  CHECK_EQ(initial_capacity, new_space->Capacity());
+  FLAG_dynamic_new_space_sizing = false;
+}
+
+
 TEST(CollectingAllAvailableGarbageShrinksNewSpace) {
   InitializeVM();
 
@@ -1966,3 +2084,455 @@ TEST(Regress2237) {
   HEAP->CollectAllGarbage(Heap::kNoGCFlags);
   CHECK(SlicedString::cast(*slice)->parent()->IsSeqAsciiString());
 }
+
+
+TEST(ParallelScavenge) {
+  FLAG_parallel_scavenge = true;
+  FLAG_scavenger_threads = 2;
+  InitializeVM();
+  CHECK(Isolate::Current()->gc_helper_threads(GCHelperThread::SCAVENGING) !=
+        NULL);
+
+  v8::HandleScope scope;
+  const int kArrays = 1000;
+  const char* kString = "a string that is copied by a parallel scavenge";
+  // The tenured array is only reachable through the store buffer from old
+  // space, the new space arrays link to each other and to strings and heap
+  // numbers that are copied or promoted by any of the scavengers.
+  Handle<FixedArray> old_array = FACTORY->NewFixedArray(kArrays, TENURED);
+  Handle<FixedArray> head = FACTORY->NewFixedArray(3);
+  {
+    v8::HandleScope inner_scope;
+    for (int i = 0; i < kArrays; i++) {
+      Handle<FixedArray> array = FACTORY->NewFixedArray(3);
+      array->set(0, *FACTORY->NewNumber(i + 0.5));
+      array->set(1, *FACTORY->NewStringFromAscii(CStrVector(kString)));
+      array->set(2, head->get(2));
+      head->set(2, *array);
+      old_array->set(i, *array);
+    }
+  }
+  CHECK(HEAP->InNewSpace(head->get(2)));
+
+  // The first scavenge copies the objects within new space and the second
+  // one promotes them.
+  for (int round = 0; round < 2; round++) {
+    HEAP->CollectGarbage(NEW_SPACE);
+    Object* current = head->get(2);
+    for (int i = kArrays - 1; i >= 0; i--) {
+      FixedArray* array = FixedArray::cast(current);
+      CHECK_EQ(array, old_array->get(i));
+      CHECK_EQ(i + 0.5, array->get(0)->Number());
+      CHECK(String::cast(array->get(1))->IsEqualTo(CStrVector(kString)));
+      current = array->get(2);
+    }
+    CHECK(current->IsUndefined());
+  }
+  CHECK(!HEAP->InNewSpace(head->get(2)));
+#ifdef DEBUG
+  HEAP->Verify();
+#endif
+}
+
+
+TEST(StoreBufferSlotSets) {
+  InitializeVM();
+  v8::HandleScope scope;
+  // More distinct old-to-new slots than fit into the store buffer, so its
+  // entries have to move to the slot set of the array's chunk.
+  const int kLength =
+      StoreBuffer::kOldStoreBufferLength + StoreBuffer::kStoreBufferLength;
+  Handle<FixedArray> array = FACTORY->NewFixedArray(kLength, TENURED);
+  Handle<Object> number = FACTORY->NewNumber(0.5, NOT_TENURED);
+  CHECK(HEAP->InNewSpace(*number));
+  for (int i = 0; i < kLength; i++) {
+    array->set(i, *number);
+  }
+  MemoryChunk* chunk = MemoryChunk::FromAddress(array->address());
+  CHECK(chunk->slot_set() != NULL);
+
+  // The first scavenge copies the number within new space and the second
+  // one promotes it.  All slots have to be updated both times.
+  for (int round = 0; round < 2; round++) {
+    HEAP->CollectGarbage(NEW_SPACE);
+    for (int i = 0; i < kLength; i++) {
+      CHECK_EQ(*number, array->get(i));
+    }
+  }
+  CHECK(!HEAP->InNewSpace(*number));
+  // No slot points to new space any more.
+  CHECK(chunk->slot_set() == NULL);
+#ifdef DEBUG
+  HEAP->Verify();
+#endif
+}
+
+
+TEST(AllocationSitePretenuring) {
+  FLAG_allocation_site_pretenuring = true;
+  InitializeVM();
+  v8::HandleScope scope;
+
+  CompileRun("function make() { return { a: 1, b: 2 }; }"
+             "var keep = [];"
+             "for (var i = 0; i < 1000; i++) keep.push(make());");
+  Handle<JSObject> o =
+      v8::Utils::OpenHandle(*v8::Handle<v8::Object>::Cast(
+          CompileRun("make()")));
+  CHECK(HEAP->InNewSpace(*o));
+
+  // The fast cloning stub copies the undecided site itself and only leaves
+  // every n-th copy to the runtime, which tracks it.
+  Handle<JSFunction> make =
+      v8::Utils::OpenHandle(*v8::Handle<v8::Function>::Cast(
+          CompileRun("make")));
+  Object* literal = make->literals()->get(JSFunction::kLiteralsPrefixSize);
+  CHECK(literal->IsAllocationSite());
+  Handle<AllocationSite> site(AllocationSite::cast(literal));
+  CHECK_EQ(AllocationSite::kUndecided, site->pretenure_decision());
+  CHECK_GE(site->memento_create_count(),
+           AllocationSite::kMinimumCreatedCount);
+  CHECK_LT(site->memento_create_count(), 1000);
+
+  // All tracked copies survive the scavenge.  The next copy made by the
+  // runtime digests that, and later copies are tenured except for one
+  // sample in new space out of every kTenuredSampleInterval copies.
+  HEAP->CollectGarbage(NEW_SPACE);
+  CompileRun("for (var i = 0; i < 8; i++) make();");
+  CHECK_EQ(AllocationSite::kTenure, site->pretenure_decision());
+  Handle<JSArray> copies =
+      v8::Utils::OpenHandle(*v8::Handle<v8::Array>::Cast(
+          CompileRun("var copies = [];"
+                     "for (var i = 0; i < 8; i++) copies.push(make());"
+                     "copies")));
+  int copies_in_new_space = 0;
+  for (int i = 0; i < AllocationSite::kTenuredSampleInterval; i++) {
+    if (HEAP->InNewSpace(FixedArray::cast(copies->elements())->get(i))) {
+      copies_in_new_space++;
+    }
+  }
+  CHECK_EQ(1, copies_in_new_space);
+  CHECK(CompileRun("make().b == 2")->BooleanValue());
+
+  // The stub fills tenured copies without a write barrier, so it has to
+  // record their pointers to new space itself.
+  Handle<Object> number = FACTORY->NewNumber(1.5);
+  CHECK(HEAP->InNewSpace(*number));
+  site->boilerplate()->FastPropertyAtPut(0, *number);
+  CompileRun("copies = [];"
+             "for (var i = 0; i < 8; i++) copies.push(make());");
+  HEAP->CollectGarbage(NEW_SPACE);
+  HEAP->CollectGarbage(NEW_SPACE);
+  CHECK(CompileRun("copies.every(function(c) { return c.a == 1.5; })")
+            ->BooleanValue());
+
+  // The sampled copies die young.  Once the runtime sees the next sample,
+  // the site goes back to new space.
+  CompileRun("keep = copies = null;"
+             "for (var i = 0; i < 8000; i++) make();");
+  HEAP->CollectGarbage(NEW_SPACE);
+  CompileRun("for (var i = 0; i < 8; i++) make();");
+  CHECK_EQ(AllocationSite::kDontTenure, site->pretenure_decision());
+  o = v8::Utils::OpenHandle(*v8::Handle<v8::Object>::Cast(
+      CompileRun("make()")));
+  CHECK(HEAP->InNewSpace(*o));
+}
+
+
+TEST(MemoryReducer) {
+  FLAG_memory_reducer = true;
+  InitializeVM();
+  v8::HandleScope scope;
+  MemoryReducer* reducer = HEAP->memory_reducer();
+  CHECK_EQ(MemoryReducer::DONE, reducer->state());
+
+  // Grow the old space well beyond the committed memory delta.
+  CompileRun("var garbage = [];"
+             "for (var i = 0; i < 2000; i++) garbage.push(new Array(1000));");
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  CHECK_EQ(MemoryReducer::WAIT, reducer->state());
+
+  // The delay has not expired yet, so idle time does not trigger a GC.
+  int ms_count = HEAP->ms_count();
+  CHECK(!reducer->NotifyIdle(true));
+  CHECK_EQ(ms_count, HEAP->ms_count());
+  CHECK_EQ(MemoryReducer::WAIT, reducer->state());
+
+  // Once the delay has expired, idle time with a low allocation rate runs a
+  // GC that gives back the memory of the garbage.
+  CompileRun("garbage = null;");
+  intptr_t committed = HEAP->CommittedMemory();
+  double now = OS::TimeCurrentMillis() + MemoryReducer::kLongDelayMs;
+  CHECK(reducer->NotifyIdle(true, now));
+  CHECK_EQ(ms_count + 1, HEAP->ms_count());
+  CHECK_EQ(1, reducer->started_gcs());
+  CHECK_GT(committed, HEAP->CommittedMemory());
+  CHECK_GT(reducer->stats_before_last_gc().committed[OLD_POINTER_SPACE],
+           reducer->stats_after_last_gc().committed[OLD_POINTER_SPACE]);
+
+  // That GC released enough memory to try again after a short delay.  The
+  // reduction ends once a GC releases too little or the maximum number of
+  // GCs is reached.
+  CHECK_EQ(MemoryReducer::WAIT, reducer->state());
+  while (reducer->state() == MemoryReducer::WAIT) {
+    now += MemoryReducer::kLongDelayMs;
+    CHECK(reducer->NotifyIdle(true, now));
+  }
+  CHECK_EQ(MemoryReducer::DONE, reducer->state());
+  CHECK_LE(reducer->started_gcs(), MemoryReducer::kMaxNumberOfGCs);
+  CHECK_EQ(ms_count + reducer->started_gcs(), HEAP->ms_count());
+}
+
+
+TEST(IncrementalMarkingPauseTarget) {
+  if (!FLAG_incremental_marking) return;
+  FLAG_gc_target_pause_ms = 1;
+  InitializeVM();
+  v8::HandleScope scope;
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+
+  IncrementalMarking* marking = HEAP->incremental_marking();
+  marking->Abort();
+  marking->Start();
+  while (!marking->IsMarking() && !marking->IsStopped()) {
+    marking->Step(MB, IncrementalMarking::NO_GC_VIA_STACK_GUARD);
+  }
+  CHECK(marking->IsMarking());
+
+  // A step for far more allocation than can be marked within the target
+  // pause is capped at what the measured marking speed allows.
+  int capped = marking->capped_steps_count();
+  intptr_t max_step =
+      marking->marking_speed_in_bytes_per_ms() * FLAG_gc_target_pause_ms;
+  marking->Step(Max(4 * max_step, static_cast<intptr_t>(MB)),
+                IncrementalMarking::NO_GC_VIA_STACK_GUARD);
+  CHECK_EQ(capped + 1, marking->capped_steps_count());
+
+  marking->Abort();
+  FLAG_gc_target_pause_ms = 0;
+}
+
+
+TEST(LargeObjectChunkPool) {
+  InitializeVM();
+  MemoryAllocator* allocator = ISOLATE->memory_allocator();
+  const int kLength = 256 * KB;
+  Address chunk;
+  {
+    v8::HandleScope scope;
+    Handle<FixedArray> array = FACTORY->NewFixedArray(kLength, TENURED);
+    CHECK(HEAP->lo_space()->Contains(*array));
+    chunk = MemoryChunk::FromAddress(array->address())->address();
+  }
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  CHECK_LT(0, static_cast<int>(allocator->SizePooledLargeChunks()));
+
+  // An allocation of the same size reuses the pooled chunk.
+  v8::HandleScope scope;
+  Handle<FixedArray> array = FACTORY->NewFixedArray(kLength, TENURED);
+  CHECK_EQ(chunk, MemoryChunk::FromAddress(array->address())->address());
+  CHECK_EQ(0, static_cast<int>(allocator->SizePooledLargeChunks()));
+
+  // Shrinking the heap gives the pool back to the OS.
+  array = FACTORY->NewFixedArray(kLength, TENURED);
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  HEAP->Shrink();
+  CHECK_EQ(0, static_cast<int>(allocator->SizePooledLargeChunks()));
+}
+
+
+TEST(LargeObjectTrimmedTailIsReleased) {
+  InitializeVM();
+  v8::HandleScope scope;
+  CompileRun("var a = [];"
+             "for (var i = 0; i < 300000; i++) a.push(i);");
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  intptr_t size = HEAP->lo_space()->Size();
+  CompileRun("a.length = 10;");
+  CHECK_GT(size, HEAP->lo_space()->Size());
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+}
+
+
+TEST(ExternalMemoryPressureDrivesIncrementalMarking) {
+  if (!FLAG_incremental_marking) return;
+  InitializeVM();
+  v8::HandleScope scope;
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+  IncrementalMarking* marking = HEAP->incremental_marking();
+  marking->Abort();
+  int ms_count = HEAP->ms_count();
+
+  // More than half of the external allocation limit starts marking instead
+  // of a full collection.
+  intptr_t amount = 6 * HEAP->MaxSemiSpaceSize();
+  v8::V8::AdjustAmountOfExternalAllocatedMemory(amount);
+  CHECK(!marking->IsStopped());
+  CHECK_EQ(ms_count, HEAP->ms_count());
+
+  // Further external allocation advances the marking.
+  int steps = marking->steps_count();
+  v8::V8::AdjustAmountOfExternalAllocatedMemory(
+      IncrementalMarking::kAllocatedThreshold);
+  CHECK_EQ(steps + 1, marking->steps_count());
+
+  v8::V8::AdjustAmountOfExternalAllocatedMemory(
+      -(amount + IncrementalMarking::kAllocatedThreshold));
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+}
+
+
+TEST(EvacuationCandidatesWithinBudget) {
+  if (FLAG_stress_compaction || FLAG_always_compact || FLAG_never_compact) {
+    return;
+  }
+  FLAG_evacuation_time_budget_ms = 1000;
+  InitializeVM();
+  v8::HandleScope scope;
+  PagedSpace* space = HEAP->old_pointer_space();
+
+  // Fill a few pages with arrays and keep only every fourth of them alive.
+  const int kArrays = 4 * space->AreaSize() / FixedArray::SizeFor(1000);
+  Handle<FixedArray> keep =
+      FACTORY->NewFixedArray((kArrays + 3) / 4, TENURED);
+  for (int i = 0; i < kArrays; i++) {
+    v8::HandleScope inner_scope;
+    Handle<FixedArray> array = FACTORY->NewFixedArray(1000, TENURED);
+    if (i % 4 == 0) keep->set(i / 4, *array);
+  }
+  HEAP->CollectAllGarbage(Heap::kAbortIncrementalMarkingMask);
+
+  List<Page*> pages;
+  List<intptr_t> live_bytes;
+  PageIterator it(space);
+  while (it.has_next()) {
+    Page* p = it.next();
+    FreeList::SizeStats sizes;
+    pages.Add(p);
+    live_bytes.Add(space->EstimateLiveBytes(p, &sizes));
+  }
+
+  MarkCompactCollector* collector = HEAP->mark_compact_collector();
+  CHECK(collector->StartCompaction(
+      MarkCompactCollector::NON_INCREMENTAL_COMPACTION));
+  int candidates = 0;
+  intptr_t max_candidate_live_bytes = 0;
+  for (int i = 0; i < pages.length(); i++) {
+    if (!pages[i]->IsEvacuationCandidate()) continue;
+    candidates++;
+    max_candidate_live_bytes = Max(max_candidate_live_bytes, live_bytes[i]);
+  }
+  CHECK_GT(candidates, 0);
+  CHECK_LE(max_candidate_live_bytes, space->AreaSize() - space->AreaSize() / 4);
+  collector->AbortCompaction();
+
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  FLAG_evacuation_time_budget_ms = 0;
+}
+
+
+static intptr_t GetReportNumber(v8::Handle<v8::Object> report,
+                                const char* name) {
+  return static_cast<intptr_t>(
+      report->Get(v8::String::New(name))->IntegerValue());
+}
+
+
+TEST(FragmentationReport) {
+  if (FLAG_stress_compaction || FLAG_always_compact) return;
+  InitializeVM();
+  v8::HandleScope scope;
+  const char* extension_names[] = { "v8/statistics" };
+  v8::ExtensionConfiguration extensions(1, extension_names);
+  v8::Persistent<v8::Context> context = v8::Context::New(&extensions);
+  context->Enter();
+
+  // Leave the old pointer space with pages that are a quarter live.
+  PagedSpace* old_pointer_space = HEAP->old_pointer_space();
+  const int kArrays =
+      4 * old_pointer_space->AreaSize() / FixedArray::SizeFor(1000);
+  Handle<FixedArray> keep =
+      FACTORY->NewFixedArray((kArrays + 3) / 4, TENURED);
+  for (int i = 0; i < kArrays; i++) {
+    v8::HandleScope inner_scope;
+    Handle<FixedArray> array = FACTORY->NewFixedArray(1000, TENURED);
+    if (i % 4 == 0) keep->set(i / 4, *array);
+  }
+
+  v8::Local<v8::Object> report =
+      CompileRun("getV8FragmentationReport(true)")->ToObject();
+
+  // Building and reading the report allocates maps, but the pages of the
+  // old pointer space stay as they were reported.
+  List<intptr_t> expected_live_bytes;
+  PageIterator it(old_pointer_space);
+  while (it.has_next()) {
+    FreeList::SizeStats sizes;
+    expected_live_bytes.Add(
+        old_pointer_space->EstimateLiveBytes(it.next(), &sizes));
+  }
+
+  PagedSpaces spaces;
+  for (PagedSpace* space = spaces.next();
+       space != NULL;
+       space = spaces.next()) {
+    v8::Local<v8::Value> value =
+        report->Get(v8::String::New(AllocationSpaceName(space->identity())));
+    CHECK(value->IsObject());
+    v8::Local<v8::Object> space_report = value->ToObject();
+    intptr_t area_size = GetReportNumber(space_report, "area_size");
+    CHECK_EQ(static_cast<intptr_t>(space->AreaSize()), area_size);
+    int space_pages =
+        static_cast<int>(GetReportNumber(space_report, "pages"));
+    CHECK_GT(space_pages, 0);
+
+    // The report gives the live bytes of the pages in page order.
+    v8::Local<v8::Array> page_live_bytes = v8::Local<v8::Array>::Cast(
+        space_report->Get(v8::String::New("page_live_bytes")));
+    CHECK_EQ(space_pages, static_cast<int>(page_live_bytes->Length()));
+    intptr_t live_bytes = 0;
+    for (int i = 0; i < space_pages; i++) {
+      intptr_t reported =
+          static_cast<intptr_t>(page_live_bytes->Get(i)->IntegerValue());
+      if (space == old_pointer_space) {
+        CHECK_EQ(expected_live_bytes[i], reported);
+      }
+      CHECK(reported >= 0 && reported <= area_size);
+      live_bytes += reported;
+    }
+    CHECK_EQ(live_bytes, GetReportNumber(space_report, "live_bytes"));
+
+    // Every page is in exactly one of the ten bins of the histogram.
+    v8::Local<v8::Array> histogram = v8::Local<v8::Array>::Cast(
+        space_report->Get(v8::String::New("live_bytes_histogram")));
+    CHECK_EQ(10, static_cast<int>(histogram->Length()));
+    int histogram_pages = 0;
+    int lower_half_pages = 0;
+    for (int i = 0; i < 10; i++) {
+      int bin = static_cast<int>(histogram->Get(i)->Int32Value());
+      CHECK_GE(bin, 0);
+      histogram_pages += bin;
+      if (i < 5) lower_half_pages += bin;
+    }
+    CHECK_EQ(space_pages, histogram_pages);
+
+    intptr_t free_list_bytes = 0;
+    const char* free_list_names[] = {
+      "free_list_small", "free_list_medium", "free_list_large", "free_list_huge"
+    };
+    for (int i = 0; i < 4; i++) {
+      intptr_t bytes = GetReportNumber(space_report, free_list_names[i]);
+      CHECK_GE(bytes, 0);
+      free_list_bytes += bytes;
+    }
+    CHECK_LE(free_list_bytes, space_pages * area_size - live_bytes);
+
+    if (space == old_pointer_space) {
+      CHECK_EQ(expected_live_bytes.length(), space_pages);
+      CHECK_GT(lower_half_pages, 0);
+    }
+  }
+
+  context->Exit();
+  context.Dispose();
+}
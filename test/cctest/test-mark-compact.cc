@@ -77,6 +77,170 @@ TEST(MarkingDeque) {
 }
 
 
+TEST(WorkStealingMarkingDeque) {
+  const int kObjects = 200;
+  WorkStealingMarkingDeque victim;
+  WorkStealingMarkingDeque thief;
+
+  Address address = NULL;
+  for (int i = 0; i < kObjects; i++) {
+    victim.Push(HeapObject::FromAddress(address));
+    address += kPointerSize;
+  }
+  CHECK(victim.HasSharedWork());
+  CHECK(!thief.HasSharedWork());
+
+  CHECK(victim.StealInto(&thief));
+  CHECK(!thief.StealInto(&victim));
+
+  int popped = 0;
+  HeapObject* object;
+  while (victim.Pop(&object)) popped++;
+  CHECK(victim.IsEmpty());
+  CHECK(!victim.StealInto(&thief));
+  while (thief.Pop(&object)) popped++;
+  CHECK(thief.IsEmpty());
+  CHECK_EQ(kObjects, popped);
+}
+
+
+TEST(ParallelMarking) {
+  FLAG_parallel_marking = true;
+  FLAG_marking_threads = 2;
+  FLAG_always_compact = true;
+  InitializeVM();
+  CHECK(Isolate::Current()->gc_helper_threads(GCHelperThread::MARKING) !=
+        NULL);
+
+  v8::HandleScope sc;
+  CompileRun(
+      "var live = [];"
+      "for (var i = 0; i < 20000; i++) {"
+      "  live.push({ index: i, name: 'o' + i, children: [{}, [i]] });"
+      "}"
+      "var garbage = [];"
+      "for (var i = 0; i < 20000; i++) garbage.push({ index: i });");
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  intptr_t size_with_garbage = HEAP->SizeOfObjects();
+
+  CompileRun("garbage = null;");
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  CHECK_LT(HEAP->SizeOfObjects(), size_with_garbage);
+
+  v8::Local<v8::Value> result = CompileRun(
+      "var sum = 0;"
+      "for (var i = 0; i < live.length; i++) {"
+      "  if (live[i].name == 'o' + i) sum += live[i].children[1][0];"
+      "}"
+      "sum;");
+  CHECK_EQ(199990000, result->Int32Value());
+}
+
+
+TEST(ConcurrentSweeping) {
+  FLAG_concurrent_sweeping = true;
+  FLAG_sweeper_threads = 2;
+  InitializeVM();
+  CHECK(Isolate::Current()->sweeper_threads() != NULL);
+  MarkCompactCollector* collector = HEAP->mark_compact_collector();
+
+  v8::HandleScope sc;
+  const int kArrays = 100;
+  const int kArrayLength = 8192;
+  Handle<FixedArray> survivors = FACTORY->NewFixedArray(kArrays, TENURED);
+  {
+    // Every other array survives, so that the pages of the old pointer
+    // space are neither empty nor full after the next GC.
+    AlwaysAllocateScope always_allocate;
+    for (int i = 0; i < kArrays; i++) {
+      Object* array =
+          HEAP->AllocateFixedArray(kArrayLength, TENURED)->ToObjectChecked();
+      if (i % 2 == 0) survivors->set(i, array);
+    }
+  }
+
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  CHECK(collector->IsConcurrentSweepingInProgress());
+  intptr_t capacity_after_gc = HEAP->old_pointer_space()->Capacity();
+
+  // Allocation picks up the memory freed by the sweeper threads instead of
+  // growing the space.  The arrays are small enough to be carved out of the
+  // freed blocks.
+  const int kSmallArrayLength = kArrayLength / 8;
+  for (int i = 0; i < kArrays * 2; i++) {
+    HEAP->AllocateFixedArray(kSmallArrayLength, TENURED)->ToObjectChecked();
+  }
+  CHECK_EQ(capacity_after_gc, HEAP->old_pointer_space()->Capacity());
+
+  if (collector->IsConcurrentSweepingInProgress()) {
+    collector->WaitUntilSweepingCompleted();
+  }
+  CHECK(!collector->IsConcurrentSweepingInProgress());
+  CHECK(HEAP->IsSweepingComplete());
+  PageIterator it(HEAP->old_pointer_space());
+  while (it.has_next()) {
+    Page* p = it.next();
+    CHECK_EQ(MemoryChunk::PARALLEL_SWEEPING_DONE, p->parallel_sweeping());
+  }
+
+  // The survivors are intact.
+  for (int i = 0; i < kArrays; i += 2) {
+    CHECK_EQ(kArrayLength, FixedArray::cast(survivors->get(i))->length());
+  }
+}
+
+
+TEST(ParallelCompaction) {
+  FLAG_parallel_compaction = true;
+  FLAG_compaction_threads = 2;
+  FLAG_always_compact = true;
+  InitializeVM();
+  CHECK(Isolate::Current()->gc_helper_threads(GCHelperThread::COMPACTION) !=
+        NULL);
+
+  v8::HandleScope sc;
+  const int kArrays = 2000;
+  const int kArrayLength = 256;
+  const int kStringLength = 512;
+  Handle<FixedArray> survivors = FACTORY->NewFixedArray(kArrays, TENURED);
+  Address addresses[kArrays];
+  {
+    // Every other array, heap number and string survives, so that pages in
+    // both old spaces become evacuation candidates.  The arrays also point to
+    // new space and to each other.
+    AlwaysAllocateScope always_allocate;
+    v8::HandleScope inner_scope;
+    for (int i = 0; i < kArrays; i++) {
+      Handle<FixedArray> array = FACTORY->NewFixedArray(kArrayLength, TENURED);
+      array->set(0, *FACTORY->NewNumber(i + 0.5, TENURED));
+      array->set(1, *FACTORY->NewFixedArray(1));
+      array->set(3, *FACTORY->NewRawAsciiString(kStringLength, TENURED));
+      if (i >= 2) array->set(2, survivors->get(i - 2));
+      if (i % 2 == 0) survivors->set(i, *array);
+      addresses[i] = array->address();
+    }
+  }
+
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+
+  int moved = 0;
+  for (int i = 0; i < kArrays; i += 2) {
+    FixedArray* array = FixedArray::cast(survivors->get(i));
+    if (array->address() != addresses[i]) moved++;
+    CHECK_EQ(kArrayLength, array->length());
+    CHECK_EQ(i + 0.5, array->get(0)->Number());
+    CHECK(array->get(1)->IsFixedArray());
+    if (i >= 2) CHECK_EQ(survivors->get(i - 2), array->get(2));
+    CHECK_EQ(kStringLength, String::cast(array->get(3))->length());
+  }
+  CHECK_GT(moved, 0);
+#ifdef DEBUG
+  HEAP->Verify();
+#endif
+}
+
+
 TEST(Promotion) {
   // This test requires compaction. If compaction is turned off, we
   // skip the entire test.
@@ -612,6 +612,87 @@ TEST(Utf8CharacterStream) {
   }
 }
 
+
+// Delivers a source in chunks of a fixed size.
+class ChunkedSourceStream : public v8::ScriptSourceStream {
+ public:
+  ChunkedSourceStream(const char* data, int length, int chunk_size)
+      : data_(data), length_(length), chunk_size_(chunk_size), position_(0) { }
+
+  virtual int GetNextChunk(const char** chunk) {
+    int size = i::Min(chunk_size_, length_ - position_);
+    *chunk = data_ + position_;
+    position_ += size;
+    return size;
+  }
+
+ private:
+  const char* data_;
+  int length_;
+  int chunk_size_;
+  int position_;
+};
+
+
+TEST(ChunkedUtf8CharacterStream) {
+  static const unsigned kMaxUC16CharU = unibrow::Utf8::kMaxThreeByteChar;
+  static const int kMaxUC16Char = static_cast<int>(kMaxUC16CharU);
+
+  static const int kAllUtf8CharsSize =
+      (unibrow::Utf8::kMaxOneByteChar + 1) +
+      (unibrow::Utf8::kMaxTwoByteChar - unibrow::Utf8::kMaxOneByteChar) * 2 +
+      (unibrow::Utf8::kMaxThreeByteChar - unibrow::Utf8::kMaxTwoByteChar) * 3;
+  static const unsigned kAllUtf8CharsSizeU =
+      static_cast<unsigned>(kAllUtf8CharsSize);
+
+  char buffer[kAllUtf8CharsSizeU];
+  unsigned cursor = 0;
+  for (int i = 0; i <= kMaxUC16Char; i++) {
+    cursor += unibrow::Utf8::Encode(buffer + cursor,
+                                    i,
+                                    unibrow::Utf16::kNoPreviousCharacter);
+  }
+  ASSERT(cursor == kAllUtf8CharsSizeU);
+
+  // Chunks of seven bytes split many of the multi-byte characters.
+  ChunkedSourceStream source(buffer, kAllUtf8CharsSize, 7);
+  i::ChunkedUtf8ToUtf16CharacterStream stream(&source);
+  for (int i = 0; i <= kMaxUC16Char; i++) {
+    CHECK_EQU(i, stream.pos());
+    int32_t c = stream.Advance();
+    CHECK_EQ(i, c);
+    CHECK_EQU(i + 1, stream.pos());
+  }
+  for (int i = kMaxUC16Char; i >= 0; i--) {
+    CHECK_EQU(i + 1, stream.pos());
+    stream.PushBack(i);
+    CHECK_EQU(i, stream.pos());
+  }
+  int i = 0;
+  while (stream.pos() < kMaxUC16CharU) {
+    CHECK_EQU(i, stream.pos());
+    unsigned progress = stream.SeekForward(12);
+    i += progress;
+    int32_t c = stream.Advance();
+    if (i <= kMaxUC16Char) {
+      CHECK_EQ(i, c);
+    } else {
+      CHECK_EQ(-1, c);
+    }
+    i += 1;
+    CHECK_EQU(i, stream.pos());
+  }
+
+  stream.ReadToEnd();
+  CHECK(!stream.is_ascii());
+  CHECK_EQU(kMaxUC16Char + 1, stream.length());
+  i::Vector<i::uc16> chars = stream.ReleaseTwoByteData();
+  for (int j = 0; j <= kMaxUC16Char; j++) {
+    CHECK_EQ(j, static_cast<int>(chars[j]));
+  }
+  chars.Dispose();
+}
+
 #undef CHECK_EQU
 
 void TestStreamScanner(i::Utf16CharacterStream* stream,
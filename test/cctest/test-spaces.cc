@@ -265,3 +265,49 @@ TEST(LargeObjectSpace) {
 
   CHECK(lo->AllocateRaw(lo_size, NOT_EXECUTABLE)->IsFailure());
 }
+
+
+TEST(HugePages) {
+  FLAG_huge_pages = true;
+  v8::V8::Initialize();
+  size_t huge_page_size = VirtualMemory::HugePageSize();
+  if (huge_page_size == 0) return;
+
+  MemoryAllocator* allocator = Isolate::Current()->memory_allocator();
+  intptr_t huge_pages_before = allocator->SizeHugePages();
+  {
+    v8::HandleScope scope;
+    int length = static_cast<int>(3 * huge_page_size / kPointerSize);
+    Handle<FixedArray> array = FACTORY->NewFixedArray(length, TENURED);
+    MemoryChunk* chunk = MemoryChunk::FromAddress(array->address());
+    CHECK(HEAP->lo_space()->Contains(*array));
+    CHECK(IsAligned(reinterpret_cast<intptr_t>(chunk->address()),
+                    huge_page_size));
+    // The kernel may not support transparent huge pages.
+    if (!chunk->IsFlagSet(MemoryChunk::HUGE_PAGES)) return;
+    CHECK_GE(allocator->SizeHugePages(),
+             huge_pages_before + static_cast<intptr_t>(3 * huge_page_size));
+
+    v8::HeapStatistics stats;
+    v8::V8::GetHeapStatistics(&stats);
+    CHECK_EQ(allocator->SizeHugePages(),
+             static_cast<intptr_t>(stats.total_heap_size_huge_pages()));
+  }
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  CHECK_EQ(huge_pages_before, allocator->SizeHugePages());
+
+  // A chunk kept in the large object chunk pool counts again once reused.
+  if (allocator->SizePooledLargeChunks() == 0) return;
+  {
+    v8::HandleScope scope;
+    int length = static_cast<int>(3 * huge_page_size / kPointerSize);
+    Handle<FixedArray> array = FACTORY->NewFixedArray(length, TENURED);
+    CHECK_EQ(static_cast<intptr_t>(0), allocator->SizePooledLargeChunks());
+    CHECK(MemoryChunk::FromAddress(array->address())->IsFlagSet(
+        MemoryChunk::HUGE_PAGES));
+    CHECK_GE(allocator->SizeHugePages(),
+             huge_pages_before + static_cast<intptr_t>(3 * huge_page_size));
+  }
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  CHECK_EQ(huge_pages_before, allocator->SizeHugePages());
+}
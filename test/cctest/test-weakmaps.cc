@@ -38,10 +38,12 @@ static Handle<JSWeakMap> AllocateJSWeakMap() {
   Handle<Map> map = FACTORY->NewMap(JS_WEAK_MAP_TYPE, JSWeakMap::kSize);
   Handle<JSObject> weakmap_obj = FACTORY->NewJSObjectFromMap(map);
   Handle<JSWeakMap> weakmap(JSWeakMap::cast(*weakmap_obj));
-  // Do not use handles for the hash table, it would make entries strong.
-  Object* table_obj = ObjectHashTable::Allocate(1)->ToObjectChecked();
-  ObjectHashTable* table = ObjectHashTable::cast(table_obj);
-  weakmap->set_table(table);
+  // Do not keep a handle to the hash table, it would make entries strong.
+  {
+    v8::HandleScope scope;
+    Handle<ObjectHashTable> table = FACTORY->NewObjectHashTable(1);
+    weakmap->set_table(*table);
+  }
   weakmap->set_next(Smi::FromInt(0));
   return weakmap;
 }
@@ -224,3 +226,54 @@ TEST(Regress2060b) {
   HEAP->CollectAllGarbage(Heap::kNoGCFlags);
   HEAP->CollectAllGarbage(Heap::kNoGCFlags);
 }
+
+
+// Test that a chain of weak maps, where the key of each entry is the value
+// of the entry in the previous weak map, is marked in a single pass.  The
+// weak maps are encountered in the opposite order of the chain, so marking
+// them by rescanning all weak maps until a fixed point is reached would be
+// quadratic in the length of the chain.
+TEST(EphemeronChain) {
+  FLAG_incremental_marking = false;
+  LocalContext context;
+  v8::HandleScope scope;
+  GlobalHandles* global_handles = Isolate::Current()->global_handles();
+  static const int kChainLength = 10000;
+
+  Handle<FixedArray> weakmaps = FACTORY->NewFixedArray(kChainLength);
+  Handle<Object> first_key;
+  {
+    v8::HandleScope scope;
+    Handle<Map> map = FACTORY->NewMap(JS_OBJECT_TYPE, JSObject::kHeaderSize);
+    first_key = global_handles->Create(*FACTORY->NewJSObjectFromMap(map));
+    // Only the chain itself may keep the keys alive, so the key of the next
+    // entry is passed on in a fixed array.
+    Handle<FixedArray> next_key = FACTORY->NewFixedArray(1);
+    next_key->set(0, *first_key);
+    for (int i = 0; i < kChainLength; i++) {
+      v8::HandleScope scope;
+      Handle<JSWeakMap> weakmap = AllocateJSWeakMap();
+      Handle<JSObject> key(JSObject::cast(next_key->get(0)));
+      Handle<JSObject> value = FACTORY->NewJSObjectFromMap(map);
+      PutIntoWeakMap(weakmap, key, value);
+      weakmaps->set(i, *weakmap);
+      next_key->set(0, *value);
+    }
+    next_key->set(0, Smi::FromInt(0));
+  }
+
+  // All entries are reachable from the first key.
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  for (int i = 0; i < kChainLength; i++) {
+    JSWeakMap* weakmap = JSWeakMap::cast(weakmaps->get(i));
+    CHECK_EQ(1, ObjectHashTable::cast(weakmap->table())->NumberOfElements());
+  }
+
+  // Dropping the first key makes all entries unreachable.
+  global_handles->Destroy(first_key.location());
+  HEAP->CollectAllGarbage(Heap::kNoGCFlags);
+  for (int i = 0; i < kChainLength; i++) {
+    JSWeakMap* weakmap = JSWeakMap::cast(weakmaps->get(i));
+    CHECK_EQ(0, ObjectHashTable::cast(weakmap->table())->NumberOfElements());
+  }
+}
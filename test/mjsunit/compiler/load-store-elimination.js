@@ -0,0 +1,100 @@
+// Copyright 2012 the V8 project authors. All rights reserved.
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+//       copyright notice, this list of conditions and the following
+//       disclaimer in the documentation and/or other materials provided
+//       with the distribution.
+//     * Neither the name of Google Inc. nor the names of its
+//       contributors may be used to endorse or promote products derived
+//       from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Flags: --allow-natives-syntax --use-load-store-elimination
+
+// Test that loads are forwarded from stores and earlier loads of the same
+// field, but not across stores that may write the same field through
+// another object, calls or loops.
+
+function Point(x, y) {
+  this.x = x;
+  this.y = y;
+}
+
+function forward(p, q) {
+  p.x = 1;
+  q.x = 2;  // p and q may be the same object.
+  var a = p.x;
+  p.y = 3;
+  p.y = 4;
+  return a + p.y;
+}
+
+function call(p, f) {
+  var a = p.x;
+  f(p);
+  return a + p.x;
+}
+
+function loop(p, n) {
+  var sum = 0;
+  var a = p.x;
+  for (var i = 0; i < n; i++) {
+    sum += p.x;
+    p.x = i;
+  }
+  return a + sum + p.x;
+}
+
+function merge(p, c) {
+  if (c) {
+    p.x = 10;
+  } else {
+    p.x = 20;
+  }
+  return p.x;
+}
+
+function increment(p) { p.x++; }
+
+function test() {
+  var p = new Point(0, 0);
+  var q = new Point(0, 0);
+  assertEquals(5, forward(p, q));
+  assertEquals(4, p.y);
+  assertEquals(6, forward(p, p));
+  assertEquals(2, p.x);
+
+  p.x = 1;
+  assertEquals(3, call(p, increment));
+
+  p.x = 5;
+  assertEquals(5 + (5 + 0 + 1) + 2, loop(p, 3));
+  assertEquals(2, p.x);
+
+  assertEquals(10, merge(p, true));
+  assertEquals(20, merge(p, false));
+}
+
+test();
+test();
+%OptimizeFunctionOnNextCall(forward);
+%OptimizeFunctionOnNextCall(call);
+%OptimizeFunctionOnNextCall(loop);
+%OptimizeFunctionOnNextCall(merge);
+test();
@@ -230,6 +230,17 @@ def scavenge_scope(r):
 def real_mutator(r):
   return r['mutator'] - r['stepstook']
 
+# Incremental marking steps are only reported by mark-sweeps, and the pause
+# target only by traces that have it.
+def longest_step(r):
+  return r.get('longeststep', 0)
+
+def capped_steps(r):
+  return r.get('cappedsteps', 0)
+
+def target_pause(r):
+  return r.get('targetpause', 0)
+
 plots = [
   [
     Set('style fill solid 0.5 noborder'),
@@ -288,6 +299,13 @@ plots = [
          Item('Reclaimed', reclaimed_bytes),
          Item('Promoted', 'promoted', style = 'lines', lc = 'black'))
   ],
+  [
+    Plot(Item('Longest IGC step', longest_step, style = 'lines', lc = 'red'),
+         Item('Target pause', target_pause, style = 'lines', lc = 'black'),
+         Item('Capped IGC steps', capped_steps, x1y2,
+              style = 'lines',
+              lc = 'blue'))
+  ],
 ]
 
 def freduce(f, field, trace, init):